@@ -0,0 +1,429 @@
+/**
+ * @file catalogo.c
+ * @brief Catalogo delle missioni caricato da file dati
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * Le definizioni delle missioni (nome, descrizione, obiettivi, oggetto) vivono
+ * in un unico catalogo indicizzato per id, letto da un file dati compatto.
+ * Il file viene caricato con una sola lettura in un unico blocco di memoria:
+ * le definizioni puntano direttamente al pool di stringhe del file, quindi il
+ * costo di avvio e la memoria per missione restano costanti al crescere del
+ * catalogo. Se il file manca si usa il catalogo predefinito compilato nel gioco,
+ * che è anche quello scritto da --esporta-missioni.
+ */
+
+#include "catalogo.h"
+#include "missioni.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Dimensione dell'intestazione del file (magic, versione, missioni, prerequisiti, pool)
+#define DIM_INTESTAZIONE_CATALOGO 20
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CATALOGO PREDEFINITO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Il Castello richiede le tre missioni preliminari
+static const uint32_t PREREQUISITI_CASTELLO[] = { MISSIONE_PALUDE, MISSIONE_MAGIONE, MISSIONE_GROTTA };
+
+/// @brief Missioni compilate nel gioco, nell'ordine di TipoMissione
+static const DefinizioneMissione MISSIONI_PREDEFINITE[] = {
+    [MISSIONE_PALUDE] = {
+        .nome = "Palude Putrescente",
+        .descrizione = "Sconfiggi 3 Generale Orco del Signore Oscuro",
+        .oggetto = "",
+        .obiettiviTotali = 3,                    // 3 Generali Orco da eliminare
+        .flag = 0
+    },
+    [MISSIONE_MAGIONE] = {
+        .nome = "Magione Infestata",
+        .descrizione = "Recupera la chiave del Castello e sconfiggi un Vampiro Superiore",
+        .oggetto = "Chiave del Castello",
+        .obiettiviTotali = 1,                    // 1 Vampiro Superiore da eliminare
+        .flag = MISSIONE_FLAG_OGGETTO
+    },
+    [MISSIONE_GROTTA] = {
+        .nome = "Grotta di Cristallo",
+        .descrizione = "Recupera la Spada dell'Eroe",
+        .oggetto = "Spada dell'Eroe",
+        .obiettiviTotali = 0,                    // Nessun nemico specifico, solo recuperare la spada
+        .flag = MISSIONE_FLAG_OGGETTO
+    },
+    [MISSIONE_CASTELLO] = {
+        .nome = "Castello del Signore Oscuro",
+        .descrizione = "Sconfiggi il Signore Oscuro",
+        .oggetto = "",
+        .obiettiviTotali = 1,                    // 1 boss finale
+        .flag = MISSIONE_FLAG_FINALE,
+        .prerequisiti = PREREQUISITI_CASTELLO,
+        .numeroPrerequisiti = sizeof(PREREQUISITI_CASTELLO) / sizeof(PREREQUISITI_CASTELLO[0])
+    },
+};
+
+#define NUMERO_MISSIONI_PREDEFINITE (int)(sizeof(MISSIONI_PREDEFINITE) / sizeof(MISSIONI_PREDEFINITE[0]))
+#define NUMERO_ARCHI_PREDEFINITI (int)(sizeof(PREREQUISITI_CASTELLO) / sizeof(PREREQUISITI_CASTELLO[0]))
+
+/// @brief Archi uscenti del catalogo predefinito (costruiti al primo utilizzo)
+static uint32_t inizioDipendentiPredefiniti[NUMERO_MISSIONI_PREDEFINITE + 1];
+static uint32_t dipendentiPredefiniti[NUMERO_ARCHI_PREDEFINITI];
+
+static CatalogoMissioni catalogoPredefinito;
+
+/// @brief Catalogo corrente (NULL finché non viene usato la prima volta)
+static const CatalogoMissioni* catalogoCorrente = NULL;
+
+/// @brief Catalogo caricato da file e blocco che contiene definizioni, grafo e pool
+static CatalogoMissioni catalogoCaricato;
+static void* bloccoCaricato = NULL;
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CODIFICA LITTLE-ENDIAN
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+static uint32_t leggiU32(const unsigned char* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint16_t leggiU16(const unsigned char* p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static void scriviU32(unsigned char* p, uint32_t valore) {
+    p[0] = valore & 0xff;
+    p[1] = (valore >> 8) & 0xff;
+    p[2] = (valore >> 16) & 0xff;
+    p[3] = (valore >> 24) & 0xff;
+}
+
+static void scriviU16(unsigned char* p, uint16_t valore) {
+    p[0] = valore & 0xff;
+    p[1] = (valore >> 8) & 0xff;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * GRAFO DEI PREREQUISITI
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Costruisce gli archi uscenti (missione -> missioni che la richiedono)
+ *
+ * @details
+ * I prerequisiti sono archi entranti; completaMissione() ha bisogno di quelli
+ * uscenti per aggiornare solo le missioni che dipendono da quella completata.
+ * Gli archi vengono raccolti in formato compresso (CSR): i dipendenti della
+ * missione i sono dipendenti[inizio[i] .. inizio[i+1]).
+ * Nello stesso passaggio verifica con l'algoritmo di Kahn che il grafo sia
+ * aciclico: una missione in un ciclo non potrebbe mai essere sbloccata.
+ *
+ * @param[in,out] c Catalogo con missioni e numeroArchi già impostati
+ * @param inizio Spazio per numeroMissioni + 1 elementi
+ * @param dipendenti Spazio per numeroArchi elementi
+ * @return false se un prerequisito non esiste, se il grafo ha un ciclo o manca la memoria
+ */
+static bool costruisciDipendenti(CatalogoMissioni* c, uint32_t* inizio, uint32_t* dipendenti) {
+    int n = c->numeroMissioni;
+
+    // Conteggio degli archi uscenti, poi somme prefisse
+    memset(inizio, 0, sizeof(uint32_t) * ((size_t)n + 1));
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < c->missioni[i].numeroPrerequisiti; k++) {
+            uint32_t p = c->missioni[i].prerequisiti[k];
+            if (p >= (uint32_t)n || p == (uint32_t)i) return false;
+            inizio[p + 1]++;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        inizio[i + 1] += inizio[i];
+    }
+
+    uint32_t* gradoEntrante = malloc(sizeof(uint32_t) * (size_t)n * 2 + 1);
+    if (!gradoEntrante) return false;
+    uint32_t* coda = gradoEntrante + n;
+
+    // Riempimento: il cursore di ogni missione parte dal suo inizio
+    for (int i = 0; i < n; i++) {
+        gradoEntrante[i] = inizio[i];
+    }
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < c->missioni[i].numeroPrerequisiti; k++) {
+            dipendenti[gradoEntrante[c->missioni[i].prerequisiti[k]]++] = (uint32_t)i;
+        }
+    }
+
+    // Kahn: se non si visitano tutte le missioni c'è un ciclo
+    int testa = 0, fondo = 0;
+    for (int i = 0; i < n; i++) {
+        gradoEntrante[i] = c->missioni[i].numeroPrerequisiti;
+        if (gradoEntrante[i] == 0) coda[fondo++] = (uint32_t)i;
+    }
+    while (testa < fondo) {
+        uint32_t m = coda[testa++];
+        for (uint32_t e = inizio[m]; e < inizio[m + 1]; e++) {
+            if (--gradoEntrante[dipendenti[e]] == 0) coda[fondo++] = dipendenti[e];
+        }
+    }
+
+    free(gradoEntrante);
+    c->inizioDipendenti = inizio;
+    c->dipendenti = dipendenti;
+    return fondo == n;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * ACCESSO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+const CatalogoMissioni* catalogoMissioni(void) {
+    if (catalogoCorrente == NULL && !caricaCatalogoMissioni(PERCORSO_CATALOGO_MISSIONI)) {
+        usaCatalogoPredefinito();
+    }
+    return catalogoCorrente;
+}
+
+const DefinizioneMissione* definizioneMissione(int id) {
+    const CatalogoMissioni* catalogo = catalogoMissioni();
+    if (id < 0 || id >= catalogo->numeroMissioni) {
+        return NULL;
+    }
+    return &catalogo->missioni[id];
+}
+
+int numeroMissioniCatalogo(void) {
+    return catalogoMissioni()->numeroMissioni;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CARICAMENTO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Decodifica il contenuto di un file catalogo già in memoria
+ *
+ * @details
+ * Controlla l'intestazione, che la dimensione del file corrisponda esattamente
+ * a intestazione + record + prerequisiti + pool, che ogni offset cada dentro il
+ * pool, che ogni lista di prerequisiti cada dentro il suo array e che il pool
+ * finisca con '\0' (così ogni stringa è terminata).
+ *
+ * @param dati Contenuto del file
+ * @param dimensione Numero di byte del file
+ * @param[out] definizioni Array da riempire (numeroMissioni elementi)
+ * @param[out] prerequisiti Array da riempire (numeroPrerequisiti elementi)
+ * @return false se il file non è valido
+ */
+static bool decodificaCatalogo(const unsigned char* dati, size_t dimensione,
+                               DefinizioneMissione* definizioni, uint32_t* prerequisiti) {
+    if (dimensione < DIM_INTESTAZIONE_CATALOGO || memcmp(dati, CATALOGO_MISSIONI_MAGIC, 4) != 0 ||
+        leggiU32(dati + 4) != CATALOGO_MISSIONI_VERSIONE) {
+        return false;
+    }
+
+    uint64_t numero = leggiU32(dati + 8);
+    uint64_t numeroArchi = leggiU32(dati + 12);
+    uint64_t dimensionePool = leggiU32(dati + 16);
+    if (numero > INT32_MAX || numeroArchi > INT32_MAX || dimensionePool == 0 ||
+        DIM_INTESTAZIONE_CATALOGO + numero * DIM_RECORD_MISSIONE + numeroArchi * 4 + dimensionePool != dimensione) {
+        return false;
+    }
+
+    const unsigned char* record = dati + DIM_INTESTAZIONE_CATALOGO;
+    const unsigned char* archi = record + numero * DIM_RECORD_MISSIONE;
+    const char* pool = (const char*)(archi + numeroArchi * 4);
+    if (pool[dimensionePool - 1] != '\0') {
+        return false;
+    }
+
+    for (uint64_t e = 0; e < numeroArchi; e++) {
+        prerequisiti[e] = leggiU32(archi + e * 4);
+    }
+
+    for (uint64_t i = 0; i < numero; i++, record += DIM_RECORD_MISSIONE) {
+        uint32_t nome = leggiU32(record);
+        uint32_t descrizione = leggiU32(record + 4);
+        uint32_t oggetto = leggiU32(record + 8);
+        uint64_t primo = leggiU32(record + 12);
+        uint16_t numeroPrerequisiti = leggiU16(record + 18);
+        if (nome >= dimensionePool || descrizione >= dimensionePool || oggetto >= dimensionePool ||
+            primo + numeroPrerequisiti > numeroArchi || leggiU16(record + 16) > MAX_OBIETTIVI_MISSIONE) {
+            return false;
+        }
+
+        definizioni[i].nome = pool + nome;
+        definizioni[i].descrizione = pool + descrizione;
+        definizioni[i].oggetto = pool + oggetto;
+        definizioni[i].obiettiviTotali = leggiU16(record + 16);
+        definizioni[i].flag = record[20];
+        definizioni[i].prerequisiti = prerequisiti + primo;
+        definizioni[i].numeroPrerequisiti = numeroPrerequisiti;
+    }
+    return true;
+}
+
+bool caricaCatalogoMissioni(const char* percorso) {
+    FILE* f = fopen(percorso, "rb");
+    if (!f) return false;
+
+    fseek(f, 0, SEEK_END);
+    long dimensione = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (dimensione < DIM_INTESTAZIONE_CATALOGO) {
+        fclose(f);
+        return false;
+    }
+
+    // I contatori dell'intestazione dimensionano un blocco solo che contiene
+    // definizioni, prerequisiti, archi uscenti e infine il file così com'è
+    unsigned char intestazione[DIM_INTESTAZIONE_CATALOGO];
+    if (fread(intestazione, 1, sizeof(intestazione), f) != sizeof(intestazione)) {
+        fclose(f);
+        return false;
+    }
+    uint64_t numero = leggiU32(intestazione + 8);
+    uint64_t numeroArchi = leggiU32(intestazione + 12);
+    if (numero * DIM_RECORD_MISSIONE + numeroArchi * 4 > (uint64_t)dimensione) {
+        fclose(f);
+        return false;
+    }
+
+    size_t dimDefinizioni = (size_t)numero * sizeof(DefinizioneMissione);
+    size_t dimGrafo = sizeof(uint32_t) * ((size_t)numeroArchi * 2 + (size_t)numero + 1);
+    unsigned char* blocco = malloc(dimDefinizioni + dimGrafo + (size_t)dimensione);
+    if (!blocco) {
+        fclose(f);
+        return false;
+    }
+
+    DefinizioneMissione* definizioni = (DefinizioneMissione*)blocco;
+    uint32_t* prerequisiti = (uint32_t*)(blocco + dimDefinizioni);
+    uint32_t* dipendenti = prerequisiti + numeroArchi;
+    uint32_t* inizio = dipendenti + numeroArchi;
+    unsigned char* dati = blocco + dimDefinizioni + dimGrafo;
+
+    memcpy(dati, intestazione, sizeof(intestazione));
+    size_t resto = (size_t)dimensione - sizeof(intestazione);
+    bool letto = fread(dati + sizeof(intestazione), 1, resto, f) == resto;
+    fclose(f);
+
+    CatalogoMissioni nuovo = {
+        .missioni = definizioni,
+        .numeroMissioni = (int)numero,
+        .numeroArchi = (int)numeroArchi
+    };
+    if (!letto || !decodificaCatalogo(dati, (size_t)dimensione, definizioni, prerequisiti) ||
+        !costruisciDipendenti(&nuovo, inizio, dipendenti)) {
+        free(blocco);
+        return false;
+    }
+
+    free(bloccoCaricato);
+    bloccoCaricato = blocco;
+    catalogoCaricato = nuovo;
+    catalogoCorrente = &catalogoCaricato;
+    return true;
+}
+
+void usaCatalogoPredefinito(void) {
+    catalogoPredefinito.missioni = MISSIONI_PREDEFINITE;
+    catalogoPredefinito.numeroMissioni = NUMERO_MISSIONI_PREDEFINITE;
+    catalogoPredefinito.numeroArchi = NUMERO_ARCHI_PREDEFINITI;
+    costruisciDipendenti(&catalogoPredefinito, inizioDipendentiPredefiniti, dipendentiPredefiniti);
+
+    catalogoCorrente = &catalogoPredefinito;
+    free(bloccoCaricato);
+    bloccoCaricato = NULL;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * ESPORTAZIONE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Offset che avrà una stringa nel pool (la stringa vuota è sempre all'offset 0)
+ */
+static uint32_t offsetNelPool(const char* testo, uint32_t* dimensionePool) {
+    if (testo == NULL || testo[0] == '\0') return 0;
+    uint32_t offset = *dimensionePool;
+    *dimensionePool += (uint32_t)strlen(testo) + 1;
+    return offset;
+}
+
+bool esportaCatalogoMissioni(const char* percorso) {
+    const CatalogoMissioni* catalogo = catalogoMissioni();
+
+    FILE* f = fopen(percorso, "wb");
+    if (!f) return false;
+
+    // Prima passata: record con gli offset (il pool inizia con la stringa vuota)
+    uint32_t dimensionePool = 1;
+    uint32_t primoPrerequisito = 0;
+    bool ok = true;
+
+    unsigned char intestazione[DIM_INTESTAZIONE_CATALOGO];
+    memcpy(intestazione, CATALOGO_MISSIONI_MAGIC, 4);
+    scriviU32(intestazione + 4, CATALOGO_MISSIONI_VERSIONE);
+    scriviU32(intestazione + 8, (uint32_t)catalogo->numeroMissioni);
+    scriviU32(intestazione + 12, (uint32_t)catalogo->numeroArchi);
+    scriviU32(intestazione + 16, 0);                       // Riscritta alla fine
+    ok = ok && fwrite(intestazione, 1, sizeof(intestazione), f) == sizeof(intestazione);
+
+    for (int i = 0; i < catalogo->numeroMissioni; i++) {
+        const DefinizioneMissione* d = &catalogo->missioni[i];
+        unsigned char record[DIM_RECORD_MISSIONE] = {0};
+
+        scriviU32(record, offsetNelPool(d->nome, &dimensionePool));
+        scriviU32(record + 4, offsetNelPool(d->descrizione, &dimensionePool));
+        scriviU32(record + 8, offsetNelPool(d->oggetto, &dimensionePool));
+        scriviU32(record + 12, primoPrerequisito);
+        scriviU16(record + 16, d->obiettiviTotali);
+        scriviU16(record + 18, d->numeroPrerequisiti);
+        record[20] = d->flag;
+        primoPrerequisito += d->numeroPrerequisiti;
+        ok = ok && fwrite(record, 1, sizeof(record), f) == sizeof(record);
+    }
+
+    // Liste dei prerequisiti, nello stesso ordine dei record
+    for (int i = 0; i < catalogo->numeroMissioni; i++) {
+        const DefinizioneMissione* d = &catalogo->missioni[i];
+        for (int k = 0; k < d->numeroPrerequisiti; k++) {
+            unsigned char arco[4];
+            scriviU32(arco, d->prerequisiti[k]);
+            ok = ok && fwrite(arco, 1, sizeof(arco), f) == sizeof(arco);
+        }
+    }
+
+    // Seconda passata: il pool nello stesso ordine degli offset
+    ok = ok && fputc('\0', f) != EOF;
+    for (int i = 0; i < catalogo->numeroMissioni; i++) {
+        const DefinizioneMissione* d = &catalogo->missioni[i];
+        const char* testi[] = { d->nome, d->descrizione, d->oggetto };
+        for (int t = 0; t < 3; t++) {
+            if (testi[t] != NULL && testi[t][0] != '\0') {
+                ok = ok && fwrite(testi[t], 1, strlen(testi[t]) + 1, f) == strlen(testi[t]) + 1;
+            }
+        }
+    }
+
+    scriviU32(intestazione + 16, dimensionePool);
+    ok = ok && fseek(f, 16, SEEK_SET) == 0 && fwrite(intestazione + 16, 1, 4, f) == 4;
+
+    return (fclose(f) == 0) && ok;
+}
+
+int mainEsportaMissioni(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s --esporta-missioni FILE\n", argv[0]);
+        return 1;
+    }
+
+    if (!esportaCatalogoMissioni(argv[1])) {
+        fprintf(stderr, "Impossibile scrivere il catalogo '%s'\n", argv[1]);
+        return 1;
+    }
+
+    printf("{\"missioni\":%d,\"file\":\"%s\"}\n", numeroMissioniCatalogo(), argv[1]);
+    return 0;
+}
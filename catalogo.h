@@ -0,0 +1,109 @@
+#ifndef CATALOGO_H
+#define CATALOGO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Catalogo delle missioni: unica fonte dei dati immutabili di ogni missione
+ * (nome, descrizione, obiettivi, oggetto da recuperare, prerequisiti).
+ *
+ * Formato del file dati (interi little-endian a dimensione fissa):
+ *   "DGMC"  versione:u32  numeroMissioni:u32  numeroPrerequisiti:u32  dimensionePool:u32
+ *   numeroMissioni record da DIM_RECORD_MISSIONE byte:
+ *     nome:u32  descrizione:u32  oggetto:u32   (offset nel pool di stringhe)
+ *     primoPrerequisito:u32  obiettiviTotali:u16  numeroPrerequisiti:u16
+ *     flag:u8  riservato:3 byte
+ *   numeroPrerequisiti id di missione:u32 (le liste dei record, una dopo l'altra)
+ *   pool di stringhe terminate da '\0'
+ * L'id di una missione è la posizione del suo record: la ricerca per id è un
+ * accesso diretto all'array. Il file viene letto con una sola lettura in un
+ * unico blocco e le stringhe non vengono copiate.
+ */
+#define CATALOGO_MISSIONI_MAGIC "DGMC"
+#define CATALOGO_MISSIONI_VERSIONE 2
+#define DIM_RECORD_MISSIONE 24
+#define PERCORSO_CATALOGO_MISSIONI "dati/missioni.dat"
+#define MAX_OBIETTIVI_MISSIONE 255         // Gli obiettivi raggiunti sono contati su 8 bit
+
+// Flag di una missione
+#define MISSIONE_FLAG_FINALE  0x01         // Missione finale (mostrata come tale nel menu)
+#define MISSIONE_FLAG_OGGETTO 0x02         // Per completarla va recuperato un oggetto speciale
+
+// Dati immutabili di una missione
+typedef struct {
+    const char* nome;              // Nome descrittivo della missione
+    const char* descrizione;       // Descrizione dell'obiettivo
+    const char* oggetto;           // Oggetto speciale da recuperare ("" se nessuno)
+    uint16_t obiettiviTotali;      // Numero di obiettivi necessari (es: 3 Generali Orco)
+    uint8_t flag;                  // Combinazione di MISSIONE_FLAG_*
+    const uint32_t* prerequisiti;  // Id delle missioni da completare prima di sbloccarla
+    uint16_t numeroPrerequisiti;   // Numero di prerequisiti (0 = sbloccata dall'inizio)
+} DefinizioneMissione;
+
+// Catalogo caricato: array di definizioni indicizzato per id più il grafo dei prerequisiti
+typedef struct {
+    const DefinizioneMissione* missioni;   // Definizioni, indice = id della missione
+    int numeroMissioni;                    // Numero di missioni del catalogo
+    int numeroArchi;                       // Numero totale di prerequisiti
+    const uint32_t* inizioDipendenti;      // numeroMissioni + 1 elementi (formato CSR)
+    const uint32_t* dipendenti;            // Missioni che richiedono ciascuna missione
+} CatalogoMissioni;
+
+/**
+ * Missioni che hanno la missione indicata tra i prerequisiti:
+ * dipendenti[inizioDipendenti[id] .. inizioDipendenti[id + 1])
+ * Il grafo viene verificato aciclico al caricamento
+ */
+static inline const uint32_t* dipendentiMissione(const CatalogoMissioni* c, int id, int* numero) {
+    *numero = (int)(c->inizioDipendenti[id + 1] - c->inizioDipendenti[id]);
+    return c->dipendenti + c->inizioDipendenti[id];
+}
+
+// --- ACCESSO AL CATALOGO ---
+
+/**
+ * Ritorna il catalogo corrente
+ * Al primo utilizzo prova a caricare PERCORSO_CATALOGO_MISSIONI e,
+ * se il file manca o non è valido, usa il catalogo predefinito
+ */
+const CatalogoMissioni* catalogoMissioni(void);
+
+/**
+ * Ritorna la definizione della missione con l'id indicato (NULL se non esiste)
+ */
+const DefinizioneMissione* definizioneMissione(int id);
+
+/**
+ * Numero di missioni del catalogo corrente
+ */
+int numeroMissioniCatalogo(void);
+
+// --- CARICAMENTO ED ESPORTAZIONE ---
+
+/**
+ * Carica il catalogo dal file indicato e lo rende il catalogo corrente
+ * Ritorna false (lasciando invariato il catalogo corrente) se il file
+ * non esiste o non è un catalogo valido (compresi prerequisiti ciclici)
+ */
+bool caricaCatalogoMissioni(const char* percorso);
+
+/**
+ * Torna al catalogo predefinito compilato nel gioco
+ */
+void usaCatalogoPredefinito(void);
+
+/**
+ * Scrive il catalogo corrente nel formato del file dati
+ * Ritorna false se il file non può essere scritto
+ */
+bool esportaCatalogoMissioni(const char* percorso);
+
+/**
+ * Esporta il catalogo corrente su file
+ * Uso: --esporta-missioni FILE
+ * Ritorna 0 se tutto è andato bene, 1 in caso di errore
+ */
+int mainEsportaMissioni(int argc, char* argv[]);
+
+#endif // CATALOGO_H
@@ -0,0 +1,579 @@
+/**
+ * @file combattimento.c
+ * @brief Motore dei combattimenti con generatore Philox4x32-10
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+ * cifra un contatore da 128 bit con una chiave da 64 bit in 10 round di
+ * moltiplicazioni 32x32 -> 64 e XOR. Qui il contatore è
+ * (round, 0, incontro basso, incontro alto) e la chiave è il seme.
+ *
+ * Il danno di un colpo è 1 + (x * danno) >> 32: una moltiplicazione al posto
+ * del modulo, senza divisioni nel round.
+ *
+ * Le tabelle degli esiti risolvono la stessa catena di Markov in modo esatto:
+ * da (h, n) ogni round porta a uno stato con h o n più piccolo, tranne il
+ * round in cui entrambi mancano, che torna in (h, n) con probabilità q.
+ * Sommando la serie geometrica di quei round, la riga di (h, n) è la
+ * combinazione delle righe già calcolate divisa per (1 - q).
+ */
+
+#include "combattimento.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PHILOX_M0 0xD2511F53u              ///< Moltiplicatori di Philox4x32
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u              ///< Incrementi della chiave (costante di Weyl)
+#define PHILOX_W1 0xBB67AE85u
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * GENERATORE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Blocco di quattro numeri da 32 bit per il contatore x con chiave k
+static inline void philox4x32(uint32_t x[4], uint32_t k0, uint32_t k1) {
+    for (int i = 0; i < 10; i++) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * x[0];
+        uint64_t p1 = (uint64_t)PHILOX_M1 * x[2];
+        uint32_t y0 = (uint32_t)(p1 >> 32) ^ x[1] ^ k0;
+        uint32_t y2 = (uint32_t)(p0 >> 32) ^ x[3] ^ k1;
+        x[1] = (uint32_t)p1;
+        x[3] = (uint32_t)p0;
+        x[0] = y0;
+        x[2] = y2;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+/// @brief Numero in [0, n) da 32 bit casuali
+static inline int entro(uint32_t x, int n) {
+    return (int)(((uint64_t)x * (uint32_t)n) >> 32);
+}
+
+/// @brief Danno di un attacco: 0 se manca (tiro >= precisione), altrimenti almeno 1 dopo la difesa
+static inline int colpo(const Combattente* attaccante, const Combattente* difensore,
+                        int tiro, uint32_t tiroDanno) {
+    if (tiro >= attaccante->precisione) return 0;
+    int danno = 1 + entro(tiroDanno, attaccante->danno) - difensore->difesa;
+    return danno > 1 ? danno : 1;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * REGISTRO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Aggiunge una voce al registro (se c'è): solo una copia di 16 byte, niente testo
+static inline void annota(RegistroCombattimento* registro, uint64_t incontro, uint32_t round,
+                          TipoVoceRegistro tipo, int flag, int attaccante, int bersaglio,
+                          int tiro, int danno, int vitaRimasta) {
+    if (registro == NULL) return;
+    if (vitaRimasta > INT16_MAX) vitaRimasta = INT16_MAX;
+    if (danno > INT16_MAX) danno = INT16_MAX;
+
+    registro->voci[registro->scritte++ & (DIM_REGISTRO_COMBATTIMENTO - 1)] = (VoceRegistro){
+        .incontro = (uint32_t)incontro,
+        .round = (uint16_t)round,
+        .tipo = (uint8_t)tipo,
+        .flag = (uint8_t)flag,
+        .attaccante = (int8_t)attaccante,
+        .bersaglio = (int8_t)bersaglio,
+        .tiro = (uint8_t)tiro,
+        .danno = (int16_t)danno,
+        .vitaRimasta = (int16_t)vitaRimasta
+    };
+}
+
+/// @brief Nome del nemico coinvolto in una voce
+static const char* nomeNemico(const VoceRegistro* voce) {
+    return (voce->flag & VOCE_GENERALE) ? "il generale" : "il nemico";
+}
+
+size_t formattaVoceRegistro(const VoceRegistro* voce, char* buffer, size_t dimensione) {
+    const char* danni = voce->danno == 1 ? "danno" : "danni";
+    int n;
+
+    switch (voce->tipo) {
+        case VOCE_ATTACCO:
+            if (voce->attaccante == EROE_NEL_REGISTRO) {
+                n = voce->danno > 0
+                    ? snprintf(buffer, dimensione, "Round %u: colpisci %s per %d %s (tiro %u, vita %d).",
+                               voce->round, nomeNemico(voce), voce->danno, danni, voce->tiro, voce->vitaRimasta)
+                    : snprintf(buffer, dimensione, "Round %u: manchi %s (tiro %u).",
+                               voce->round, nomeNemico(voce), voce->tiro);
+            } else {
+                n = voce->danno > 0
+                    ? snprintf(buffer, dimensione, "Round %u: %s ti colpisce per %d %s (tiro %u, vita %d).",
+                               voce->round, nomeNemico(voce), voce->danno, danni, voce->tiro, voce->vitaRimasta)
+                    : snprintf(buffer, dimensione, "Round %u: %s ti manca (tiro %u).",
+                               voce->round, nomeNemico(voce), voce->tiro);
+            }
+            break;
+
+        case VOCE_CADUTA:
+            n = voce->bersaglio == EROE_NEL_REGISTRO
+                ? snprintf(buffer, dimensione, "Round %u: cadi in combattimento.", voce->round)
+                : snprintf(buffer, dimensione, "Round %u: %s cade.", voce->round, nomeNemico(voce));
+            break;
+
+        default:
+            n = snprintf(buffer, dimensione, "Round %u: voce sconosciuta.", voce->round);
+            break;
+    }
+    return n < 0 ? 0 : (size_t)n;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * COMBATTENTI
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+Combattente combattenteEroe(const Eroe* eroe) {
+    return (Combattente){ eroe->vita, DANNO_EROE, PRECISIONE_EROE, 0 };
+}
+
+Combattente combattenteNemico(int vitaBase, int dannoBase, int precisione, int livello, bool generale) {
+    if (livello < 1) livello = 1;
+    if (dannoBase < 1) dannoBase = 1;
+    return (Combattente){
+        .vita = vitaBase + 3 * (livello - 1),
+        .danno = dannoBase + (generale ? 2 : 0) + (livello - 1),
+        .precisione = precisione,
+        .difesa = 0
+    };
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * COMBATTIMENTO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+void iniziaCombattimento(Combattimento* c, const Combattente* eroe, const Combattente* nemico,
+                         uint64_t seme, uint64_t incontro) {
+    c->eroe = *eroe;
+    c->nemico = *nemico;
+    if (c->eroe.danno < 1) c->eroe.danno = 1;
+    if (c->nemico.danno < 1) c->nemico.danno = 1;
+    c->chiave[0] = (uint32_t)seme;
+    c->chiave[1] = (uint32_t)(seme >> 32);
+    c->incontro = incontro;
+    c->round = 0;
+    c->esito = c->eroe.vita <= 0 ? COMBATTIMENTO_SCONFITTA :
+               c->nemico.vita <= 0 ? COMBATTIMENTO_VITTORIA : COMBATTIMENTO_IN_CORSO;
+    c->registro = NULL;
+}
+
+EsitoCombattimento risolviRound(Combattimento* c, RoundCombattimento* dettaglio) {
+    RoundCombattimento r = { 0, 0 };
+
+    if (c->esito == COMBATTIMENTO_IN_CORSO) {
+        CONTA_SONDA(SONDA_ROUND, 1);
+        uint32_t x[4] = { c->round, 0, (uint32_t)c->incontro, (uint32_t)(c->incontro >> 32) };
+        philox4x32(x, c->chiave[0], c->chiave[1]);
+        c->round++;
+
+        int tiro = entro(x[0], 100);
+        r.dannoInflitto = colpo(&c->eroe, &c->nemico, tiro, x[1]);
+        c->nemico.vita -= r.dannoInflitto;
+        if (c->nemico.vita < 0) c->nemico.vita = 0;
+        annota(c->registro, c->incontro, c->round, VOCE_ATTACCO, 0, EROE_NEL_REGISTRO, 0,
+               tiro, r.dannoInflitto, c->nemico.vita);
+
+        if (c->nemico.vita == 0) {
+            annota(c->registro, c->incontro, c->round, VOCE_CADUTA, 0, EROE_NEL_REGISTRO, 0, 0, 0, 0);
+            c->esito = COMBATTIMENTO_VITTORIA;
+        } else {
+            tiro = entro(x[2], 100);
+            r.dannoSubito = colpo(&c->nemico, &c->eroe, tiro, x[3]);
+            c->eroe.vita -= r.dannoSubito;
+            if (c->eroe.vita < 0) c->eroe.vita = 0;
+            annota(c->registro, c->incontro, c->round, VOCE_ATTACCO, 0, 0, EROE_NEL_REGISTRO,
+                   tiro, r.dannoSubito, c->eroe.vita);
+
+            if (c->eroe.vita == 0) {
+                annota(c->registro, c->incontro, c->round, VOCE_CADUTA, 0, 0, EROE_NEL_REGISTRO, 0, 0, 0);
+                c->esito = COMBATTIMENTO_SCONFITTA;
+            } else if (c->round >= MAX_ROUND_COMBATTIMENTO) {
+                c->esito = COMBATTIMENTO_FUGA;
+            }
+        }
+    }
+
+    if (dettaglio != NULL) *dettaglio = r;
+    return c->esito;
+}
+
+EsitoCombattimento risolviCombattimento(Combattimento* c) {
+    MISURA_SONDA(SONDA_COMBATTIMENTO);
+    while (c->esito == COMBATTIMENTO_IN_CORSO) {
+        risolviRound(c, NULL);
+    }
+    return c->esito;
+}
+
+void applicaCombattimento(Eroe* eroe, const Combattimento* c) {
+    modificaVita(eroe, c->eroe.vita - eroe->vita);
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * GRUPPI DI NEMICI
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+bool inizializzaPoolNemici(PoolNemici* p, int capacita, Arena* arena) {
+    memset(p, 0, sizeof(*p));
+    if (capacita < 1 || capacita > MAX_NEMICI_POOL) return false;
+
+    size_t n = (size_t)capacita;
+    char* blocco = allocaMemoria(arena, (sizeof(int32_t) * 6 + sizeof(uint32_t) + sizeof(uint16_t)) * n);
+    if (blocco == NULL) return false;
+
+    p->arena = arena;
+    p->blocco = blocco;
+    p->vita = (int32_t*)blocco;
+    p->attacco = p->vita + n;
+    p->difesa = p->attacco + n;
+    p->precisione = p->difesa + n;
+    p->danni = p->precisione + n;
+    p->liberi = p->danni + n;
+    p->stato = (uint32_t*)(p->liberi + n);
+    p->generazione = (uint16_t*)(p->stato + n);
+    p->capacita = capacita;
+    return true;
+}
+
+void liberaPoolNemici(PoolNemici* p) {
+    if (p == NULL) return;
+    rilasciaMemoria(p->arena, p->blocco);
+    memset(p, 0, sizeof(*p));
+}
+
+void svuotaPoolNemici(PoolNemici* p) {
+    for (int i = 0; i < p->alto; i++) {
+        if (p->stato[i] & NEMICO_VIVO) p->generazione[i]++;
+        p->stato[i] = 0;
+    }
+    p->alto = 0;
+    p->numeroLiberi = 0;
+    p->vivi = 0;
+}
+
+ManigliaNemico aggiungiNemico(PoolNemici* p, const Combattente* nemico, bool generale) {
+    int slot;
+    if (p->numeroLiberi > 0) {
+        slot = p->liberi[--p->numeroLiberi];
+    } else if (p->alto < p->capacita) {
+        slot = p->alto++;
+    } else {
+        return NEMICO_NESSUNO;
+    }
+
+    p->vita[slot] = nemico->vita;
+    p->attacco[slot] = nemico->danno > 0 ? nemico->danno : 1;
+    p->difesa[slot] = nemico->difesa;
+    p->precisione[slot] = nemico->precisione;
+    p->danni[slot] = 0;
+    p->stato[slot] = NEMICO_VIVO | (generale ? NEMICO_GENERALE : 0);
+    p->vivi++;
+    return (ManigliaNemico)p->generazione[slot] << 16 | (ManigliaNemico)(slot + 1);
+}
+
+void danneggiaNemici(PoolNemici* p) {
+    int32_t* restrict vita = p->vita;
+    int32_t* restrict danni = p->danni;
+    const int32_t* restrict difesa = p->difesa;
+    const uint32_t* restrict stato = p->stato;
+    int n = p->alto;
+
+    // NEMICO_VIVO vale 1: fa da maschera moltiplicativa
+    for (int i = 0; i < n; i++) {
+        int32_t effettivo = danni[i] - difesa[i];
+        effettivo = effettivo > 1 ? effettivo : 1;
+        vita[i] -= effettivo * (int32_t)((danni[i] > 0) & stato[i] & NEMICO_VIVO);
+        danni[i] = 0;
+    }
+}
+
+int raccogliCaduti(PoolNemici* p, ManigliaNemico* caduti, int massimo) {
+    const int32_t* restrict vita = p->vita;
+    const uint32_t* restrict stato = p->stato;
+    int n = p->alto;
+    int numero = 0;
+
+    // Prima un conteggio senza salti: di solito non cade nessuno
+    for (int i = 0; i < n; i++) {
+        numero += (vita[i] <= 0) * (int)(stato[i] & NEMICO_VIVO);
+    }
+    if (numero == 0) return 0;
+
+    int scritti = 0;
+    for (int i = 0; i < n; i++) {
+        if (!(p->stato[i] & NEMICO_VIVO) || p->vita[i] > 0) continue;
+        if (caduti != NULL && scritti < massimo) {
+            caduti[scritti++] = (ManigliaNemico)p->generazione[i] << 16 | (ManigliaNemico)(i + 1);
+        }
+        p->vita[i] = 0;
+        p->stato[i] = 0;
+        p->generazione[i]++;
+        p->liberi[p->numeroLiberi++] = i;
+        p->vivi--;
+    }
+    return numero;
+}
+
+void iniziaCombattimentoGruppo(CombattimentoGruppo* c, const Combattente* eroe, PoolNemici* nemici,
+                               uint64_t seme, uint64_t incontro) {
+    c->eroe = *eroe;
+    if (c->eroe.danno < 1) c->eroe.danno = 1;
+    c->nemici = nemici;
+    c->chiave[0] = (uint32_t)seme;
+    c->chiave[1] = (uint32_t)(seme >> 32);
+    c->incontro = incontro;
+    c->round = 0;
+    c->esito = c->eroe.vita <= 0 ? COMBATTIMENTO_SCONFITTA :
+               nemici->vivi == 0 ? COMBATTIMENTO_VITTORIA : COMBATTIMENTO_IN_CORSO;
+    c->registro = NULL;
+}
+
+/// @brief Flag della voce per il nemico nello slot
+static inline int flagNemico(const PoolNemici* p, int slot) {
+    return (p->stato[slot] & NEMICO_GENERALE) ? VOCE_GENERALE : 0;
+}
+
+/// @brief Annota i nemici senza più vita prima che raccogliCaduti() liberi i loro slot
+static void annotaCaduti(const CombattimentoGruppo* c, uint32_t round) {
+    const PoolNemici* p = c->nemici;
+    for (int i = 0; i < p->alto; i++) {
+        if ((p->stato[i] & NEMICO_VIVO) && p->vita[i] <= 0) {
+            annota(c->registro, c->incontro, round, VOCE_CADUTA, flagNemico(p, i),
+                   EROE_NEL_REGISTRO, i, 0, 0, 0);
+        }
+    }
+}
+
+EsitoCombattimento risolviRoundGruppo(CombattimentoGruppo* c, RoundCombattimento* dettaglio) {
+    MISURA_SONDA(SONDA_ROUND_GRUPPO);
+    RoundCombattimento r = { 0, 0 };
+    PoolNemici* p = c->nemici;
+
+    if (c->esito == COMBATTIMENTO_IN_CORSO) {
+        uint32_t numero = c->round + 1;   // Round nel registro
+        uint32_t lo = (uint32_t)c->incontro, hi = (uint32_t)(c->incontro >> 32);
+        uint32_t x[4] = { c->round, 0, lo, hi };
+        philox4x32(x, c->chiave[0], c->chiave[1]);
+
+        // L'eroe finisce per primo il nemico più debole
+        int bersaglio = -1;
+        for (int i = 0; i < p->alto; i++) {
+            if ((p->stato[i] & NEMICO_VIVO) && (bersaglio < 0 || p->vita[i] < p->vita[bersaglio])) {
+                bersaglio = i;
+            }
+        }
+        int tiro = entro(x[0], 100);
+        if (bersaglio >= 0 && tiro < c->eroe.precisione) {
+            int32_t prima = p->vita[bersaglio];
+            p->danni[bersaglio] = 1 + entro(x[1], c->eroe.danno);
+            danneggiaNemici(p);
+            r.dannoInflitto = prima - p->vita[bersaglio];
+        }
+        if (c->registro != NULL && bersaglio >= 0) {
+            int vita = p->vita[bersaglio] > 0 ? p->vita[bersaglio] : 0;
+            annota(c->registro, c->incontro, numero, VOCE_ATTACCO, flagNemico(p, bersaglio),
+                   EROE_NEL_REGISTRO, bersaglio, tiro, r.dannoInflitto, vita);
+            annotaCaduti(c, numero);
+        }
+        raccogliCaduti(p, NULL, 0);
+
+        // Attaccano tutti i nemici rimasti: lo slot i usa le ultime due parole del blocco (round, i)
+        for (int i = 0; i < p->alto; i++) {
+            uint32_t y[4] = { c->round, (uint32_t)i, lo, hi };
+            philox4x32(y, c->chiave[0], c->chiave[1]);
+            int32_t danno = 1 + entro(y[3], p->attacco[i]) - c->eroe.difesa;
+            danno = danno > 1 ? danno : 1;
+            int tiroNemico = entro(y[2], 100);
+            bool vivo = (p->stato[i] & NEMICO_VIVO) != 0;
+            bool colpisce = vivo && tiroNemico < p->precisione[i];
+            r.dannoSubito += colpisce ? danno : 0;
+
+            if (c->registro != NULL && vivo) {
+                int vita = c->eroe.vita - r.dannoSubito;
+                annota(c->registro, c->incontro, numero, VOCE_ATTACCO, flagNemico(p, i), i,
+                       EROE_NEL_REGISTRO, tiroNemico, colpisce ? danno : 0, vita > 0 ? vita : 0);
+            }
+        }
+        c->eroe.vita -= r.dannoSubito;
+        c->round++;
+
+        if (c->eroe.vita <= 0) {
+            c->eroe.vita = 0;
+            annota(c->registro, c->incontro, numero, VOCE_CADUTA, 0, 0, EROE_NEL_REGISTRO, 0, 0, 0);
+            c->esito = COMBATTIMENTO_SCONFITTA;
+        } else if (p->vivi == 0) {
+            c->esito = COMBATTIMENTO_VITTORIA;
+        } else if (c->round >= MAX_ROUND_COMBATTIMENTO) {
+            c->esito = COMBATTIMENTO_FUGA;
+        }
+    }
+
+    if (dettaglio != NULL) *dettaglio = r;
+    return c->esito;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * DISTRIBUZIONE ESATTA DEGLI ESITI
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Probabilità di ogni danno di un attacco: [0] = mancato, [d] = d danni
+ *
+ * I danni oltre MAX_VITA_ESITI sono contati in MAX_VITA_ESITI: abbattono
+ * comunque qualsiasi combattente tabulato.
+ */
+static void distribuzioneDanno(const Combattente* attaccante, const Combattente* difensore,
+                               double danno[MAX_VITA_ESITI + 1]) {
+    double colpisce = attaccante->precisione <= 0 ? 0.0 :
+                      attaccante->precisione >= 100 ? 1.0 : attaccante->precisione / 100.0;
+
+    memset(danno, 0, sizeof(double) * (MAX_VITA_ESITI + 1));
+    danno[0] = 1.0 - colpisce;
+    for (int tiro = 1; tiro <= attaccante->danno; tiro++) {
+        int d = tiro - difensore->difesa;
+        if (d < 1) d = 1;
+        if (d > MAX_VITA_ESITI) d = MAX_VITA_ESITI;
+        danno[d] += colpisce / attaccante->danno;
+    }
+}
+
+bool calcolaTabellaEsiti(TabellaEsiti* t, const Combattente* eroe, const Combattente* nemico,
+                         int vitaEroe, int vitaNemico) {
+    MISURA_SONDA(SONDA_TABELLA_ESITI);
+    memset(t, 0, sizeof(*t));
+    if (vitaEroe < 1 || vitaNemico < 1 || vitaEroe > MAX_VITA_ESITI || vitaNemico > MAX_VITA_ESITI) {
+        return false;
+    }
+
+    t->eroe = *eroe;
+    t->nemico = *nemico;
+    if (t->eroe.danno < 1) t->eroe.danno = 1;
+    if (t->nemico.danno < 1) t->nemico.danno = 1;
+    t->vitaEroe = vitaEroe;
+    t->vitaNemico = vitaNemico;
+
+    // Somma delle lunghezze (h + n) di tutte le righe
+    size_t stati = (size_t)vitaEroe * vitaNemico;
+    size_t valori = (size_t)vitaNemico * vitaEroe * (vitaEroe + 1) / 2 +
+                    (size_t)vitaEroe * vitaNemico * (vitaNemico + 1) / 2;
+    char* blocco = calloc(1, (sizeof(double) + sizeof(uint32_t)) * stati + sizeof(double) * valori);
+    if (blocco == NULL) return false;
+
+    t->vittoria = (double*)blocco;
+    t->probabilita = t->vittoria + stati;
+    t->inizioRiga = (uint32_t*)(t->probabilita + valori);
+
+    double dannoEroe[MAX_VITA_ESITI + 1], dannoNemico[MAX_VITA_ESITI + 1];
+    distribuzioneDanno(&t->eroe, &t->nemico, dannoEroe);
+    distribuzioneDanno(&t->nemico, &t->eroe, dannoNemico);
+    double ritorno = dannoEroe[0] * dannoNemico[0];   // Entrambi mancano: si resta in (h, n)
+
+    uint32_t posizione = 0;
+    for (int h = 1; h <= vitaEroe; h++) {
+        for (int n = 1; n <= vitaNemico; n++) {
+            size_t stato = (size_t)(h - 1) * vitaNemico + (n - 1);
+            double* riga = t->probabilita + posizione;
+            t->inizioRiga[stato] = posizione;
+            posizione += (uint32_t)(h + n);
+
+            for (int de = 0; de <= MAX_VITA_ESITI; de++) {
+                double a = dannoEroe[de];
+                if (a == 0.0) continue;
+                if (de >= n) {                            // Il nemico cade: vittoria con vita h
+                    riga[h - 1] += a;
+                    continue;
+                }
+
+                int m = n - de;
+                for (int dn = 0; dn <= MAX_VITA_ESITI; dn++) {
+                    double p = a * dannoNemico[dn];
+                    if (p == 0.0 || (de == 0 && dn == 0)) continue;
+                    if (dn >= h) {                        // L'eroe cade col nemico a vita m
+                        riga[h + m - 1] += p;
+                        continue;
+                    }
+
+                    // Stato più piccolo, già calcolato: ne riporta gli esiti
+                    int k = h - dn;
+                    const double* seguente = distribuzioneEsiti(t, k, m);
+                    for (int i = 0; i < k; i++) riga[i] += p * seguente[i];
+                    for (int j = 0; j < m; j++) riga[h + j] += p * seguente[k + j];
+                }
+            }
+
+            // Se nessuno può colpire il combattimento non finisce: la riga resta a zero
+            double vittoria = 0.0;
+            if (ritorno < 1.0) {
+                for (int i = 0; i < h + n; i++) riga[i] /= 1.0 - ritorno;
+                for (int i = 0; i < h; i++) vittoria += riga[i];
+            }
+            t->vittoria[stato] = vittoria;
+        }
+    }
+    return true;
+}
+
+void liberaTabellaEsiti(TabellaEsiti* t) {
+    if (t == NULL) return;
+    free(t->vittoria);
+    memset(t, 0, sizeof(*t));
+}
+
+/// @brief true se i due combattenti hanno gli stessi modificatori (la vita non conta)
+static bool stessiModificatori(const Combattente* a, const Combattente* b) {
+    return a->danno == b->danno && a->precisione == b->precisione && a->difesa == b->difesa;
+}
+
+// Tabelle ricordate da esitiCombattimento(): una cache per thread, perché le
+// sessioni del server giocano su più thread insieme
+static _Thread_local TabellaEsiti tabelle[MAX_TABELLE_ESITI];
+static _Thread_local int prossima = 0;
+
+const TabellaEsiti* esitiCombattimento(const Combattente* eroe, const Combattente* nemico) {
+    Combattente e = *eroe, n = *nemico;
+    if (e.danno < 1) e.danno = 1;
+    if (n.danno < 1) n.danno = 1;
+    if (e.vita > MAX_VITA_ESITI || n.vita > MAX_VITA_ESITI) return NULL;
+
+    // La vita dell'eroe cambia spesso: si tabula subito fino alla vita massima
+    int vitaEroe = e.vita > VITA_MASSIMA_EROE ? e.vita : VITA_MASSIMA_EROE;
+    int vitaNemico = n.vita > 1 ? n.vita : 1;
+    int libera = -1;
+
+    for (int i = 0; i < MAX_TABELLE_ESITI; i++) {
+        TabellaEsiti* t = &tabelle[i];
+        if (t->vittoria == NULL) {
+            if (libera < 0) libera = i;
+        } else if (stessiModificatori(&t->eroe, &e) && stessiModificatori(&t->nemico, &n)) {
+            if (t->vitaEroe >= e.vita && t->vitaNemico >= n.vita) return t;
+            // Troppo piccola: si ricalcola qui, grande abbastanza per entrambe le richieste
+            if (t->vitaEroe > vitaEroe) vitaEroe = t->vitaEroe;
+            if (t->vitaNemico > vitaNemico) vitaNemico = t->vitaNemico;
+            libera = i;
+            break;
+        }
+    }
+    if (libera < 0) {
+        libera = prossima;
+        prossima = (prossima + 1) % MAX_TABELLE_ESITI;
+    }
+
+    TabellaEsiti* t = &tabelle[libera];
+    liberaTabellaEsiti(t);
+    if (!calcolaTabellaEsiti(t, &e, &n, vitaEroe, vitaNemico)) return NULL;
+    return t;
+}
+
+void liberaEsitiCombattimento(void) {
+    for (int i = 0; i < MAX_TABELLE_ESITI; i++) liberaTabellaEsiti(&tabelle[i]);
+    prossima = 0;
+}
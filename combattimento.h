@@ -0,0 +1,338 @@
+#ifndef COMBATTIMENTO_H
+#define COMBATTIMENTO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "eroe.h"
+#include "utils.h"
+
+/**
+ * Motore dei combattimenti
+ * Il caso viene da Philox4x32-10, un generatore "a contatore": il blocco di
+ * numeri del round r dell'incontro i è philox((r, i), seme), senza stato da
+ * far avanzare. Un combattimento si riproduce quindi da (seme, incontro), e
+ * thread diversi possono giocare incontri diversi senza condividere nulla.
+ *
+ * Ogni round consuma esattamente un blocco (quattro numeri da 32 bit): il
+ * colpo e il danno dell'eroe, poi quelli del nemico. Un round non alloca
+ * memoria e non fa I/O, quindi i combattimenti si possono simulare in massa.
+ */
+
+// Parametri di base (il simulatore li può cambiare nel proprio modello)
+#define DANNO_EROE 6                       // Danno massimo di un colpo dell'eroe
+#define PRECISIONE_EROE 75                 // Probabilità (%) che l'eroe colpisca
+#define VITA_NEMICO 6                      // Vita di un nemico comune al livello 1
+#define VITA_GENERALE 14                   // Vita di un generale al livello 1
+#define DANNO_NEMICO 3                     // Danno massimo di un colpo nemico al livello 1
+#define PRECISIONE_NEMICO 50               // Probabilità (%) che il nemico colpisca
+#define MAX_ROUND_COMBATTIMENTO 1000       // Oltre questo numero di round vince chi difende (l'eroe fugge)
+
+// Chi partecipa a un combattimento
+typedef struct {
+    int vita;                      // Vita corrente (il combattente cade a 0)
+    int danno;                     // Danno massimo di un colpo (un colpo fa da 1 a danno)
+    int precisione;                // Probabilità (%) di colpire
+    int difesa;                    // Sottratta a ogni colpo subito (un colpo fa sempre almeno 1)
+} Combattente;
+
+// Stato di un combattimento
+typedef enum {
+    COMBATTIMENTO_IN_CORSO = 0,
+    COMBATTIMENTO_VITTORIA,        // Il nemico è caduto
+    COMBATTIMENTO_SCONFITTA,       // L'eroe è caduto
+    COMBATTIMENTO_FUGA             // Superato MAX_ROUND_COMBATTIMENTO senza vincitori
+} EsitoCombattimento;
+
+// Cosa è successo in un round (danno 0 = colpo mancato o non tirato)
+typedef struct {
+    int dannoInflitto;             // Danno dell'eroe al nemico
+    int dannoSubito;               // Danno del nemico all'eroe
+} RoundCombattimento;
+
+// --- REGISTRO DEI COMBATTIMENTI ---
+
+#define DIM_REGISTRO_COMBATTIMENTO 256     // Voci ricordate (potenza di 2): le più vecchie vengono sovrascritte
+#define EROE_NEL_REGISTRO (-1)             // Attaccante o bersaglio "eroe" (altrimenti è lo slot del nemico)
+
+// Tipo di una voce del registro
+typedef enum {
+    VOCE_ATTACCO = 0,              // Un attacco, andato a segno o no
+    VOCE_CADUTA                    // Il bersaglio è caduto
+} TipoVoceRegistro;
+
+#define VOCE_GENERALE 0x01                 // Il nemico coinvolto è un generale
+
+/**
+ * Voce binaria del registro (16 byte): il testo viene composto solo quando
+ * qualcuno la legge, con formattaVoceRegistro()
+ */
+typedef struct {
+    uint32_t incontro;             // 32 bit bassi dell'id dell'incontro
+    uint16_t round;                // Round (da 1)
+    uint8_t tipo;                  // TipoVoceRegistro
+    uint8_t flag;                  // VOCE_*
+    int8_t attaccante;             // EROE_NEL_REGISTRO o slot del nemico
+    int8_t bersaglio;
+    uint8_t tiro;                  // Tiro per colpire (0..99, colpisce se minore della precisione)
+    uint8_t riservato;
+    int16_t danno;                 // 0 = mancato
+    int16_t vitaRimasta;           // Vita del bersaglio dopo la voce
+} VoceRegistro;
+
+// Registro circolare a dimensione fissa (nessuna allocazione)
+typedef struct {
+    VoceRegistro voci[DIM_REGISTRO_COMBATTIMENTO];
+    uint64_t scritte;              // Voci scritte in totale (la prossima va in scritte % DIM)
+} RegistroCombattimento;
+
+/**
+ * Numero di voci leggibili (al massimo DIM_REGISTRO_COMBATTIMENTO)
+ */
+static inline int vociRegistro(const RegistroCombattimento* r) {
+    return r->scritte < DIM_REGISTRO_COMBATTIMENTO ? (int)r->scritte : DIM_REGISTRO_COMBATTIMENTO;
+}
+
+/**
+ * Voce 'indice' tra quelle leggibili (0 = la più vecchia)
+ */
+static inline const VoceRegistro* voceRegistro(const RegistroCombattimento* r, int indice) {
+    uint64_t prima = r->scritte - (uint64_t)vociRegistro(r);
+    return &r->voci[(prima + (uint64_t)indice) & (DIM_REGISTRO_COMBATTIMENTO - 1)];
+}
+
+/**
+ * Scrive in 'buffer' il testo di una voce, dal punto di vista dell'eroe
+ * Ritorna il numero di caratteri necessari (come snprintf)
+ */
+size_t formattaVoceRegistro(const VoceRegistro* voce, char* buffer, size_t dimensione);
+
+// Un combattimento tra l'eroe e un nemico
+typedef struct {
+    Combattente eroe;
+    Combattente nemico;
+    uint32_t chiave[2];            // Seme, diviso nelle due parole della chiave di Philox
+    uint64_t incontro;             // Id dell'incontro (parte alta del contatore)
+    uint32_t round;                // Round già giocati (parte bassa del contatore)
+    EsitoCombattimento esito;
+    RegistroCombattimento* registro; // Dove annotare i round (NULL = nessun registro)
+} Combattimento;
+
+/**
+ * Combattente con i dati dell'eroe (vita corrente e parametri di base)
+ */
+Combattente combattenteEroe(const Eroe* eroe);
+
+/**
+ * Nemico di un livello: ogni livello oltre il primo aggiunge 3 vita e 1 danno,
+ * un generale colpisce più forte di 2
+ */
+Combattente combattenteNemico(int vitaBase, int dannoBase, int precisione, int livello, bool generale);
+
+/**
+ * Prepara un combattimento riproducibile da (seme, incontro), senza registro
+ */
+void iniziaCombattimento(Combattimento* c, const Combattente* eroe, const Combattente* nemico,
+                         uint64_t seme, uint64_t incontro);
+
+/**
+ * Gioca un round (prima attacca l'eroe, poi il nemico se è ancora in piedi)
+ * Scrive in 'dettaglio' (se non è NULL) i danni del round
+ * Ritorna l'esito dopo il round
+ */
+EsitoCombattimento risolviRound(Combattimento* c, RoundCombattimento* dettaglio);
+
+/**
+ * Gioca i round fino alla fine del combattimento
+ */
+EsitoCombattimento risolviCombattimento(Combattimento* c);
+
+/**
+ * Riporta sull'eroe la vita rimasta alla fine del combattimento (con modificaVita())
+ */
+void applicaCombattimento(Eroe* eroe, const Combattimento* c);
+
+// --- GRUPPI DI NEMICI ---
+
+#define MAX_NEMICI_POOL 65535              // Slot massimi di un pool (l'indice sta in 16 bit)
+#define SCORTA_GENERALE 1                  // Nemici comuni che accompagnano ogni generale
+
+// Bit di stato[] di un nemico del pool
+#define NEMICO_VIVO      0x01              // Slot occupato da un nemico in piedi
+#define NEMICO_GENERALE  0x02              // Obiettivo della missione
+
+/**
+ * Maniglia stabile di un nemico: (generazione << 16) | (slot + 1), 0 = nessuno
+ * Quando il nemico cade lo slot viene riusato con una generazione nuova, quindi
+ * una maniglia vecchia non indica mai il nemico sbagliato.
+ */
+typedef uint32_t ManigliaNemico;
+#define NEMICO_NESSUNO 0
+
+/**
+ * Pool di nemici come struttura di array, tutti in un unico blocco
+ * Le operazioni sui nemici (danni, controllo dei caduti)
+ * sono cicli senza salti su tutti gli slot fino a 'alto': gli slot vuoti
+ * partecipano con una maschera a zero, così il compilatore può vettorizzarli.
+ */
+typedef struct {
+    int32_t* vita;
+    int32_t* attacco;              // Danno massimo di un colpo
+    int32_t* difesa;
+    int32_t* precisione;           // Probabilità (%) di colpire
+    int32_t* danni;                // Danni in arrivo nel round, applicati da danneggiaNemici()
+    uint32_t* stato;               // Bit NEMICO_* (32 bit come gli altri array: niente conversioni nei cicli)
+    uint16_t* generazione;         // Cresce ogni volta che lo slot viene liberato
+    int32_t* liberi;               // Pila degli slot liberi sotto 'alto'
+    int numeroLiberi;
+    int alto;                      // Slot usati almeno una volta
+    int vivi;                      // Nemici in piedi
+    int capacita;                  // Slot allocati
+    void* blocco;
+    Arena* arena;                  // Arena da cui viene il blocco (NULL = heap)
+} PoolNemici;
+
+/**
+ * Alloca un pool per 'capacita' nemici (al massimo MAX_NEMICI_POOL) da 'arena' (NULL = heap)
+ * Ritorna false se la capacità non è valida o la memoria non basta
+ */
+bool inizializzaPoolNemici(PoolNemici* p, int capacita, Arena* arena);
+
+/**
+ * Libera la memoria del pool
+ */
+void liberaPoolNemici(PoolNemici* p);
+
+/**
+ * Toglie tutti i nemici (le maniglie date finora non valgono più)
+ */
+void svuotaPoolNemici(PoolNemici* p);
+
+/**
+ * Aggiunge un nemico con i dati di 'nemico'; NEMICO_NESSUNO se il pool è pieno
+ */
+ManigliaNemico aggiungiNemico(PoolNemici* p, const Combattente* nemico, bool generale);
+
+/**
+ * Slot del nemico, -1 se la maniglia non è (più) valida
+ */
+static inline int slotNemico(const PoolNemici* p, ManigliaNemico m) {
+    int slot = (int)(m & 0xFFFF) - 1;
+    if (slot < 0 || slot >= p->alto || p->generazione[slot] != (uint16_t)(m >> 16) ||
+        !(p->stato[slot] & NEMICO_VIVO)) {
+        return -1;
+    }
+    return slot;
+}
+
+/**
+ * Applica a tutti i nemici i danni accumulati in danni[] (meno la difesa,
+ * almeno 1 per ogni colpo andato a segno) e azzera danni[]
+ */
+void danneggiaNemici(PoolNemici* p);
+
+/**
+ * Libera gli slot dei nemici senza più vita e ne scrive le maniglie in 'caduti'
+ * (fino a 'massimo'; 'caduti' può essere NULL)
+ * Ritorna il numero di nemici caduti
+ */
+int raccogliCaduti(PoolNemici* p, ManigliaNemico* caduti, int massimo);
+
+// Un combattimento dell'eroe contro tutti i nemici di un pool
+typedef struct {
+    Combattente eroe;
+    PoolNemici* nemici;
+    uint32_t chiave[2];
+    uint64_t incontro;
+    uint32_t round;
+    EsitoCombattimento esito;
+    RegistroCombattimento* registro; // Dove annotare i round (NULL = nessun registro)
+} CombattimentoGruppo;
+
+/**
+ * Prepara un combattimento di gruppo riproducibile da (seme, incontro), senza registro
+ * Il round r usa il blocco di Philox (r, slot) per ogni slot: con un solo
+ * nemico nello slot 0 il combattimento è identico a quello di risolviRound()
+ */
+void iniziaCombattimentoGruppo(CombattimentoGruppo* c, const Combattente* eroe, PoolNemici* nemici,
+                               uint64_t seme, uint64_t incontro);
+
+/**
+ * Gioca un round: l'eroe colpisce il nemico con meno vita, poi tutti quelli
+ * rimasti in piedi attaccano l'eroe
+ * In 'dettaglio' (se non è NULL): il danno dell'eroe e la somma dei danni subiti
+ * Ritorna l'esito dopo il round
+ */
+EsitoCombattimento risolviRoundGruppo(CombattimentoGruppo* c, RoundCombattimento* dettaglio);
+
+// --- DISTRIBUZIONE ESATTA DEGLI ESITI ---
+
+#define MAX_VITA_ESITI 64                  // Vita massima (eroe e nemico) delle tabelle degli esiti
+#define MAX_TABELLE_ESITI 8                // Tabelle ricordate da esitiCombattimento()
+
+/**
+ * Probabilità esatte di ogni esito di un combattimento, per ogni coppia di vite
+ * Un combattimento finisce con l'eroe vivo a vita k (1..h) o caduto col
+ * nemico a vita j (1..n): la riga dello stato (h, n) contiene le h + n
+ * probabilità in quest'ordine. Le righe si calcolano una volta sola per
+ * programmazione dinamica, dagli stati più piccoli ai più grandi; dopo
+ * ogni domanda è una lettura di tabella.
+ * Il modello è quello di risolviRound() con tiri uniformi (il generatore se
+ * ne discosta di meno di 2^-25 per tiro); la fuga dopo
+ * MAX_ROUND_COMBATTIMENTO round è trascurata.
+ */
+typedef struct {
+    Combattente eroe;              // Modificatori (la vita non conta)
+    Combattente nemico;
+    int vitaEroe;                  // Vite massime tabulate
+    int vitaNemico;
+    uint32_t* inizioRiga;          // Posizione in 'probabilita' della riga di (h, n)
+    double* probabilita;           // Righe degli esiti, una dopo l'altra
+    double* vittoria;              // Probabilità di vittoria di ogni stato (somma della parte "vivo")
+} TabellaEsiti;
+
+/**
+ * Calcola la tabella per i modificatori di 'eroe' e 'nemico' e vite fino a
+ * vitaEroe x vitaNemico (al massimo MAX_VITA_ESITI)
+ * Ritorna false se le vite non sono valide o la memoria non basta
+ */
+bool calcolaTabellaEsiti(TabellaEsiti* t, const Combattente* eroe, const Combattente* nemico,
+                         int vitaEroe, int vitaNemico);
+
+/**
+ * Libera la memoria di una tabella
+ */
+void liberaTabellaEsiti(TabellaEsiti* t);
+
+/**
+ * Tabella ricordata per i modificatori dei due combattenti, che copre almeno
+ * la loro vita corrente; viene calcolata alla prima richiesta
+ * Le tabelle ricordate sono di ogni thread: il puntatore va usato sul thread che l'ha chiesto,
+ * prima della chiamata successiva
+ * Ritorna NULL se le vite superano MAX_VITA_ESITI o la memoria non basta
+ */
+const TabellaEsiti* esitiCombattimento(const Combattente* eroe, const Combattente* nemico);
+
+/**
+ * Libera le tabelle ricordate dal thread chiamante (da chiamare prima che un thread finisca)
+ */
+void liberaEsitiCombattimento(void);
+
+/**
+ * Probabilità che l'eroe vinca partendo da (vitaEroe, vitaNemico)
+ */
+static inline double probabilitaVittoria(const TabellaEsiti* t, int vitaEroe, int vitaNemico) {
+    if (vitaNemico <= 0) return 1.0;
+    if (vitaEroe <= 0) return 0.0;
+    return t->vittoria[(vitaEroe - 1) * t->vitaNemico + (vitaNemico - 1)];
+}
+
+/**
+ * Riga degli esiti di (vitaEroe, vitaNemico), entrambe almeno 1:
+ * [k - 1] = P(vittoria con vita k), [vitaEroe + j - 1] = P(sconfitta col nemico a vita j)
+ */
+static inline const double* distribuzioneEsiti(const TabellaEsiti* t, int vitaEroe, int vitaNemico) {
+    return t->probabilita + t->inizioRiga[(vitaEroe - 1) * t->vitaNemico + (vitaNemico - 1)];
+}
+
+#endif // COMBATTIMENTO_H
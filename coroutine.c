@@ -0,0 +1,299 @@
+/**
+ * @file coroutine.c
+ * @brief Coroutine con stack proprio e riserva di stack con pagina di guardia
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * Ogni coroutine vive in un'unica mappatura:
+ *
+ *   [pagina di guardia][........ stack ........][struct Coroutine]
+ *
+ * Lo stack cresce verso la guardia; la struttura sta in cima, così creare
+ * una coroutine non richiede altre allocazioni. Le mappature di coroutine
+ * liberate restano in una riserva (fino a MAX_STACK_LIBERI) e vengono riusate
+ * senza chiamare mmap.
+ *
+ * Il cambio di contesto su x86-64 (System V) salva sullo stack di partenza i
+ * registri che il chiamato deve preservare (rbx, rbp, r12-r15, più i
+ * controlli di MXCSR e della FPU), scambia rsp e li ripristina dallo stack di
+ * arrivo: una chiamata a funzione, senza toccare la maschera dei segnali come
+ * fa swapcontext().
+ */
+
+#ifndef _WIN32
+
+#define _DEFAULT_SOURCE   // MAP_ANONYMOUS, MAP_NORESERVE
+
+#include "coroutine.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#if defined(__x86_64__) && defined(__ELF__)
+#define CAMBIO_CONTESTO_PROPRIO 1
+#else
+#include <ucontext.h>
+#endif
+
+// Annotazioni per i sanitizer, che altrimenti non capiscono il cambio di stack
+#ifdef __SANITIZE_ADDRESS__
+#include <sanitizer/common_interface_defs.h>
+#endif
+#ifdef __SANITIZE_THREAD__
+#include <sanitizer/tsan_interface.h>
+#endif
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CAMBIO DI CONTESTO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+#ifdef CAMBIO_CONTESTO_PROPRIO
+
+// Contesto sospeso: lo stack pointer, sotto il quale ci sono i registri salvati
+typedef void* Contesto;
+
+/// @brief Salva i registri e lo stack pointer in *salva e riparte dal contesto 'carica'
+void cambiaContestoCoroutine(Contesto* salva, Contesto carica);
+
+__asm__(
+    ".text\n"
+    ".globl cambiaContestoCoroutine\n"
+    ".hidden cambiaContestoCoroutine\n"
+    ".type cambiaContestoCoroutine, @function\n"
+    "cambiaContestoCoroutine:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size cambiaContestoCoroutine, .-cambiaContestoCoroutine\n"
+);
+
+#else
+
+typedef ucontext_t Contesto;
+
+#endif
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * COROUTINE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+struct Coroutine {
+    Contesto contesto;             // La coroutine, quando è sospesa
+    Contesto chiamante;            // Chi l'ha ripresa, mentre la coroutine gira
+    FunzioneCoroutine funzione;
+    void* argomento;
+    bool finita;
+    Coroutine* precedente;         // Coroutine corrente prima della ripresa (riprese annidate)
+    char* mappatura;               // Inizio della mappatura (la pagina di guardia)
+    size_t dimensioneMappatura;
+    char* bassoStack;              // Primo byte utilizzabile dello stack
+    size_t dimensioneStack;
+#ifdef __SANITIZE_ADDRESS__
+    void* falsoStack;              // Stato di ASan del lato che cede il controllo
+    const void* bassoChiamante;
+    size_t dimensioneChiamante;
+#endif
+#ifdef __SANITIZE_THREAD__
+    void* fibra;
+    void* fibraChiamante;
+#endif
+};
+
+static _Thread_local Coroutine* corrente = NULL;
+
+// Riserva delle mappature libere (comune a tutti i thread)
+static pthread_mutex_t bloccoRiserva = PTHREAD_MUTEX_INITIALIZER;
+static char* mappatureLibere[MAX_STACK_LIBERI];
+static int numeroMappatureLibere = 0;
+
+/// @brief Dimensione della mappatura di una coroutine: guardia, stack e struttura
+static size_t dimensioneMappatura(void) {
+    size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+    size_t struttura = (sizeof(Coroutine) + pagina - 1) / pagina * pagina;
+    return pagina + DIM_STACK_COROUTINE + struttura;
+}
+
+/// @brief Prende una mappatura dalla riserva o ne crea una nuova con la sua pagina di guardia
+static char* prendiMappatura(size_t dimensione) {
+    char* mappatura = NULL;
+    pthread_mutex_lock(&bloccoRiserva);
+    if (numeroMappatureLibere > 0) mappatura = mappatureLibere[--numeroMappatureLibere];
+    pthread_mutex_unlock(&bloccoRiserva);
+    if (mappatura != NULL) return mappatura;
+
+    mappatura = mmap(NULL, dimensione, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mappatura == MAP_FAILED) return NULL;
+    if (mprotect(mappatura, (size_t)sysconf(_SC_PAGESIZE), PROT_NONE) != 0) {
+        munmap(mappatura, dimensione);
+        return NULL;
+    }
+    return mappatura;
+}
+
+/// @brief Cambia contesto avvisando i sanitizer (se attivi) del cambio di stack
+static inline void cambia(Contesto* salva, Contesto* carica, void** falsoStack,
+                          const void* bassoArrivo, size_t dimensioneArrivo) {
+#ifdef __SANITIZE_ADDRESS__
+    __sanitizer_start_switch_fiber(falsoStack, bassoArrivo, dimensioneArrivo);
+#else
+    (void)falsoStack;
+    (void)bassoArrivo;
+    (void)dimensioneArrivo;
+#endif
+#ifdef CAMBIO_CONTESTO_PROPRIO
+    cambiaContestoCoroutine(salva, *carica);
+#else
+    swapcontext(salva, carica);
+#endif
+}
+
+/// @brief Ultimo cambio di una coroutine finita: il suo stack non verrà più usato
+static void esciDallaCoroutine(Coroutine* co) {
+    co->finita = true;
+#ifdef __SANITIZE_THREAD__
+    __tsan_switch_to_fiber(co->fibraChiamante, 0);
+#endif
+#ifdef __SANITIZE_ADDRESS__
+    // NULL: ASan può liberare il falso stack della coroutine
+    cambia(&co->contesto, &co->chiamante, NULL, co->bassoChiamante, co->dimensioneChiamante);
+#else
+    cambia(&co->contesto, &co->chiamante, NULL, NULL, 0);
+#endif
+    abort();   // Una coroutine finita non viene più ripresa
+}
+
+/// @brief Prima funzione eseguita sullo stack della coroutine
+static void avvioCoroutine(void) {
+    Coroutine* co = corrente;
+#ifdef __SANITIZE_ADDRESS__
+    __sanitizer_finish_switch_fiber(NULL, &co->bassoChiamante, &co->dimensioneChiamante);
+#endif
+    co->funzione(co->argomento);
+    esciDallaCoroutine(co);
+}
+
+Coroutine* creaCoroutine(FunzioneCoroutine funzione, void* argomento) {
+    size_t dimensione = dimensioneMappatura();
+    char* mappatura = prendiMappatura(dimensione);
+    if (mappatura == NULL) return NULL;
+
+    size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+    Coroutine* co = (Coroutine*)(mappatura + pagina + DIM_STACK_COROUTINE);
+    memset(co, 0, sizeof(*co));
+    co->funzione = funzione;
+    co->argomento = argomento;
+    co->mappatura = mappatura;
+    co->dimensioneMappatura = dimensione;
+    co->bassoStack = mappatura + pagina;
+    co->dimensioneStack = DIM_STACK_COROUTINE;
+
+#ifdef CAMBIO_CONTESTO_PROPRIO
+    // Stack iniziale come lo lascerebbe cambiaContestoCoroutine(): controlli
+    // di MXCSR e FPU, sei registri a zero e l'indirizzo di ritorno che porta ad
+    // avvioCoroutine(). Sopra resta un finto indirizzo di ritorno, così la
+    // funzione parte con lo stack allineato come dopo una call.
+    uint64_t* cima = (uint64_t*)(co->bassoStack + co->dimensioneStack);
+    uint64_t* sp = cima - 9;
+    uint32_t controlli[2] = { 0x1F80, 0x037F };   // Valori iniziali di MXCSR e della FPU
+    memcpy(&sp[0], controlli, sizeof(controlli));
+    for (int i = 1; i <= 6; i++) sp[i] = 0;
+    sp[7] = (uint64_t)(uintptr_t)avvioCoroutine;
+    sp[8] = 0;
+    co->contesto = sp;
+#else
+    getcontext(&co->contesto);
+    co->contesto.uc_stack.ss_sp = co->bassoStack;
+    co->contesto.uc_stack.ss_size = co->dimensioneStack;
+    co->contesto.uc_link = NULL;
+    makecontext(&co->contesto, avvioCoroutine, 0);
+#endif
+
+#ifdef __SANITIZE_THREAD__
+    co->fibra = __tsan_create_fiber(0);
+#endif
+    return co;
+}
+
+void riprendiCoroutine(Coroutine* co) {
+    if (co == NULL || co->finita) return;
+
+    co->precedente = corrente;
+    corrente = co;
+#ifdef __SANITIZE_THREAD__
+    co->fibraChiamante = __tsan_get_current_fiber();
+    __tsan_switch_to_fiber(co->fibra, 0);
+#endif
+#ifdef __SANITIZE_ADDRESS__
+    void* falsoStack = NULL;
+    cambia(&co->chiamante, &co->contesto, &falsoStack, co->bassoStack, co->dimensioneStack);
+    __sanitizer_finish_switch_fiber(falsoStack, NULL, NULL);
+#else
+    cambia(&co->chiamante, &co->contesto, NULL, co->bassoStack, co->dimensioneStack);
+#endif
+    corrente = co->precedente;
+}
+
+void cediCoroutine(void) {
+    Coroutine* co = corrente;
+    if (co == NULL) return;
+
+#ifdef __SANITIZE_THREAD__
+    __tsan_switch_to_fiber(co->fibraChiamante, 0);
+#endif
+#ifdef __SANITIZE_ADDRESS__
+    cambia(&co->contesto, &co->chiamante, &co->falsoStack, co->bassoChiamante, co->dimensioneChiamante);
+    __sanitizer_finish_switch_fiber(co->falsoStack, &co->bassoChiamante, &co->dimensioneChiamante);
+#else
+    cambia(&co->contesto, &co->chiamante, NULL, NULL, 0);
+#endif
+}
+
+Coroutine* coroutineCorrente(void) {
+    return corrente;
+}
+
+bool coroutineFinita(const Coroutine* co) {
+    return co->finita;
+}
+
+void liberaCoroutine(Coroutine* co) {
+    if (co == NULL) return;
+#ifdef __SANITIZE_THREAD__
+    __tsan_destroy_fiber(co->fibra);
+#endif
+
+    char* mappatura = co->mappatura;
+    size_t dimensione = co->dimensioneMappatura;
+
+    pthread_mutex_lock(&bloccoRiserva);
+    bool tenuta = numeroMappatureLibere < MAX_STACK_LIBERI;
+    if (tenuta) mappatureLibere[numeroMappatureLibere++] = mappatura;
+    pthread_mutex_unlock(&bloccoRiserva);
+
+    if (!tenuta) munmap(mappatura, dimensione);
+}
+
+#endif // !_WIN32
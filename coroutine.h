@@ -0,0 +1,69 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Coroutine con stack proprio: una funzione scritta con i soliti cicli
+ * bloccanti che può sospendersi a metà (cediCoroutine) e ripartire dallo
+ * stesso punto quando qualcuno la riprende. Il server ci fa girare il gioco
+ * di ogni connessione: quando chiede una riga che non è ancora arrivata cede,
+ * e il thread passa alle altre sessioni.
+ *
+ * Gli stack sono piccoli, hanno una pagina di guardia in fondo (uno stack
+ * esaurito fa fallire il processo invece di sporcare la memoria vicina) e
+ * vengono riusati da una riserva comune. Su x86-64 il cambio di contesto
+ * salva solo i registri che il chiamato deve preservare, senza chiamate al
+ * sistema; altrove si usa ucontext.
+ *
+ * Una coroutine va ripresa sempre dallo stesso thread: il codice del gioco
+ * usa variabili _Thread_local (la sessione corrente, il diario) e il
+ * compilatore può tenerne l'indirizzo in un registro attraverso una cessione.
+ *
+ * Non disponibile su Windows.
+ */
+
+#define DIM_STACK_COROUTINE (64 * 1024)    // Stack di una coroutine (le pagine si occupano solo se usate)
+#define MAX_STACK_LIBERI 1024              // Stack tenuti da parte per le coroutine successive
+
+typedef struct Coroutine Coroutine;
+
+/// Funzione eseguita dalla coroutine: quando ritorna la coroutine è finita
+typedef void (*FunzioneCoroutine)(void* argomento);
+
+/**
+ * Crea una coroutine che eseguirà funzione(argomento) alla prima ripresa
+ * Ritorna NULL se non c'è memoria per lo stack
+ */
+Coroutine* creaCoroutine(FunzioneCoroutine funzione, void* argomento);
+
+/**
+ * Esegue la coroutine finché non cede o finisce
+ * Non va chiamata su una coroutine finita
+ */
+void riprendiCoroutine(Coroutine* co);
+
+/**
+ * Sospende la coroutine corrente e torna a chi l'ha ripresa
+ * (va chiamata dall'interno di una coroutine)
+ */
+void cediCoroutine(void);
+
+/**
+ * Coroutine in esecuzione sul thread chiamante (NULL fuori da ogni coroutine)
+ */
+Coroutine* coroutineCorrente(void);
+
+/**
+ * true se la funzione della coroutine è ritornata
+ */
+bool coroutineFinita(const Coroutine* co);
+
+/**
+ * Rimette lo stack nella riserva; la coroutine deve essere finita o mai ripresa
+ * (di una sospesa a metà si perde solo ciò che il suo stack teneva)
+ */
+void liberaCoroutine(Coroutine* co);
+
+#endif // COROUTINE_H
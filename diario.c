@@ -0,0 +1,558 @@
+/**
+ * @file diario.c
+ * @brief Diario asincrono: record binari per thread, formattazione in background
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * Ogni thread che scrive ha un buffer circolare con un solo produttore (il
+ * thread stesso) e un solo consumatore (il thread del diario): due contatori
+ * che crescono sempre, pubblicati con store di tipo release, bastano a
+ * sincronizzarli. Il produttore non si blocca mai: se il buffer è pieno il
+ * record viene scartato e contato.
+ *
+ * Un record contiene l'indirizzo del formato e gli argomenti già estratti
+ * (8 byte per i numeri, i byte per le stringhe). Il thread del diario
+ * ripercorre il formato per rimettere insieme il testo, che viene scritto
+ * sul file con una sola fwrite per ogni giro di raccolta.
+ * L'ordine è garantito tra i messaggi dello stesso thread; messaggi di
+ * thread diversi possono comparire fuori ordine (l'ora è nel testo).
+ *
+ * Il thread del diario parte solo quando un thread scrive il suo primo
+ * messaggio: le modalità che non registrano nulla non lo creano. Quando
+ * non c'è niente da raccogliere dorme su una variabile di condizione e il
+ * primo produttore che lo trova addormentato lo sveglia.
+ */
+
+#ifndef _WIN32
+#define _DEFAULT_SOURCE   // localtime_r(), clock_gettime(), pthread_condattr_setclock()
+#endif
+
+#include "diario.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <direct.h>   // per _mkdir su Windows
+#define MKDIR(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define MKDIR(path) mkdir(path, 0700)
+#endif
+
+/**
+ * @brief Attesa massima del thread del diario senza risvegli (millisecondi)
+ *
+ * @details
+ * Di norma il thread viene svegliato dal produttore; l'attesa a tempo copre
+ * il caso (raro) in cui il produttore pubblica proprio mentre il thread si
+ * addormenta e non lo vede in attesa.
+ */
+#define ATTESA_DIARIO_MS 250
+
+/// @brief Testo formattato accumulato prima di una fwrite
+#define DIM_TESTO_DIARIO (64 * 1024)
+
+/// @brief Il record era troppo lungo: gli argomenti finali mancano
+#define RECORD_TRONCATO 0x01
+
+/// @brief Record binario: 128 byte, copiato così com'è nel buffer
+typedef struct {
+    const char* formato;
+    int64_t secondi;               // Ora del messaggio (tempo UTC)
+    int32_t nanosecondi;
+    uint8_t livello;
+    uint8_t categoria;
+    uint8_t flag;                  // RECORD_*
+    uint8_t lunghezza;             // Byte usati in dati[]
+    unsigned char dati[DIM_DATI_RECORD_DIARIO];
+} RecordDiario;
+
+/// @brief Buffer circolare di un thread (contatori su linee di cache diverse)
+typedef struct BufferDiario {
+    RecordDiario record[DIM_BUFFER_DIARIO];
+    _Atomic uint64_t scritti;      // Record pubblicati (solo il produttore scrive)
+    char separaScritti[56];
+    _Atomic uint64_t letti;        // Record consumati (solo il thread del diario scrive)
+    char separaLetti[56];
+    _Atomic uint64_t persi;        // Record scartati a buffer pieno
+    uint64_t persiSegnalati;       // Persi già scritti nel diario (solo il thread del diario)
+    int numero;                    // Numero del thread, in ordine di registrazione
+    struct BufferDiario* prossimo;
+} BufferDiario;
+
+/// @brief Buffer del thread corrente (NULL finché non scrive il primo messaggio)
+static _Thread_local BufferDiario* bufferThread = NULL;
+
+/// @brief Buffer di tutti i thread (inserimento in testa senza blocchi, mai liberati)
+static _Atomic(BufferDiario*) buffers = NULL;
+static atomic_int threadRegistrati = 0;
+
+/// @brief Stato del thread del diario
+static struct {
+    pthread_t thread;
+    pthread_once_t avvio;          // Creazione del thread al primo messaggio
+    bool avviato;
+    atomic_int fermo;              // Richiesta di fermarsi dopo l'ultima raccolta
+    atomic_int inAttesa;           // Il thread dorme su 'risveglio'
+    pthread_mutex_t blocco;        // Protegge l'addormentarsi del thread
+    pthread_cond_t risveglio;
+    const char* percorso;          // NULL finché avviaDiario non lo imposta
+    FILE* file;                    // Aperto al primo messaggio
+    char testo[DIM_TESTO_DIARIO];
+    size_t lunghezza;
+} diario = {
+    .avvio = PTHREAD_ONCE_INIT,
+    .blocco = PTHREAD_MUTEX_INITIALIZER
+};
+
+static const char* const nomiLivelli[] = { "DEBUG", "INFO", "AVVISO", "ERRORE" };
+static const char* const nomiCategorie[NUMERO_CATEGORIE_DIARIO] = {
+    "gioco", "salvataggi", "missioni", "combattimento", "simulatore", "server"
+};
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * FORMATO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Tipo di argomento richiesto da una conversione
+typedef enum {
+    ARGOMENTO_NESSUNO,             // Testo normale o "%%"
+    ARGOMENTO_INTERO,              // d i c (con segno)
+    ARGOMENTO_NATURALE,            // u x X o (senza segno)
+    ARGOMENTO_REALE,               // e f g
+    ARGOMENTO_STRINGA,             // s
+    ARGOMENTO_PUNTATORE            // p
+} TipoArgomento;
+
+/// @brief Una conversione del formato
+typedef struct {
+    const char* inizio;            // '%' iniziale
+    const char* fine;              // Carattere dopo la conversione
+    TipoArgomento tipo;
+    char lunghezza;                // 0, 'h', 'l', 'L' (ll), 'z'
+} Conversione;
+
+/**
+ * @brief Trova la prossima conversione del formato a partire da 'f'
+ * @return false se il formato è finito
+ */
+static bool prossimaConversione(const char* f, Conversione* c) {
+    while (*f && (*f != '%' || f[1] == '%')) f += *f == '%' ? 2 : 1;
+    if (*f == '\0') return false;
+
+    c->inizio = f++;
+    while (*f && strchr("-+ #0", *f)) f++;
+    while (*f >= '0' && *f <= '9') f++;
+    if (*f == '.') {
+        f++;
+        while (*f >= '0' && *f <= '9') f++;
+    }
+
+    c->lunghezza = 0;
+    if (*f == 'h') { c->lunghezza = 'h'; f += f[1] == 'h' ? 2 : 1; }
+    else if (*f == 'l') { c->lunghezza = f[1] == 'l' ? 'L' : 'l'; f += f[1] == 'l' ? 2 : 1; }
+    else if (*f == 'z') { c->lunghezza = 'z'; f++; }
+
+    switch (*f) {
+        case 'd': case 'i': case 'c': c->tipo = ARGOMENTO_INTERO; break;
+        case 'u': case 'x': case 'X': case 'o': c->tipo = ARGOMENTO_NATURALE; break;
+        case 'e': case 'f': case 'g': case 'E': case 'F': case 'G': c->tipo = ARGOMENTO_REALE; break;
+        case 's': c->tipo = ARGOMENTO_STRINGA; break;
+        case 'p': c->tipo = ARGOMENTO_PUNTATORE; break;
+        default:  c->tipo = ARGOMENTO_NESSUNO; break;   // Conversione non supportata: stampata com'è
+    }
+    c->fine = *f ? f + 1 : f;
+    return true;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * PRODUTTORI
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+static void avviaThreadDiario(void);
+
+/**
+ * @brief Alloca il buffer del thread e lo aggiunge alla lista
+ *
+ * @details
+ * Il buffer viene azzerato con memset e non con calloc: così le pagine
+ * vengono toccate adesso e non durante i primi messaggi.
+ */
+static BufferDiario* registraThreadDiario(void) {
+    BufferDiario* b = malloc(sizeof(BufferDiario));
+    if (b == NULL) return NULL;
+    memset(b, 0, sizeof(*b));
+
+    b->numero = atomic_fetch_add_explicit(&threadRegistrati, 1, memory_order_relaxed);
+    b->prossimo = atomic_load_explicit(&buffers, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&buffers, &b->prossimo, b,
+                                                  memory_order_release, memory_order_relaxed));
+    bufferThread = b;
+
+    // Il primo messaggio del processo fa partire il thread che li scrive
+    if (diario.percorso != NULL) pthread_once(&diario.avvio, avviaThreadDiario);
+    return b;
+}
+
+/**
+ * @brief Ora del messaggio
+ *
+ * @details
+ * Dove c'è, l'orologio "coarse" di Linux costa pochi nanosecondi invece di
+ * qualche decina; la sua risoluzione (pochi millisecondi) basta al diario.
+ */
+static inline void oraDiario(struct timespec* ts) {
+#ifdef CLOCK_REALTIME_COARSE
+    clock_gettime(CLOCK_REALTIME_COARSE, ts);
+#else
+    timespec_get(ts, TIME_UTC);
+#endif
+}
+
+/**
+ * @brief Estrae gli argomenti seguendo il formato e li copia nel record
+ *
+ * @details
+ * Gli interi vengono allargati a 64 bit secondo il modificatore di
+ * lunghezza, così il thread del diario li rilegge tutti allo stesso modo.
+ */
+static void copiaArgomenti(RecordDiario* r, const char* formato, va_list argomenti) {
+    Conversione c;
+    size_t usati = 0;
+
+    for (const char* f = formato; prossimaConversione(f, &c); f = c.fine) {
+        if (c.tipo == ARGOMENTO_NESSUNO) continue;
+
+        if (c.tipo == ARGOMENTO_STRINGA) {
+            const char* s = va_arg(argomenti, const char*);
+            if (s == NULL) s = "(null)";
+            size_t n = strlen(s);
+            if (usati + 1 >= sizeof(r->dati)) { r->flag |= RECORD_TRONCATO; break; }
+            if (n > sizeof(r->dati) - usati - 1) {
+                n = sizeof(r->dati) - usati - 1;
+                r->flag |= RECORD_TRONCATO;
+            }
+            memcpy(r->dati + usati, s, n);
+            r->dati[usati + n] = '\0';
+            usati += n + 1;
+            continue;
+        }
+
+        uint64_t valore;
+        if (c.tipo == ARGOMENTO_REALE) {
+            double d = va_arg(argomenti, double);
+            memcpy(&valore, &d, sizeof(valore));
+        } else if (c.tipo == ARGOMENTO_PUNTATORE) {
+            valore = (uint64_t)(uintptr_t)va_arg(argomenti, void*);
+        } else if (c.lunghezza == 'L') {
+            valore = (uint64_t)va_arg(argomenti, long long);
+        } else if (c.lunghezza == 'l') {
+            valore = c.tipo == ARGOMENTO_INTERO ? (uint64_t)(int64_t)va_arg(argomenti, long)
+                                                : (uint64_t)va_arg(argomenti, unsigned long);
+        } else if (c.lunghezza == 'z') {
+            valore = (uint64_t)va_arg(argomenti, size_t);
+        } else {
+            valore = c.tipo == ARGOMENTO_INTERO ? (uint64_t)(int64_t)va_arg(argomenti, int)
+                                                : (uint64_t)va_arg(argomenti, unsigned int);
+        }
+
+        if (usati + sizeof(valore) > sizeof(r->dati)) { r->flag |= RECORD_TRONCATO; break; }
+        memcpy(r->dati + usati, &valore, sizeof(valore));
+        usati += sizeof(valore);
+    }
+    r->lunghezza = (uint8_t)usati;
+}
+
+void scriviDiario(int livello, CategoriaDiario categoria, const char* formato, ...) {
+    BufferDiario* b = bufferThread;
+    if (b == NULL && (b = registraThreadDiario()) == NULL) return;
+
+    uint64_t scritti = atomic_load_explicit(&b->scritti, memory_order_relaxed);
+    if (scritti - atomic_load_explicit(&b->letti, memory_order_acquire) == DIM_BUFFER_DIARIO) {
+        atomic_fetch_add_explicit(&b->persi, 1, memory_order_relaxed);
+        return;
+    }
+
+    RecordDiario* r = &b->record[scritti & (DIM_BUFFER_DIARIO - 1)];
+    struct timespec ts;
+    oraDiario(&ts);
+    r->formato = formato;
+    r->secondi = (int64_t)ts.tv_sec;
+    r->nanosecondi = (int32_t)ts.tv_nsec;
+    r->livello = (uint8_t)livello;
+    r->categoria = (uint8_t)categoria;
+    r->flag = 0;
+
+    va_list argomenti;
+    va_start(argomenti, formato);
+    copiaArgomenti(r, formato, argomenti);
+    va_end(argomenti);
+
+    atomic_store_explicit(&b->scritti, scritti + 1, memory_order_release);
+
+    // Si segnala senza prendere il blocco: il produttore non deve mai aspettare
+    if (atomic_load_explicit(&diario.inAttesa, memory_order_relaxed)) {
+        pthread_cond_signal(&diario.risveglio);
+    }
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * THREAD DEL DIARIO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Apre il file del diario, creando la sua cartella se non c'è
+ */
+static FILE* apriFileDiario(void) {
+    FILE* f = fopen(diario.percorso, "a");
+    if (f != NULL) return f;
+
+    const char* barra = strrchr(diario.percorso, '/');
+    if (barra == NULL || barra == diario.percorso) return NULL;
+
+    char cartella[256];
+    size_t n = (size_t)(barra - diario.percorso);
+    if (n >= sizeof(cartella)) return NULL;
+    memcpy(cartella, diario.percorso, n);
+    cartella[n] = '\0';
+    MKDIR(cartella);
+    return fopen(diario.percorso, "a");
+}
+
+/// @brief Scrive sul file il testo accumulato (aprendo il file la prima volta)
+static void svuotaTestoDiario(void) {
+    if (diario.lunghezza == 0) return;
+    if (diario.file == NULL) diario.file = apriFileDiario();
+    if (diario.file != NULL) {
+        fwrite(diario.testo, 1, diario.lunghezza, diario.file);
+        fflush(diario.file);
+    }
+    diario.lunghezza = 0;
+}
+
+/// @brief Aggiunge testo formattato al blocco da scrivere
+static void aggiungiTesto(const char* formato, ...) {
+    size_t libero = sizeof(diario.testo) - diario.lunghezza;
+    va_list argomenti;
+    va_start(argomenti, formato);
+    int n = vsnprintf(diario.testo + diario.lunghezza, libero, formato, argomenti);
+    va_end(argomenti);
+    if (n > 0) diario.lunghezza += (size_t)n < libero ? (size_t)n : libero - 1;
+}
+
+/// @brief Copia il testo del formato tra 'da' e 'a' ("%%" diventa "%")
+static void aggiungiLetterale(const char* da, const char* a) {
+    for (const char* t = da; t < a && diario.lunghezza + 1 < sizeof(diario.testo); t++) {
+        if (*t == '%' && t + 1 < a && t[1] == '%') t++;
+        diario.testo[diario.lunghezza++] = *t;
+    }
+}
+
+/**
+ * @brief Ricostruisce il testo di un record
+ *
+ * @details
+ * Il testo tra le conversioni viene copiato così com'è ("%%" diventa "%"),
+ * ogni conversione viene passata da sola a snprintf con il suo argomento.
+ */
+static void formattaRecord(const RecordDiario* r, int thread) {
+    // Lo spazio per una riga intera: se non c'è si scrive prima il blocco
+    if (sizeof(diario.testo) - diario.lunghezza < 512) svuotaTestoDiario();
+
+    time_t secondi = (time_t)r->secondi;
+    struct tm ora;
+#ifdef _WIN32
+    localtime_s(&ora, &secondi);
+#else
+    localtime_r(&secondi, &ora);
+#endif
+    aggiungiTesto("%04d-%02d-%02d %02d:%02d:%02d.%03d %-6s %-13s t%d  ",
+                  ora.tm_year + 1900, ora.tm_mon + 1, ora.tm_mday, ora.tm_hour, ora.tm_min, ora.tm_sec,
+                  (int)(r->nanosecondi / 1000000),
+                  nomiLivelli[r->livello & 3],
+                  r->categoria < NUMERO_CATEGORIE_DIARIO ? nomiCategorie[r->categoria] : "?",
+                  thread);
+
+    Conversione c;
+    const char* f = r->formato;
+    size_t letti = 0;
+    bool finiti = false;
+
+    while (!finiti && prossimaConversione(f, &c)) {
+        aggiungiLetterale(f, c.inizio);
+        f = c.fine;
+
+        char specifica[32];
+        size_t lunghezza = (size_t)(c.fine - c.inizio);
+        if (lunghezza >= sizeof(specifica) || c.tipo == ARGOMENTO_NESSUNO) {
+            aggiungiTesto("%.*s", (int)lunghezza, c.inizio);
+            continue;
+        }
+        memcpy(specifica, c.inizio, lunghezza);
+        specifica[lunghezza] = '\0';
+
+        if (c.tipo == ARGOMENTO_STRINGA) {
+            if (letti >= r->lunghezza) { finiti = true; break; }
+            const char* s = (const char*)r->dati + letti;
+            aggiungiTesto(specifica, s);
+            letti += strlen(s) + 1;
+            continue;
+        }
+
+        uint64_t valore;
+        if (letti + sizeof(valore) > r->lunghezza) { finiti = true; break; }
+        memcpy(&valore, r->dati + letti, sizeof(valore));
+        letti += sizeof(valore);
+
+        if (c.tipo == ARGOMENTO_REALE) {
+            double d;
+            memcpy(&d, &valore, sizeof(d));
+            aggiungiTesto(specifica, d);
+        } else if (c.tipo == ARGOMENTO_PUNTATORE) {
+            aggiungiTesto(specifica, (void*)(uintptr_t)valore);
+        } else if (c.lunghezza == 'L') {
+            aggiungiTesto(specifica, (long long)valore);
+        } else if (c.lunghezza == 'l') {
+            aggiungiTesto(specifica, (long)valore);
+        } else if (c.lunghezza == 'z') {
+            aggiungiTesto(specifica, (size_t)valore);
+        } else {
+            aggiungiTesto(specifica, (int)valore);
+        }
+    }
+
+    if (finiti || (r->flag & RECORD_TRONCATO)) {
+        aggiungiTesto(" [...]");
+    } else {
+        aggiungiLetterale(f, f + strlen(f));
+    }
+    if (diario.lunghezza == 0 || diario.testo[diario.lunghezza - 1] != '\n') aggiungiTesto("\n");
+}
+
+/**
+ * @brief Formatta i record pubblicati da tutti i thread e li scrive sul file
+ * @return Numero di record raccolti
+ */
+static size_t raccogliRecord(void) {
+    size_t raccolti = 0;
+
+    for (BufferDiario* b = atomic_load_explicit(&buffers, memory_order_acquire); b; b = b->prossimo) {
+        uint64_t letti = atomic_load_explicit(&b->letti, memory_order_relaxed);
+        uint64_t scritti = atomic_load_explicit(&b->scritti, memory_order_acquire);
+
+        raccolti += (size_t)(scritti - letti);
+        for (; letti < scritti; letti++) {
+            formattaRecord(&b->record[letti & (DIM_BUFFER_DIARIO - 1)], b->numero);
+        }
+        atomic_store_explicit(&b->letti, letti, memory_order_release);
+
+        uint64_t persi = atomic_load_explicit(&b->persi, memory_order_relaxed);
+        if (persi != b->persiSegnalati) {
+            aggiungiTesto("[diario] %llu messaggi persi dal thread t%d (buffer pieno)\n",
+                          (unsigned long long)(persi - b->persiSegnalati), b->numero);
+            b->persiSegnalati = persi;
+        }
+    }
+
+    svuotaTestoDiario();
+    return raccolti;
+}
+
+/// @brief true se qualche thread ha pubblicato record non ancora raccolti
+static bool recordDaRaccogliere(void) {
+    for (BufferDiario* b = atomic_load_explicit(&buffers, memory_order_acquire); b; b = b->prossimo) {
+        if (atomic_load_explicit(&b->scritti, memory_order_acquire) !=
+            atomic_load_explicit(&b->letti, memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Dorme finché un produttore o terminaDiario non lo svegliano
+ *
+ * @details
+ * inAttesa viene alzato prima di ricontrollare i buffer: un produttore che
+ * pubblica dopo il controllo vede il flag e manda il segnale.
+ */
+static void attendiDiario(void) {
+    struct timespec scadenza;
+#ifdef _WIN32
+    timespec_get(&scadenza, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &scadenza);
+#endif
+    scadenza.tv_nsec += ATTESA_DIARIO_MS * 1000000L;
+    if (scadenza.tv_nsec >= 1000000000L) {
+        scadenza.tv_sec += scadenza.tv_nsec / 1000000000L;
+        scadenza.tv_nsec %= 1000000000L;
+    }
+
+    pthread_mutex_lock(&diario.blocco);
+    atomic_store(&diario.inAttesa, 1);
+    if (!atomic_load(&diario.fermo) && !recordDaRaccogliere()) {
+        pthread_cond_timedwait(&diario.risveglio, &diario.blocco, &scadenza);
+    }
+    atomic_store(&diario.inAttesa, 0);
+    pthread_mutex_unlock(&diario.blocco);
+}
+
+static void* eseguiDiario(void* argomento) {
+    (void)argomento;
+    while (!atomic_load_explicit(&diario.fermo, memory_order_acquire)) {
+        if (raccogliRecord() == 0) attendiDiario();
+    }
+    raccogliRecord();   // Ciò che è stato scritto prima della richiesta di fermarsi
+    return NULL;
+}
+
+/**
+ * @brief Crea il thread del diario (una sola volta, dal primo thread che scrive)
+ *
+ * @details
+ * La condizione usa l'orologio monotono, così l'attesa a tempo non si
+ * allunga né si accorcia se l'ora di sistema cambia. Se il thread non può
+ * essere creato i record restano nei buffer e i successivi vengono scartati.
+ */
+static void avviaThreadDiario(void) {
+    pthread_condattr_t attributi;
+    pthread_condattr_init(&attributi);
+#ifndef _WIN32
+    pthread_condattr_setclock(&attributi, CLOCK_MONOTONIC);
+#endif
+    pthread_cond_init(&diario.risveglio, &attributi);
+    pthread_condattr_destroy(&attributi);
+
+    atomic_store_explicit(&diario.fermo, 0, memory_order_relaxed);
+    if (pthread_create(&diario.thread, NULL, eseguiDiario, NULL) != 0) return;
+
+    diario.avviato = true;
+    atexit(terminaDiario);
+}
+
+void avviaDiario(const char* percorso) {
+    diario.percorso = percorso;
+}
+
+void terminaDiario(void) {
+    if (!diario.avviato) return;
+
+    pthread_mutex_lock(&diario.blocco);
+    atomic_store_explicit(&diario.fermo, 1, memory_order_release);
+    pthread_cond_signal(&diario.risveglio);
+    pthread_mutex_unlock(&diario.blocco);
+    pthread_join(diario.thread, NULL);
+    diario.avviato = false;
+
+    if (diario.file != NULL) {
+        fclose(diario.file);
+        diario.file = NULL;
+    }
+}
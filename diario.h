@@ -0,0 +1,89 @@
+#ifndef DIARIO_H
+#define DIARIO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Diario del gioco: messaggi diagnostici scritti su file, mai sullo schermo
+ * Chi scrive copia solo un record binario (formato, ora, argomenti) nel buffer
+ * circolare del proprio thread, senza blocchi né formattazione. Un thread in
+ * background raccoglie i record di tutti i thread, li formatta e li scrive
+ * sul file a blocchi.
+ *
+ * Il formato deve essere una stringa letterale (nel record finisce solo il
+ * suo indirizzo). Sono supportate le conversioni d i u x X o c s p e f g
+ * con i modificatori h, l, ll, z; le stringhe vengono copiate (troncate se
+ * non c'è spazio nel record).
+ *
+ * Livello minimo e categorie si scelgono a tempo di compilazione
+ * (-DLIVELLO_MINIMO_DIARIO=..., -DCATEGORIE_DIARIO=...): i messaggi esclusi
+ * non generano codice.
+ */
+
+#define FILE_DIARIO "gioco.log"            // File del diario (nella cartella dei salvataggi)
+#define DIM_BUFFER_DIARIO 1024             // Record per thread (potenza di 2)
+#define DIM_DATI_RECORD_DIARIO 104         // Byte per gli argomenti di un record
+
+// Livelli dei messaggi, dal meno al più importante
+#define DIARIO_DEBUG  0
+#define DIARIO_INFO   1
+#define DIARIO_AVVISO 2
+#define DIARIO_ERRORE 3
+
+// Categorie dei messaggi (bit di CATEGORIE_DIARIO)
+typedef enum {
+    CATEGORIA_GIOCO = 0,           // Avvio, menu, sessione
+    CATEGORIA_SALVATAGGI,          // File dei salvataggi
+    CATEGORIA_MISSIONI,            // Missioni e dungeon
+    CATEGORIA_COMBATTIMENTO,       // Motore di combattimento
+    CATEGORIA_SIMULATORE,          // Simulazioni Monte Carlo
+    CATEGORIA_SERVER,              // Connessioni e sessioni del server
+    NUMERO_CATEGORIE_DIARIO        // Numero di categorie (non è una categoria)
+} CategoriaDiario;
+
+#ifndef LIVELLO_MINIMO_DIARIO
+#define LIVELLO_MINIMO_DIARIO DIARIO_INFO
+#endif
+
+#ifndef CATEGORIE_DIARIO
+#define CATEGORIE_DIARIO 0xFFFFFFFFu
+#endif
+
+/// true se i messaggi di quel livello e categoria vengono compilati
+#define DIARIO_ATTIVO(livello, categoria) \
+    ((livello) >= LIVELLO_MINIMO_DIARIO && ((CATEGORIE_DIARIO >> (categoria)) & 1u))
+
+/// Scrive un messaggio nel diario (il filtro è una costante: se è falso il compilatore lo elimina)
+#define DIARIO(livello, categoria, ...) \
+    do { \
+        if (DIARIO_ATTIVO(livello, categoria)) scriviDiario((livello), (categoria), __VA_ARGS__); \
+    } while (0)
+
+#ifdef __GNUC__
+#define FORMATO_DIARIO __attribute__((format(printf, 3, 4)))
+#else
+#define FORMATO_DIARIO
+#endif
+
+/**
+ * Sceglie il file del diario: il thread che lo scrive parte al primo messaggio
+ * (il file e la sua cartella vengono creati solo allora); all'uscita del
+ * processo scrive i record rimasti
+ * Senza questa chiamata i messaggi restano nei buffer e non arrivano su file
+ */
+void avviaDiario(const char* percorso);
+
+/**
+ * Ferma il thread del diario dopo aver scritto tutti i record (chiamata anche all'uscita)
+ */
+void terminaDiario(void);
+
+/**
+ * Accoda un record nel buffer del thread chiamante (usare la macro DIARIO)
+ * Se il buffer è pieno il record viene scartato e contato
+ */
+void scriviDiario(int livello, CategoriaDiario categoria, const char* formato, ...) FORMATO_DIARIO;
+
+#endif // DIARIO_H
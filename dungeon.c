@@ -0,0 +1,675 @@
+/**
+ * @file dungeon.c
+ * @brief Generazione procedurale ed esplorazione dei dungeon delle missioni
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * I collegamenti formano un albero che porta ogni stanza verso l'ingresso
+ * (quindi tutto è raggiungibile), più qualche passaggio in più per creare dei
+ * giri. Nessuna scelta dipende dall'ordine di generazione:
+ * - la direzione verso l'ingresso di una stanza è la prima estrazione del suo seme
+ * - un passaggio in più tra due stanze dipende dal seme del passaggio
+ * - le stanze speciali (generali, oggetto) vengono estratte alla creazione
+ * quindi le uscite di una stanza si ricavano guardando solo lei e le quattro
+ * vicine, e materializzare una stanza costa O(1).
+ */
+
+#include "dungeon.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Probabilità (su 100) di un passaggio in più tra due stanze vicine
+#define PROBABILITA_PASSAGGIO_EXTRA 15
+
+/// @brief Slot allocati alla creazione (poi raddoppiati quando servono)
+#define CAPACITA_INIZIALE_DUNGEON 64
+
+/// @brief Numero casuale in [0, n)
+static inline int casuale(uint64_t* stato, int n) {
+    return (int)(((splitMix64(stato) >> 32) * (uint64_t)n) >> 32);
+}
+
+/// @brief Stato iniziale del generatore di una stanza (o di un passaggio, con 'sale' diverso)
+static inline uint64_t semeStanza(const Dungeon* d, int id, uint64_t sale) {
+    uint64_t stato = d->seme ^ (((uint64_t)id << 2 | sale) * 0xD1B54A32D192ED03ULL);
+    return splitMix64(&stato);
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * REGOLE DI GENERAZIONE DI UNA STANZA
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Uscita dell'albero che avvicina la stanza all'ingresso (0 per l'ingresso)
+ *
+ * @details
+ * A caso tra la direzione orizzontale e quella verticale, quando servono entrambe.
+ * È la prima estrazione dal seme della stanza.
+ */
+static int direzioneVersoIngresso(const Dungeon* d, int id) {
+    int x = id % d->larghezza, y = id / d->larghezza;
+    int ingressoX = d->ingresso % d->larghezza, ingressoY = d->ingresso / d->larghezza;
+    int orizzontale = x < ingressoX ? USCITA_EST : x > ingressoX ? USCITA_OVEST : 0;
+    int verticale = y < ingressoY ? USCITA_SUD : 0;
+
+    if (orizzontale && verticale) {
+        uint64_t stato = semeStanza(d, id, 0);
+        return casuale(&stato, 2) ? orizzontale : verticale;
+    }
+    return orizzontale | verticale;
+}
+
+/// @brief true se c'è un passaggio in più tra la stanza e la vicina a est (o a sud)
+static bool passaggioExtra(const Dungeon* d, int id, int direzione) {
+    uint64_t stato = semeStanza(d, id, direzione == USCITA_EST ? 1 : 2);
+    return casuale(&stato, 100) < PROBABILITA_PASSAGGIO_EXTRA;
+}
+
+/// @brief Maschera delle uscite di una stanza, simmetrica con quelle delle vicine
+static uint8_t usciteStanza(const Dungeon* d, int id) {
+    int uscite = direzioneVersoIngresso(d, id);
+
+    for (int direzione = USCITA_NORD; direzione <= USCITA_OVEST; direzione <<= 1) {
+        int vicina = stanzaVicina(d, id, direzione);
+        if (vicina < 0) continue;
+
+        // La vicina si collega a questa per avvicinarsi all'ingresso
+        if (direzioneVersoIngresso(d, vicina) == uscitaOpposta(direzione)) uscite |= direzione;
+
+        // Passaggi in più: decisi dalla stanza più a nord-ovest della coppia
+        if (direzione == USCITA_EST || direzione == USCITA_SUD) {
+            if (passaggioExtra(d, id, direzione)) uscite |= direzione;
+        } else if (passaggioExtra(d, vicina, uscitaOpposta(direzione))) {
+            uscite |= direzione;
+        }
+    }
+    return (uint8_t)uscite;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * STANZE MATERIALIZZATE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Posizione iniziale di un id nella tabella hash (moltiplicazione di Fibonacci)
+static inline int posizioneHash(const Dungeon* d, int id) {
+    return (int)(((uint32_t)id * 2654435769u) & (uint32_t)(d->dimensioneTabella - 1));
+}
+
+/**
+ * @brief Alloca (o ingrandisce) gli array delle stanze materializzate
+ *
+ * @details
+ * Tutti gli array stanno in un unico blocco, prima quelli a 32 bit e poi
+ * quelli a 8 bit. Quando la capacità raddoppia si crea un blocco nuovo, si
+ * copiano gli slot esistenti (che non cambiano) e si ricostruisce la tabella.
+ */
+static bool ridimensionaStanze(Dungeon* d, int capacita) {
+    int dimensioneTabella = 1;
+    while (dimensioneTabella < 2 * capacita) dimensioneTabella <<= 1;
+
+    size_t dimensione = sizeof(int) * (size_t)capacita * 2 +
+                        sizeof(int32_t) * (size_t)dimensioneTabella +
+                        6 * (size_t)capacita;
+    char* p = allocaMemoria(d->arena, dimensione);
+    if (p == NULL) return false;
+
+    Dungeon nuovo = *d;
+    nuovo.blocco = p;
+    nuovo.capacita = capacita;
+    nuovo.dimensioneTabella = dimensioneTabella;
+
+    nuovo.idStanza = (int*)p;                  p += sizeof(int) * (size_t)capacita;
+    nuovo.pila = (int*)p;                      p += sizeof(int) * (size_t)capacita;
+    nuovo.tabella = (int32_t*)p;               p += sizeof(int32_t) * (size_t)dimensioneTabella;
+    nuovo.uscite = (uint8_t*)p;                p += capacita;
+    nuovo.contenuto = (uint8_t*)p;             p += capacita;
+    nuovo.valore = (uint8_t*)p;                p += capacita;
+    nuovo.larghezzaStanza = (uint8_t*)p;       p += capacita;
+    nuovo.altezzaStanza = (uint8_t*)p;         p += capacita;
+    nuovo.esplorata = (uint8_t*)p;
+
+    int n = d->stanzeMaterializzate;
+    if (n > 0) {
+        memcpy(nuovo.idStanza, d->idStanza, sizeof(int) * (size_t)n);
+        memcpy(nuovo.pila, d->pila, sizeof(int) * (size_t)d->altezzaPila);
+        memcpy(nuovo.uscite, d->uscite, (size_t)n);
+        memcpy(nuovo.contenuto, d->contenuto, (size_t)n);
+        memcpy(nuovo.valore, d->valore, (size_t)n);
+        memcpy(nuovo.larghezzaStanza, d->larghezzaStanza, (size_t)n);
+        memcpy(nuovo.altezzaStanza, d->altezzaStanza, (size_t)n);
+        memcpy(nuovo.esplorata, d->esplorata, (size_t)n);
+    }
+
+    memset(nuovo.tabella, 0xFF, sizeof(int32_t) * (size_t)dimensioneTabella);
+    for (int s = 0; s < n; s++) {
+        int h = posizioneHash(&nuovo, nuovo.idStanza[s]);
+        while (nuovo.tabella[h] >= 0) h = (h + 1) & (dimensioneTabella - 1);
+        nuovo.tabella[h] = s;
+    }
+
+    rilasciaMemoria(d->arena, d->blocco);
+    *d = nuovo;
+    return true;
+}
+
+int slotStanza(const Dungeon* d, int id) {
+    int h = posizioneHash(d, id);
+    while (d->tabella[h] >= 0) {
+        if (d->idStanza[d->tabella[h]] == id) return d->tabella[h];
+        h = (h + 1) & (d->dimensioneTabella - 1);
+    }
+    return -1;
+}
+
+/**
+ * @brief Materializza una stanza: uscite, dimensioni e contenuto dal suo seme
+ *
+ * @details
+ * Le stanze speciali hanno il contenuto deciso alla creazione; le altre
+ * estraggono dal proprio seme, dopo la direzione verso l'ingresso (che è
+ * sempre la prima estrazione), dimensioni e contenuto.
+ */
+int materializzaStanza(Dungeon* d, int id) {
+    if (d == NULL || id < 0 || id >= d->numeroStanze) return -1;
+
+    int slot = slotStanza(d, id);
+    if (slot >= 0) return slot;
+
+    if (d->stanzeMaterializzate == d->capacita && !ridimensionaStanze(d, d->capacita * 2)) {
+        return -1;
+    }
+
+    slot = d->stanzeMaterializzate++;
+    CONTA_SONDA(SONDA_MATERIALIZZA_STANZA, 1);
+    int h = posizioneHash(d, id);
+    while (d->tabella[h] >= 0) h = (h + 1) & (d->dimensioneTabella - 1);
+    d->tabella[h] = slot;
+
+    uint64_t stato = semeStanza(d, id, 0);
+    splitMix64(&stato);  // Prima estrazione: direzione verso l'ingresso
+
+    d->idStanza[slot] = id;
+    d->uscite[slot] = usciteStanza(d, id);
+    d->larghezzaStanza[slot] = (uint8_t)(3 + casuale(&stato, DIM_CELLA_DUNGEON - 4));
+    d->altezzaStanza[slot] = (uint8_t)(3 + casuale(&stato, DIM_CELLA_DUNGEON - 4));
+    d->contenuto[slot] = STANZA_VUOTA;
+    d->valore[slot] = 0;
+    d->esplorata[slot] = 0;
+
+    int tiro = casuale(&stato, 100);
+    int tesoro = 5 + casuale(&stato, 16);
+
+    for (int i = 0; i < d->numeroSpeciali; i++) {
+        if (d->stanzeSpeciali[i] == id) {
+            d->contenuto[slot] = d->contenutoSpeciale[i];
+            d->valore[slot] = d->contenutoSpeciale[i] == STANZA_GENERALE ? 2 : 0;
+            return slot;
+        }
+    }
+    if (id != d->ingresso) {
+        if (tiro < 35) {
+            d->contenuto[slot] = STANZA_NEMICO;
+            d->valore[slot] = 1;
+        } else if (tiro < 45) {
+            d->contenuto[slot] = STANZA_TESORO;
+            d->valore[slot] = (uint8_t)tesoro;
+        }
+    }
+    return slot;
+}
+
+/// @brief Materializza le stanze collegate a quella indicata
+static bool materializzaCollegate(Dungeon* d, int id) {
+    uint8_t uscite = d->uscite[slotStanza(d, id)];
+    for (int direzione = USCITA_NORD; direzione <= USCITA_OVEST; direzione <<= 1) {
+        if ((uscite & direzione) && materializzaStanza(d, stanzaVicina(d, id, direzione)) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool stanzaEsplorata(const Dungeon* d, int id) {
+    int slot = slotStanza(d, id);
+    return slot >= 0 && d->esplorata[slot];
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CREAZIONE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Estrae una stanza diversa dall'ingresso e dalle stanze speciali già scelte
+static int stanzaSpecialeCasuale(const Dungeon* d, uint64_t* stato) {
+    for (;;) {
+        int id = (int)(splitMix64(stato) % (uint64_t)d->numeroStanze);
+        bool libera = id != d->ingresso;
+        for (int i = 0; i < d->numeroSpeciali && libera; i++) {
+            libera = d->stanzeSpeciali[i] != id;
+        }
+        if (libera) return id;
+    }
+}
+
+/**
+ * @brief Prepara il dungeon
+ *
+ * @details
+ * Il lavoro fatto qui non dipende dalla dimensione del dungeon: si estraggono
+ * le stanze speciali (con il generatore del dungeon) e si materializzano
+ * l'ingresso e le stanze collegate. Il resto viene generato durante l'esplorazione.
+ */
+bool generaDungeon(Dungeon* d, int larghezza, int altezza, uint64_t seme,
+                   int generali, bool conOggetto, Arena* arena) {
+    MISURA_SONDA(SONDA_GENERA_DUNGEON);
+    if (d == NULL || larghezza < 1 || altezza < 1 ||
+        larghezza > MAX_LATO_DUNGEON || altezza > MAX_LATO_DUNGEON) {
+        return false;
+    }
+
+    memset(d, 0, sizeof(*d));
+    d->arena = arena;
+    d->larghezza = larghezza;
+    d->altezza = altezza;
+    d->numeroStanze = larghezza * altezza;
+    d->ingresso = (altezza - 1) * larghezza + larghezza / 2;
+    d->seme = seme;
+
+    // Stanze speciali, finché ce ne sono di libere
+    uint64_t stato = seme;
+    int libere = d->numeroStanze - 1;
+    if (libere > MAX_STANZE_SPECIALI) libere = MAX_STANZE_SPECIALI;
+    if (conOggetto && libere > 0) {
+        d->stanzeSpeciali[d->numeroSpeciali] = stanzaSpecialeCasuale(d, &stato);
+        d->contenutoSpeciale[d->numeroSpeciali++] = STANZA_OGGETTO;
+        libere--;
+    }
+    for (int g = 0; g < generali && libere > 0; g++, libere--) {
+        d->stanzeSpeciali[d->numeroSpeciali] = stanzaSpecialeCasuale(d, &stato);
+        d->contenutoSpeciale[d->numeroSpeciali++] = STANZA_GENERALE;
+    }
+
+    if (!ridimensionaStanze(d, CAPACITA_INIZIALE_DUNGEON)) return false;
+
+    // L'eroe parte dall'ingresso
+    int slot = materializzaStanza(d, d->ingresso);
+    d->esplorata[slot] = 1;
+    d->stanzeEsplorate = 1;
+    d->pila[0] = d->ingresso;
+    d->altezzaPila = 1;
+
+    if (!materializzaCollegate(d, d->ingresso)) {
+        liberaDungeon(d);
+        return false;
+    }
+    return true;
+}
+
+void liberaDungeon(Dungeon* d) {
+    if (d == NULL) return;
+    rilasciaMemoria(d->arena, d->blocco);
+    memset(d, 0, sizeof(*d));
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * ESPLORAZIONE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+int esploraProssimaStanza(Dungeon* d) {
+    MISURA_SONDA(SONDA_ESPLORA_STANZA);
+    while (d->altezzaPila > 0) {
+        int corrente = stanzaCorrente(d);
+        uint8_t uscite = d->uscite[slotStanza(d, corrente)];
+
+        for (int direzione = USCITA_NORD; direzione <= USCITA_OVEST; direzione <<= 1) {
+            if (!(uscite & direzione)) continue;
+
+            // Le stanze collegate sono già materializzate dalla visita di quella corrente
+            int vicina = stanzaVicina(d, corrente, direzione);
+            int slot = slotStanza(d, vicina);
+            if (d->esplorata[slot]) continue;
+
+            d->esplorata[slot] = 1;
+            d->stanzeEsplorate++;
+            d->pila[d->altezzaPila++] = vicina;
+            if (!materializzaCollegate(d, vicina)) return -1;
+            return vicina;
+        }
+
+        // Vicoli ciechi: si torna indietro (senza costo) fino a una stanza con uscite nuove
+        if (d->altezzaPila == 1) break;
+        d->altezzaPila--;
+    }
+    return -1;
+}
+
+void svuotaStanza(Dungeon* d, int id) {
+    if (d == NULL) return;
+    int slot = slotStanza(d, id);
+    if (slot < 0) return;
+    d->contenuto[slot] = STANZA_VUOTA;
+    d->valore[slot] = 0;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * MAPPA A CASELLE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Parola con i bit [inizio, fine) accesi (0 <= inizio < fine <= 64)
+static inline uint64_t bitIntervallo(int inizio, int fine) {
+    uint64_t alti = fine >= 64 ? ~0ULL : (1ULL << fine) - 1;
+    return alti & ~((1ULL << inizio) - 1);
+}
+
+/**
+ * @brief Apre (bit a 0) un rettangolo di caselle nella maschera dei muri
+ *
+ * @details
+ * Per ogni riga si azzerano solo le parole toccate dal rettangolo, con una
+ * maschera per parola invece di un bit per volta.
+ */
+static void scavaRettangolo(MappaDungeon* m, int x0, int y0, int larghezza, int altezza) {
+    int x1 = x0 + larghezza;
+    for (int y = y0; y < y0 + altezza; y++) {
+        uint64_t* riga = m->muri + (size_t)y * m->parolePerRiga;
+        for (int p = x0 / 64; p <= (x1 - 1) / 64; p++) {
+            int inizio = x0 > p * 64 ? x0 - p * 64 : 0;
+            int fine = x1 < (p + 1) * 64 ? x1 - p * 64 : 64;
+            riga[p] &= ~bitIntervallo(inizio, fine);
+        }
+    }
+}
+
+bool casellaStanza(const MappaDungeon* m, const Dungeon* d, int id, int* x, int* y) {
+    int cx = id % d->larghezza - m->origineX;
+    int cy = id / d->larghezza - m->origineY;
+    if (cx < 0 || cy < 0 || cx * DIM_CELLA_DUNGEON >= m->larghezza ||
+        cy * DIM_CELLA_DUNGEON >= m->altezza) {
+        return false;
+    }
+    *x = cx * DIM_CELLA_DUNGEON + DIM_CELLA_DUNGEON / 2;
+    *y = cy * DIM_CELLA_DUNGEON + DIM_CELLA_DUNGEON / 2;
+    return true;
+}
+
+#define CELLE_PER_PAROLA (64 / DIM_CELLA_DUNGEON)   /**< Celle coperte da una parola di una riga della mappa */
+
+/**
+ * @brief Allarga la mappa finché copre la cella (cx, cy)
+ *
+ * @details
+ * La mappa copre il rettangolo delle stanze scavate finora. Quando una stanza
+ * cade fuori il lato che deve crescere almeno raddoppia (senza superare
+ * MAX_CELLE_MAPPA né uscire dal dungeon), quindi le copie costano in tutto
+ * al più il doppio della mappa finale. In orizzontale i bordi cadono su
+ * multipli di CELLE_PER_PAROLA celle: le righe vecchie si copiano a parole
+ * intere nella posizione nuova.
+ *
+ * @return false se la cella resterebbe oltre MAX_CELLE_MAPPA o la memoria non basta
+ */
+static bool copriCella(MappaDungeon* m, const Dungeon* d, int cx, int cy) {
+    int vecchiaX0 = m->origineX, vecchiaY0 = m->origineY;
+    int vecchieX = m->larghezza / DIM_CELLA_DUNGEON, vecchieY = m->altezza / DIM_CELLA_DUNGEON;
+    int x0 = cx, x1 = cx + 1, y0 = cy, y1 = cy + 1;
+
+    if (m->blocco != NULL) {
+        if (cx >= vecchiaX0 && cx < vecchiaX0 + vecchieX && cy >= vecchiaY0 && cy < vecchiaY0 + vecchieY) {
+            return true;
+        }
+        // Rettangolo minimo, poi raddoppio del lato che cresce entro MAX_CELLE_MAPPA
+        x0 = cx < vecchiaX0 ? cx : vecchiaX0;
+        x1 = cx >= vecchiaX0 + vecchieX ? cx + 1 : vecchiaX0 + vecchieX;
+        y0 = cy < vecchiaY0 ? cy : vecchiaY0;
+        y1 = cy >= vecchiaY0 + vecchieY ? cy + 1 : vecchiaY0 + vecchieY;
+        if (x1 - x0 > MAX_CELLE_MAPPA || y1 - y0 > MAX_CELLE_MAPPA) return false;
+        int margineX = (MAX_CELLE_MAPPA - (x1 - x0) < vecchieX) ? MAX_CELLE_MAPPA - (x1 - x0) : vecchieX;
+        int margineY = (MAX_CELLE_MAPPA - (y1 - y0) < vecchieY) ? MAX_CELLE_MAPPA - (y1 - y0) : vecchieY;
+        if (cx < vecchiaX0) x0 -= margineX;
+        if (cx >= vecchiaX0 + vecchieX) x1 += margineX;
+        if (cy < vecchiaY0) y0 -= margineY;
+        if (cy >= vecchiaY0 + vecchieY) y1 += margineY;
+    }
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > d->larghezza) x1 = d->larghezza;
+    if (y1 > d->altezza) y1 = d->altezza;
+    x0 -= x0 % CELLE_PER_PAROLA;
+    x1 += (CELLE_PER_PAROLA - x1 % CELLE_PER_PAROLA) % CELLE_PER_PAROLA;
+    if (x1 - x0 > MAX_CELLE_MAPPA) return false;    // L'allineamento non rientra
+
+    int larghezza = (x1 - x0) * DIM_CELLA_DUNGEON;
+    int altezza = (y1 - y0) * DIM_CELLA_DUNGEON;
+    int parolePerRiga = larghezza / 64;
+    size_t parole = (size_t)parolePerRiga * (size_t)altezza;
+    uint64_t* blocco = allocaMemoria(m->arena, 3 * parole * sizeof(uint64_t));
+    if (blocco == NULL) return false;
+    memset(blocco, 0xFF, parole * sizeof(uint64_t));            // Tutto muro finché non si scava
+    memset(blocco + parole, 0, 2 * parole * sizeof(uint64_t));
+
+    // Le maschere vecchie finiscono spostate di righe e parole intere
+    if (m->blocco != NULL) {
+        int righe = (vecchiaY0 - y0) * DIM_CELLA_DUNGEON;
+        int colonne = (vecchiaX0 - x0) / CELLE_PER_PAROLA;
+        size_t vecchieParole = (size_t)m->parolePerRiga * (size_t)m->altezza;
+        for (int k = 0; k < 3; k++) {
+            const uint64_t* da = (const uint64_t*)m->blocco + k * vecchieParole;
+            uint64_t* a = blocco + k * parole;
+            for (int r = 0; r < m->altezza; r++) {
+                memcpy(a + (size_t)(r + righe) * parolePerRiga + colonne, da + (size_t)r * m->parolePerRiga,
+                       (size_t)m->parolePerRiga * sizeof(uint64_t));
+            }
+        }
+        m->xVista += (vecchiaX0 - x0) * DIM_CELLA_DUNGEON;
+        m->yVista += righe;
+        rilasciaMemoria(m->arena, m->blocco);
+    }
+
+    m->origineX = x0;
+    m->origineY = y0;
+    m->larghezza = larghezza;
+    m->altezza = altezza;
+    m->parolePerRiga = parolePerRiga;
+    m->blocco = blocco;
+    m->muri = blocco;
+    m->visibili = blocco + parole;
+    m->esplorate = blocco + 2 * parole;
+    return true;
+}
+
+/**
+ * @brief La mappa parte dalle stanze già materializzate e cresce con aggiornaMappaDungeon()
+ */
+bool inizializzaMappaDungeon(MappaDungeon* m, const Dungeon* d) {
+    memset(m, 0, sizeof(*m));
+    m->arena = d->arena;
+
+    aggiornaMappaDungeon(m, d);
+    return m->blocco != NULL;
+}
+
+/**
+ * @brief Scava stanza e corridoi di ogni slot nuovo
+ *
+ * @details
+ * Prima allarga la mappa se la stanza è fuori (vedi copriCella()); una stanza
+ * che non ci sta resta fuori dalla mappa.
+ * La stanza è un rettangolo che contiene sempre il centro della cella; ogni
+ * uscita è un corridoio dal centro al bordo della cella, che incontra quello
+ * della stanza vicina sul bordo comune.
+ */
+void aggiornaMappaDungeon(MappaDungeon* m, const Dungeon* d) {
+    const int meta = DIM_CELLA_DUNGEON / 2;
+
+    for (int s = m->stanzeDisegnate; s < d->stanzeMaterializzate; s++) {
+        int cx, cy;
+        if (!copriCella(m, d, d->idStanza[s] % d->larghezza, d->idStanza[s] / d->larghezza) ||
+            !casellaStanza(m, d, d->idStanza[s], &cx, &cy)) {
+            continue;
+        }
+        int tx = cx - meta, ty = cy - meta;   // Angolo della cella
+
+        int w = d->larghezzaStanza[s], h = d->altezzaStanza[s];
+        scavaRettangolo(m, tx + (DIM_CELLA_DUNGEON - w) / 2, ty + (DIM_CELLA_DUNGEON - h) / 2, w, h);
+
+        if (d->uscite[s] & USCITA_NORD)  scavaRettangolo(m, cx, ty, 1, meta + 1);
+        if (d->uscite[s] & USCITA_SUD)   scavaRettangolo(m, cx, cy, 1, meta);
+        if (d->uscite[s] & USCITA_OVEST) scavaRettangolo(m, tx, cy, meta + 1, 1);
+        if (d->uscite[s] & USCITA_EST)   scavaRettangolo(m, cx, cy, meta, 1);
+    }
+    m->stanzeDisegnate = d->stanzeMaterializzate;
+}
+
+void liberaMappaDungeon(MappaDungeon* m) {
+    if (m == NULL) return;
+    rilasciaMemoria(m->arena, m->blocco);
+    memset(m, 0, sizeof(*m));
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CAMPO VISIVO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Trasformazioni delle coordinate per gli otto ottanti
+static const int OTTANTI[8][4] = {
+    { 1,  0,  0,  1}, { 0,  1,  1,  0}, { 0, -1,  1,  0}, {-1,  0,  0,  1},
+    {-1,  0,  0, -1}, { 0, -1, -1,  0}, { 0,  1, -1,  0}, { 1,  0,  0, -1}
+};
+
+static inline void accendiCasella(uint64_t* maschera, const MappaDungeon* m, int x, int y) {
+    maschera[(size_t)y * m->parolePerRiga + x / 64] |= 1ULL << (x % 64);
+}
+
+/**
+ * @brief Proiezione delle ombre in un ottante (shadowcasting ricorsivo)
+ *
+ * @details
+ * Si scorrono le righe dell'ottante allontanandosi dall'osservatore tenendo
+ * l'intervallo di pendenze [fine, inizio] ancora illuminato; ogni muro
+ * restringe l'intervallo e la parte oltre il muro viene proseguita in una
+ * chiamata ricorsiva. Le caselle fuori mappa contano come muri.
+ */
+static void proiettaOmbre(MappaDungeon* m, int ox, int oy, int riga, float inizio, float fine,
+                          int raggio, const int t[4]) {
+    if (inizio < fine) return;
+    float nuovoInizio = 0.0f;
+
+    for (int j = riga; j <= raggio; j++) {
+        bool bloccato = false;
+
+        for (int dx = -j; dx <= 0; dx++) {
+            int dy = -j;
+            int x = ox + dx * t[0] + dy * t[1];
+            int y = oy + dx * t[2] + dy * t[3];
+            float pendenzaSinistra = (dx - 0.5f) / (dy + 0.5f);
+            float pendenzaDestra = (dx + 0.5f) / (dy - 0.5f);
+
+            if (inizio < pendenzaDestra) continue;
+            if (fine > pendenzaSinistra) break;
+
+            bool dentro = x >= 0 && y >= 0 && x < m->larghezza && y < m->altezza;
+            if (dentro && dx * dx + dy * dy <= raggio * raggio) accendiCasella(m->visibili, m, x, y);
+
+            bool muro = !dentro || casellaMappa(m, m->muri, x, y);
+            if (bloccato) {
+                if (muro) {
+                    nuovoInizio = pendenzaDestra;
+                } else {
+                    bloccato = false;
+                    inizio = nuovoInizio;
+                }
+            } else if (muro && j < raggio) {
+                bloccato = true;
+                proiettaOmbre(m, ox, oy, j + 1, inizio, pendenzaSinistra, raggio, t);
+                nuovoInizio = pendenzaDestra;
+            }
+        }
+        if (bloccato) break;
+    }
+}
+
+/**
+ * @brief Righe [y0, y1] e parole [p0, p1] che contengono le caselle a distanza <= raggio da (x, y)
+ *
+ * @details
+ * Le operazioni sul campo visivo toccano solo queste parole, quindi il lavoro
+ * non dipende dalla dimensione della mappa.
+ */
+static void finestraParole(const MappaDungeon* m, int x, int y, int raggio,
+                           int* y0, int* y1, int* p0, int* p1) {
+    *y0 = y - raggio > 0 ? y - raggio : 0;
+    *y1 = y + raggio < m->altezza - 1 ? y + raggio : m->altezza - 1;
+    *p0 = (x - raggio > 0 ? x - raggio : 0) / 64;
+    *p1 = (x + raggio < m->larghezza - 1 ? x + raggio : m->larghezza - 1) / 64;
+}
+
+void calcolaCampoVisivo(MappaDungeon* m, int x, int y, int raggio) {
+    MISURA_SONDA(SONDA_CAMPO_VISIVO);
+    int y0, y1, p0, p1;
+
+    // Spegne il campo visivo precedente, solo nella sua finestra
+    if (m->raggioVista > 0) {
+        finestraParole(m, m->xVista, m->yVista, m->raggioVista, &y0, &y1, &p0, &p1);
+        for (int r = y0; r <= y1; r++) {
+            uint64_t* riga = m->visibili + (size_t)r * m->parolePerRiga;
+            for (int p = p0; p <= p1; p++) riga[p] = 0;
+        }
+    }
+
+    m->xVista = x;
+    m->yVista = y;
+    m->raggioVista = raggio;
+    if (x < 0 || y < 0 || x >= m->larghezza || y >= m->altezza || raggio < 1) {
+        m->raggioVista = 0;
+        return;
+    }
+
+    accendiCasella(m->visibili, m, x, y);
+    for (int o = 0; o < 8; o++) {
+        proiettaOmbre(m, x, y, 1, 1.0f, 0.0f, raggio, OTTANTI[o]);
+    }
+
+    // Nebbia di guerra: ciò che è visibile ora resta esplorato (64 caselle per operazione)
+    finestraParole(m, x, y, raggio, &y0, &y1, &p0, &p1);
+    for (int r = y0; r <= y1; r++) {
+        size_t base = (size_t)r * m->parolePerRiga;
+        for (int p = p0; p <= p1; p++) {
+            m->esplorate[base + p] |= m->visibili[base + p];
+        }
+    }
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * DISEGNO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+size_t disegnaMappaDungeon(const MappaDungeon* m, int x, int y, int larghezza, int altezza,
+                           char* buffer, size_t dimensione) {
+    MISURA_SONDA(SONDA_DISEGNA_MAPPA);
+    int x0 = x - larghezza / 2;
+    int y0 = y - altezza / 2;
+    size_t scritti = 0;
+
+    for (int r = y0; r < y0 + altezza; r++) {
+        for (int c = x0; c <= x0 + larghezza; c++) {
+            char carattere;
+            if (c == x0 + larghezza) {
+                carattere = '\n';
+            } else if (r < 0 || c < 0 || r >= m->altezza || c >= m->larghezza ||
+                       !casellaMappa(m, m->esplorate, c, r)) {
+                carattere = ' ';
+            } else if (r == y && c == x) {
+                carattere = '@';
+            } else if (casellaMappa(m, m->muri, c, r)) {
+                carattere = '#';
+            } else {
+                carattere = casellaMappa(m, m->visibili, c, r) ? '.' : ',';
+            }
+
+            if (scritti + 1 < dimensione) buffer[scritti] = carattere;
+            scritti++;
+        }
+    }
+    if (dimensione > 0) buffer[scritti < dimensione ? scritti : dimensione - 1] = '\0';
+    return scritti;
+}
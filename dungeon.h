@@ -0,0 +1,238 @@
+#ifndef DUNGEON_H
+#define DUNGEON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "utils.h"
+
+/**
+ * Dungeon procedurale di una missione, generato una stanza alla volta
+ * Le stanze stanno su una griglia di larghezza x altezza celle e l'id di una
+ * stanza è la sua cella (y * larghezza + x): i vicini si trovano con l'aritmetica
+ * degli indici, senza puntatori.
+ *
+ * Ogni stanza si ricava solo dal proprio seme (seme del dungeon + id), quindi
+ * può essere generata in qualsiasi ordine e rigenerata quando serve. Una stanza
+ * viene materializzata, insieme alle stanze collegate, la prima volta che
+ * l'eroe ci entra: memoria e tempo crescono con le stanze visitate, non con
+ * la dimensione del dungeon.
+ *
+ * Le stanze materializzate sono in array separati (struttura di array)
+ * indicizzati per posizione di materializzazione ("slot"); una tabella hash
+ * porta dall'id della stanza al suo slot.
+ */
+
+#define DIM_CELLA_DUNGEON 8                // Lato in caselle di una cella (stanza più muri)
+#define MAX_LATO_DUNGEON 16384             // Massimo numero di celle per lato
+#define MAX_STANZE_SPECIALI 256            // Generali più oggetto piazzati alla creazione
+
+// Uscite di una stanza (bit della maschera uscite[])
+#define USCITA_NORD  0x01
+#define USCITA_EST   0x02
+#define USCITA_SUD   0x04
+#define USCITA_OVEST 0x08
+
+// Contenuto di una stanza
+typedef enum {
+    STANZA_VUOTA = 0,              // Niente di interessante
+    STANZA_NEMICO,                 // Un nemico comune (valore = livello)
+    STANZA_GENERALE,               // Un nemico che conta come obiettivo della missione (valore = livello)
+    STANZA_OGGETTO,                // L'oggetto speciale della missione
+    STANZA_TESORO                  // Monete (valore = quantità)
+} ContenutoStanza;
+
+// Dungeon: griglia logica più le stanze materializzate finora
+typedef struct {
+    int larghezza;                 // Celle per riga
+    int altezza;                   // Righe di celle
+    int numeroStanze;              // larghezza * altezza (stanze logiche, non allocate)
+    int ingresso;                  // Id della stanza di ingresso
+    uint64_t seme;                 // Seme da cui derivano i semi delle stanze
+
+    int stanzeSpeciali[MAX_STANZE_SPECIALI]; // Id delle stanze con generali e oggetto
+    uint8_t contenutoSpeciale[MAX_STANZE_SPECIALI];
+    int numeroSpeciali;
+
+    // Stanze materializzate, indice = slot
+    int* idStanza;                 // Id della stanza nello slot
+    uint8_t* uscite;               // Maschera USCITA_* (i collegamenti sono simmetrici)
+    uint8_t* contenuto;            // ContenutoStanza (svuotato quando viene raccolto)
+    uint8_t* valore;               // Dato del contenuto (vedi ContenutoStanza)
+    uint8_t* larghezzaStanza;      // Caselle interne (al massimo DIM_CELLA_DUNGEON - 2)
+    uint8_t* altezzaStanza;
+    uint8_t* esplorata;            // 1 se l'eroe ci è entrato
+    int stanzeMaterializzate;      // Slot usati
+    int capacita;                  // Slot allocati
+
+    int32_t* tabella;              // Hash id -> slot (indirizzamento aperto, -1 = libero)
+    int dimensioneTabella;         // Potenza di 2, almeno il doppio di capacita
+
+    int* pila;                     // Percorso dall'ingresso alla stanza corrente (esplorazione in profondità)
+    int altezzaPila;
+    int stanzeEsplorate;           // Stanze visitate finora
+
+    void* blocco;                  // Unico blocco che contiene tutti gli array
+    Arena* arena;                  // Arena da cui vengono i blocchi (NULL = heap)
+} Dungeon;
+
+/**
+ * Stanza vicina nella direzione indicata (una sola USCITA_*), -1 se fuori dalla griglia
+ * Non controlla che ci sia un'uscita: vedi uscite[]
+ */
+static inline int stanzaVicina(const Dungeon* d, int id, int direzione) {
+    int x = id % d->larghezza;
+    int y = id / d->larghezza;
+    switch (direzione) {
+        case USCITA_NORD:  return y > 0 ? id - d->larghezza : -1;
+        case USCITA_EST:   return x + 1 < d->larghezza ? id + 1 : -1;
+        case USCITA_SUD:   return y + 1 < d->altezza ? id + d->larghezza : -1;
+        case USCITA_OVEST: return x > 0 ? id - 1 : -1;
+        default:           return -1;
+    }
+}
+
+/**
+ * Uscita opposta (NORD <-> SUD, EST <-> OVEST)
+ */
+static inline int uscitaOpposta(int direzione) {
+    return direzione <= USCITA_EST ? direzione << 2 : direzione >> 2;
+}
+
+/**
+ * Stanza in cui si trova l'eroe (in cima al percorso)
+ */
+static inline int stanzaCorrente(const Dungeon* d) {
+    return d->pila[d->altezzaPila - 1];
+}
+
+// --- GENERAZIONE ---
+
+/**
+ * Prepara un dungeon di larghezza x altezza stanze senza generarle
+ * Sceglie subito le stanze di 'generali' nemici obiettivo e, se 'conOggetto',
+ * quella dell'oggetto speciale; materializza solo l'ingresso (al centro del
+ * lato sud, già esplorato) e le stanze collegate. Tutte le stanze sono
+ * raggiungibili dall'ingresso.
+ * La memoria viene da 'arena' (NULL = heap); mappa e percorsi del dungeon
+ * usano la stessa.
+ * Ritorna false se le dimensioni non sono valide o la memoria non basta
+ */
+bool generaDungeon(Dungeon* d, int larghezza, int altezza, uint64_t seme,
+                   int generali, bool conOggetto, Arena* arena);
+
+/**
+ * Libera la memoria del dungeon
+ */
+void liberaDungeon(Dungeon* d);
+
+/**
+ * Slot della stanza, materializzandola se serve
+ * Ritorna -1 se l'id non è valido o la memoria non basta
+ */
+int materializzaStanza(Dungeon* d, int id);
+
+/**
+ * Slot di una stanza già materializzata, -1 se non lo è ancora
+ */
+int slotStanza(const Dungeon* d, int id);
+
+/**
+ * true se l'eroe è già entrato nella stanza
+ */
+bool stanzaEsplorata(const Dungeon* d, int id);
+
+// --- ESPLORAZIONE ---
+
+/**
+ * Porta l'eroe nella prossima stanza non visitata (in profondità: prima i vicini
+ * della stanza corrente, poi si torna indietro lungo il percorso), la segna
+ * esplorata e materializza le stanze collegate
+ * Ritorna l'id della stanza o -1 se il dungeon è stato esplorato tutto
+ */
+int esploraProssimaStanza(Dungeon* d);
+
+/**
+ * Svuota il contenuto di una stanza materializzata (nemico sconfitto, oggetto o tesoro raccolto)
+ */
+void svuotaStanza(Dungeon* d, int id);
+
+// --- MAPPA, CAMPO VISIVO E NEBBIA DI GUERRA ---
+
+#define RAGGIO_VISTA 6                     // Caselle viste attorno all'eroe
+#define MAX_CELLE_MAPPA 512                // Massimo di celle per lato coperte dalla mappa
+
+/**
+ * Mappa a caselle del dungeon: ogni cella è un quadrato di DIM_CELLA_DUNGEON
+ * caselle con la stanza al centro e i corridoi verso le uscite.
+ * Muri, caselle visibili ora e caselle già viste sono tre bitset con una riga
+ * di parole da 64 bit per ogni riga della mappa: le combinazioni tra maschere
+ * si fanno una parola (64 caselle) alla volta.
+ * Solo le stanze materializzate vengono scavate; il resto è muro. La mappa
+ * copre il rettangolo delle stanze scavate e si allarga quando ne compaiono
+ * fuori, quindi la memoria segue l'esplorazione e non il lato del dungeon.
+ */
+typedef struct {
+    int origineX;                  // Prima cella coperta dalla mappa
+    int origineY;
+    int larghezza;                 // Caselle per riga
+    int altezza;                   // Righe di caselle
+    int parolePerRiga;             // Parole da 64 bit di ogni riga di ogni maschera
+
+    uint64_t* muri;                // Bit = 1 se la casella blocca la vista
+    uint64_t* visibili;            // Campo visivo corrente
+    uint64_t* esplorate;           // Caselle viste almeno una volta (il resto è nebbia)
+
+    int stanzeDisegnate;           // Slot del dungeon già scavati nella mappa
+    int xVista;                    // Centro e raggio dell'ultimo campo visivo
+    int yVista;
+    int raggioVista;
+
+    void* blocco;                  // Unico blocco con le tre maschere
+    Arena* arena;                  // Arena del dungeon (NULL = heap)
+} MappaDungeon;
+
+/**
+ * Lettura del bit di una casella in una delle maschere della mappa
+ */
+static inline bool casellaMappa(const MappaDungeon* m, const uint64_t* maschera, int x, int y) {
+    return (maschera[(size_t)y * m->parolePerRiga + x / 64] >> (x % 64)) & 1;
+}
+
+/**
+ * Prepara la mappa del dungeon e scava le stanze già materializzate
+ * Ritorna false se la memoria non basta
+ */
+bool inizializzaMappaDungeon(MappaDungeon* m, const Dungeon* d);
+
+/**
+ * Scava nella mappa le stanze materializzate dopo l'ultimo aggiornamento,
+ * allargando la mappa se servono
+ */
+void aggiornaMappaDungeon(MappaDungeon* m, const Dungeon* d);
+
+/**
+ * Casella della mappa al centro di una stanza; false se la stanza è fuori dalla mappa
+ */
+bool casellaStanza(const MappaDungeon* m, const Dungeon* d, int id, int* x, int* y);
+
+/**
+ * Ricalcola il campo visivo da (x, y) e aggiunge le caselle viste a quelle esplorate
+ * Il costo dipende solo dal raggio, non dalla dimensione della mappa
+ */
+void calcolaCampoVisivo(MappaDungeon* m, int x, int y, int raggio);
+
+/**
+ * Disegna in 'buffer' una finestra di larghezza x altezza caselle centrata su (x, y):
+ * '@' eroe, '#' muro, '.' pavimento visibile, ',' pavimento ricordato, ' ' nebbia
+ * Ritorna il numero di caratteri necessari (come snprintf)
+ */
+size_t disegnaMappaDungeon(const MappaDungeon* m, int x, int y, int larghezza, int altezza,
+                           char* buffer, size_t dimensione);
+
+/**
+ * Libera la memoria della mappa
+ */
+void liberaMappaDungeon(MappaDungeon* m);
+
+#endif // DUNGEON_H
@@ -4,6 +4,8 @@
 #include <string.h>                // include per funzioni su stringhe come strcpy, strlen
 
 #include "eroe.h"                  // include dell'header che definisce la struttura Eroe e costanti come MAX_NOME_EROE
+#include "schermo.h"               // include per stampa(), l'output del gioco
+#include "tastiera.h"              // include per tastieraLeggiRiga(), la lettura delle righe di input
 
 
 //funzione che initializza l'eroe e di conseguenza i campi della struttura Eroe
@@ -28,38 +30,31 @@ void inizializzaEroe(Eroe* eroe, const char* nome) { //parametri, puntatore dlla
 //Funzione che mi mosta i dati del mio eroe
 void mostraEroe(const Eroe* eroe) { 
     if (eroe == NULL) {               //Verifica di sicurezza sul puntatore
-        printf("Eroe non valido.\n"); //Avvisa se il puntatore è NULL
+        stampa("Eroe non valido.\n"); //Avvisa se il puntatore è NULL
         return;                       //Esce dalla funzione
     }
 
-    printf("\033[1;36m//---- DATI EROE ----//\033[0m\n"); // stampa intestazione colorata (ANSI)
+    stampa("\033[1;36m//---- DATI EROE ----//\033[0m\n"); // stampa intestazione colorata (ANSI)
 
     //Dati eroe in colore normale
-    printf("\033[1;31mNome:\033[0m %s\n", eroe->nome);                 //Stampa il nome dell'eroe con etichetta colorata
-    printf("\033[1;31mVita:\033[0m %d\n", eroe->vita);                 //Stampa la vita corrente dell'eroe
-    printf("\033[1;31mMonete:\033[0m %d\n", eroe->monete);             //Stampa il numero di monete possedute
-    printf("\033[1;31mMissioni Completate:\033[0m %d\n", eroe->missioniCompletate); //Stampa le missioni completate
-    printf("\033[1;31mOggetti Posseduti:\033[0m %d\n", eroe->oggettiPosseduti);     //Stampa il numero di oggetti posseduti
+    stampa("\033[1;31mNome:\033[0m %s\n", eroe->nome);                 //Stampa il nome dell'eroe con etichetta colorata
+    stampa("\033[1;31mVita:\033[0m %d\n", eroe->vita);                 //Stampa la vita corrente dell'eroe
+    stampa("\033[1;31mMonete:\033[0m %d\n", eroe->monete);             //Stampa il numero di monete possedute
+    stampa("\033[1;31mMissioni Completate:\033[0m %d\n", eroe->missioniCompletate); //Stampa le missioni completate
+    stampa("\033[1;31mOggetti Posseduti:\033[0m %d\n", eroe->oggettiPosseduti);     //Stampa il numero di oggetti posseduti
 
-    printf("\033[1;36m//---------------//\033[0m\n"); // stampa linea di chiusura colorata
+    stampa("\033[1;36m//---------------//\033[0m\n"); // stampa linea di chiusura colorata
 }                                                
 
 
 //funzione che legge il nome dell'eroe da stdin e lo pulisce
 void dichiaraNomeEroe(char* nomeEroe) {           
-    printf("Inserisci il nome del tuo eroe: ");    
+    stampa("Inserisci il nome del tuo eroe: ");    
     
-    //fgets() legge una riga da tastiera (STDIN(standardinput)) di lungezza massima MAX NOME ERORE
-    //legge anche le evewntuali newLine
-    fgets(nomeEroe, MAX_NOME_EROE, stdin);
-    
-    // Rimuovi il carattere di nuova linea se presente
-
-    //uso size_t perche strlen mi torna questo tipo di dato che esclude numeri negativi
-    size_t len = strlen(nomeEroe);                  //Calcola la lunghezza della stringa letta
-
-    if (len > 0 && nomeEroe[len - 1] == '\n') {     //Ce l'ultimo carattere è '\n'
-        nomeEroe[len - 1] = '\0';                   //Sostituisci il '\n' con il terminatore di stringa
+    //tastieraLeggiRiga() legge una riga (da tastiera o dallo script headless) di lungezza massima MAX NOME ERORE
+    //toglie gia' il carattere di nuova linea e scarta quello che non entra nel buffer
+    if (!tastieraLeggiRiga(nomeEroe, MAX_NOME_EROE)) {
+        nomeEroe[0] = '\0';                         //Input terminato: nome vuoto
     }
 }                                                 
 
@@ -3,6 +3,7 @@
 #define EROE_H            // Definisce la macro EROE_H per segnare che questo header è stato incluso
 
 #define MAX_NOME_EROE 25  // Definisce la costante MAX_NOME_EROE = 25 (usata per limiti di lunghezza nome)
+#define VITA_MASSIMA_EROE 20 // Vita iniziale e vita dopo il riposo (o la sconfitta)
  // Nota: assicurarsi che la dimensione dell'array nome nella struct sia coerente con questa macro
 
 // Definizione della struttura Eroe che rappresenta lo stato di un personaggio
@@ -0,0 +1,104 @@
+/**
+ * @file eventi.c
+ * @brief Bus degli eventi di gioco con coda circolare preallocata
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * Gli eventi vengono copiati in una coda circolare di dimensione fissa e
+ * consegnati più tardi, in un punto preciso del ciclo di gioco, così chi li
+ * produce non deve sapere chi li ascolta. Gli iscritti sono divisi per tipo:
+ * un evento costa solo le chiamate ai propri iscritti e un tipo senza iscritti
+ * non entra nemmeno in coda.
+ */
+
+#include "eventi.h"
+#include "sessione.h"
+#include <stddef.h>
+
+/// @brief Bus della sessione corrente
+static inline BusEventi* busCorrente(void) {
+    return &sessioneCorrente()->eventi;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * ISCRIZIONI
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+bool iscriviEvento(TipoEvento tipo, IscrittoEvento funzione, void* contesto) {
+    BusEventi* bus = busCorrente();
+    if (tipo < 0 || tipo >= NUMERO_TIPI_EVENTO || funzione == NULL ||
+        bus->numeroIscritti[tipo] == MAX_ISCRITTI_EVENTO) {
+        return false;
+    }
+
+    bus->iscritti[tipo][bus->numeroIscritti[tipo]++] = (Iscrizione){ funzione, contesto };
+    return true;
+}
+
+void annullaIscrizioneEvento(TipoEvento tipo, IscrittoEvento funzione, void* contesto) {
+    BusEventi* bus = busCorrente();
+    if (tipo < 0 || tipo >= NUMERO_TIPI_EVENTO) return;
+
+    Iscrizione* iscritti = bus->iscritti[tipo];
+    int n = bus->numeroIscritti[tipo];
+
+    for (int i = 0; i < n; i++) {
+        if (iscritti[i].funzione == funzione && iscritti[i].contesto == contesto) {
+            // Scorre i successivi per mantenere l'ordine di iscrizione
+            for (int j = i + 1; j < n; j++) {
+                iscritti[j - 1] = iscritti[j];
+            }
+            bus->numeroIscritti[tipo]--;
+            return;
+        }
+    }
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * PUBBLICAZIONE E CONSEGNA
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+bool pubblicaEvento(TipoEvento tipo, int missione, int valore) {
+    BusEventi* bus = busCorrente();
+    if (tipo < 0 || tipo >= NUMERO_TIPI_EVENTO) return false;
+
+    // Nessuno interessato: l'evento non costa nulla
+    if (bus->numeroIscritti[tipo] == 0) return true;
+
+    if (bus->fondo - bus->testa == DIM_CODA_EVENTI) return false;  // Coda piena
+
+    bus->coda[bus->fondo++ & (DIM_CODA_EVENTI - 1)] = (Evento){ tipo, missione, valore };
+    return true;
+}
+
+int consegnaEventi(void) {
+    BusEventi* bus = busCorrente();
+    int consegnati = 0;
+
+    // La coda può crescere durante la consegna: si ricontrolla il fondo ad ogni giro
+    while (bus->testa != bus->fondo) {
+        Evento evento = bus->coda[bus->testa++ & (DIM_CODA_EVENTI - 1)];
+
+        // Copia degli iscritti: un iscritto può annullare la propria iscrizione
+        Iscrizione iscritti[MAX_ISCRITTI_EVENTO];
+        int n = bus->numeroIscritti[evento.tipo];
+        for (int i = 0; i < n; i++) {
+            iscritti[i] = bus->iscritti[evento.tipo][i];
+        }
+
+        for (int i = 0; i < n; i++) {
+            iscritti[i].funzione(&evento, iscritti[i].contesto);
+        }
+        consegnati++;
+    }
+    return consegnati;
+}
+
+void reimpostaEventi(void) {
+    BusEventi* bus = busCorrente();
+    bus->testa = bus->fondo = 0;
+    for (int t = 0; t < NUMERO_TIPI_EVENTO; t++) {
+        bus->numeroIscritti[t] = 0;
+    }
+}
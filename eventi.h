@@ -0,0 +1,91 @@
+#ifndef EVENTI_H
+#define EVENTI_H
+
+#include <stdbool.h>
+
+/**
+ * Bus degli eventi di gioco
+ * Chi produce un evento (esplorazione, combattimento) lo pubblica in una coda
+ * circolare preallocata; consegnaEventi() lo passa solo agli iscritti a quel
+ * tipo di evento. Nessuna allocazione per evento, costo O(iscritti al tipo).
+ * Le funzioni agiscono sul bus della sessione corrente.
+ */
+
+/**
+ * Dimensione della coda circolare degli eventi.
+ * Deve essere una potenza di 2 (l'indice viene calcolato con una maschera).
+ */
+#define DIM_CODA_EVENTI 64
+
+// Numero massimo di iscritti per ogni tipo di evento
+#define MAX_ISCRITTI_EVENTO 8
+
+// Tipi di evento del gioco
+typedef enum {
+    EVENTO_NEMICO_UCCISO = 0,      // Un nemico è stato sconfitto (valore = 1 se era un obiettivo della missione)
+    EVENTO_OGGETTO_RECUPERATO,     // L'oggetto speciale della missione è stato trovato
+    EVENTO_STANZA_ESPLORATA,       // Una stanza del dungeon è stata ripulita (valore = id stanza)
+    NUMERO_TIPI_EVENTO             // Numero di tipi (non è un evento)
+} TipoEvento;
+
+// Singolo evento: piccolo e copiato per valore nella coda
+typedef struct {
+    TipoEvento tipo;               // Tipo di evento
+    int missione;                  // Missione in cui è avvenuto (TipoMissione)
+    int valore;                    // Dato specifico del tipo (vedi TipoEvento)
+} Evento;
+
+// Funzione chiamata per ogni evento del tipo a cui ci si è iscritti
+typedef void (*IscrittoEvento)(const Evento* evento, void* contesto);
+
+// Un iscritto: funzione più il contesto da passarle
+typedef struct {
+    IscrittoEvento funzione;
+    void* contesto;
+} Iscrizione;
+
+// Stato di un bus: ogni sessione di gioco ha il proprio (vedi sessione.h)
+typedef struct {
+    Evento coda[DIM_CODA_EVENTI];                                   // Coda circolare
+    unsigned testa;                                                 // Prossimo evento da consegnare
+    unsigned fondo;                                                 // Prossima posizione libera
+    Iscrizione iscritti[NUMERO_TIPI_EVENTO][MAX_ISCRITTI_EVENTO];   // Iscritti per tipo
+    int numeroIscritti[NUMERO_TIPI_EVENTO];                         // Iscritti usati per tipo
+} BusEventi;
+
+// --- ISCRIZIONI ---
+
+/**
+ * Iscrive una funzione agli eventi di un tipo
+ * Gli iscritti vengono chiamati nell'ordine di iscrizione
+ * Ritorna false se il tipo non è valido o non c'è più posto
+ */
+bool iscriviEvento(TipoEvento tipo, IscrittoEvento funzione, void* contesto);
+
+/**
+ * Cancella l'iscrizione (stessa funzione e stesso contesto)
+ */
+void annullaIscrizioneEvento(TipoEvento tipo, IscrittoEvento funzione, void* contesto);
+
+// --- PUBBLICAZIONE E CONSEGNA ---
+
+/**
+ * Accoda un evento senza consegnarlo
+ * Un evento di un tipo senza iscritti viene scartato subito
+ * Ritorna false se la coda è piena
+ */
+bool pubblicaEvento(TipoEvento tipo, int missione, int valore);
+
+/**
+ * Consegna agli iscritti tutti gli eventi in coda, compresi quelli
+ * pubblicati dagli iscritti durante la consegna
+ * Ritorna il numero di eventi consegnati
+ */
+int consegnaEventi(void);
+
+/**
+ * Scarta gli eventi in coda e tutte le iscrizioni
+ */
+void reimpostaEventi(void);
+
+#endif // EVENTI_H
@@ -0,0 +1,237 @@
+/**
+ * @file headless.c
+ * @brief Esecuzione automatica di partite da script, senza prompt né rendering
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * La modalità headless serve per test di carico e profiling della logica reale
+ * di menu.c, missioni.c e salvataggi.c:
+ * - lo script viene caricato una sola volta e indicizzato per righe
+ * - ogni input richiesto dai menu viene preso dallo script (vedi tastiera.c)
+ * - l'output di gioco è disattivato (vedi schermo.c), quindi non si paga la formattazione
+ * - i salvataggi vanno in una cartella di prova svuotata prima di ogni partita
+ *   (vedi preparaCartellaProva()): i risultati non dipendono da ciò che c'è su
+ *   disco e i salvataggi veri non vengono toccati
+ * - per ogni partita si emette una riga JSON con lo stato finale
+ */
+
+#include "headless.h"
+#include "menu.h"
+#include "eroe.h"
+#include "missioni.h"
+#include "salvataggi.h"
+#include "schermo.h"
+#include "tastiera.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CARICAMENTO SCRIPT
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Script caricato in memoria
+ *
+ * @details
+ * Il testo resta in un unico buffer; righe[] punta alle singole righe
+ * così ogni input dello script costa un solo accesso per indice.
+ */
+typedef struct {
+    char* testo;                   ///< Contenuto del file
+    RigaScript* righe;             ///< Righe utili (commenti esclusi)
+    int numeroRighe;               ///< Numero di righe utili
+} Script;
+
+/**
+ * @brief Carica il file di script e lo divide in righe
+ *
+ * @details
+ * Le righe che iniziano con '#' sono commenti e vengono saltate.
+ * Il '\r' finale (file scritti su Windows) viene ignorato.
+ *
+ * @return true se il caricamento è riuscito
+ */
+static bool caricaScript(const char* percorso, Script* script) {
+    memset(script, 0, sizeof(*script));
+
+    FILE* f = fopen(percorso, "rb");
+    if (!f) return false;
+
+    fseek(f, 0, SEEK_END);
+    long dimensione = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (dimensione < 0) {
+        fclose(f);
+        return false;
+    }
+
+    script->testo = malloc((size_t)dimensione + 1);
+    if (!script->testo || fread(script->testo, 1, (size_t)dimensione, f) != (size_t)dimensione) {
+        fclose(f);
+        free(script->testo);
+        return false;
+    }
+    fclose(f);
+    script->testo[dimensione] = '\0';
+
+    // Al massimo una riga per ogni '\n' più l'ultima
+    int capacita = 1;
+    for (long i = 0; i < dimensione; i++) {
+        if (script->testo[i] == '\n') capacita++;
+    }
+    script->righe = malloc(sizeof(RigaScript) * (size_t)capacita);
+    if (!script->righe) {
+        free(script->testo);
+        return false;
+    }
+
+    char* p = script->testo;
+    char* fine = script->testo + dimensione;
+    while (p < fine) {
+        char* a_capo = memchr(p, '\n', (size_t)(fine - p));
+        char* fineRiga = a_capo ? a_capo : fine;
+        size_t lunghezza = (size_t)(fineRiga - p);
+        if (lunghezza > 0 && p[lunghezza - 1] == '\r') lunghezza--;
+
+        if (!(lunghezza > 0 && p[0] == '#')) {
+            script->righe[script->numeroRighe].testo = p;
+            script->righe[script->numeroRighe].lunghezza = lunghezza;
+            script->numeroRighe++;
+        }
+        p = a_capo ? a_capo + 1 : fine;
+    }
+    return true;
+}
+
+static void liberaScript(Script* script) {
+    free(script->righe);
+    free(script->testo);
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * ESECUZIONE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Scrive il risultato di una partita partita dal villaggio
+ */
+static void scriviRisultatoVillaggio(FILE* out, long partita, const Eroe* eroe,
+                                     const GestoreMissioni* gestore, long long durataNs) {
+    fprintf(out, "{\"partita\":%ld,\"input\":%ld,\"ns\":%lld,"
+                 "\"eroe\":{\"vita\":%d,\"monete\":%d,\"missioniCompletate\":%d,\"oggetti\":%d},"
+                 "\"missioni\":[",
+            partita, tastieraInputConsumati(), durataNs,
+            eroe->vita, eroe->monete, eroe->missioniCompletate, eroe->oggettiPosseduti);
+    for (int i = 0; i < gestore->numeroMissioni; i++) {
+        fprintf(out, "%s{\"id\":%d,\"completata\":%s,\"sbloccata\":%s,\"obiettivi\":%d}",
+                i ? "," : "", i,
+                missioneCompletata(gestore, i) ? "true" : "false",
+                missioneSbloccata(gestore, i) ? "true" : "false",
+                obiettiviCompletati(gestore, i));
+    }
+    fprintf(out, "]}\n");
+}
+
+int eseguiHeadless(const OpzioniHeadless* opzioni, FILE* risultati) {
+    if (opzioni == NULL || opzioni->percorsoScript == NULL || risultati == NULL) return 1;
+
+    Script script;
+    if (!caricaScript(opzioni->percorsoScript, &script)) {
+        fprintf(stderr, "Impossibile leggere lo script '%s'\n", opzioni->percorsoScript);
+        return 1;
+    }
+
+    ModalitaSchermo modalitaPrecedente = schermoModalita();
+    schermoImpostaModalita(SCHERMO_SILENZIOSO);
+    tastieraImpostaScript(script.righe, script.numeroRighe);
+
+    long long inizioTotale = adessoNs();
+    long inputTotali = 0;
+    int esito = 0;
+
+    for (long partita = 1; partita <= opzioni->ripetizioni; partita++) {
+        if (!preparaCartellaProva()) {
+            fprintf(stderr, "Impossibile preparare la cartella di prova in '%s'\n", CARTELLA_SALVATAGGI);
+            esito = 1;
+            break;
+        }
+        tastieraRiavvolgiScript();
+        long long inizio = adessoNs();
+
+        if (opzioni->partenza == HEADLESS_MENU_PRINCIPALE) {
+            menuPrincipale();
+            long long durata = adessoNs() - inizio;
+            if (opzioni->dettagli) {
+                fprintf(risultati, "{\"partita\":%ld,\"input\":%ld,\"ns\":%lld}\n",
+                        partita, tastieraInputConsumati(), durata);
+            }
+        } else {
+            Eroe eroe;
+            GestoreMissioni gestore;
+            inizializzaEroe(&eroe, opzioni->nomeEroe);
+            inizializzaGestoreMissioni(&gestore, arenaSessione());
+
+            while (menuDelVillaggio(&eroe, &gestore) && !tastieraInputTerminato());
+
+            long long durata = adessoNs() - inizio;
+            if (opzioni->dettagli) {
+                scriviRisultatoVillaggio(risultati, partita, &eroe, &gestore, durata);
+            }
+            liberaGestoreMissioni(&gestore);
+            svuotaArena(arenaSessione());
+        }
+        inputTotali += tastieraInputConsumati();
+    }
+
+    long long totaleNs = adessoNs() - inizioTotale;
+    double secondi = totaleNs / 1e9;
+    if (esito == 0) {
+        fprintf(risultati, "{\"riepilogo\":{\"partite\":%ld,\"input\":%ld,\"ns\":%lld,\"partiteAlSecondo\":%.1f}}\n",
+                opzioni->ripetizioni, inputTotali, totaleNs,
+                secondi > 0 ? opzioni->ripetizioni / secondi : 0.0);
+    }
+
+    tastieraRimuoviScript();
+    schermoImpostaModalita(modalitaPrecedente);
+    rimuoviCartellaSalvataggi();
+    liberaScript(&script);
+    return esito;
+}
+
+int mainHeadless(int argc, char* argv[]) {
+    OpzioniHeadless opzioni = {
+        .percorsoScript = NULL,
+        .ripetizioni = 1,
+        .nomeEroe = "Headless",
+        .partenza = HEADLESS_VILLAGGIO,
+        .dettagli = false
+    };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            opzioni.ripetizioni = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--nome") == 0 && i + 1 < argc) {
+            opzioni.nomeEroe = argv[++i];
+        } else if (strcmp(argv[i], "--menu") == 0) {
+            opzioni.partenza = HEADLESS_MENU_PRINCIPALE;
+        } else if (strcmp(argv[i], "--dettagli") == 0) {
+            opzioni.dettagli = true;
+        } else if (opzioni.percorsoScript == NULL) {
+            opzioni.percorsoScript = argv[i];
+        } else {
+            opzioni.percorsoScript = NULL;
+            break;
+        }
+    }
+
+    if (opzioni.percorsoScript == NULL || opzioni.ripetizioni < 1 ||
+        strlen(opzioni.nomeEroe) >= MAX_NOME_EROE) {
+        fprintf(stderr, "Uso: %s --headless SCRIPT [-n RIPETIZIONI] [--nome NOME] [--menu] [--dettagli]\n",
+                argv[0]);
+        return 1;
+    }
+
+    return eseguiHeadless(&opzioni, stdout);
+}
@@ -0,0 +1,35 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// Punto di partenza di ogni partita simulata
+typedef enum {
+    HEADLESS_VILLAGGIO = 0,        // Eroe nuovo già nel villaggio: lo script guida menuDelVillaggio()
+    HEADLESS_MENU_PRINCIPALE       // Lo script parte da menuPrincipale()
+} PartenzaHeadless;
+
+// Opzioni della modalità headless
+typedef struct {
+    const char* percorsoScript;    // File con un input per riga (le righe che iniziano con '#' sono commenti)
+    long ripetizioni;              // Quante volte eseguire lo script
+    const char* nomeEroe;          // Nome dell'eroe creato per ogni partita (solo HEADLESS_VILLAGGIO)
+    PartenzaHeadless partenza;     // Da quale menu parte lo script
+    bool dettagli;                 // true per emettere una riga di risultati per ogni partita
+} OpzioniHeadless;
+
+/**
+ * Esegue lo script per il numero di ripetizioni richiesto, senza prompt né output di gioco
+ * I risultati (JSON, uno per riga) vengono scritti su 'risultati'
+ * Ritorna 0 se tutto è andato bene, 1 in caso di errore
+ */
+int eseguiHeadless(const OpzioniHeadless* opzioni, FILE* risultati);
+
+/**
+ * Interpreta gli argomenti da riga di comando di --headless ed esegue
+ * Uso: --headless SCRIPT [-n RIPETIZIONI] [--nome NOME] [--menu] [--dettagli]
+ */
+int mainHeadless(int argc, char* argv[]);
+
+#endif // HEADLESS_H
@@ -1,6 +1,68 @@
+#include <stdio.h>
+#include <string.h>
 #include "menu.h"
+#include "headless.h"
+#include "registrazione.h"
+#include "catalogo.h"
+#include "simulatore.h"
+#include "utils.h"
+#include "diario.h"
+#include "salvataggi.h"
+#include "server.h"
+
+int main(int argc, char* argv[]) {
+    // Sonde di misura (solo compilando con -DSTRUMENTAZIONE, vedi utils.h)
+    inizializzaStrumentazione();
+
+    // Diagnostica su file accanto ai salvataggi, scritta da un thread in
+    // background che parte solo se la modalità scelta registra qualcosa (vedi diario.c)
+    avviaDiario(CARTELLA_SALVATAGGI "/" FILE_DIARIO);
+
+    // Modalità headless: partite guidate da script, senza prompt (vedi headless.c)
+    if (argc > 1 && strcmp(argv[1], "--headless") == 0) {
+        argv[1] = argv[0];
+        return mainHeadless(argc - 1, argv + 1);
+    }
+
+    // Riproduzione di una sessione registrata (vedi registrazione.c)
+    if (argc > 1 && strcmp(argv[1], "--riproduci") == 0) {
+        argv[1] = argv[0];
+        return mainRiproduci(argc - 1, argv + 1);
+    }
+
+    // Esportazione del catalogo delle missioni nel formato del file dati (vedi catalogo.c)
+    if (argc > 1 && strcmp(argv[1], "--esporta-missioni") == 0) {
+        argv[1] = argv[0];
+        return mainEsportaMissioni(argc - 1, argv + 1);
+    }
+
+    // Simulazione Monte Carlo delle missioni per il bilanciamento (vedi simulatore.c)
+    if (argc > 1 && strcmp(argv[1], "--simula") == 0) {
+        argv[1] = argv[0];
+        return mainSimula(argc - 1, argv + 1);
+    }
+
+    // Server di gioco multi-sessione e client di prova (vedi server.c)
+    if (argc > 1 && strcmp(argv[1], "--server") == 0) {
+        argv[1] = argv[0];
+        return mainServer(argc - 1, argv + 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "--client") == 0) {
+        argv[1] = argv[0];
+        return mainClient(argc - 1, argv + 1);
+    }
+
+    uint64_t seme = inizializzaSemeSessione();
+    DIARIO(DIARIO_INFO, CATEGORIA_GIOCO, "Sessione avviata (seme %llu)", (unsigned long long)seme);
+
+    // Registrazione della sessione: ogni input viene salvato per poterla riprodurre
+    if (argc > 2 && strcmp(argv[1], "--registra") == 0) {
+        if (!avviaRegistrazione(argv[2], seme)) {
+            fprintf(stderr, "Impossibile creare la registrazione '%s'\n", argv[2]);
+            return 1;
+        }
+    }
 
-int main() {
     menuPrincipale();
     return 0;
 }
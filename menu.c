@@ -21,20 +21,20 @@
 //Include la libreria per le funzioni di gestione delle stringhe (strcmp / strcpy)
 #include <string.h>
 
+//Include la libreria standard per strtol
+#include <stdlib.h>
+
 //Include tutti i file header personalizzati del progetto che contengono le varie dichiarazioni delle funzioni
 #include "menu.h"       ///< Funzioni relative al menu di gioco
 #include "salvataggi.h" ///< Funzioni relative al salvataggio e il caricamento delle partite
 #include "eroe.h"       ///< Funzioni e strutture relative all'eroe ed al personaggio
 #include "trucchi.h"    ///< Funzioni per gestire i trucchi
 #include "missioni.h"   ///< Funzioni per gestire le varie missioni di gioco
-
-/**
- * @def MAX_TRUCCHI
- * @brief Numero massimo di caratteri ammessi per la sequenza di attivazione trucchi
- * @details Definisce la dimensione del buffer che memorizza la sequenza Konami
- *          per l'attivazione dei trucchi nel menu principale
- */
-#define MAX_TRUCCHI 32
+#include "tastiera.h"   ///< Input da tastiera in modalità raw (un tasto alla volta)
+#include "schermo.h"    ///< Output testuale del gioco (disattivabile in modalità headless)
+#include "opzioni.h"    ///< Definizioni dei menu e tabelle tasto -> azione
+#include "utils.h"      ///< Arena della sessione (tutto lo stato di una partita)
+#include "sessione.h"   ///< Stato del giocatore corrente (trucchi attivi)
 
 /**
  * @defgroup ANSI_Colors Codici colore ANSI
@@ -52,42 +52,25 @@
 #define COLORE_RESET "\033[0m"        ///< Ripristina colore normale (fondamentale per evitare che tutto rimanga colorato)
 /** @} */ // Fine gruppo ANSI_Colors
 
-/**
- * @var trucchiAttivi
- * @brief Variabile globale statica che traccia lo stato di attivazione dei trucchi
- * @details Visibile solo all'interno di questo file (static).
- *          È FONDAMENTALE per determinare se i trucchi sono stati attivati tramite
- *          la sequenza Konami e quindi se mostrare l'opzione trucchi nel menu
+/*
+ * Lo stato di attivazione dei trucchi sta nella sessione (Sessione::trucchiAttivi,
+ * vedi sessione.h): ogni giocatore del server sblocca i trucchi per conto suo.
+ * È FONDAMENTALE per determinare se i trucchi sono stati attivati tramite
+ * la sequenza Konami e quindi se mostrare l'opzione trucchi nel menu
  */
-static bool trucchiAttivi = false;
 
 //Prototipi (dichiarazioni) di funzioni statiche (usate solo in questo file)
 //servono per dichiarare funzioni che verranno usate più avanti nel codice
 
 /**
- * @brief Stampa il menu principale con due opzioni (senza trucchi)
- * @details Visualizza un riquadro decorativo con le opzioni:
- *          1. Nuova partita
- *          2. Carica salvataggio
- *          0. Esci
- *          Questa versione viene mostrata quando i trucchi NON sono attivi
+ * @brief Stampa il menu principale dentro un riquadro
+ * @details Visualizza un riquadro decorativo con le voci del menu indicato:
+ *          MENU_PRINCIPALE (1. Nuova partita, 2. Carica salvataggio, 0. Esci) quando
+ *          i trucchi NON sono attivi, MENU_PRINCIPALE_TRUCCHI (con anche 3. Trucchi) quando lo sono
  * @note Funzione statica, utilizzabile solo in questo file
- * @see stampaMenuConRiquadroAtreOpzioni()
+ * @see opzioni.h
  */
-static void stampaMenuConRiquadroADueOpzioni(void);
-
-/**
- * @brief Stampa il menu principale con tre opzioni (con trucchi)
- * @details Visualizza un riquadro decorativo con le opzioni:
- *          1. Nuova partita
- *          2. Carica salvataggio
- *          3. Trucchi
- *          0. Esci
- *          Questa versione viene mostrata quando i trucchi SONO attivi
- * @note Funzione statica, utilizzabile solo in questo file
- * @see stampaMenuConRiquadroADueOpzioni()
- */
-static void stampaMenuConRiquadroAtreOpzioni(void);
+static void stampaMenuConRiquadro(const DefinizioneMenu* menu);
 
 /**
  * @brief Stampa il menu specifico del villaggio di gioco
@@ -128,12 +111,17 @@ static void stampaMenuVillaggio(void);
  *          1. Legge il carattere inserito dall'utente
  *          2. Automaticamente svuota il buffer (rimuove '\n' e altri residui)
  *          3. Restituisce solo il carattere valido
+ *          
+ *          Se lo standard input è un terminale basta premere il tasto (senza Invio)
+ *          e le frecce vengono tradotte in w/s/a/d. Con input da pipe o file resta
+ *          la lettura classica di una riga; in modalità headless il carattere arriva dallo script.
  * 
- * @return char Il carattere inserito dall'utente (senza caratteri residui nel buffer)
+ * @return char Il carattere inserito dall'utente (senza caratteri residui nel buffer),
+ *              oppure INPUT_FINE se l'input è terminato
  * 
  * @code
  * // Esempio di utilizzo:
- * printf("Inserisci una scelta [1-3]: ");
+ * stampa("Inserisci una scelta [1-3]: ");
  * char scelta = leggiCaratterePulito();
  * if (scelta == '1') {
  *     // Elabora scelta 1
@@ -144,14 +132,7 @@ static void stampaMenuVillaggio(void);
  * @see pulisciBuffer()
  */
 char leggiCaratterePulito(void) {
-    int c; ///< Variabile per leggere i caratteri aggiuntivi dal buffer
-
-    char ch = getchar(); ///< Legge il primo carattere inserito dall'utente e lo memorizza in ch
-    
-    //Ciclo while che continua finché non trova '\n' o EOF
-    while ((c = getchar()) != '\n' && c != EOF);
-    
-    return ch; ///< Restituisce il carattere valido
+    return tastieraLeggiCarattere(); ///< Legge il carattere e scarta il resto della riga (vedi tastiera.c)
 }
 
 /**
@@ -171,7 +152,7 @@ char leggiCaratterePulito(void) {
  * @code
  * // Esempio di utilizzo:
  * int numero;
- * printf("Inserisci un numero: ");
+ * stampa("Inserisci un numero: ");
  * scanf("%d", &numero);
  * pulisciBuffer();  // FONDAMENTALE per evitare problemi
  * @endcode
@@ -184,6 +165,25 @@ void pulisciBuffer(void) {
     while ((c = getchar()) != '\n' && c != EOF); ///< Svuota tutto fino a newline o EOF
 }
 
+/**
+ * @brief Legge un numero intero (anche negativo) su una riga
+ * @details Sostituisce scanf("%d") + pulisciBuffer(): legge l'intera riga tramite
+ *          tastieraLeggiRiga() (quindi funziona anche con gli script headless)
+ *          e la converte con strtol. Una riga non numerica o vuota vale 0.
+ * 
+ * @return int Il numero letto, 0 se la riga non è un numero o l'input è terminato
+ * 
+ * @see tastieraLeggiRiga()
+ */
+int leggiNumero(void) {
+    char riga[32]; ///< Buffer per la riga letta
+    
+    if (!tastieraLeggiRiga(riga, sizeof(riga))) {
+        return 0;
+    }
+    return (int)strtol(riga, NULL, 10);
+}
+
 /** @} */ // Fine gruppo BufferManagement
 
 /**
@@ -196,101 +196,74 @@ void pulisciBuffer(void) {
  *          - Routing verso le varie funzionalità (nuova partita, carica, trucchi, esci)
  *          
  *          Il menu rimane attivo in un ciclo infinito fino a quando l'utente sceglie di uscire.
- *          La sequenza Konami viene memorizzata carattere per carattere e verificata quando
- *          l'utente preme spazio come terminatore.
+ *          Ogni tasto fa avanzare l'automa dei trucchi (vedi trucchi.c): appena l'ultima
+ *          lettera di un codice viene digitata il codice è riconosciuto, senza buffer né terminatore.
  * 
  * @return void Non restituisce alcun valore (il ciclo continua fino all'uscita)
  * 
  * @note La sequenza Konami è nascosta e viene attivata inserendo una serie specifica di caratteri
- *       seguita da spazio. Una volta attivati i trucchi, appare l'opzione "3. Trucchi" nel menu.
+ *       (anche con le frecce). Una volta attivati i trucchi, appare l'opzione "3. Trucchi" nel menu.
  * 
- * @warning Se l'utente inserisce una sequenza troppo lunga (>MAX_TRUCCHI), viene automaticamente
- *          resettata per evitare overflow del buffer
- * 
- * @see stampaMenuConRiquadroADueOpzioni()
- * @see stampaMenuConRiquadroAtreOpzioni()
+ * @see avanzaTrucchi()
+ * @see stampaMenuConRiquadro()
  * @see gestisciNuovaPartita()
  * @see gestisciCaricaSalvataggio()
  * @see gestisciMenuTrucchi()
  */
 void menuPrincipale(void) {
     char opzione; ///< Variabile contenente l'opzione scelta dall'utente
+    Sessione* sessione = sessioneCorrente(); ///< Giocatore corrente (stato dei trucchi)
     
-    char contTrucchi[MAX_TRUCCHI] = {0}; ///< Buffer per memorizzare la sequenza Konami mediante un array di dimensione MAX_TRUCCHI
-    int i = 0; ///< Contatore per la posizione corrente nel buffer dei trucchi
+    reimpostaTrucchi(); ///< L'automa dei trucchi riparte dallo stato iniziale ad ogni ingresso nel menu
 
     while (1) { //ciclo infinito 
 
-        // Stampa il menu appropriato in base allo stato dei trucchi
-        if (trucchiAttivi) { //se i trucchi sono attivi
-            stampaMenuConRiquadroAtreOpzioni(); //personalizzazione con trucchi
-        } else { //altrimenti
-            stampaMenuConRiquadroADueOpzioni(); //personalizzazione senza trucchi
-        }
-        
+        // Sceglie il menu appropriato in base allo stato dei trucchi
         // Usa operatore ternario: condizione ? se vera : se falsa
-        printf("Seleziona una delle opzioni del menu [%s] : ", trucchiAttivi ? "1 - 3" : "1 - 2 - 0");
+        const DefinizioneMenu* menu = sessione->trucchiAttivi ? &MENU_PRINCIPALE_TRUCCHI : &MENU_PRINCIPALE;
+        stampaMenuConRiquadro(menu);
+        
+        stampa("Seleziona una delle opzioni del menu [%s] : ", sessione->trucchiAttivi ? "1 - 3 - 0" : "1 - 2 - 0");
 
         opzione = leggiCaratterePulito(); //svuota il buffer per evitare terminatori non desiderati
 
+        if (opzione == INPUT_FINE) { //input terminato (EOF o script esaurito): niente più scelte possibili
+            return;
+        }
+
+        // Ogni tasto fa avanzare l'automa dei trucchi: costo costante, nessun buffer
+        if (!sessione->trucchiAttivi && avanzaTrucchi(opzione) == TRUCCO_MENU) {
+            stampa("\n" COLORE_VERDE "TRUCCHI ATTIVATI!\n" COLORE_RESET);
+            sessione->trucchiAttivi = true; //imposta i trucchi a true
+            continue; //torna al menu, che ora mostra anche l'opzione trucchi
+        }
+
         // Verifica se il carattere inserito è valido
-        if (!carattereValido(opzione, trucchiAttivi)) { //se il carattere non è valido
-            printf(COLORE_ROSSO "Carattere non valido, riprova.\n" COLORE_RESET);
+        if (!carattereValido(opzione, sessione->trucchiAttivi)) { //se il carattere non è valido
+            stampa(COLORE_ROSSO "Carattere non valido, riprova.\n" COLORE_RESET);
             continue; //salta tutto il codice corrente e torna all'inizio del loop (FONDAMENTALE)
         }
 
-        //Opzioni del menu
-        switch (opzione) {
-            case '0':
-                printf(COLORE_GIALLO "Uscita dal gioco. Arrivederci!\n" COLORE_RESET);
+        //Opzioni del menu: la tabella del menu traduce il tasto nell'azione
+        switch (azioneMenu(menu, opzione)) {
+            case PRINCIPALE_ESCI:
+                stampa(COLORE_GIALLO "Uscita dal gioco. Arrivederci!\n" COLORE_RESET);
                 return; // Termina il programma
                 
-            case '1':
+            case PRINCIPALE_NUOVA_PARTITA:
                 gestisciNuovaPartita(); //gestione nuova partita
                 break; // Torna al menu principale dopo la partita, esce dallo switch
                 
-            case '2':
+            case PRINCIPALE_CARICA:
                 gestisciCaricaSalvataggio(); //gestione carica del salvataggio
                 break; // Torna al menu principale dopo la partita, esce dallo switch
                 
-            case '3':
-                if (trucchiAttivi) { // se i trucchi sono attivi
-                    gestisciMenuTrucchi(); //gestione del menu trucchi
-                } else { //altrimenti
-                    printf(COLORE_ROSSO "Opzione non valida.\n" COLORE_RESET);
-                }
-                break; //esce dallo switch
-                
-            case ' ':
-                // Terminatore della sequenza Konami
-                if (i == 0) { //se il contatore dei caratteri konami rimane invariato
-                    printf(COLORE_ROSSO "Errore: terminatore spazio inserito senza sequenza.\n" COLORE_RESET);
-                } else { //altrimenti
-                    if (confrontoString(contTrucchi)) { //se la stringa corrisponde alla stringa della sequenza konami
-                        printf("\n" COLORE_VERDE "TRUCCHI ATTIVATI!\n" COLORE_RESET);
-                        trucchiAttivi = true; //imposta i trucchi a true
-                    } else {
-                        printf("\n" COLORE_ROSSO "Codice errato. Riprova.\n" COLORE_RESET);
-                    }
-                    i = 0; //riparte con il conteggio a 0
-                    contTrucchi[0] = '\0'; //imposta il terminatore del contenitore di trucchi per la partita successiva o per un successivo inserimento
-                }
+            case PRINCIPALE_TRUCCHI:
+                gestisciMenuTrucchi(); //gestione del menu trucchi (presente solo se i trucchi sono attivi)
                 break; //esce dallo switch
                 
             default:
-                // Se non siamo in modalità trucchi, accumula caratteri per il codice Konami
-                if (!trucchiAttivi) { //se i trucchi non sono stati attivati
-                    if (i < MAX_TRUCCHI - 1) { //finché il contatore i dei trucchi è inferiore alla dimensione massima meno uno (il meno uno serve per lasciare lo spazio al terminatore '\0')
-                        contTrucchi[i++] = opzione; //scorro l'array e salvo il carattere
-                        contTrucchi[i] = '\0'; //imposto quello successivo con il terminatore
-                    } else { //altrimenti se i supera il massimo di caratteri ammessi
-                        printf(COLORE_ROSSO "Sequenza troppo lunga, ripartiamo.\n" COLORE_RESET);
-                        i = 0; //reimposta i a 0
-                        contTrucchi[0] = '\0'; //imposta il terminatore del contenitore di trucchi per la partita successiva o per un successivo inserimento
-                    }
-                } else {
-                    printf(COLORE_ROSSO "Opzione non valida.\n" COLORE_RESET);
-                }
+                // Carattere di un codice trucco: l'automa lo ha già consumato, non c'è altro da fare
                 break; //esce dallo switch
         }
     }
@@ -324,39 +297,50 @@ void menuPrincipale(void) {
  * @see menuDelVillaggio()
  */
 void gestisciNuovaPartita(void) {
-    printf("\n" COLORE_VERDE "Hai scelto NUOVA PARTITA!\n" COLORE_RESET);
+    stampa("\n" COLORE_VERDE "Hai scelto NUOVA PARTITA!\n" COLORE_RESET);
+    
+    //Tutto lo stato della partita sta nell'arena della sessione, svuotata quando si torna al menu principale
+    Arena* sessione = arenaSessione();
     
     //Crea un nuovo eroe
-    Eroe eroe; ///< Crea una variabile eroe di tipo Eroe, un'istanza di Eroe (vedi struct Eroe.h)
-    printf("Inserisci il nome del tuo eroe: ");
-    dichiaraNomeEroe(eroe.nome); ///< Passo come parametro il campo della struct del mio eroe appena creato alla funzione 
+    Eroe* eroe = allocaArenaAzzerata(sessione, sizeof(Eroe)); ///< L'eroe della partita (vedi struct Eroe.h)
+    GestoreMissioni* gestore = allocaArenaAzzerata(sessione, sizeof(GestoreMissioni)); ///< Lo stato delle missioni
+    if (eroe == NULL || gestore == NULL) {
+        stampa(COLORE_ROSSO "Memoria insufficiente per iniziare la partita.\n" COLORE_RESET);
+        svuotaArena(sessione);
+        return;
+    }
+    stampa("Inserisci il nome del tuo eroe: ");
+    dichiaraNomeEroe(eroe->nome); ///< Passo come parametro il campo della struct del mio eroe appena creato alla funzione 
 
-    inizializzaEroe(&eroe, eroe.nome); ///< Inizializzazione dell'eroe passando l'indirizzo di memoria della mia variabile eroe e il nome senza caratteri fastidiosi nel buffer
+    inizializzaEroe(eroe, eroe->nome); ///< Inizializzazione dell'eroe passando l'indirizzo di memoria della mia variabile eroe e il nome senza caratteri fastidiosi nel buffer
     
     //Crea un salvataggio iniziale di tipo Salvataggio (vedi struct file salvataggi.h)
-    Salvataggio s = creaSalvataggioDaEroe(&eroe); ///< Passo l'indirizzo di memoria della mia variabile eroe 
+    Salvataggio s = creaSalvataggioDaEroe(eroe); ///< Passo l'indirizzo di memoria della mia variabile eroe 
 
     if (salvaGioco(&s)) { //Se il gioco viene salvato correttamente (se la funzione mi torna true)
-        printf(COLORE_VERDE "Salvataggio iniziale creato con successo!\n" COLORE_RESET);
+        stampa(COLORE_VERDE "Salvataggio iniziale creato con successo!\n" COLORE_RESET);
     } else { //altrimenti (se mi torna false)
-        printf(COLORE_ROSSO "Errore nel salvataggio iniziale.\n" COLORE_RESET);
+        stampa(COLORE_ROSSO "Errore nel salvataggio iniziale.\n" COLORE_RESET);
     }
 
-    mostraEroe(&eroe); ///< Mostra tutte le caratteristiche del mio eroe
+    mostraEroe(eroe); ///< Mostra tutte le caratteristiche del mio eroe
     
     //Inizializza il gestore delle missioni
-    GestoreMissioni gestore; ///< Creo un'istanza di GestoreMissioni
-    inizializzaGestoreMissioni(&gestore); ///< Inizializzo il gestore delle missioni (vedi missioni.c)
+    inizializzaGestoreMissioni(gestore, sessione); ///< Inizializzo il gestore delle missioni (vedi missioni.c)
     
-    printf("\n" COLORE_CIANO "Benvenuto nel villaggio, %s!\n" COLORE_RESET, eroe.nome);
-    printf(COLORE_GIALLO "Il capo del villaggio ti chiama...\n" COLORE_RESET);
-    printf(COLORE_ROSSO "\"Un'oscura minaccia incombe sul regno. Sei la nostra ultima speranza!\"\n" COLORE_RESET);
+    stampa("\n" COLORE_CIANO "Benvenuto nel villaggio, %s!\n" COLORE_RESET, eroe->nome);
+    stampa(COLORE_GIALLO "Il capo del villaggio ti chiama...\n" COLORE_RESET);
+    stampa(COLORE_ROSSO "\"Un'oscura minaccia incombe sul regno. Sei la nostra ultima speranza!\"\n" COLORE_RESET);
     
     //Entra nel menu del villaggio (loop principale di gioco)
     bool continuaGioco = true; ///< Flag per controllare il loop di gioco
     while (continuaGioco) {
-        continuaGioco = menuDelVillaggio(&eroe, &gestore);
+        continuaGioco = menuDelVillaggio(eroe, gestore);
     }
+    
+    liberaGestoreMissioni(gestore); ///< Libera le missioni allocate dal gestore
+    svuotaArena(sessione); ///< Libera in un colpo tutto lo stato della partita
 }
 
 /**
@@ -397,58 +381,60 @@ void gestisciNuovaPartita(void) {
  * @see menuDelVillaggio()
  */
 void gestisciCaricaSalvataggio(void) {
-    printf("\n" COLORE_CIANO "Hai scelto CARICA SALVATAGGIO!\n" COLORE_RESET);
+    stampa("\n" COLORE_CIANO "Hai scelto CARICA SALVATAGGIO!\n" COLORE_RESET);
     mostraMenuSalvataggi();
 
     if (contaSalvataggi() == 0) {
-        printf(COLORE_GIALLO "Nessun salvataggio disponibile.\n" COLORE_RESET);
+        stampa(COLORE_GIALLO "Nessun salvataggio disponibile.\n" COLORE_RESET);
         return;
     }
 
     int sceltaSalvataggio = chiediSalvataggioDaCaricare();
     if (sceltaSalvataggio == -1) {
-        printf(COLORE_GIALLO "Tornando al menu principale...\n" COLORE_RESET);
+        stampa(COLORE_GIALLO "Tornando al menu principale...\n" COLORE_RESET);
         return;
     }
 
     // ===== QUI È IL PUNTO CHIAVE =====
     // Chiedi all'utente cosa vuoi fare con il salvataggio selezionato
-    printf("\n" COLORE_CIANO "Seleziona un'opzione per il salvataggio %d:\n" COLORE_RESET, sceltaSalvataggio);
-    printf("1. Carica\n");
-    printf("2. Elimina\n");
-    printf("3. Annulla\n");
+    stampa("\n" COLORE_CIANO "Seleziona un'opzione per il salvataggio %d:\n" COLORE_RESET, sceltaSalvataggio);
+    stampaVociMenu(&MENU_SALVATAGGIO);
     
-    char scelta; ///< Variabile per memorizzare la scelta dell'utente
+    int azione; ///< Azione scelta dall'utente (vedi VOCI_MENU_SALVATAGGIO)
     
     while (1) {
-        printf("Seleziona opzione [1-3]: ");
-        scelta = leggiCaratterePulito();
+        stampa("Seleziona opzione [1-3]: ");
+        char scelta = leggiCaratterePulito();
         
-        if (scelta >= '1' && scelta <= '3') {
+        if (scelta == INPUT_FINE) {
+            return;
+        }
+        azione = azioneMenu(&MENU_SALVATAGGIO, scelta);
+        if (azione != AZIONE_NESSUNA) {
             break;
         }
-        printf(COLORE_ROSSO "Opzione non valida. Riprova.\n" COLORE_RESET);
+        stampa(COLORE_ROSSO "Opzione non valida. Riprova.\n" COLORE_RESET);
     }
     
-    if (scelta == '3') {
+    if (azione == SALVATAGGIO_ANNULLA) {
         // Annulla
-        printf(COLORE_GIALLO "Operazione annullata. Tornando al menu principale...\n" COLORE_RESET);
+        stampa(COLORE_GIALLO "Operazione annullata. Tornando al menu principale...\n" COLORE_RESET);
         return;
     }
     
-    if (scelta == '2') {
+    if (azione == SALVATAGGIO_ELIMINA) {
         // Elimina
-        printf(COLORE_ROSSO "\nSei sicuro di voler eliminare definitivamente il salvataggio? [S/N]: " COLORE_RESET);
+        stampa(COLORE_ROSSO "\nSei sicuro di voler eliminare definitivamente il salvataggio? [S/N]: " COLORE_RESET);
         char conferma = leggiCaratterePulito();
         
-        if (conferma == 'S' || conferma == 's') {
+        if (azioneMenu(&MENU_CONFERMA, conferma) == CONFERMA_SI) {
             if (eliminaSalvataggio(sceltaSalvataggio)) {
-                printf(COLORE_VERDE "Salvataggio eliminato con successo.\n" COLORE_RESET);
+                stampa(COLORE_VERDE "Salvataggio eliminato con successo.\n" COLORE_RESET);
             } else {
-                printf(COLORE_ROSSO "Errore nell'eliminazione del salvataggio.\n" COLORE_RESET);
+                stampa(COLORE_ROSSO "Errore nell'eliminazione del salvataggio.\n" COLORE_RESET);
             }
         } else {
-            printf(COLORE_GIALLO "Eliminazione annullata.\n" COLORE_RESET);
+            stampa(COLORE_GIALLO "Eliminazione annullata.\n" COLORE_RESET);
         }
         return; // Torna al menu principale
     }
@@ -458,37 +444,45 @@ void gestisciCaricaSalvataggio(void) {
     // Carica il salvataggio selezionato
     Salvataggio s; ///< Struttura per contenere i dati del salvataggio caricato
     if (!leggiSalvataggioIndice(sceltaSalvataggio, &s)) {
-        printf(COLORE_ROSSO "Errore nel caricamento del salvataggio.\n" COLORE_RESET);
+        stampa(COLORE_ROSSO "Errore nel caricamento del salvataggio.\n" COLORE_RESET);
         return;
     }
     
-    Eroe eroeCaricato = creaEroeDaSalvataggio(&s); ///< Ricrea l'eroe dai dati del salvataggio
-    printf(COLORE_VERDE "\nSalvataggio caricato con successo!\n" COLORE_RESET);
-    mostraEroe(&eroeCaricato);
+    //Tutto lo stato della partita sta nell'arena della sessione, svuotata quando si torna al menu principale
+    Arena* sessione = arenaSessione();
+    Eroe* eroeCaricato = allocaArena(sessione, sizeof(Eroe));
+    GestoreMissioni* gestore = allocaArenaAzzerata(sessione, sizeof(GestoreMissioni));
+    if (eroeCaricato == NULL || gestore == NULL) {
+        stampa(COLORE_ROSSO "Memoria insufficiente per caricare la partita.\n" COLORE_RESET);
+        svuotaArena(sessione);
+        return;
+    }
+    *eroeCaricato = creaEroeDaSalvataggio(&s); ///< Ricrea l'eroe dai dati del salvataggio
+    stampa(COLORE_VERDE "\nSalvataggio caricato con successo!\n" COLORE_RESET);
+    mostraEroe(eroeCaricato);
     
     // Inizializza il gestore missioni (TODO: salvare e caricare anche lo stato delle missioni)
-    GestoreMissioni gestore;
-    inizializzaGestoreMissioni(&gestore);
+    inizializzaGestoreMissioni(gestore, sessione);
     
     // TODO: Ripristinare lo stato delle missioni completate dal salvataggio
-    // Per ora utilizziamo il contatore missioniCompletate dell'eroe
-    for (int i = 0; i < eroeCaricato.missioniCompletate && i < 3; i++) {
-        gestore.missioni[i].completata = true;
-        gestore.missioniCompletate = eroeCaricato.missioniCompletate;
-    }
-    
-    // Sblocca la missione finale se necessario
-    if (tutteLePreliminariCompletate(&gestore)) {
-        sbloccaMissioneFinale(&gestore);
+    // Per ora segniamo come completate le prime missioni sbloccate non finali del catalogo:
+    // ogni completamento sblocca le missioni che dipendono da lei (anche la finale)
+    for (int i = 0; i < gestore->numeroMissioni && gestore->missioniCompletate < eroeCaricato->missioniCompletate; i++) {
+        if (missioneSbloccata(gestore, (TipoMissione)i) && !(getMissione(gestore, (TipoMissione)i)->flag & MISSIONE_FLAG_FINALE)) {
+            ripristinaMissioneCompletata(gestore, (TipoMissione)i);
+        }
     }
     
-    printf(COLORE_CIANO "\nBentornato, %s!\n" COLORE_RESET, eroeCaricato.nome);
+    stampa(COLORE_CIANO "\nBentornato, %s!\n" COLORE_RESET, eroeCaricato->nome);
     
     // Entra nel menu del villaggio
     bool continuaGioco = true;
     while (continuaGioco) {
-        continuaGioco = menuDelVillaggio(&eroeCaricato, &gestore);
+        continuaGioco = menuDelVillaggio(eroeCaricato, gestore);
     }
+    
+    liberaGestoreMissioni(gestore);
+    svuotaArena(sessione);
 }
 
 /**
@@ -513,17 +507,17 @@ void gestisciCaricaSalvataggio(void) {
  * @see chiediSalvataggioDaCaricare()
  */
 void gestisciMenuTrucchi(void) {
-    printf("\n" COLORE_MAGENTA "Sei entrato nel menu TRUCCHI!\n" COLORE_RESET);
+    stampa("\n" COLORE_MAGENTA "Sei entrato nel menu TRUCCHI!\n" COLORE_RESET);
     mostraMenuSalvataggi();
 
     if (contaSalvataggi() == 0) {
-        printf(COLORE_GIALLO "Nessun salvataggio disponibile per modifiche.\n" COLORE_RESET);
+        stampa(COLORE_GIALLO "Nessun salvataggio disponibile per modifiche.\n" COLORE_RESET);
         return;
     }
 
     int sceltaSalvataggio = chiediSalvataggioDaCaricare();
     if (sceltaSalvataggio == -1) {
-        printf(COLORE_GIALLO "Tornando al menu principale...\n" COLORE_RESET);
+        stampa(COLORE_GIALLO "Tornando al menu principale...\n" COLORE_RESET);
         return;
     }
 
@@ -568,20 +562,22 @@ void gestisciMenuTrucchi(void) {
  * @see salvaGioco()
  */
 void modificaCampoSalvataggio(int sceltaSalvataggio) {
-    printf(COLORE_CIANO "\nHai scelto il salvataggio %d\n" COLORE_RESET, sceltaSalvataggio);
-    printf("Cosa vuoi modificare nel salvataggio %d?\n", sceltaSalvataggio);
-    printf("1. Vita\n");
-    printf("2. Monete\n");
-    printf("3. Sblocca Missione Finale\n");
+    stampa(COLORE_CIANO "\nHai scelto il salvataggio %d\n" COLORE_RESET, sceltaSalvataggio);
+    stampa("Cosa vuoi modificare nel salvataggio %d?\n", sceltaSalvataggio);
+    stampaVociMenu(&MENU_MODIFICA);
 
-    char scelta; ///< Variabile per memorizzare la scelta dell'utente
+    int azione; ///< Azione scelta dall'utente (vedi VOCI_MENU_MODIFICA)
     
     while (1) {
-        printf("Scegli un'opzione [1-3]: ");
-        scelta = leggiCaratterePulito();
+        stampa("Scegli un'opzione [1-3]: ");
+        char scelta = leggiCaratterePulito();
 
-        if (scelta < '1' || scelta > '3') {
-            printf(COLORE_ROSSO "Opzione non valida. Riprova.\n" COLORE_RESET);
+        if (scelta == INPUT_FINE) {
+            return;
+        }
+        azione = azioneMenu(&MENU_MODIFICA, scelta);
+        if (azione == AZIONE_NESSUNA) {
+            stampa(COLORE_ROSSO "Opzione non valida. Riprova.\n" COLORE_RESET);
             continue;
         }
         break;
@@ -589,41 +585,37 @@ void modificaCampoSalvataggio(int sceltaSalvataggio) {
 
     Salvataggio s; ///< Struttura per contenere i dati del salvataggio
     if (!leggiSalvataggioIndice(sceltaSalvataggio, &s)) {
-        printf(COLORE_ROSSO "Errore nel caricamento del salvataggio.\n" COLORE_RESET);
+        stampa(COLORE_ROSSO "Errore nel caricamento del salvataggio.\n" COLORE_RESET);
         return;
     }
 
     Eroe eroeModificato = creaEroeDaSalvataggio(&s); ///< Ricrea l'eroe dal salvataggio per modificarlo
 
-    if (scelta == '1') {
-        printf(COLORE_GIALLO "Modifica della VITA selezionata.\n" COLORE_RESET);
-        printf("Di quanto vuoi modificare la vita? (usa numero negativo per diminuire): ");
-        int delta; ///< Valore di modifica (positivo o negativo)
-        scanf("%d", &delta);
-        pulisciBuffer();  
+    if (azione == MODIFICA_VITA) {
+        stampa(COLORE_GIALLO "Modifica della VITA selezionata.\n" COLORE_RESET);
+        stampa("Di quanto vuoi modificare la vita? (usa numero negativo per diminuire): ");
+        int delta = leggiNumero(); ///< Valore di modifica (positivo o negativo)
         modificaVita(&eroeModificato, delta);
-        printf(COLORE_VERDE "Vita modificata! Nuova vita: %d\n" COLORE_RESET, eroeModificato.vita);
+        stampa(COLORE_VERDE "Vita modificata! Nuova vita: %d\n" COLORE_RESET, eroeModificato.vita);
         
-    } else if (scelta == '2') {
-        printf(COLORE_GIALLO "Modifica delle MONETE selezionata.\n" COLORE_RESET);
-        printf("Di quanto vuoi modificare le monete? (usa numero negativo per diminuire): ");
-        int delta; ///< Valore di modifica (positivo o negativo)
-        scanf("%d", &delta);
-        pulisciBuffer();  
+    } else if (azione == MODIFICA_MONETE) {
+        stampa(COLORE_GIALLO "Modifica delle MONETE selezionata.\n" COLORE_RESET);
+        stampa("Di quanto vuoi modificare le monete? (usa numero negativo per diminuire): ");
+        int delta = leggiNumero(); ///< Valore di modifica (positivo o negativo)
         modificaMonete(&eroeModificato, delta);
-        printf(COLORE_VERDE "Monete modificate! Nuove monete: %d\n" COLORE_RESET, eroeModificato.monete);
+        stampa(COLORE_VERDE "Monete modificate! Nuove monete: %d\n" COLORE_RESET, eroeModificato.monete);
         
-    } else if (scelta == '3') {
-        printf(COLORE_MAGENTA "Sblocco della MISSIONE FINALE selezionata.\n" COLORE_RESET);
+    } else if (azione == MODIFICA_FINALE) {
+        stampa(COLORE_MAGENTA "Sblocco della MISSIONE FINALE selezionata.\n" COLORE_RESET);
         eroeModificato.missioniCompletate = 3; ///< Imposta a 3 per sbloccare la missione finale
-        printf(COLORE_VERDE "Missione finale sbloccata! Tutte le missioni preliminari sono ora completate.\n" COLORE_RESET);
+        stampa(COLORE_VERDE "Missione finale sbloccata! Tutte le missioni preliminari sono ora completate.\n" COLORE_RESET);
     }
 
     Salvataggio sModificato = creaSalvataggioDaEroe(&eroeModificato); ///< Crea un nuovo salvataggio con le modifiche
     if (salvaGioco(&sModificato)) {
-        printf(COLORE_VERDE "Modifica salvata con successo!\n" COLORE_RESET);
+        stampa(COLORE_VERDE "Modifica salvata con successo!\n" COLORE_RESET);
     } else {
-        printf(COLORE_ROSSO "Errore nel salvataggio delle modifiche.\n" COLORE_RESET);
+        stampa(COLORE_ROSSO "Errore nel salvataggio delle modifiche.\n" COLORE_RESET);
     }
 }
 
@@ -666,14 +658,16 @@ bool menuDelVillaggio(Eroe* eroe, GestoreMissioni* gestore) {
     
     stampaMenuVillaggio();
     
-    printf("Seleziona una delle opzioni del menu [1-5]: ");
+    stampa("Seleziona una delle opzioni del menu [1-5]: ");
     
     char scelta = leggiCaratterePulito(); ///< Legge la scelta dell'utente
     
-    switch (scelta) {
-        case '1': {
+    if (scelta == INPUT_FINE) return false; // Input terminato: si torna al menu principale
+    
+    switch (azioneMenu(&MENU_VILLAGGIO, scelta)) {
+        case VILLAGGIO_MISSIONE: {
             // Intraprendi una missione
-            printf("\n" COLORE_CIANO "INTRAPRENDI UNA MISSIONE\n" COLORE_RESET);
+            stampa("\n" COLORE_CIANO "INTRAPRENDI UNA MISSIONE\n" COLORE_RESET);
             TipoMissione missioneScelta = selezionaMissione(gestore);
             
             if (missioneScelta != MISSIONE_NESSUNA) {
@@ -682,32 +676,32 @@ bool menuDelVillaggio(Eroe* eroe, GestoreMissioni* gestore) {
                 // Aggiorna il contatore delle missioni completate dell'eroe
                 eroe->missioniCompletate = gestore->missioniCompletate;
             } else {
-                printf(COLORE_GIALLO "Nessuna missione selezionata.\n" COLORE_RESET);
+                stampa(COLORE_GIALLO "Nessuna missione selezionata.\n" COLORE_RESET);
             }
             break;
         }
         
-        case '2':
+        case VILLAGGIO_RIPOSA:
             // Riposati
             riposatiAlVillaggio(eroe);
             break;
             
-        case '3':
+        case VILLAGGIO_INVENTARIO:
             // Inventario
             mostraInventario(eroe);
             break;
             
-        case '4':
+        case VILLAGGIO_SALVA:
             // Salva la partita
             salvaPartitaCorrente(eroe);
             break;
             
-        case '5':
+        case VILLAGGIO_ESCI:
             // Esci
             return gestisciUscita();
             
         default:
-            printf(COLORE_ROSSO "Opzione non valida!\n" COLORE_RESET);
+            stampa(COLORE_ROSSO "Opzione non valida!\n" COLORE_RESET);
             break;
     }
     
@@ -744,18 +738,18 @@ bool menuDelVillaggio(Eroe* eroe, GestoreMissioni* gestore) {
 void riposatiAlVillaggio(Eroe* eroe) {
     if (eroe == NULL) return;
     
-    printf("\n" COLORE_VERDE "Ti riposi alla locanda del villaggio...\n" COLORE_RESET);
+    stampa("\n" COLORE_VERDE "Ti riposi alla locanda del villaggio...\n" COLORE_RESET);
     
     if (eroe->vita >= 20) {
-        printf(COLORE_CIANO "Sei già in perfetta salute! (20/20 punti vita)\n" COLORE_RESET);
+        stampa(COLORE_CIANO "Sei già in perfetta salute! (20/20 punti vita)\n" COLORE_RESET);
     } else {
         int vitaPrecedente = eroe->vita; ///< Memorizza la vita prima del riposo per calcolare il recupero
         eroe->vita = 20; ///< Imposta la vita al massimo
-        printf(COLORE_VERDE "Hai recuperato %d punti vita!\n" COLORE_RESET, 20 - vitaPrecedente);
-        printf(COLORE_CIANO "Punti vita: %d/20\n" COLORE_RESET, eroe->vita);
+        stampa(COLORE_VERDE "Hai recuperato %d punti vita!\n" COLORE_RESET, 20 - vitaPrecedente);
+        stampa(COLORE_CIANO "Punti vita: %d/20\n" COLORE_RESET, eroe->vita);
     }
     
-    printf(COLORE_GIALLO "Sei pronto per nuove avventure!\n" COLORE_RESET);
+    stampa(COLORE_GIALLO "Sei pronto per nuove avventure!\n" COLORE_RESET);
 }
 
 /**
@@ -778,7 +772,7 @@ void riposatiAlVillaggio(Eroe* eroe) {
 void mostraInventario(const Eroe* eroe) {
     if (eroe == NULL) return;
     
-    printf("\n" COLORE_CIANO "INVENTARIO\n" COLORE_RESET);
+    stampa("\n" COLORE_CIANO "INVENTARIO\n" COLORE_RESET);
     mostraEroe(eroe);
 }
 
@@ -810,14 +804,14 @@ void mostraInventario(const Eroe* eroe) {
 void salvaPartitaCorrente(const Eroe* eroe) {
     if (eroe == NULL) return;
     
-    printf("\n" COLORE_GIALLO "Salvataggio della partita in corso...\n" COLORE_RESET);
+    stampa("\n" COLORE_GIALLO "Salvataggio della partita in corso...\n" COLORE_RESET);
     
     Salvataggio s = creaSalvataggioDaEroe(eroe); ///< Converte i dati dell'eroe in formato salvataggio
     
     if (salvaGioco(&s)) {
-        printf(COLORE_VERDE "Partita salvata con successo!\n" COLORE_RESET);
+        stampa(COLORE_VERDE "Partita salvata con successo!\n" COLORE_RESET);
     } else {
-        printf(COLORE_ROSSO "Errore durante il salvataggio.\n" COLORE_RESET);
+        stampa(COLORE_ROSSO "Errore durante il salvataggio.\n" COLORE_RESET);
     }
 }
 
@@ -840,24 +834,24 @@ void salvaPartitaCorrente(const Eroe* eroe) {
  * 
  * @code
  * // Esempio di utilizzo nel menu:
- * case '5':
+ * case VILLAGGIO_ESCI:
  *     return gestisciUscita(); // Il valore di ritorno determina se continuare
  * @endcode
  * 
  * @see menuDelVillaggio()
  */
 bool gestisciUscita(void) {
-    printf("\n" COLORE_GIALLO "Stai uscendo dal gioco.\n" COLORE_RESET);
-    printf(COLORE_ROSSO "Ricordati di salvare la partita per non perdere i tuoi progressi!\n" COLORE_RESET);
-    printf("Sei sicuro di voler procedere? [S/N]: ");
+    stampa("\n" COLORE_GIALLO "Stai uscendo dal gioco.\n" COLORE_RESET);
+    stampa(COLORE_ROSSO "Ricordati di salvare la partita per non perdere i tuoi progressi!\n" COLORE_RESET);
+    stampa("Sei sicuro di voler procedere? [S/N]: ");
     
     char conferma = leggiCaratterePulito(); ///< Legge la risposta dell'utente
     
-    if (conferma == 'S' || conferma == 's') {
-        printf(COLORE_GIALLO "Tornando al menu principale...\n" COLORE_RESET);
+    if (azioneMenu(&MENU_CONFERMA, conferma) == CONFERMA_SI || conferma == INPUT_FINE) {
+        stampa(COLORE_GIALLO "Tornando al menu principale...\n" COLORE_RESET);
         return false; // Esce dal loop del villaggio
     } else {
-        printf(COLORE_VERDE "Continuiamo l'avventura!\n" COLORE_RESET);
+        stampa(COLORE_VERDE "Continuiamo l'avventura!\n" COLORE_RESET);
         return true; // Continua il gioco
     }
 }
@@ -871,73 +865,39 @@ bool gestisciUscita(void) {
  */
 
 /**
- * @brief Stampa il menu principale senza l'opzione trucchi
- * @details Visualizza un riquadro decorativo ASCII con bordi blu contenente le opzioni:
- *          - 1. Nuova partita
- *          - 2. Carica salvataggio
- *          - 0. Esci
+ * @brief Stampa il menu principale dentro un riquadro
+ * @details Visualizza un riquadro decorativo ASCII con bordi blu contenente le voci
+ *          del menu passato (vedi opzioni.h):
+ *          - MENU_PRINCIPALE quando trucchiAttivi == false
+ *          - MENU_PRINCIPALE_TRUCCHI quando trucchiAttivi == true (aggiunge "3. Trucchi")
  *          
- *          Questa versione viene mostrata quando trucchiAttivi == false
- * 
- * @return void Non restituisce alcun valore
+ *          Le righe delle voci vengono generate dalla definizione del menu, così il testo
+ *          mostrato e i tasti accettati non possono divergere.
  * 
- * @note Funzione statica - visibile solo in questo file
- * @note Utilizza codici ANSI per colorare il bordo in blu
- * 
- * @see stampaMenuConRiquadroAtreOpzioni()
- * @see menuPrincipale()
- */
-static void stampaMenuConRiquadroADueOpzioni(void)
-{
-    const char *blu = "\033[94m";     ///< Codice ANSI per colore blu chiaro
-    const char *reset = "\033[0m";    ///< Codice ANSI per ripristinare il colore
-
-    printf("%s", blu);
-    printf("*************************************\n");
-    printf("*           MENU PRINCIPALE         *\n");
-    printf("*                                   *\n");
-    printf("*  1. Nuova partita                 *\n");
-    printf("*  2. Carica salvataggio            *\n");
-    printf("*  0. Esci                          *\n");
-    printf("*                                   *\n");
-    printf("*************************************\n");
-    printf("%s", reset);
-}
-
-/**
- * @brief Stampa il menu principale con l'opzione trucchi
- * @details Visualizza un riquadro decorativo ASCII con bordi blu contenente le opzioni:
- *          - 1. Nuova partita
- *          - 2. Carica salvataggio
- *          - 3. Trucchi (opzione aggiuntiva)
- *          - 0. Esci
- *          
- *          Questa versione viene mostrata quando trucchiAttivi == true
+ * @param[in] menu Definizione del menu da stampare
  * 
  * @return void Non restituisce alcun valore
  * 
  * @note Funzione statica - visibile solo in questo file
  * @note Utilizza codici ANSI per colorare il bordo in blu
- * @note L'opzione "3. Trucchi" appare solo dopo aver inserito la sequenza Konami
  * 
- * @see stampaMenuConRiquadroADueOpzioni()
  * @see menuPrincipale()
  */
-static void stampaMenuConRiquadroAtreOpzioni(void)
+static void stampaMenuConRiquadro(const DefinizioneMenu* menu)
 {
     const char *blu = "\033[94m";     ///< Codice ANSI per colore blu chiaro
     const char *reset = "\033[0m";    ///< Codice ANSI per ripristinare il colore
 
-    printf("%s", blu);
-    printf("*************************************\n");
-    printf("*           MENU PRINCIPALE         *\n");
-    printf("*                                   *\n");
-    printf("*  1. Nuova partita                 *\n");
-    printf("*  2. Carica salvataggio            *\n");
-    printf("*  3. Trucchi                       *\n");
-    printf("*  0. Esci                          *\n");
-    printf("*************************************\n");
-    printf("%s", reset);
+    stampa("%s", blu);
+    stampa("*************************************\n");
+    stampa("*           MENU PRINCIPALE         *\n");
+    stampa("*                                   *\n");
+    for (int i = 0; i < menu->numeroVoci; i++) {
+        stampa("*  %c. %-30s*\n", menu->voci[i].tasto, menu->voci[i].etichetta); ///< Larghezza fissa per allineare il bordo destro
+    }
+    stampa("*                                   *\n");
+    stampa("*************************************\n");
+    stampa("%s", reset);
 }
 
 /**
@@ -960,16 +920,12 @@ static void stampaMenuConRiquadroAtreOpzioni(void)
  */
 static void stampaMenuVillaggio(void)
 {
-    printf("\n");
-    printf(COLORE_VERDE "--------------------------------------------\n" COLORE_RESET);
-    printf(COLORE_VERDE "         MENU DEL VILLAGGIO\n" COLORE_RESET);
-    printf(COLORE_VERDE "--------------------------------------------\n" COLORE_RESET);
-    printf("1. Intraprendi una missione\n");
-    printf("2. Riposati\n");
-    printf("3. Inventario\n");
-    printf("4. Salva la partita\n");
-    printf("5. Esci\n");
-    printf("\n");
+    stampa("\n");
+    stampa(COLORE_VERDE "--------------------------------------------\n" COLORE_RESET);
+    stampa(COLORE_VERDE "         MENU DEL VILLAGGIO\n" COLORE_RESET);
+    stampa(COLORE_VERDE "--------------------------------------------\n" COLORE_RESET);
+    stampaVociMenu(&MENU_VILLAGGIO); ///< Voci generate dalla definizione del menu (vedi opzioni.h)
+    stampa("\n");
 }
 
 /** @} */ // Fine gruppo MenuDisplay
\ No newline at end of file
@@ -79,4 +79,7 @@ char leggiCaratterePulito(void);
 
 void pulisciBuffer(void);
 
+//Funzione che legge un numero intero su una riga (0 se non valido)
+int leggiNumero(void);
+
 #endif
\ No newline at end of file
@@ -12,6 +12,18 @@
  */
 
 #include "missioni.h"
+#include "menu.h"
+#include "schermo.h"
+#include "tastiera.h"
+#include "opzioni.h"
+#include "eventi.h"
+#include "dungeon.h"
+#include "utils.h"
+#include "sessione.h"
+#include "padovan.h"
+#include "percorsi.h"
+#include "combattimento.h"
+#include "diario.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -25,100 +37,106 @@
 #define COLORE_MAGENTA "\033[1;35m"    /**< Codice ANSI per testo magenta brillante */
 #define COLORE_RESET "\033[0m"         /**< Codice ANSI per reset formattazione */
 
+#define INDICE_PADOVAN_DUNGEON 7       /**< P(7) = 5 stanze per lato per una missione senza prerequisiti */
+
 
 // --- FUNZIONI DI INIZIALIZZAZIONE ---
 
 /**
- * @brief Inizializza una singola missione con i parametri specificati
- * 
- * Questa funzione configura tutti i campi di una struttura Missione con i valori
- * iniziali appropriati. Il nome e la descrizione vengono copiati in modo sicuro
- * usando strncpy con terminazione garantita della stringa.
- * 
- * @param[out] m Puntatore alla struttura Missione da inizializzare
- * @param[in] tipo Tipo della missione (MISSIONE_PALUDE, MISSIONE_MAGIONE, etc.)
- * @param[in] nome Nome descrittivo della missione (max 49 caratteri)
- * @param[in] descrizione Descrizione dettagliata dell'obiettivo (max 199 caratteri)
- * @param[in] obiettiviTotali Numero totale di obiettivi da completare
- * 
- * @note Se m è NULL, la funzione ritorna immediatamente senza operazioni
- * @note Le stringhe vengono troncate se superano la lunghezza massima consentita
- * @note Tutte le missioni sono sbloccate di default tranne MISSIONE_CASTELLO
- * 
- * @warning Il puntatore m deve essere valido e allocato prima della chiamata
+ * @brief Imposta un bit di un bitset di missioni
  */
-void inizializzaMissione(Missione* m, TipoMissione tipo, const char* nome, 
-                         const char* descrizione, int obiettiviTotali) {
-    if (m == NULL) return;
-    
-    m->tipo = tipo;
-    strncpy(m->nome, nome, 49);
-    m->nome[49] = '\0';
-    strncpy(m->descrizione, descrizione, 199);
-    m->descrizione[199] = '\0';
-    m->completata = false;
-    m->sbloccata = (tipo != MISSIONE_CASTELLO); // Tutte sbloccate tranne la finale
-    m->obiettiviCompletati = 0;
-    m->obiettiviTotali = obiettiviTotali;
-    m->oggettoRecuperato = false;
+static inline void impostaBitMissione(uint64_t* bitset, int id) {
+    bitset[id / MISSIONI_PER_PAROLA] |= (uint64_t)1 << (id % MISSIONI_PER_PAROLA);
 }
 
 /**
- * @brief Inizializza il gestore delle missioni con tutte le missioni del gioco
+ * @brief Inizializza il gestore delle missioni con tutte le missioni del catalogo
  * 
- * Questa funzione configura il GestoreMissioni con tutte e quattro le missioni
- * disponibili nel gioco, impostando i loro parametri iniziali. Utilizza lo stile
- * di formattazione Vertical-Alignment-Style (Antirez).
+ * Questa funzione alloca in un solo blocco lo stato di tutte le missioni del
+ * catalogo (vedi catalogo.c): tre bitset da un bit per missione e due array di
+ * piccoli contatori. L'id di una missione è la posizione del suo bit e dei suoi
+ * contatori, quindi ogni accesso resta diretto anche con centinaia di missioni.
  * 
- * Le missioni inizializzate sono:
+ * Le missioni predefinite sono:
  * - MISSIONE_PALUDE: "Palude Putrescente" - 3 Generali Orco da eliminare
  * - MISSIONE_MAGIONE: "Magione Infestata" - 1 Vampiro Superiore + recupero chiave
  * - MISSIONE_GROTTA: "Grotta di Cristallo" - Recupero Spada dell'Eroe
  * - MISSIONE_CASTELLO: "Castello del Signore Oscuro" - Boss finale (bloccata)
  * 
  * @param[out] gestore Puntatore alla struttura GestoreMissioni da inizializzare
+ * @param[in] arena Arena da cui allocare lo stato delle missioni (NULL = heap)
+ * 
+ * @return true se il gestore è stato inizializzato, false se manca la memoria
  * 
  * @pre gestore deve essere un puntatore valido ad una struttura allocata
- * @post Tutte le missioni sono inizializzate con i loro parametri di default
+ * @post Nessuna missione è completata e nessun oggetto è recuperato
  * @post missioniCompletate è impostato a 0
  * @post missioneCorrente è impostato a MISSIONE_NESSUNA
- * @post Solo MISSIONE_CASTELLO inizia in stato bloccato
+ * @post Le missioni con prerequisiti (es: MISSIONE_CASTELLO) iniziano in stato bloccato
  * 
- * @note Se gestore è NULL, la funzione ritorna immediatamente senza operazioni
+ * @note Il gestore va liberato con liberaGestoreMissioni()
  */
-void inizializzaGestoreMissioni(GestoreMissioni* gestore) {
-    if (gestore == NULL) return;//se il puntatore e' nulla e quindi non punta a nulla esce
+bool inizializzaGestoreMissioni(GestoreMissioni* gestore, Arena* arena) {
+    if (gestore == NULL) return false;//se il puntatore e' nulla e quindi non punta a nulla esce
     
     gestore->missioniCompletate = 0;                //Inizializza a 0 i campi gel gestore
     gestore->missioneCorrente = MISSIONE_NESSUNA;   //Inizializza la missione attuale (vedi typedef Enum)
     
-    //Inizializza Palude Putrescente
-    inizializzaMissione(&gestore->missioni[MISSIONE_PALUDE], 
-                       MISSIONE_PALUDE,
-                       "Palude Putrescente",
-                       "Sconfiggi 3 Generale Orco del Signore Oscuro",
-                       3); // 3 Generali Orco da eliminare
-    
-    // Inizializza Magione Infestata
-    inizializzaMissione(&gestore->missioni[MISSIONE_MAGIONE],
-                       MISSIONE_MAGIONE,
-                       "Magione Infestata",
-                       "Recupera la chiave del Castello e sconfiggi un Vampiro Superiore",
-                       1); // 1 Vampiro Superiore da eliminare
-    
-    // Inizializza Grotta di Cristallo
-    inizializzaMissione(&gestore->missioni[MISSIONE_GROTTA],
-                       MISSIONE_GROTTA,
-                       "Grotta di Cristallo",
-                       "Recupera la Spada dell'Eroe",
-                       0); // Nessun nemico specifico, solo recuperare la spada
-    
-    // Inizializza Castello del Signore Oscuro (bloccata inizialmente)
-    inizializzaMissione(&gestore->missioni[MISSIONE_CASTELLO],
-                       MISSIONE_CASTELLO,
-                       "Castello del Signore Oscuro",
-                       "Sconfiggi il Signore Oscuro",
-                       1); // 1 boss finale
+    const CatalogoMissioni* catalogo = catalogoMissioni();
+    int n = catalogo->numeroMissioni;
+    int parole = (n + MISSIONI_PER_PAROLA - 1) / MISSIONI_PER_PAROLA;
+    
+    // Blocco unico: prima i bitset (allineati a 64 bit), poi i contatori
+    size_t dimBitset = sizeof(uint64_t) * (size_t)parole;
+    size_t dimensione = 3 * dimBitset + 2 * sizeof(uint16_t) * (size_t)n + sizeof(uint8_t) * (size_t)n;
+    unsigned char* blocco = allocaMemoria(arena, dimensione);
+    
+    gestore->arena = arena;
+    gestore->catalogo = catalogo;
+    gestore->numeroMissioni = blocco ? n : 0;
+    gestore->parole = blocco ? parole : 0;
+    gestore->dimensioneStato = blocco ? dimensione : 0;
+    gestore->completate = (uint64_t*)blocco;
+    gestore->sbloccate = (uint64_t*)(blocco + dimBitset);
+    gestore->oggettiRecuperati = (uint64_t*)(blocco + 2 * dimBitset);
+    gestore->prerequisitiMancanti = (uint16_t*)(blocco + 3 * dimBitset);
+    gestore->ingressi = (uint16_t*)(blocco + 3 * dimBitset + sizeof(uint16_t) * (size_t)n);
+    gestore->obiettiviCompletati = (uint8_t*)(blocco + 3 * dimBitset + 2 * sizeof(uint16_t) * (size_t)n);
+    if (!blocco) return false;
+    
+    // Sono sbloccate solo le missioni senza prerequisiti
+    for (int i = 0; i < n; i++) {
+        gestore->prerequisitiMancanti[i] = catalogo->missioni[i].numeroPrerequisiti;
+        if (gestore->prerequisitiMancanti[i] == 0) {
+            impostaBitMissione(gestore->sbloccate, i);
+        }
+    }
+    return true;
+}
+
+void liberaGestoreMissioni(GestoreMissioni* gestore) {
+    if (gestore == NULL) return;
+    
+    rilasciaMemoria(gestore->arena, gestore->completate);  // Inizio del blocco unico dello stato
+    gestore->completate = gestore->sbloccate = gestore->oggettiRecuperati = NULL;
+    gestore->prerequisitiMancanti = gestore->ingressi = NULL;
+    gestore->obiettiviCompletati = NULL;
+    gestore->numeroMissioni = 0;
+    gestore->parole = 0;
+    gestore->dimensioneStato = 0;
+}
+
+bool copiaGestoreMissioni(GestoreMissioni* destinazione, const GestoreMissioni* sorgente) {
+    if (destinazione == NULL || sorgente == NULL ||
+        destinazione->catalogo != sorgente->catalogo ||
+        destinazione->dimensioneStato != sorgente->dimensioneStato) {
+        return false;
+    }
+    
+    memcpy(destinazione->completate, sorgente->completate, sorgente->dimensioneStato);
+    destinazione->missioniCompletate = sorgente->missioniCompletate;
+    destinazione->missioneCorrente = sorgente->missioneCorrente;
+    return true;
 }
 
 // --- FUNZIONI DI VISUALIZZAZIONE ---
@@ -145,34 +163,38 @@ void inizializzaGestoreMissioni(GestoreMissioni* gestore) {
  * @see TipoMissione
  */
 int mostraMenuMissioni(const GestoreMissioni* gestore) {
+    MISURA_SONDA(SONDA_MENU_MISSIONI);
     if (gestore == NULL) return 0;
     
-    printf("\n");
-    printf(COLORE_CIANO "----------------------------------------------\n" COLORE_RESET);
-    printf(COLORE_CIANO "     MENU DI SELEZIONE MISSIONE             \n" COLORE_RESET);
-    printf(COLORE_CIANO "----------------------------------------------\n" COLORE_RESET);
+    stampa("\n");
+    stampa(COLORE_CIANO "----------------------------------------------\n" COLORE_RESET);
+    stampa(COLORE_CIANO "     MENU DI SELEZIONE MISSIONE             \n" COLORE_RESET);
+    stampa(COLORE_CIANO "----------------------------------------------\n" COLORE_RESET);
     
     int disponibili = 0;
     
-    // Mostra solo le missioni non completate e sbloccate
-    for (int i = 0; i < 4; i++) {
-        const Missione* m = &gestore->missioni[i];
+    // Mostra solo le missioni non completate e sbloccate (64 missioni per parola)
+    for (int p = 0; p < gestore->parole; p++) {
+        uint64_t bit = gestore->sbloccate[p] & ~gestore->completate[p];
         
-        if (!m->completata && m->sbloccata) {
+        while (bit) {
+            const DefinizioneMissione* d = &gestore->catalogo->missioni[p * MISSIONI_PER_PAROLA + __builtin_ctzll(bit)];
+            bit &= bit - 1;  // Toglie il bit appena visitato
+            
             disponibili++;
-            printf(COLORE_GIALLO "%d. %s\n" COLORE_RESET, disponibili, m->nome);
-            printf("   Obiettivo: %s\n", m->descrizione);
+            stampa(COLORE_GIALLO "%d. %s\n" COLORE_RESET, disponibili, d->nome);
+            stampa("   Obiettivo: %s\n", d->descrizione);
             
             // Mostra icona speciale per la missione finale
-            if (m->tipo == MISSIONE_CASTELLO) {
-                printf(COLORE_ROSSO "    MISSIONE FINALE    \n" COLORE_RESET);
+            if (d->flag & MISSIONE_FLAG_FINALE) {
+                stampa(COLORE_ROSSO "    MISSIONE FINALE    \n" COLORE_RESET);
             }
-            printf("\n");
+            stampa("\n");
         }
     }
     
     if (disponibili == 0) {
-        printf(COLORE_VERDE "Tutte le missioni sono state completate!\n" COLORE_RESET);
+        stampa(COLORE_VERDE "Tutte le missioni sono state completate!\n" COLORE_RESET);
     }
     
     return disponibili;
@@ -188,62 +210,59 @@ int mostraMenuMissioni(const GestoreMissioni* gestore) {
  * 
  * La funzione adatta la visualizzazione in base al tipo di missione:
  * - Per missioni con obiettivi numerici mostra una barra di progresso
- * - Per MISSIONE_MAGIONE mostra lo stato della chiave
- * - Per MISSIONE_GROTTA mostra lo stato della spada
+ * - Per le missioni con un oggetto da recuperare (chiave, spada) ne mostra lo stato
  * 
- * @param[in] missione Puntatore costante alla Missione da visualizzare
+ * @param[in] gestore Puntatore costante al GestoreMissioni
+ * @param[in] tipo Id della missione da visualizzare
  * 
- * @pre missione deve essere un puntatore valido
+ * @pre gestore deve essere un puntatore valido
  * @post Stampa le informazioni formattate su stdout
  * 
- * @note Se missione è NULL, la funzione ritorna immediatamente
+ * @note Se tipo non è un id valido, la funzione ritorna immediatamente
  * @note La barra di progresso usa caratteri Unicode per una migliore visualizzazione
  * 
  * @see TipoMissione
- * @see Missione
+ * @see DefinizioneMissione
  */
-void mostraStatoMissione(const Missione* missione) {
-    if (missione == NULL) return;
+void mostraStatoMissione(const GestoreMissioni* gestore, TipoMissione tipo) {
+    const DefinizioneMissione* d = getMissione(gestore, tipo);
+    if (d == NULL) return;
+    
+    int completati = gestore->obiettiviCompletati[tipo];
     
-    printf("\n");
-    printf(COLORE_BLU "---------------------------------------\n" COLORE_RESET);
-    printf(COLORE_BLU "  MISSIONE: %s\n" COLORE_RESET, missione->nome);
-    printf(COLORE_BLU "---------------------------------------\n" COLORE_RESET);
-    printf(COLORE_GIALLO "Obiettivo: " COLORE_RESET "%s\n", missione->descrizione);
+    stampa("\n");
+    stampa(COLORE_BLU "---------------------------------------\n" COLORE_RESET);
+    stampa(COLORE_BLU "  MISSIONE: %s\n" COLORE_RESET, d->nome);
+    stampa(COLORE_BLU "---------------------------------------\n" COLORE_RESET);
+    stampa(COLORE_GIALLO "Obiettivo: " COLORE_RESET "%s\n", d->descrizione);
     
     // Mostra progresso solo se ci sono obiettivi numerici
-    if (missione->obiettiviTotali > 0) {
-        printf(COLORE_CIANO "Stato di avanzamento: " COLORE_RESET);
-        printf("Eliminati %d su %d", missione->obiettiviCompletati, missione->obiettiviTotali);
+    if (d->obiettiviTotali > 0) {
+        stampa(COLORE_CIANO "Stato di avanzamento: " COLORE_RESET);
+        stampa("Eliminati %d su %d", completati, d->obiettiviTotali);
         
         // Mostra barra di progresso
-        printf(" [");
-        for (int i = 0; i < missione->obiettiviTotali; i++) {
-            if (i < missione->obiettiviCompletati) {
-                printf(COLORE_VERDE "█" COLORE_RESET);
+        stampa(" [");
+        for (int i = 0; i < d->obiettiviTotali; i++) {
+            if (i < completati) {
+                stampa(COLORE_VERDE "█" COLORE_RESET);
             } else {
-                printf("░");
+                stampa("░");
             }
         }
-        printf("]\n");
+        stampa("]\n");
     }
     
     // Mostra se l'oggetto speciale è stato recuperato
-    if (missione->tipo == MISSIONE_MAGIONE) {
-        if (missione->oggettoRecuperato) {
-            printf(COLORE_VERDE "Chiave del Castello: RECUPERATA\n" COLORE_RESET);
-        } else {
-            printf(COLORE_ROSSO "Chiave del Castello: NON ANCORA TROVATA\n" COLORE_RESET);
-        }
-    } else if (missione->tipo == MISSIONE_GROTTA) {
-        if (missione->oggettoRecuperato) {
-            printf(COLORE_VERDE "Spada dell'Eroe: RECUPERATA\n" COLORE_RESET);
+    if (d->flag & MISSIONE_FLAG_OGGETTO) {
+        if (bitMissione(gestore->oggettiRecuperati, tipo)) {
+            stampa(COLORE_VERDE "%s: RECUPERATA\n" COLORE_RESET, d->oggetto);
         } else {
-            printf(COLORE_ROSSO "Spada dell'Eroe: NON ANCORA TROVATA\n" COLORE_RESET);
+            stampa(COLORE_ROSSO "%s: NON ANCORA TROVATA\n" COLORE_RESET, d->oggetto);
         }
     }
     
-    printf(COLORE_BLU "------------------------------------------\n" COLORE_RESET);
+    stampa(COLORE_BLU "------------------------------------------\n" COLORE_RESET);
 }
 
 /**
@@ -255,41 +274,45 @@ void mostraStatoMissione(const Missione* missione) {
  * - Negozio
  * - Inventario
  * - Torna al Villaggio (con indicazione del costo se applicabile)
+ * - Mappa del Dungeon
+ * - Registro dei combattimenti
  * 
  * L'opzione di ritorno al villaggio mostra il costo di 50 monete solo se
  * la missione non è ancora completata (obiettivi non raggiunti o oggetto
  * speciale non recuperato).
  * 
- * @param[in] missione Puntatore costante alla Missione corrente
+ * @param[in] gestore Puntatore costante al GestoreMissioni
+ * @param[in] tipo Id della missione corrente
  * @param[in] eroe Puntatore costante all'Eroe (per visualizzare statistiche)
  * 
- * @pre missione e eroe devono essere puntatori validi
+ * @pre gestore e eroe devono essere puntatori validi
  * @post Visualizza lo stato della missione e il menu su stdout
  * 
- * @note Se missione o eroe sono NULL, la funzione ritorna immediatamente
+ * @note Se tipo non è valido o eroe è NULL, la funzione ritorna immediatamente
  * @note Il costo per tornare al villaggio è 50 monete se la missione non è completa
  * 
  * @see mostraStatoMissione()
  * @see obiettiviRaggiunti()
  * @see Eroe
  */
-void mostraMenuDuranteMissione(const Missione* missione, const Eroe* eroe) {
-    if (missione == NULL || eroe == NULL) return;
+void mostraMenuDuranteMissione(const GestoreMissioni* gestore, TipoMissione tipo, const Eroe* eroe) {
+    MISURA_SONDA(SONDA_MENU_MISSIONE);
+    if (getMissione(gestore, tipo) == NULL || eroe == NULL) return;
     
-    mostraStatoMissione(missione);
+    mostraStatoMissione(gestore, tipo);
     
-    printf("\n" COLORE_CIANO "Menu di Missione:\n" COLORE_RESET);
-    printf("1. Esplora stanza del Dungeon\n");
-    printf("2. Negozio\n");
-    printf("3. Inventario\n");
-    printf("4. Torna al Villaggio");
+    stampa("\n" COLORE_CIANO "Menu di Missione:\n" COLORE_RESET);
     
-    // Indica il costo per tornare se la missione non è completa
-    if (!obiettiviRaggiunti(missione) || 
-        (missione->tipo != MISSIONE_CASTELLO && !missione->oggettoRecuperato)) {
-        printf(" " COLORE_GIALLO "(Paga 50 Monete)" COLORE_RESET);
+    const VoceMenu* voci = MENU_MISSIONE.voci;
+    for (int i = 0; i < MENU_MISSIONE.numeroVoci; i++) {
+        stampa("%c. %s", voci[i].tasto, voci[i].etichetta);
+        
+        // Indica il costo per tornare se la missione non è completa
+        if (voci[i].azione == AZIONE_TORNA && !obiettiviRaggiunti(gestore, tipo)) {
+            stampa(" " COLORE_GIALLO "(Paga %d Monete)" COLORE_RESET, COSTO_RITORNO_VILLAGGIO);
+        }
+        stampa("\n");
     }
-    printf("\n");
 }
 
 // --- FUNZIONI DI SELEZIONE ---
@@ -318,7 +341,7 @@ void mostraMenuDuranteMissione(const Missione* missione, const Eroe* eroe) {
  * @pre gestore deve essere un puntatore valido
  * @post Non modifica lo stato del gestore
  * 
- * @note Utilizza fgets per una lettura sicura dell'input
+ * @note Utilizza tastieraLeggiRiga per una lettura sicura dell'input
  * @note Mostra messaggio di errore per scelte non valide
  * 
  * @see mostraMenuMissioni()
@@ -333,31 +356,36 @@ TipoMissione selezionaMissione(GestoreMissioni* gestore) {
         return MISSIONE_NESSUNA;
     }
     
-    printf("Seleziona una delle opzioni del menu [1-%d]: ", disponibili);
+    stampa("Seleziona una delle opzioni del menu [1-%d]: ", disponibili);
     
     int scelta;
     char buffer[10];
     
-    if (fgets(buffer, sizeof(buffer), stdin) == NULL) {
+    if (!tastieraLeggiRiga(buffer, sizeof(buffer))) {
         return MISSIONE_NESSUNA;
     }
     
     scelta = atoi(buffer);
     
     if (scelta < 1 || scelta > disponibili) {
-        printf(COLORE_ROSSO "Scelta non valida!\n" COLORE_RESET);
+        stampa(COLORE_ROSSO "Scelta non valida!\n" COLORE_RESET);
         return MISSIONE_NESSUNA;
     }
     
-    // Mappa la scelta alla missione corrispondente
-    int contatore = 0;
-    for (int i = 0; i < 4; i++) {
-        if (!gestore->missioni[i].completata && gestore->missioni[i].sbloccata) {
-            contatore++;
-            if (contatore == scelta) {
-                return (TipoMissione)i;
-            }
+    // Mappa la scelta alla missione corrispondente: conta le disponibili
+    // parola per parola e scende nei bit solo nella parola che la contiene
+    for (int p = 0; p < gestore->parole; p++) {
+        uint64_t bit = gestore->sbloccate[p] & ~gestore->completate[p];
+        int inParola = __builtin_popcountll(bit);
+        
+        if (scelta > inParola) {
+            scelta -= inParola;
+            continue;
         }
+        while (--scelta > 0) {
+            bit &= bit - 1;
+        }
+        return (TipoMissione)(p * MISSIONI_PER_PAROLA + __builtin_ctzll(bit));
     }
     
     return MISSIONE_NESSUNA;
@@ -365,12 +393,458 @@ TipoMissione selezionaMissione(GestoreMissioni* gestore) {
 
 // --- FUNZIONI DI GESTIONE ---
 
+/**
+ * @brief Segna una missione come completata e aggiorna il grafo dei prerequisiti
+ * 
+ * Ogni missione tiene il numero di prerequisiti non ancora completati: completare
+ * una missione decrementa il contatore dei soli dipendenti (archi uscenti) e
+ * sblocca quelli che arrivano a zero.
+ * 
+ * @param[in,out] gestore Gestore con la missione (già validata dal chiamante)
+ * @param[in] tipo Missione completata
+ * @param[in] annuncia true per mostrare i messaggi di sblocco
+ */
+static void propagaCompletamento(GestoreMissioni* gestore, TipoMissione tipo, bool annuncia) {
+    impostaBitMissione(gestore->completate, tipo);
+    gestore->missioniCompletate++;
+    
+    int numero;
+    const uint32_t* dipendenti = dipendentiMissione(gestore->catalogo, tipo, &numero);
+    
+    for (int k = 0; k < numero; k++) {
+        uint32_t d = dipendenti[k];
+        if (--gestore->prerequisitiMancanti[d] == 0) {
+            if (annuncia) {
+                sbloccaMissione(gestore, (TipoMissione)d);
+            } else {
+                impostaBitMissione(gestore->sbloccate, (int)d);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Missione in corso vista dagli iscritti al bus degli eventi
+ */
+typedef struct {
+    GestoreMissioni* gestore;      ///< Gestore con lo stato della missione
+    TipoMissione tipo;             ///< Missione in corso
+    bool obiettiviRaggiunti;       ///< Aggiornato dagli eventi: niente controlli ad ogni giro
+} MissioneInCorso;
+
+/**
+ * @brief Iscritto di tracciamento: aggiorna il progresso della missione in corso
+ * 
+ * Riceve solo i tipi di evento a cui la missione si è iscritta (nemici uccisi se
+ * ha obiettivi numerici, oggetti recuperati se ha un oggetto speciale) e ignora
+ * gli eventi di altre missioni.
+ */
+static void tracciaMissioneDaEvento(const Evento* evento, void* contesto) {
+    MissioneInCorso* m = contesto;
+    if (evento->missione != (int)m->tipo) return;
+    
+    if (evento->tipo == EVENTO_NEMICO_UCCISO) {
+        if (!evento->valore) return;   // Nemico comune: non è un obiettivo
+        incrementaObiettivi(m->gestore, m->tipo);
+    } else if (evento->tipo == EVENTO_OGGETTO_RECUPERATO) {
+        segnaOggettoRecuperato(m->gestore, m->tipo);
+    }
+    m->obiettiviRaggiunti = obiettiviRaggiunti(m->gestore, m->tipo);
+}
+
+/**
+ * @brief Iscritto di interfaccia: mostra il messaggio di progresso
+ * 
+ * Iscritto dopo tracciaMissioneDaEvento(), quindi vede lo stato già aggiornato.
+ */
+static void mostraProgressoDaEvento(const Evento* evento, void* contesto) {
+    const MissioneInCorso* m = contesto;
+    if (evento->missione != (int)m->tipo) return;
+    if (evento->tipo == EVENTO_NEMICO_UCCISO && !evento->valore) return;
+    
+    const DefinizioneMissione* d = getMissione(m->gestore, m->tipo);
+    
+    if (evento->tipo == EVENTO_OGGETTO_RECUPERATO) {
+        stampa(COLORE_VERDE "✨ Hai recuperato un oggetto speciale!\n" COLORE_RESET);
+        stampa(COLORE_GIALLO "Hai ottenuto: %s!\n" COLORE_RESET, d->oggetto);
+        
+        if (m->tipo == MISSIONE_GROTTA) {
+            stampa(COLORE_CIANO "   La tua potenza di attacco aumenta di +2!\n" COLORE_RESET);
+        }
+    }
+    
+    if (m->obiettiviRaggiunti) {
+        stampa(COLORE_VERDE "Obiettivi della missione raggiunti!\n" COLORE_RESET);
+    } else if (evento->tipo == EVENTO_NEMICO_UCCISO) {
+        stampa(COLORE_CIANO "Progresso: %d/%d obiettivi completati\n" COLORE_RESET,
+               m->gestore->obiettiviCompletati[m->tipo], d->obiettiviTotali);
+    }
+}
+
+/**
+ * @brief Iscrive (o cancella) la missione agli eventi che la riguardano
+ * 
+ * Una missione senza obiettivi numerici non ascolta i nemici uccisi e una senza
+ * oggetto speciale non ascolta gli oggetti: per lei quegli eventi non costano nulla.
+ */
+static void iscriviMissioneAgliEventi(MissioneInCorso* m, bool iscrivi) {
+    const DefinizioneMissione* d = getMissione(m->gestore, m->tipo);
+    TipoEvento tipi[2];
+    int numeroTipi = 0;
+    
+    if (d->obiettiviTotali > 0)              tipi[numeroTipi++] = EVENTO_NEMICO_UCCISO;
+    if (d->flag & MISSIONE_FLAG_OGGETTO)     tipi[numeroTipi++] = EVENTO_OGGETTO_RECUPERATO;
+    
+    for (int i = 0; i < numeroTipi; i++) {
+        if (iscrivi) {
+            iscriviEvento(tipi[i], tracciaMissioneDaEvento, m);
+            iscriviEvento(tipi[i], mostraProgressoDaEvento, m);
+        } else {
+            annullaIscrizioneEvento(tipi[i], tracciaMissioneDaEvento, m);
+            annullaIscrizioneEvento(tipi[i], mostraProgressoDaEvento, m);
+        }
+    }
+}
+
+/**
+ * @brief Dungeon della missione in corso con gli strumenti per muoversi al suo interno
+ */
+typedef struct {
+    Dungeon dungeon;               ///< Stanze (generate durante l'esplorazione)
+    RicercaPercorsi ricerca;       ///< Stato riutilizzato dalle ricerche A*
+    CampoDistanze versoIngresso;   ///< Distanza dall'ingresso (l'uscita del dungeon) di ogni stanza materializzata
+    CampoDistanze versoOggetto;    ///< Distanza dalla stanza dell'oggetto speciale
+    int stanzaOggetto;             ///< Id della stanza dell'oggetto speciale, -1 se la missione non ne ha
+    MappaDungeon mappa;            ///< Caselle, campo visivo e nebbia di guerra
+    PoolNemici nemici;             ///< Nemici del combattimento in corso (generale e scorta)
+    RegistroCombattimento registro;///< Round dei combattimenti della missione, in forma binaria
+} DungeonMissione;
+
+
+#define VOCI_REGISTRO_MOSTRATE 24      /**< Voci del registro mostrate dal menu della missione */
+
+#define LARGHEZZA_FINESTRA_MAPPA 48    /**< Caselle mostrate per riga dalla mappa del dungeon */
+#define ALTEZZA_FINESTRA_MAPPA 20      /**< Righe mostrate dalla mappa del dungeon */
+
+/**
+ * @brief Aggiorna la mappa con le stanze nuove e ricalcola il campo visivo dal centro della stanza corrente
+ */
+static void guardaIntorno(DungeonMissione* dm) {
+    int x, y;
+    aggiornaMappaDungeon(&dm->mappa, &dm->dungeon);
+    if (casellaStanza(&dm->mappa, &dm->dungeon, stanzaCorrente(&dm->dungeon), &x, &y)) {
+        calcolaCampoVisivo(&dm->mappa, x, y, RAGGIO_VISTA);
+    }
+}
+
+/**
+ * @brief Mostra la parte di mappa attorno all'eroe (solo le caselle già viste)
+ */
+static void mostraMappaDungeon(const DungeonMissione* dm) {
+    char finestra[(LARGHEZZA_FINESTRA_MAPPA + 1) * ALTEZZA_FINESTRA_MAPPA + 1];
+    int x, y;
+    
+    if (!casellaStanza(&dm->mappa, &dm->dungeon, stanzaCorrente(&dm->dungeon), &x, &y)) {
+        stampa(COLORE_GIALLO "Questa zona del dungeon non è sulla mappa.\n" COLORE_RESET);
+        return;
+    }
+    disegnaMappaDungeon(&dm->mappa, x, y, LARGHEZZA_FINESTRA_MAPPA, ALTEZZA_FINESTRA_MAPPA,
+                        finestra, sizeof(finestra));
+    stampa(COLORE_BLU "Mappa del dungeon" COLORE_RESET " (@ = tu, # = muro, . = visibile, , = già visto)\n");
+    stampa("%s", finestra);
+}
+
+/**
+ * @brief Genera il dungeon di una missione
+ * 
+ * Il lato viene da latoDungeonMissione(). Il seme deriva dal seme della
+ * sessione, dall'id della missione e dal numero dell'ingresso: ogni volta che
+ * si rientra nella missione il dungeon è nuovo (nemici e tesori di un dungeon
+ * già ripulito non ricompaiono), mentre una sessione registrata viene
+ * riprodotta identica.
+ * Tutta la memoria del dungeon viene da 'arena'.
+ */
+static bool generaDungeonMissione(DungeonMissione* dm, const DefinizioneMissione* d, TipoMissione tipo,
+                                  unsigned ingresso, Arena* arena) {
+    int lato = latoDungeonMissione(d);
+    uint64_t stato = semeSessione() ^ ((uint64_t)(tipo + 1) * 0x9E3779B97F4A7C15ULL) ^
+                     ((uint64_t)ingresso * 0xD1B54A32D192ED03ULL);
+    
+    memset(dm, 0, sizeof(*dm));
+    if (!generaDungeon(&dm->dungeon, lato, lato, splitMix64(&stato), d->obiettiviTotali,
+                       (d->flag & MISSIONE_FLAG_OGGETTO) != 0, arena)) {
+        return false;
+    }
+    dm->stanzaOggetto = -1;
+    for (int i = 0; i < dm->dungeon.numeroSpeciali; i++) {
+        if (dm->dungeon.contenutoSpeciale[i] == STANZA_OGGETTO) dm->stanzaOggetto = dm->dungeon.stanzeSpeciali[i];
+    }
+    if (!inizializzaCampoDistanze(&dm->versoIngresso, &dm->dungeon, dm->dungeon.ingresso) ||
+        (dm->stanzaOggetto >= 0 &&
+         !inizializzaCampoDistanze(&dm->versoOggetto, &dm->dungeon, dm->stanzaOggetto)) ||
+        !inizializzaMappaDungeon(&dm->mappa, &dm->dungeon) ||
+        !inizializzaPoolNemici(&dm->nemici, 1 + SCORTA_GENERALE, arena)) {
+        liberaMappaDungeon(&dm->mappa);
+        liberaCampoDistanze(&dm->versoOggetto);
+        liberaCampoDistanze(&dm->versoIngresso);
+        liberaDungeon(&dm->dungeon);
+        return false;
+    }
+    guardaIntorno(dm);
+    return true;
+}
+
+/**
+ * @brief Libera il dungeon della missione e gli strumenti associati
+ */
+static void liberaDungeonMissione(DungeonMissione* dm) {
+    liberaPoolNemici(&dm->nemici);
+    liberaMappaDungeon(&dm->mappa);
+    liberaCampoDistanze(&dm->versoOggetto);
+    liberaCampoDistanze(&dm->versoIngresso);
+    liberaRicercaPercorsi(&dm->ricerca);
+    liberaDungeon(&dm->dungeon);
+}
+
+/**
+ * @brief Riassume un combattimento appena finito (i round sono nel registro)
+ */
+static void riassumiCombattimento(uint32_t round, int inflitti, int subiti, int vita) {
+    stampa("Il combattimento dura %u round: infliggi " COLORE_VERDE "%d" COLORE_RESET
+           " danni e ne subisci " COLORE_ROSSO "%d" COLORE_RESET " (vita %d).\n",
+           round, inflitti, subiti, vita);
+}
+
+/**
+ * @brief Combatte il nemico di una stanza
+ * 
+ * Il combattimento si riproduce da (seme del dungeon, id della stanza): 
+ * rientrando nella stessa stanza con la stessa vita va a finire allo stesso modo.
+ * I round finiscono nel registro della missione e diventano testo solo se il
+ * giocatore lo apre.
+ * 
+ * @return Esito del combattimento (la vita dell'eroe è già aggiornata)
+ */
+static EsitoCombattimento combattiNemicoStanza(DungeonMissione* dm, int stanza, int slot, Eroe* eroe) {
+    const Dungeon* dungeon = &dm->dungeon;
+    bool generale = dungeon->contenuto[slot] == STANZA_GENERALE;
+    Combattente sfidante = combattenteEroe(eroe);
+    Combattente nemico = combattenteNemico(generale ? VITA_GENERALE : VITA_NEMICO, DANNO_NEMICO,
+                                           PRECISIONE_NEMICO, dungeon->valore[slot], generale);
+    Combattimento c;
+    RoundCombattimento round;
+    int inflitti = 0, subiti = 0;
+    
+    const TabellaEsiti* esiti = esitiCombattimento(&sfidante, &nemico);
+    if (esiti != NULL) {
+        stampa("Probabilità di vittoria: " COLORE_GIALLO "%.1f%%" COLORE_RESET "\n",
+               100.0 * probabilitaVittoria(esiti, sfidante.vita, nemico.vita));
+    }
+    
+    iniziaCombattimento(&c, &sfidante, &nemico, dungeon->seme, (uint64_t)stanza);
+    c.registro = &dm->registro;
+    while (c.esito == COMBATTIMENTO_IN_CORSO) {
+        risolviRound(&c, &round);
+        inflitti += round.dannoInflitto;
+        subiti += round.dannoSubito;
+    }
+    riassumiCombattimento(c.round, inflitti, subiti, c.eroe.vita);
+    applicaCombattimento(eroe, &c);
+    return c.esito;
+}
+
+/**
+ * @brief Combatte un generale e la sua scorta di SCORTA_GENERALE nemici comuni
+ * 
+ * Come per i nemici singoli, il combattimento si riproduce da (seme del
+ * dungeon, id della stanza) e i round vanno nel registro della missione.
+ * 
+ * @return Esito del combattimento (la vita dell'eroe è già aggiornata)
+ */
+static EsitoCombattimento combattiGeneraleStanza(DungeonMissione* dm, int stanza, int slot, Eroe* eroe) {
+    const Dungeon* dungeon = &dm->dungeon;
+    PoolNemici* nemici = &dm->nemici;
+    Combattente sfidante = combattenteEroe(eroe);
+    Combattente generale = combattenteNemico(VITA_GENERALE, DANNO_NEMICO, PRECISIONE_NEMICO,
+                                             dungeon->valore[slot], true);
+    Combattente scorta = combattenteNemico(VITA_NEMICO, DANNO_NEMICO, PRECISIONE_NEMICO, 1, false);
+    CombattimentoGruppo c;
+    RoundCombattimento round;
+    int inflitti = 0, subiti = 0;
+    
+    svuotaPoolNemici(nemici);
+    aggiungiNemico(nemici, &generale, true);
+    for (int i = 0; i < SCORTA_GENERALE; i++) {
+        aggiungiNemico(nemici, &scorta, false);
+    }
+    stampa("Lo accompagn%s %d guardi%s.\n", SCORTA_GENERALE == 1 ? "a" : "ano", SCORTA_GENERALE,
+           SCORTA_GENERALE == 1 ? "a" : "e");
+    
+    iniziaCombattimentoGruppo(&c, &sfidante, nemici, dungeon->seme, (uint64_t)stanza);
+    c.registro = &dm->registro;
+    while (c.esito == COMBATTIMENTO_IN_CORSO) {
+        risolviRoundGruppo(&c, &round);
+        inflitti += round.dannoInflitto;
+        subiti += round.dannoSubito;
+    }
+    riassumiCombattimento(c.round, inflitti, subiti, c.eroe.vita);
+    modificaVita(eroe, c.eroe.vita - eroe->vita);
+    return c.esito;
+}
+
+/**
+ * @brief Mostra le ultime voci del registro dei combattimenti della missione
+ * 
+ * È l'unico punto in cui le voci diventano testo.
+ */
+static void mostraRegistroCombattimenti(const DungeonMissione* dm) {
+    const RegistroCombattimento* registro = &dm->registro;
+    int voci = vociRegistro(registro);
+    char riga[128];
+    
+    if (voci == 0) {
+        stampa(COLORE_GIALLO "Nessun combattimento in questa missione.\n" COLORE_RESET);
+        return;
+    }
+    stampa(COLORE_BLU "Registro dei combattimenti" COLORE_RESET " (ultime %d voci)\n",
+           voci < VOCI_REGISTRO_MOSTRATE ? voci : VOCI_REGISTRO_MOSTRATE);
+    int prima = voci > VOCI_REGISTRO_MOSTRATE ? voci - VOCI_REGISTRO_MOSTRATE : 0;
+    for (int i = prima; i < voci; i++) {
+        const VoceRegistro* voce = voceRegistro(registro, i);
+        // L'id dell'incontro è la stanza: un'intestazione per ogni combattimento
+        if (i == prima || voce->incontro != voceRegistro(registro, i - 1)->incontro) {
+            stampa(COLORE_CIANO "-- Stanza %u --\n" COLORE_RESET, voce->incontro);
+        }
+        formattaVoceRegistro(voce, riga, sizeof(riga));
+        stampa("%s\n", riga);
+    }
+}
+
+/**
+ * @brief Nome della direzione di un'uscita (una sola USCITA_*)
+ */
+static const char* nomeDirezione(int direzione) {
+    switch (direzione) {
+        case USCITA_NORD:  return "nord";
+        case USCITA_EST:   return "est";
+        case USCITA_SUD:   return "sud";
+        case USCITA_OVEST: return "ovest";
+        default:           return "?";
+    }
+}
+
+/**
+ * @brief Dice quanto è lontano il bersaglio di un campo e da che parte andare
+ * 
+ * Il primo passo è una lettura del campo (prossimoPassoCampo()), senza ricerche;
+ * non stampa nulla se si è già arrivati o se non c'è ancora una strada nota.
+ */
+static void indicaStrada(const CampoDistanze* campo, const Dungeon* dungeon, int stanza, const char* cosa) {
+    int distanza = distanzaCampo(campo, dungeon, stanza);
+    int passo = prossimoPassoCampo(campo, dungeon, stanza);
+    if (distanza == DISTANZA_INFINITA || passo == 0) return;
+    stampa("%s è a %d stanz%s da qui, verso %s.\n", cosa, distanza, distanza == 1 ? "a" : "e",
+           nomeDirezione(passo));
+}
+
+/**
+ * @brief Esplora la prossima stanza del dungeon e ne gestisce il contenuto
+ * 
+ * Il progresso della missione non viene toccato qui: nemici sconfitti e oggetti
+ * trovati vengono pubblicati sul bus degli eventi, come la stanza esplorata.
+ * 
+ * Quando la prossima stanza non è vicina a quella corrente l'eroe torna sui
+ * propri passi: la strada più breve viene cercata con A*. Dopo ogni passo i
+ * campi di distanza dall'uscita e dall'oggetto speciale vengono aggiornati con
+ * le stanze nuove e indicano da che parte andare.
+ * 
+ * @param[in,out] dm Dungeon della missione in corso
+ * @param[in,out] eroe Eroe che esplora (riceve le monete dei tesori e i danni)
+ * @param[in] tipo Id della missione in corso
+ * @return false se l'eroe è caduto in combattimento
+ */
+static bool esploraStanzaDungeon(DungeonMissione* dm, Eroe* eroe, TipoMissione tipo) {
+    Dungeon* dungeon = &dm->dungeon;
+    int precedente = stanzaCorrente(dungeon);
+    int stanza = esploraProssimaStanza(dungeon);
+    
+    if (stanza < 0) {
+        stampa(COLORE_GIALLO "Hai già esplorato ogni stanza del dungeon.\n" COLORE_RESET);
+        return true;
+    }
+    
+    // Il percorso include la stanza di partenza e quella di arrivo
+    int attraversate = cercaPercorso(&dm->ricerca, dungeon, precedente, stanza, NULL, 0) - 2;
+    if (attraversate > 0) {
+        stampa("Torni sui tuoi passi attraverso %d stanz%s già esplorat%s.\n",
+               attraversate, attraversate == 1 ? "a" : "e", attraversate == 1 ? "a" : "e");
+    }
+    
+    stampa(COLORE_CIANO "Entri in una nuova stanza (%d/%d esplorate).\n" COLORE_RESET,
+           dungeon->stanzeEsplorate, dungeon->numeroStanze);
+    
+    if (aggiornaCampoDistanze(&dm->versoIngresso, dungeon)) {
+        indicaStrada(&dm->versoIngresso, dungeon, stanza, "L'uscita");
+    }
+    // L'oggetto si indica solo finché è nella sua stanza e c'è una strada nota per arrivarci
+    if (dm->stanzaOggetto >= 0 && aggiornaCampoDistanze(&dm->versoOggetto, dungeon)) {
+        int slotOggetto = slotStanza(dungeon, dm->stanzaOggetto);
+        if (slotOggetto >= 0 && dungeon->contenuto[slotOggetto] == STANZA_OGGETTO) {
+            indicaStrada(&dm->versoOggetto, dungeon, stanza, "L'oggetto della missione");
+        }
+    }
+    guardaIntorno(dm);
+    
+    int slot = slotStanza(dungeon, stanza);  // La stanza è stata appena materializzata
+    
+    switch (dungeon->contenuto[slot]) {
+        case STANZA_NEMICO:
+        case STANZA_GENERALE: {
+            bool generale = dungeon->contenuto[slot] == STANZA_GENERALE;
+            stampa(COLORE_ROSSO "%s ti sbarra la strada!\n" COLORE_RESET,
+                   generale ? "Un nemico temibile" : "Un nemico");
+            EsitoCombattimento esito = generale ? combattiGeneraleStanza(dm, stanza, slot, eroe)
+                                                : combattiNemicoStanza(dm, stanza, slot, eroe);
+            if (esito == COMBATTIMENTO_SCONFITTA) {
+                return false;   // Il nemico resta nella stanza
+            }
+            if (esito == COMBATTIMENTO_VITTORIA) {
+                stampa(COLORE_VERDE "Il nemico è sconfitto!\n" COLORE_RESET);
+                for (int i = 0; generale && i < SCORTA_GENERALE; i++) {
+                    pubblicaEvento(EVENTO_NEMICO_UCCISO, tipo, 0);
+                }
+                pubblicaEvento(EVENTO_NEMICO_UCCISO, tipo, generale);
+            } else {
+                stampa(COLORE_GIALLO "Il nemico si dilegua nell'oscurità.\n" COLORE_RESET);
+            }
+            break;
+        }
+        
+        case STANZA_OGGETTO:
+            pubblicaEvento(EVENTO_OGGETTO_RECUPERATO, tipo, 0);
+            break;
+        
+        case STANZA_TESORO:
+            stampa(COLORE_GIALLO "Trovi un forziere con %d monete!\n" COLORE_RESET, dungeon->valore[slot]);
+            modificaMonete(eroe, dungeon->valore[slot]);
+            break;
+        
+        default:
+            stampa("La stanza è vuota.\n");
+            break;
+    }
+    
+    svuotaStanza(dungeon, stanza);
+    pubblicaEvento(EVENTO_STANZA_ESPLORATA, tipo, stanza);
+    return true;
+}
+
 /**
  * @brief Esegue il loop principale di una missione selezionata
  * 
  * Questa funzione gestisce l'intera esecuzione di una missione, fornendo
  * un menu interattivo che permette al giocatore di:
- * - Esplorare il dungeon (da implementare)
+ * - Esplorare il dungeon e combattere i nemici che si incontrano
  * - Visitare il negozio (da implementare)
  * - Controllare l'inventario
  * - Tornare al villaggio (gratis se completata, 50 monete altrimenti)
@@ -379,6 +853,14 @@ TipoMissione selezionaMissione(GestoreMissioni* gestore) {
  * Se la missione è completata (obiettivi raggiunti e oggetti recuperati),
  * viene automaticamente marcata come completata.
  * 
+ * Ad ogni ingresso viene preparato il dungeon della missione (vedi
+ * generaDungeonMissione()); "Esplora" visita una stanza nuova per volta,
+ * che viene generata solo in quel momento.
+ * 
+ * Il progresso arriva dal bus degli eventi: per la durata della missione sono
+ * iscritti un tracciamento dello stato e un iscritto che stampa i messaggi;
+ * gli eventi pubblicati da un'azione vengono consegnati subito dopo di essa.
+ * 
  * @param[in,out] gestore Puntatore al GestoreMissioni
  * @param[in,out] eroe Puntatore all'Eroe che esegue la missione
  * @param[in] tipo Tipo di missione da eseguire
@@ -389,7 +871,7 @@ TipoMissione selezionaMissione(GestoreMissioni* gestore) {
  * @retval false La missione non è disponibile, è già completata, o parametri non validi
  * 
  * @pre gestore ed eroe devono essere puntatori validi
- * @pre tipo deve essere un valore valido tra 0 e 3
+ * @pre tipo deve essere un id valido del catalogo
  * @pre La missione deve essere sbloccata e non ancora completata
  * 
  * @post gestore->missioneCorrente è impostato a tipo durante l'esecuzione
@@ -405,79 +887,128 @@ TipoMissione selezionaMissione(GestoreMissioni* gestore) {
  * @see completaMissione()
  * @see obiettiviRaggiunti()
  * @see mostraMenuDuranteMissione()
+ * @see consegnaEventi()
  */
 bool eseguiMissione(GestoreMissioni* gestore, Eroe* eroe, TipoMissione tipo) {
-    if (gestore == NULL || eroe == NULL || tipo < 0 || tipo > 3) {
+    MISURA_SONDA(SONDA_ESEGUI_MISSIONE);
+    const DefinizioneMissione* missione = getMissione(gestore, tipo);
+    
+    if (missione == NULL || eroe == NULL) {
         return false;
     }
     
-    Missione* missione = &gestore->missioni[tipo];
+    if (!missioneSbloccata(gestore, tipo) || missioneCompletata(gestore, tipo)) {
+        stampa(COLORE_ROSSO "Questa missione non è disponibile!\n" COLORE_RESET);
+        return false;
+    }
     
-    if (!missione->sbloccata || missione->completata) {
-        printf(COLORE_ROSSO "Questa missione non è disponibile!\n" COLORE_RESET);
+    // Il dungeon viene dalla lista dei liberi della sessione (uno per missione, riusato
+    // dalla successiva); tutto ciò che contiene viene allocato dopo il segno e sparisce con il ripristino
+    Arena* arena = arenaSessione();
+    ListaLibera* dungeonLiberi = &sessioneCorrente()->dungeonLiberi;
+    if (dungeonLiberi->arena != arena) {
+        inizializzaListaLibera(dungeonLiberi, arena, sizeof(DungeonMissione));
+    }
+    DungeonMissione* dungeon = prendiDaLista(dungeonLiberi);
+    SegnoArena segno = segnaArena(arena);
+    unsigned ingresso = gestore->ingressi[tipo]++;
+    if (dungeon == NULL || !generaDungeonMissione(dungeon, missione, tipo, ingresso, arena)) {
+        ripristinaArena(arena, segno);
+        restituisciALista(dungeonLiberi, dungeon);
+        DIARIO(DIARIO_ERRORE, CATEGORIA_MISSIONI, "Memoria insufficiente per il dungeon della missione %d", (int)tipo);
+        stampa(COLORE_ROSSO "Memoria insufficiente per generare il dungeon!\n" COLORE_RESET);
         return false;
     }
     
     gestore->missioneCorrente = tipo;
+    DIARIO(DIARIO_INFO, CATEGORIA_MISSIONI, "Inizia la missione %d '%s' (ingresso %u, dungeon %dx%d, seme %llu)",
+           (int)tipo, missione->nome, ingresso, dungeon->dungeon.larghezza, dungeon->dungeon.altezza,
+           (unsigned long long)dungeon->dungeon.seme);
     
-    printf(COLORE_VERDE "\nInizia la missione: %s\n" COLORE_RESET, missione->nome);
-    printf(COLORE_MAGENTA "Che l'avventura abbia inizio!\n" COLORE_RESET);
+    stampa(COLORE_VERDE "\nInizia la missione: %s\n" COLORE_RESET, missione->nome);
+    stampa(COLORE_MAGENTA "Che l'avventura abbia inizio!\n" COLORE_RESET);
     
-    // TODO: Qui verrà integrato il sistema di dungeon e combattimento
-    // Per ora mostriamo solo il menu
+    MissioneInCorso tracciamento = { gestore, tipo, obiettiviRaggiunti(gestore, tipo) };
+    iscriviMissioneAgliEventi(&tracciamento, true);
     
     bool missioneInCorso = true;
     
     while (missioneInCorso) {
-        mostraMenuDuranteMissione(missione, eroe);
+        mostraMenuDuranteMissione(gestore, tipo, eroe);
+        
+        stampa("\nSeleziona una delle opzioni del menu [1-6]: ");
         
-        printf("\nSeleziona una delle opzioni del menu [1-4]: ");
+        char scelta = leggiCaratterePulito();
         
-        char scelta;
-        int c;
-        scelta = getchar();
-        while ((c = getchar()) != '\n' && c != EOF);
+        if (scelta == INPUT_FINE) {
+            // Input terminato: la missione resta in sospeso, senza costi
+            break;
+        }
         
-        switch (scelta) {
-            case '1':
-                printf(COLORE_GIALLO "Esplorazione del dungeon... (DA IMPLEMENTARE)\n" COLORE_RESET);
-                // TODO: Chiamare la funzione di esplorazione dungeon
+        switch (azioneMenu(&MENU_MISSIONE, scelta)) {
+            case AZIONE_ESPLORA:
+                if (!esploraStanzaDungeon(dungeon, eroe, tipo)) {
+                    // Sconfitta: il progresso della missione resta, le monete no
+                    stampa(COLORE_ROSSO "Sei stato sconfitto! Ti risvegli al villaggio senza monete.\n" COLORE_RESET);
+                    modificaMonete(eroe, -eroe->monete);
+                    modificaVita(eroe, VITA_MASSIMA_EROE - eroe->vita);
+                    missioneInCorso = false;
+                }
                 break;
                 
-            case '2':
-                printf(COLORE_GIALLO "Negozio... (DA IMPLEMENTARE)\n" COLORE_RESET);
+            case AZIONE_NEGOZIO:
+                stampa(COLORE_GIALLO "Negozio... (DA IMPLEMENTARE)\n" COLORE_RESET);
                 // TODO: Aprire il negozio
                 break;
                 
-            case '3':
-                printf(COLORE_CIANO "Inventario:\n" COLORE_RESET);
+            case AZIONE_INVENTARIO:
+                stampa(COLORE_CIANO "Inventario:\n" COLORE_RESET);
                 mostraEroe(eroe);
                 break;
                 
-            case '4':
+            case AZIONE_MAPPA:
+                mostraMappaDungeon(dungeon);
+                break;
+                
+            case AZIONE_REGISTRO:
+                mostraRegistroCombattimenti(dungeon);
+                break;
+                
+            case AZIONE_TORNA:
                 // Verifica se può tornare gratuitamente
-                if (obiettiviRaggiunti(missione) && 
-                    (missione->tipo == MISSIONE_CASTELLO || missione->oggettoRecuperato)) {
-                    printf(COLORE_VERDE "Missione completata! Torni al villaggio.\n" COLORE_RESET);
+                if (tracciamento.obiettiviRaggiunti) {
+                    stampa(COLORE_VERDE "Missione completata! Torni al villaggio.\n" COLORE_RESET);
                     completaMissione(gestore, tipo);
                     missioneInCorso = false;
-                } else if (eroe->monete >= 50) {
-                    printf(COLORE_GIALLO "Paghi 50 monete per tornare al villaggio.\n" COLORE_RESET);
-                    modificaMonete(eroe, -50);
+                } else if (eroe->monete >= COSTO_RITORNO_VILLAGGIO) {
+                    stampa(COLORE_GIALLO "Paghi %d monete per tornare al villaggio.\n" COLORE_RESET,
+                           COSTO_RITORNO_VILLAGGIO);
+                    modificaMonete(eroe, -COSTO_RITORNO_VILLAGGIO);
                     missioneInCorso = false;
                 } else {
-                    printf(COLORE_ROSSO "Non hai abbastanza monete! (Servono 50 monete)\n" COLORE_RESET);
+                    stampa(COLORE_ROSSO "Non hai abbastanza monete! (Servono %d monete)\n" COLORE_RESET,
+                           COSTO_RITORNO_VILLAGGIO);
                 }
                 break;
                 
             default:
-                printf(COLORE_ROSSO "Opzione non valida!\n" COLORE_RESET);
+                stampa(COLORE_ROSSO "Opzione non valida!\n" COLORE_RESET);
                 break;
         }
+        
+        consegnaEventi();  // Progresso prodotto dall'azione appena eseguita
     }
     
+    consegnaEventi();
+    iscriviMissioneAgliEventi(&tracciamento, false);
+    DIARIO(DIARIO_INFO, CATEGORIA_MISSIONI, "Fine della missione %d: %d stanze esplorate, %s",
+           (int)tipo, dungeon->dungeon.stanzeEsplorate,
+           missioneCompletata(gestore, tipo) ? "completata" : "non completata");
+    liberaDungeonMissione(dungeon);
+    ripristinaArena(arena, segno);
+    restituisciALista(dungeonLiberi, dungeon);
     gestore->missioneCorrente = MISSIONE_NESSUNA;
-    return missione->completata;
+    return missioneCompletata(gestore, tipo);
 }
 
 /**
@@ -487,200 +1018,190 @@ bool eseguiMissione(GestoreMissioni* gestore, Eroe* eroe, TipoMissione tipo) {
  * - Marca la missione specificata come completata
  * - Incrementa il contatore delle missioni completate
  * - Mostra un messaggio celebrativo
- * - Verifica se tutte le missioni preliminari sono complete
- * - Sblocca la missione finale se le condizioni sono soddisfatte
+ * - Decrementa il contatore dei prerequisiti mancanti delle missioni che
+ *   dipendono da questa e sblocca quelle arrivate a zero
+ * 
+ * Vengono visitati solo gli archi uscenti della missione (grafo dei prerequisiti
+ * del catalogo), quindi il costo è O(dipendenti) e non O(missioni del catalogo).
  * 
  * @param[in,out] gestore Puntatore al GestoreMissioni
  * @param[in] tipo Tipo della missione da completare
  * 
  * @pre gestore deve essere un puntatore valido
- * @pre tipo deve essere un valore valido (0-3)
+ * @pre tipo deve essere un id valido del catalogo
  * 
- * @post missione->completata è impostato a true
+ * @post Il bit della missione in gestore->completate è impostato
  * @post gestore->missioniCompletate è incrementato
- * @post MISSIONE_CASTELLO può essere sbloccata se tutte le preliminari sono complete
+ * @post Le missioni che avevano come ultimo prerequisito mancante questa missione sono sbloccate
  * 
  * @note Se la missione è già completata, la funzione ritorna senza modifiche
  * @note Se gestore è NULL o tipo non è valido, la funzione ritorna senza operazioni
  * 
- * @see sbloccaMissioneFinale()
- * @see tutteLePreliminariCompletate()
+ * @see sbloccaMissione()
+ * @see dipendentiMissione()
  * @see TipoMissione
  */
 void completaMissione(GestoreMissioni* gestore, TipoMissione tipo) {
-    if (gestore == NULL || tipo < 0 || tipo > 3) return;
-    
-    Missione* m = &gestore->missioni[tipo];
+    const DefinizioneMissione* m = getMissione(gestore, tipo);
     
-    if (m->completata) return;
+    if (m == NULL || missioneCompletata(gestore, tipo)) return;
     
-    m->completata = true;
-    gestore->missioniCompletate++;
+    stampa("\n");
+    stampa(COLORE_VERDE "----------------------------------------------\n" COLORE_RESET);
+    stampa(COLORE_VERDE "            MISSIONE COMPLETATA!            \n" COLORE_RESET);
+    stampa(COLORE_VERDE "----------------------------------------------\n" COLORE_RESET);
+    stampa(COLORE_GIALLO "Hai completato: %s\n" COLORE_RESET, m->nome);
     
-    printf("\n");
-    printf(COLORE_VERDE "----------------------------------------------\n" COLORE_RESET);
-    printf(COLORE_VERDE "            MISSIONE COMPLETATA!            \n" COLORE_RESET);
-    printf(COLORE_VERDE "----------------------------------------------\n" COLORE_RESET);
-    printf(COLORE_GIALLO "Hai completato: %s\n" COLORE_RESET, m->nome);
+    propagaCompletamento(gestore, tipo, true);
+}
+
+void ripristinaMissioneCompletata(GestoreMissioni* gestore, TipoMissione tipo) {
+    if (getMissione(gestore, tipo) == NULL || missioneCompletata(gestore, tipo)) return;
     
-    // Sblocca la missione finale se tutte le preliminari sono complete
-    if (tutteLePreliminariCompletate(gestore)) {
-        sbloccaMissioneFinale(gestore);
-    }
+    propagaCompletamento(gestore, tipo, false);
 }
 
 /**
  * @brief Incrementa il contatore degli obiettivi completati di una missione
  * 
  * Aumenta di uno il numero di obiettivi completati per la missione specificata.
- * Fornisce feedback visivo all'utente riguardo al progresso della missione:
- * - Messaggio di completamento se tutti gli obiettivi sono raggiunti
- * - Messaggio di progresso con conteggio corrente altrimenti
- * 
  * Il contatore non può superare il numero totale di obiettivi della missione.
+ * Il messaggio di progresso non viene stampato qui ma da mostraProgressoDaEvento(),
+ * iscritta al bus degli eventi accanto al tracciamento della missione.
  * 
- * @param[in,out] missione Puntatore alla Missione da aggiornare
+ * @param[in,out] gestore Puntatore al GestoreMissioni
+ * @param[in] tipo Id della missione da aggiornare
  * 
- * @pre missione deve essere un puntatore valido
- * @post missione->obiettiviCompletati è incrementato di 1
+ * @pre gestore deve essere un puntatore valido
+ * @post Il contatore degli obiettivi della missione è incrementato di 1
  * @post Il valore viene limitato a obiettiviTotali se necessario
- * @post Viene stampato un messaggio di feedback su stdout
  * 
- * @note Se missione è NULL, la funzione ritorna senza operazioni
+ * @note Se tipo non è un id valido, la funzione ritorna senza operazioni
  * @note Il valore massimo è limitato a obiettiviTotali anche se incrementato oltre
  * 
  * @see obiettiviRaggiunti()
- * @see Missione
+ * @see EVENTO_NEMICO_UCCISO
  */
-void incrementaObiettivi(Missione* missione) {
-    if (missione == NULL) return;
+void incrementaObiettivi(GestoreMissioni* gestore, TipoMissione tipo) {
+    const DefinizioneMissione* d = getMissione(gestore, tipo);
+    if (d == NULL) return;
     
-    missione->obiettiviCompletati++;
-    
-    if (missione->obiettiviCompletati > missione->obiettiviTotali) {
-        missione->obiettiviCompletati = missione->obiettiviTotali;
-    }
-    
-    // Feedback visivo
-    if (obiettiviRaggiunti(missione)) {
-        printf(COLORE_VERDE "Obiettivi della missione raggiunti!\n" COLORE_RESET);
-    } else {
-        printf(COLORE_CIANO "Progresso: %d/%d obiettivi completati\n" COLORE_RESET,
-               missione->obiettiviCompletati, missione->obiettiviTotali);
+    // Contatore a 8 bit: il catalogo garantisce obiettiviTotali <= MAX_OBIETTIVI_MISSIONE
+    if (gestore->obiettiviCompletati[tipo] < d->obiettiviTotali) {
+        gestore->obiettiviCompletati[tipo]++;
     }
 }
 
 /**
  * @brief Segna un oggetto speciale come recuperato nella missione
  * 
- * Imposta il flag oggettoRecuperato a true per la missione specificata
- * e mostra messaggi appropriati in base al tipo di oggetto:
- * - Per MISSIONE_MAGIONE: mostra messaggio recupero Chiave del Castello
- * - Per MISSIONE_GROTTA: mostra messaggio recupero Spada dell'Eroe e bonus attacco
+ * Imposta il bit dell'oggetto recuperato per la missione specificata.
+ * Il messaggio con il nome dell'oggetto viene stampato da mostraProgressoDaEvento().
  * 
- * Gli oggetti speciali sono:
+ * Gli oggetti speciali predefiniti sono:
  * - Chiave del Castello (MISSIONE_MAGIONE): necessaria per accedere alla missione finale
  * - Spada dell'Eroe (MISSIONE_GROTTA): fornisce bonus di +2 all'attacco
  * 
- * @param[in,out] missione Puntatore alla Missione in cui recuperare l'oggetto
+ * @param[in,out] gestore Puntatore al GestoreMissioni
+ * @param[in] tipo Id della missione in cui recuperare l'oggetto
  * 
- * @pre missione deve essere un puntatore valido
- * @post missione->oggettoRecuperato è impostato a true
- * @post Messaggi informativi vengono stampati su stdout
+ * @pre gestore deve essere un puntatore valido
+ * @post Il bit della missione in oggettiRecuperati è impostato
  * 
- * @note Se missione è NULL, la funzione ritorna senza operazioni
+ * @note Se tipo non è un id valido, la funzione ritorna senza operazioni
  * @note L'incremento effettivo dell'attacco per la Spada deve essere gestito altrove
  * 
  * @see TipoMissione
- * @see Missione
+ * @see EVENTO_OGGETTO_RECUPERATO
  */
-void segnaOggettoRecuperato(Missione* missione) {
-    if (missione == NULL) return;
+void segnaOggettoRecuperato(GestoreMissioni* gestore, TipoMissione tipo) {
+    if (getMissione(gestore, tipo) == NULL) return;
     
-    missione->oggettoRecuperato = true;
-    
-    printf(COLORE_VERDE "✨ Hai recuperato un oggetto speciale!\n" COLORE_RESET);
-    
-    if (missione->tipo == MISSIONE_MAGIONE) {
-        printf(COLORE_GIALLO "Hai ottenuto la Chiave del Castello del Signore Oscuro!\n" COLORE_RESET);
-    } else if (missione->tipo == MISSIONE_GROTTA) {
-        printf(COLORE_GIALLO "Hai ottenuto la leggendaria Spada dell'Eroe!\n" COLORE_RESET);
-        printf(COLORE_CIANO "   La tua potenza di attacco aumenta di +2!\n" COLORE_RESET);
-    }
+    impostaBitMissione(gestore->oggettiRecuperati, tipo);
 }
 
 // --- FUNZIONI DI CONTROLLO STATO ---
 
-bool missioneCompletata(const Missione* missione) {
-    return (missione != NULL && missione->completata);
+bool missioneCompletata(const GestoreMissioni* gestore, TipoMissione tipo) {
+    return getMissione(gestore, tipo) != NULL && bitMissione(gestore->completate, tipo);
 }
 
-bool missioneSbloccata(const Missione* missione) {
-    return (missione != NULL && missione->sbloccata);
+bool missioneSbloccata(const GestoreMissioni* gestore, TipoMissione tipo) {
+    return getMissione(gestore, tipo) != NULL && bitMissione(gestore->sbloccate, tipo);
 }
 
-bool tutteLePreliminariCompletate(const GestoreMissioni* gestore) {
-    if (gestore == NULL) return false;
-    
-    return (gestore->missioni[MISSIONE_PALUDE].completata &&
-            gestore->missioni[MISSIONE_MAGIONE].completata &&
-            gestore->missioni[MISSIONE_GROTTA].completata);
+bool oggettoRecuperato(const GestoreMissioni* gestore, TipoMissione tipo) {
+    return getMissione(gestore, tipo) != NULL && bitMissione(gestore->oggettiRecuperati, tipo);
+}
+
+int obiettiviCompletati(const GestoreMissioni* gestore, TipoMissione tipo) {
+    return getMissione(gestore, tipo) != NULL ? gestore->obiettiviCompletati[tipo] : 0;
+}
+
+bool prerequisitiCompletati(const GestoreMissioni* gestore, TipoMissione tipo) {
+    return getMissione(gestore, tipo) != NULL && gestore->prerequisitiMancanti[tipo] == 0;
 }
 
-bool obiettiviRaggiunti(const Missione* missione) {
-    if (missione == NULL) return false;
+bool obiettiviRaggiunti(const GestoreMissioni* gestore, TipoMissione tipo) {
+    const DefinizioneMissione* d = getMissione(gestore, tipo);
+    if (d == NULL) return false;
     
-    // Per missioni senza obiettivi numerici (come Grotta), considera solo l'oggetto
-    if (missione->obiettiviTotali == 0) {
-        return missione->oggettoRecuperato;
+    // L'oggetto speciale (chiave, spada) va sempre recuperato
+    if ((d->flag & MISSIONE_FLAG_OGGETTO) && !bitMissione(gestore->oggettiRecuperati, tipo)) {
+        return false;
     }
     
-    return (missione->obiettiviCompletati >= missione->obiettiviTotali);
+    // Per missioni senza obiettivi numerici (come Grotta), basta l'oggetto
+    return (gestore->obiettiviCompletati[tipo] >= d->obiettiviTotali);
 }
 
-void sbloccaMissioneFinale(GestoreMissioni* gestore) {
-    if (gestore == NULL) return;
+void sbloccaMissione(GestoreMissioni* gestore, TipoMissione tipo) {
+    const DefinizioneMissione* d = getMissione(gestore, tipo);
+    if (d == NULL) return;
     
-    gestore->missioni[MISSIONE_CASTELLO].sbloccata = true;
+    impostaBitMissione(gestore->sbloccate, tipo);
     
-    printf("\n");
-    printf(COLORE_ROSSO "-------------------------------------------------\n" COLORE_RESET);
-    printf(COLORE_ROSSO "          MISSIONE FINALE SBLOCCATA!            \n" COLORE_RESET);
-    printf(COLORE_ROSSO "-------------------------------------------------\n" COLORE_RESET);
-    printf(COLORE_MAGENTA "Il Castello del Signore Oscuro ti attende...\n" COLORE_RESET);
-    printf(COLORE_GIALLO "Preparati per lo scontro finale!\n" COLORE_RESET);
+    if (!(d->flag & MISSIONE_FLAG_FINALE)) {
+        stampa(COLORE_CIANO "Nuova missione disponibile: %s\n" COLORE_RESET, d->nome);
+        return;
+    }
+    
+    stampa("\n");
+    stampa(COLORE_ROSSO "-------------------------------------------------\n" COLORE_RESET);
+    stampa(COLORE_ROSSO "          MISSIONE FINALE SBLOCCATA!            \n" COLORE_RESET);
+    stampa(COLORE_ROSSO "-------------------------------------------------\n" COLORE_RESET);
+    stampa(COLORE_MAGENTA "%s ti attende...\n" COLORE_RESET, d->nome);
+    stampa(COLORE_GIALLO "Preparati per lo scontro finale!\n" COLORE_RESET);
 }
 
 // --- FUNZIONI DI UTILITÀ ---
 
 const char* getNomeMissione(TipoMissione tipo) {
-    switch (tipo) {
-        case MISSIONE_PALUDE:   return "Palude Putrescente";
-        case MISSIONE_MAGIONE:  return "Magione Infestata";
-        case MISSIONE_GROTTA:   return "Grotta di Cristallo";
-        case MISSIONE_CASTELLO: return "Castello del Signore Oscuro";
-        default:                return "Sconosciuta";
-    }
+    const DefinizioneMissione* d = definizioneMissione(tipo);
+    return d ? d->nome : "Sconosciuta";
 }
 
 const char* getDescrizioneMissione(TipoMissione tipo) {
-    switch (tipo) {
-        case MISSIONE_PALUDE:
-            return "Sconfiggi 3 Generale Orco del Signore Oscuro";
-        case MISSIONE_MAGIONE:
-            return "Recupera la chiave del Castello e sconfiggi un Vampiro Superiore";
-        case MISSIONE_GROTTA:
-            return "Recupera la Spada dell'Eroe";
-        case MISSIONE_CASTELLO:
-            return "Sconfiggi il Signore Oscuro";
-        default:
-            return "Nessuna descrizione disponibile";
-    }
+    const DefinizioneMissione* d = definizioneMissione(tipo);
+    return d ? d->descrizione : "Nessuna descrizione disponibile";
 }
 
-Missione* getMissione(GestoreMissioni* gestore, TipoMissione tipo) {
-    if (gestore == NULL || tipo < 0 || tipo > 3) {
+const DefinizioneMissione* getMissione(const GestoreMissioni* gestore, TipoMissione tipo) {
+    if (gestore == NULL || tipo < 0 || tipo >= gestore->numeroMissioni) {
         return NULL;
     }
-    return &gestore->missioni[tipo];
-}
\ No newline at end of file
+    return &gestore->catalogo->missioni[tipo];
+}
+
+/**
+ * @brief Stanze per lato del dungeon di una missione
+ * 
+ * È un termine della successione di Padovan che avanza di uno per ogni
+ * prerequisito della missione (5, 7, 9, 12, 16, ...): cresce con la difficoltà
+ * ma più dolcemente di un raddoppio. Lo usano sia eseguiMissione() sia il
+ * simulatore, così giocano sugli stessi dungeon.
+ */
+int latoDungeonMissione(const DefinizioneMissione* d) {
+    uint64_t lato = padovan(INDICE_PADOVAN_DUNGEON + d->numeroPrerequisiti);
+    return lato > MAX_LATO_DUNGEON ? MAX_LATO_DUNGEON : (int)lato;
+}
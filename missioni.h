@@ -2,9 +2,13 @@
 #define MISSIONI_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "eroe.h"
+#include "catalogo.h"
+#include "utils.h"
 
-// Enumerazione per identificare le missioni disponibili
+// Id delle missioni predefinite (il catalogo può contenerne altre, con id successivi)
 typedef enum {
     MISSIONE_PALUDE = 0,           // Palude Putrescente
     MISSIONE_MAGIONE = 1,          // Magione Infestata
@@ -13,42 +17,69 @@ typedef enum {
     MISSIONE_NESSUNA = -1          // Nessuna missione attiva
 } TipoMissione;
 
-// Struttura che rappresenta lo stato di una singola missione
+// Numero di missioni rappresentate da una parola di un bitset
+#define MISSIONI_PER_PAROLA 64
+
+// Monete da pagare per tornare al villaggio senza aver raggiunto gli obiettivi
+#define COSTO_RITORNO_VILLAGGIO 50
+
+/**
+ * Progresso delle missioni di un eroe
+ * I dati immutabili (nome, descrizione, obiettivi totali, prerequisiti) restano
+ * nel catalogo; qui c'è solo lo stato, compattato in un unico blocco:
+ *   - tre bitset (un bit per missione): completate, sbloccate, oggetti recuperati
+ *   - un contatore a 8 bit di obiettivi raggiunti per missione
+ *   - un contatore a 16 bit di prerequisiti mancanti per missione
+ *   - un contatore a 16 bit di ingressi per missione (seme del dungeon)
+ * Con le 4 missioni predefinite lo stato occupa 44 byte; copiarlo o salvarlo
+ * è una sola memcpy di dimensioneStato byte
+ */
 typedef struct {
-    TipoMissione tipo;             // Tipo di missione
-    char nome[50];                 // Nome descrittivo della missione
-    char descrizione[200];         // Descrizione dell'obiettivo
-    bool completata;               // true se la missione è stata completata
-    bool sbloccata;                // true se la missione è accessibile
+    const CatalogoMissioni* catalogo; // Catalogo da cui provengono le missioni (definizioni e grafo)
+    int numeroMissioni;            // Numero di missioni del catalogo
+    int parole;                    // Parole da 64 bit di ogni bitset
     
-    // Contatori per il progresso della missione
-    int obiettiviCompletati;       // Numero di obiettivi raggiunti (es: 2 Generali Orco uccisi)
-    int obiettiviTotali;           // Numero di obiettivi necessari (es: 3 Generali Orco)
+    uint64_t* completate;          // Bit i = missione i completata
+    uint64_t* sbloccate;           // Bit i = missione i accessibile
+    uint64_t* oggettiRecuperati;   // Bit i = oggetto speciale della missione i trovato
+    uint16_t* prerequisitiMancanti;// Prerequisiti non ancora completati (0 = sbloccabile)
+    uint16_t* ingressi;            // Volte in cui si è entrati nella missione
+    uint8_t* obiettiviCompletati;  // Obiettivi raggiunti (es: 2 Generali Orco uccisi)
+    size_t dimensioneStato;        // Byte del blocco che contiene tutti gli array qui sopra
+    Arena* arena;                  // Arena da cui viene il blocco (NULL = heap)
     
-    // Flag speciali per oggetti da recuperare
-    bool oggettoRecuperato;        // true se l'oggetto della missione è stato trovato
-} Missione;
-
-// Struttura che gestisce tutte le missioni del gioco
-typedef struct {
-    Missione missioni[4];          // Array delle 4 missioni (3 normali + 1 finale)
     int missioniCompletate;        // Contatore delle missioni completate
     TipoMissione missioneCorrente; // Missione attualmente in corso
 } GestoreMissioni;
 
+/**
+ * Lettura di un bit di un bitset di missioni
+ */
+static inline bool bitMissione(const uint64_t* bitset, int id) {
+    return (bitset[id / MISSIONI_PER_PAROLA] >> (id % MISSIONI_PER_PAROLA)) & 1;
+}
+
 // --- FUNZIONI DI INIZIALIZZAZIONE ---
 
 /**
- * Inizializza il gestore delle missioni con i dati di default
- * Le prime 3 missioni sono sbloccate, la finale è bloccata
+ * Inizializza il gestore con lo stato iniziale di ogni missione del catalogo
+ * Sono sbloccate solo le missioni senza prerequisiti
+ * Lo stato viene allocato da 'arena' (di solito arenaSessione(); NULL = heap)
+ * Ritorna false se la memoria non è sufficiente (il gestore resta vuoto)
+ */
+bool inizializzaGestoreMissioni(GestoreMissioni* gestore, Arena* arena);
+
+/**
+ * Libera la memoria del gestore delle missioni
  */
-void inizializzaGestoreMissioni(GestoreMissioni* gestore);
+void liberaGestoreMissioni(GestoreMissioni* gestore);
 
 /**
- * Inizializza una singola missione con nome, descrizione e obiettivi
+ * Copia lo stato delle missioni di un gestore in un altro già inizializzato
+ * con lo stesso catalogo (una sola memcpy)
+ * Ritorna false se i due gestori non sono compatibili
  */
-void inizializzaMissione(Missione* m, TipoMissione tipo, const char* nome, 
-                         const char* descrizione, int obiettiviTotali);
+bool copiaGestoreMissioni(GestoreMissioni* destinazione, const GestoreMissioni* sorgente);
 
 // --- FUNZIONI DI VISUALIZZAZIONE MENU ---
 
@@ -60,14 +91,14 @@ int mostraMenuMissioni(const GestoreMissioni* gestore);
 
 /**
  * Mostra il menu durante una missione in corso
- * Include: Esplora, Negozio, Inventario, Torna al Villaggio
+ * Include: Esplora, Negozio, Inventario, Torna al Villaggio, Mappa, Registro
  */
-void mostraMenuDuranteMissione(const Missione* missione, const Eroe* eroe);
+void mostraMenuDuranteMissione(const GestoreMissioni* gestore, TipoMissione tipo, const Eroe* eroe);
 
 /**
  * Mostra lo stato di avanzamento della missione corrente
  */
-void mostraStatoMissione(const Missione* missione);
+void mostraStatoMissione(const GestoreMissioni* gestore, TipoMissione tipo);
 
 // --- FUNZIONI DI GESTIONE MISSIONI ---
 
@@ -85,63 +116,89 @@ TipoMissione selezionaMissione(GestoreMissioni* gestore);
 bool eseguiMissione(GestoreMissioni* gestore, Eroe* eroe, TipoMissione tipo);
 
 /**
- * Completa una missione, aggiorna i contatori e sblocca eventualmente la finale
+ * Completa una missione, aggiorna i contatori e sblocca le missioni che
+ * dipendono da lei (costo proporzionale al numero di dipendenti)
  */
 void completaMissione(GestoreMissioni* gestore, TipoMissione tipo);
 
+/**
+ * Come completaMissione() ma senza messaggi: usata per ripristinare lo stato
+ * delle missioni quando si carica una partita
+ */
+void ripristinaMissioneCompletata(GestoreMissioni* gestore, TipoMissione tipo);
+
 /**
  * Incrementa il contatore degli obiettivi completati (es: nemico sconfitto)
+ * Non stampa nulla: durante una missione viene chiamata dall'iscritto a
+ * EVENTO_NEMICO_UCCISO e il messaggio arriva da un iscritto separato
  */
-void incrementaObiettivi(Missione* missione);
+void incrementaObiettivi(GestoreMissioni* gestore, TipoMissione tipo);
 
 /**
  * Segna un oggetto speciale come recuperato (es: chiave, spada dell'eroe)
+ * Non stampa nulla, come incrementaObiettivi() (evento EVENTO_OGGETTO_RECUPERATO)
  */
-void segnaOggettoRecuperato(Missione* missione);
+void segnaOggettoRecuperato(GestoreMissioni* gestore, TipoMissione tipo);
 
 // --- FUNZIONI DI CONTROLLO STATO ---
 
 /**
  * Verifica se una missione è completata
  */
-bool missioneCompletata(const Missione* missione);
+bool missioneCompletata(const GestoreMissioni* gestore, TipoMissione tipo);
 
 /**
  * Verifica se una missione è accessibile/sbloccata
  */
-bool missioneSbloccata(const Missione* missione);
+bool missioneSbloccata(const GestoreMissioni* gestore, TipoMissione tipo);
+
+/**
+ * Verifica se l'oggetto speciale della missione è stato recuperato
+ */
+bool oggettoRecuperato(const GestoreMissioni* gestore, TipoMissione tipo);
 
 /**
- * Verifica se tutte le missioni preliminari sono completate
- * (necessario per sbloccare la missione finale)
+ * Numero di obiettivi raggiunti nella missione
  */
-bool tutteLePreliminariCompletate(const GestoreMissioni* gestore);
+int obiettiviCompletati(const GestoreMissioni* gestore, TipoMissione tipo);
+
+/**
+ * Verifica se tutti i prerequisiti di una missione sono completati
+ * (necessario per sbloccarla); costo costante grazie al contatore
+ */
+bool prerequisitiCompletati(const GestoreMissioni* gestore, TipoMissione tipo);
 
 /**
  * Verifica se gli obiettivi della missione sono stati raggiunti
  */
-bool obiettiviRaggiunti(const Missione* missione);
+bool obiettiviRaggiunti(const GestoreMissioni* gestore, TipoMissione tipo);
 
 /**
- * Sblocca la missione finale quando le 3 missioni base sono completate
+ * Sblocca una missione e annuncia lo sblocco (con più enfasi per la finale)
  */
-void sbloccaMissioneFinale(GestoreMissioni* gestore);
+void sbloccaMissione(GestoreMissioni* gestore, TipoMissione tipo);
 
 // --- FUNZIONI DI UTILITÀ ---
 
 /**
- * Ottiene il nome di una missione dal suo tipo
+ * Ottiene il nome di una missione dal suo tipo (letto dal catalogo)
  */
 const char* getNomeMissione(TipoMissione tipo);
 
 /**
- * Ottiene la descrizione dell'obiettivo di una missione
+ * Ottiene la descrizione dell'obiettivo di una missione (letta dal catalogo)
  */
 const char* getDescrizioneMissione(TipoMissione tipo);
 
 /**
- * Ritorna il puntatore alla missione specifica nel gestore
+ * Ritorna la definizione (dati immutabili) di una missione del gestore
+ * NULL se tipo non è un id valido
+ */
+const DefinizioneMissione* getMissione(const GestoreMissioni* gestore, TipoMissione tipo);
+
+/**
+ * Stanze per lato del dungeon di una missione (cresce con i prerequisiti)
  */
-Missione* getMissione(GestoreMissioni* gestore, TipoMissione tipo);
+int latoDungeonMissione(const DefinizioneMissione* d);
 
 #endif // MISSIONI_H
\ No newline at end of file
@@ -0,0 +1,44 @@
+/**
+ * @file opzioni.c
+ * @brief Tabelle di smistamento dei menu generate a tempo di compilazione
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * Le liste di voci di opzioni.h vengono espanse due volte per ogni menu:
+ * una per riempire la tabella di 256 elementi con gli inizializzatori designati
+ * ([tasto] = azione), una per l'elenco delle voci da stampare.
+ * Tutto è costante e viene calcolato dal compilatore.
+ */
+
+#include "opzioni.h"
+#include "schermo.h"
+#include "utils.h"
+
+#define GENERA_CELLA(tasto, azione, etichetta) [(unsigned char)(tasto)] = (uint8_t)(azione),
+#define GENERA_CELLA_ALIAS(tasto, azione)      [(unsigned char)(tasto)] = (uint8_t)(azione),
+#define GENERA_VOCE(tasto, azione, etichetta)  { (tasto), (uint8_t)(azione), (etichetta) },
+#define IGNORA_ALIAS(tasto, azione)
+
+/// @brief Genera tabella, voci e descrizione di un menu a partire dalla sua lista
+#define DEFINISCI_MENU(nome, VOCI) \
+    static const uint8_t TABELLA_##nome[256] = { VOCI(GENERA_CELLA, GENERA_CELLA_ALIAS) }; \
+    static const VoceMenu VOCI_##nome[] = { VOCI(GENERA_VOCE, IGNORA_ALIAS) }; \
+    const DefinizioneMenu nome = { \
+        TABELLA_##nome, VOCI_##nome, (int)(sizeof(VOCI_##nome) / sizeof(VOCI_##nome[0])) \
+    };
+
+DEFINISCI_MENU(MENU_PRINCIPALE,         VOCI_MENU_PRINCIPALE)
+DEFINISCI_MENU(MENU_PRINCIPALE_TRUCCHI, VOCI_MENU_PRINCIPALE_TRUCCHI)
+DEFINISCI_MENU(MENU_VILLAGGIO,          VOCI_MENU_VILLAGGIO)
+DEFINISCI_MENU(MENU_MISSIONE,           VOCI_MENU_MISSIONE)
+DEFINISCI_MENU(MENU_SALVATAGGIO,        VOCI_MENU_SALVATAGGIO)
+DEFINISCI_MENU(MENU_MODIFICA,           VOCI_MENU_MODIFICA)
+DEFINISCI_MENU(MENU_CONFERMA,           VOCI_MENU_CONFERMA)
+
+void stampaVociMenu(const DefinizioneMenu* menu) {
+    MISURA_SONDA(SONDA_STAMPA_MENU);
+    for (int i = 0; i < menu->numeroVoci; i++) {
+        stampa("%c. %s\n", menu->voci[i].tasto, menu->voci[i].etichetta);
+    }
+}
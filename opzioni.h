@@ -0,0 +1,118 @@
+#ifndef OPZIONI_H
+#define OPZIONI_H
+
+#include <stdint.h>
+
+/**
+ * Descrizione dei menu del gioco
+ *
+ * Ogni menu è definito UNA sola volta con una lista di voci:
+ *   VOCE(tasto, azione, etichetta)  -> opzione mostrata a schermo
+ *   ALIAS(tasto, azione)            -> tasto alternativo per la stessa azione
+ * Dalla lista vengono generati a tempo di compilazione:
+ *   - l'enum delle azioni del menu (0 = nessuna azione)
+ *   - la tabella di 256 elementi tasto -> azione
+ *   - l'elenco delle voci da stampare
+ * Validare e smistare un tasto costa quindi un solo accesso alla tabella.
+ */
+
+#define AZIONE_NESSUNA 0                    // Valore della tabella per i tasti non validi
+
+// --- DEFINIZIONE DEI MENU ---
+
+#define VOCI_MENU_PRINCIPALE(VOCE, ALIAS) \
+    VOCE('1', PRINCIPALE_NUOVA_PARTITA, "Nuova partita") \
+    VOCE('2', PRINCIPALE_CARICA,        "Carica salvataggio") \
+    VOCE('0', PRINCIPALE_ESCI,          "Esci")
+
+// Il menu principale con i trucchi attivi aggiunge solo l'opzione 3
+#define VOCI_MENU_PRINCIPALE_TRUCCHI(VOCE, ALIAS) \
+    VOCE('1', PRINCIPALE_NUOVA_PARTITA, "Nuova partita") \
+    VOCE('2', PRINCIPALE_CARICA,        "Carica salvataggio") \
+    VOCE('3', PRINCIPALE_TRUCCHI,       "Trucchi") \
+    VOCE('0', PRINCIPALE_ESCI,          "Esci")
+
+#define VOCI_MENU_VILLAGGIO(VOCE, ALIAS) \
+    VOCE('1', VILLAGGIO_MISSIONE,   "Intraprendi una missione") \
+    VOCE('2', VILLAGGIO_RIPOSA,     "Riposati") \
+    VOCE('3', VILLAGGIO_INVENTARIO, "Inventario") \
+    VOCE('4', VILLAGGIO_SALVA,      "Salva la partita") \
+    VOCE('5', VILLAGGIO_ESCI,       "Esci")
+
+#define VOCI_MENU_MISSIONE(VOCE, ALIAS) \
+    VOCE('1', AZIONE_ESPLORA,     "Esplora stanza del Dungeon") \
+    VOCE('2', AZIONE_NEGOZIO,     "Negozio") \
+    VOCE('3', AZIONE_INVENTARIO,  "Inventario") \
+    VOCE('4', AZIONE_TORNA,       "Torna al Villaggio") \
+    VOCE('5', AZIONE_MAPPA,       "Mappa del Dungeon") \
+    VOCE('6', AZIONE_REGISTRO,    "Registro dei combattimenti")
+
+#define VOCI_MENU_SALVATAGGIO(VOCE, ALIAS) \
+    VOCE('1', SALVATAGGIO_CARICA,  "Carica") \
+    VOCE('2', SALVATAGGIO_ELIMINA, "Elimina") \
+    VOCE('3', SALVATAGGIO_ANNULLA, "Annulla")
+
+#define VOCI_MENU_MODIFICA(VOCE, ALIAS) \
+    VOCE('1', MODIFICA_VITA,    "Vita") \
+    VOCE('2', MODIFICA_MONETE,  "Monete") \
+    VOCE('3', MODIFICA_FINALE,  "Sblocca Missione Finale")
+
+#define VOCI_MENU_CONFERMA(VOCE, ALIAS) \
+    VOCE('S', CONFERMA_SI, "Sì") \
+    ALIAS('s', CONFERMA_SI) \
+    VOCE('N', CONFERMA_NO, "No") \
+    ALIAS('n', CONFERMA_NO)
+
+// --- ENUM DELLE AZIONI (generati dalle liste) ---
+
+#define GENERA_AZIONE(tasto, azione, etichetta) azione,
+#define IGNORA_ALIAS(tasto, azione)
+
+typedef enum { PRINCIPALE_NESSUNA = AZIONE_NESSUNA, VOCI_MENU_PRINCIPALE_TRUCCHI(GENERA_AZIONE, IGNORA_ALIAS) } AzionePrincipale;
+typedef enum { VILLAGGIO_NESSUNA = AZIONE_NESSUNA, VOCI_MENU_VILLAGGIO(GENERA_AZIONE, IGNORA_ALIAS) } AzioneVillaggio;
+typedef enum { AZIONE_MISSIONE_NESSUNA = AZIONE_NESSUNA, VOCI_MENU_MISSIONE(GENERA_AZIONE, IGNORA_ALIAS) } AzioneMissione;
+typedef enum { SALVATAGGIO_NESSUNA = AZIONE_NESSUNA, VOCI_MENU_SALVATAGGIO(GENERA_AZIONE, IGNORA_ALIAS) } AzioneSalvataggio;
+typedef enum { MODIFICA_NESSUNA = AZIONE_NESSUNA, VOCI_MENU_MODIFICA(GENERA_AZIONE, IGNORA_ALIAS) } AzioneModifica;
+typedef enum { CONFERMA_NESSUNA = AZIONE_NESSUNA, VOCI_MENU_CONFERMA(GENERA_AZIONE, IGNORA_ALIAS) } AzioneConferma;
+
+#undef GENERA_AZIONE
+#undef IGNORA_ALIAS
+
+// --- DESCRIZIONE DI UN MENU ---
+
+// Voce stampabile di un menu
+typedef struct {
+    char tasto;                    // Tasto da premere
+    uint8_t azione;                // Azione associata
+    const char* etichetta;         // Testo mostrato a schermo
+} VoceMenu;
+
+// Menu completo: tabella di smistamento più voci da stampare
+typedef struct {
+    const uint8_t* tabella;        // 256 elementi: tasto -> azione (AZIONE_NESSUNA se non valido)
+    const VoceMenu* voci;          // Voci nell'ordine di stampa
+    int numeroVoci;                // Numero di voci
+} DefinizioneMenu;
+
+extern const DefinizioneMenu MENU_PRINCIPALE;
+extern const DefinizioneMenu MENU_PRINCIPALE_TRUCCHI;
+extern const DefinizioneMenu MENU_VILLAGGIO;
+extern const DefinizioneMenu MENU_MISSIONE;
+extern const DefinizioneMenu MENU_SALVATAGGIO;
+extern const DefinizioneMenu MENU_MODIFICA;
+extern const DefinizioneMenu MENU_CONFERMA;
+
+/**
+ * Ritorna l'azione associata al tasto (AZIONE_NESSUNA se il tasto non è valido)
+ * Un solo accesso alla tabella, nessun confronto
+ */
+static inline int azioneMenu(const DefinizioneMenu* menu, char tasto) {
+    return menu->tabella[(unsigned char)tasto];
+}
+
+/**
+ * Stampa tutte le voci del menu nel formato "tasto. etichetta"
+ */
+void stampaVociMenu(const DefinizioneMenu* menu);
+
+#endif // OPZIONI_H
@@ -0,0 +1,331 @@
+/**
+ * @file padovan.c
+ * @brief Successione di Padovan: tabella, potenza di matrice e precisione arbitraria
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * La ricorrenza P(n + 3) = P(n + 1) + P(n) in forma matriciale è
+ *
+ *     | P(n + 3) |   | 0 1 1 |   | P(n + 2) |
+ *     | P(n + 2) | = | 1 0 0 | * | P(n + 1) |
+ *     | P(n + 1) |   | 0 1 0 |   | P(n)     |
+ *
+ * e partendo dal vettore (1, 1, 1) P(n) è la somma dell'ultima riga di M^n:
+ * con l'elevamento a potenza per quadrati bastano O(log n) prodotti 3x3.
+ */
+
+#include "padovan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * TABELLA
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief P(0) .. P(158): tutti i termini che stanno in 64 bit
+ *
+ * @details
+ * Generata con la ricorrenza in precisione arbitraria; P(159) supera 2^64.
+ * Il commento di ogni riga è l'indice del primo termine.
+ */
+const uint64_t TABELLA_PADOVAN[PADOVAN_TERMINI_64] = {
+    1ULL, 1ULL, 1ULL,                                                       // 0
+    2ULL, 2ULL, 3ULL,                                                       // 3
+    4ULL, 5ULL, 7ULL,                                                       // 6
+    9ULL, 12ULL, 16ULL,                                                     // 9
+    21ULL, 28ULL, 37ULL,                                                    // 12
+    49ULL, 65ULL, 86ULL,                                                    // 15
+    114ULL, 151ULL, 200ULL,                                                 // 18
+    265ULL, 351ULL, 465ULL,                                                 // 21
+    616ULL, 816ULL, 1081ULL,                                                // 24
+    1432ULL, 1897ULL, 2513ULL,                                              // 27
+    3329ULL, 4410ULL, 5842ULL,                                              // 30
+    7739ULL, 10252ULL, 13581ULL,                                            // 33
+    17991ULL, 23833ULL, 31572ULL,                                           // 36
+    41824ULL, 55405ULL, 73396ULL,                                           // 39
+    97229ULL, 128801ULL, 170625ULL,                                         // 42
+    226030ULL, 299426ULL, 396655ULL,                                        // 45
+    525456ULL, 696081ULL, 922111ULL,                                        // 48
+    1221537ULL, 1618192ULL, 2143648ULL,                                     // 51
+    2839729ULL, 3761840ULL, 4983377ULL,                                     // 54
+    6601569ULL, 8745217ULL, 11584946ULL,                                    // 57
+    15346786ULL, 20330163ULL, 26931732ULL,                                  // 60
+    35676949ULL, 47261895ULL, 62608681ULL,                                  // 63
+    82938844ULL, 109870576ULL, 145547525ULL,                                // 66
+    192809420ULL, 255418101ULL, 338356945ULL,                               // 69
+    448227521ULL, 593775046ULL, 786584466ULL,                               // 72
+    1042002567ULL, 1380359512ULL, 1828587033ULL,                            // 75
+    2422362079ULL, 3208946545ULL, 4250949112ULL,                            // 78
+    5631308624ULL, 7459895657ULL, 9882257736ULL,                            // 81
+    13091204281ULL, 17342153393ULL, 22973462017ULL,                         // 84
+    30433357674ULL, 40315615410ULL, 53406819691ULL,                         // 87
+    70748973084ULL, 93722435101ULL, 124155792775ULL,                        // 90
+    164471408185ULL, 217878227876ULL, 288627200960ULL,                      // 93
+    382349636061ULL, 506505428836ULL, 670976837021ULL,                      // 96
+    888855064897ULL, 1177482265857ULL, 1559831901918ULL,                    // 99
+    2066337330754ULL, 2737314167775ULL, 3626169232672ULL,                   // 102
+    4803651498529ULL, 6363483400447ULL, 8429820731201ULL,                   // 105
+    11167134898976ULL, 14793304131648ULL, 19596955630177ULL,                // 108
+    25960439030624ULL, 34390259761825ULL, 45557394660801ULL,                // 111
+    60350698792449ULL, 79947654422626ULL, 105908093453250ULL,               // 114
+    140298353215075ULL, 185855747875876ULL, 246206446668325ULL,             // 117
+    326154101090951ULL, 432062194544201ULL, 572360547759276ULL,             // 120
+    758216295635152ULL, 1004422742303477ULL, 1330576843394428ULL,           // 123
+    1762639037938629ULL, 2334999585697905ULL, 3093215881333057ULL,          // 126
+    4097638623636534ULL, 5428215467030962ULL, 7190854504969591ULL,          // 129
+    9525854090667496ULL, 12619069972000553ULL, 16716708595637087ULL,        // 132
+    22144924062668049ULL, 29335778567637640ULL, 38861632658305136ULL,       // 135
+    51480702630305689ULL, 68197411225942776ULL, 90342335288610825ULL,       // 138
+    119678113856248465ULL, 158539746514553601ULL, 210020449144859290ULL,    // 141
+    278217860370802066ULL, 368560195659412891ULL, 488238309515661356ULL,    // 144
+    646778056030214957ULL, 856798505175074247ULL, 1135016365545876313ULL,   // 147
+    1503576561205289204ULL, 1991814870720950560ULL, 2638592926751165517ULL, // 150
+    3495391431926239764ULL, 4630407797472116077ULL, 6133984358677405281ULL, // 153
+    8125799229398355841ULL, 10764392156149521358ULL, 14259783588075761122ULL, // 156
+};
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * ARITMETICA MODULARE E POTENZA DI MATRICE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief (a + b) mod m con a, b < m (m = 0 vuol dire 2^64)
+static inline uint64_t sommaModulo(uint64_t a, uint64_t b, uint64_t m) {
+    uint64_t s = a + b;
+    if (m != 0 && (s < a || s >= m)) s -= m;
+    return s;
+}
+
+/// @brief (a * b) mod m con a, b < m (m = 0 vuol dire 2^64)
+static inline uint64_t prodottoModulo(uint64_t a, uint64_t b, uint64_t m) {
+    if (m == 0) return a * b;
+#ifdef __SIZEOF_INT128__
+    return (uint64_t)((unsigned __int128)a * b % m);
+#else
+    // Senza interi a 128 bit: raddoppi e somme, sempre minori di m
+    uint64_t r = 0;
+    while (b) {
+        if (b & 1) r = sommaModulo(r, a, m);
+        a = sommaModulo(a, a, m);
+        b >>= 1;
+    }
+    return r;
+#endif
+}
+
+/// @brief r = a * b (matrici 3x3 modulo m); r può coincidere con a o b
+static void moltiplicaMatrici(uint64_t r[3][3], const uint64_t a[3][3], const uint64_t b[3][3], uint64_t m) {
+    uint64_t t[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            uint64_t s = 0;
+            for (int k = 0; k < 3; k++) {
+                s = sommaModulo(s, prodottoModulo(a[i][k], b[k][j], m), m);
+            }
+            t[i][j] = s;
+        }
+    }
+    memcpy(r, t, sizeof(t));
+}
+
+uint64_t padovanModulo(uint64_t n, uint64_t modulo) {
+    if (modulo == 1) return 0;
+    if (n < PADOVAN_TERMINI_64) {
+        return modulo ? TABELLA_PADOVAN[n] % modulo : TABELLA_PADOVAN[n];
+    }
+
+    uint64_t base[3][3] = { {0, 1, 1}, {1, 0, 0}, {0, 1, 0} };
+    uint64_t potenza[3][3] = { {1, 0, 0}, {0, 1, 0}, {0, 0, 1} };
+
+    while (n) {
+        if (n & 1) moltiplicaMatrici(potenza, potenza, base, modulo);
+        moltiplicaMatrici(base, base, base, modulo);
+        n >>= 1;
+    }
+
+    // M^n * (1, 1, 1): l'ultima componente è P(n)
+    return sommaModulo(sommaModulo(potenza[2][0], potenza[2][1], modulo), potenza[2][2], modulo);
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * RIEMPIMENTO A BLOCCHI
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Riempie un array di termini consecutivi
+ *
+ * @details
+ * I primi tre termini vengono dalla tabella o dalla potenza di matrice; poi
+ * P(i) = P(i - 2) + P(i - 3) e P(i + 1) = P(i - 1) + P(i - 2) dipendono solo
+ * da termini già scritti, quindi si calcolano insieme: con SSE2 sono una
+ * sola somma di due coppie di uint64_t caricate da destinazione[i - 2] e
+ * destinazione[i - 3].
+ */
+void padovanRiempi(uint64_t* destinazione, uint64_t primo, size_t quanti) {
+    size_t i = 0;
+    for (; i < quanti && i < 3; i++) {
+        destinazione[i] = padovanModulo(primo + i, 0);
+    }
+
+#if defined(__SSE2__)
+    for (; i + 2 <= quanti; i += 2) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(destinazione + i - 2));
+        __m128i b = _mm_loadu_si128((const __m128i*)(destinazione + i - 3));
+        _mm_storeu_si128((__m128i*)(destinazione + i), _mm_add_epi64(a, b));
+    }
+#endif
+
+    for (; i < quanti; i++) {
+        destinazione[i] = destinazione[i - 2] + destinazione[i - 3];
+    }
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * PRECISIONE ARBITRARIA
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Assicura spazio per almeno 'cifre' cifre
+static bool riservaCifre(NumeroGrande* numero, size_t cifre) {
+    if (numero->capacita >= cifre) return true;
+
+    uint32_t* nuove = realloc(numero->cifre, sizeof(uint32_t) * cifre);
+    if (nuove == NULL) return false;
+    numero->cifre = nuove;
+    numero->capacita = cifre;
+    return true;
+}
+
+/// @brief Scrive un valore a 64 bit in un array di cifre, ritorna le cifre usate
+static size_t daInteroA64(uint32_t* cifre, uint64_t valore) {
+    cifre[0] = (uint32_t)valore;
+    cifre[1] = (uint32_t)(valore >> 32);
+    return cifre[1] ? 2 : 1;
+}
+
+/**
+ * @brief Valore esatto di P(n)
+ *
+ * @details
+ * Si parte dagli ultimi tre termini della tabella e si applica la ricorrenza
+ * con tre numeri che ruotano: il più piccolo viene sostituito in place dalla
+ * somma dei due più piccoli. P(n) ha circa 0.406 * n bit, quindi lo spazio
+ * si alloca una sola volta all'inizio.
+ */
+bool padovanGrande(uint64_t n, NumeroGrande* risultato) {
+    if (risultato == NULL || n > PADOVAN_MAX_GRANDE) return false;
+
+    if (n < PADOVAN_TERMINI_64) {
+        if (!riservaCifre(risultato, 2)) return false;
+        risultato->numeroCifre = daInteroA64(risultato->cifre, TABELLA_PADOVAN[n]);
+        return true;
+    }
+
+    size_t capacita = (size_t)(n / 64) + 4;
+    uint32_t* blocco = calloc(3 * capacita, sizeof(uint32_t));
+    if (blocco == NULL || !riservaCifre(risultato, capacita)) {
+        free(blocco);
+        return false;
+    }
+
+    // x[0] = P(k), x[1] = P(k + 1), x[2] = P(k + 2)
+    uint32_t* x[3] = { blocco, blocco + capacita, blocco + 2 * capacita };
+    size_t cifre[3];
+    uint64_t k = PADOVAN_TERMINI_64 - 3;
+    for (int j = 0; j < 3; j++) {
+        cifre[j] = daInteroA64(x[j], TABELLA_PADOVAN[k + j]);
+    }
+
+    for (; k < n; k++) {
+        // P(k + 3) = P(k + 1) + P(k), scritto al posto di P(k) (P(k + 1) >= P(k))
+        uint64_t riporto = 0;
+        size_t c = 0;
+        for (; c < cifre[1]; c++) {
+            riporto += (uint64_t)x[0][c] + x[1][c];
+            x[0][c] = (uint32_t)riporto;
+            riporto >>= 32;
+        }
+        if (riporto) x[0][c++] = (uint32_t)riporto;
+        cifre[0] = c;
+
+        uint32_t* t = x[0];  x[0] = x[1];  x[1] = x[2];  x[2] = t;
+        size_t tc = cifre[0]; cifre[0] = cifre[1]; cifre[1] = cifre[2]; cifre[2] = tc;
+    }
+
+    memcpy(risultato->cifre, x[0], sizeof(uint32_t) * cifre[0]);
+    risultato->numeroCifre = cifre[0];
+    free(blocco);
+    return true;
+}
+
+/**
+ * @brief Conversione in base 10
+ *
+ * @details
+ * Divisioni ripetute per 10^9 su una copia del numero: ogni divisione
+ * produce nove cifre decimali, dalla meno significativa.
+ */
+size_t numeroGrandeDecimale(const NumeroGrande* numero, char* buffer, size_t dimensione) {
+    if (numero == NULL || numero->numeroCifre == 0) {
+        if (dimensione > 0) buffer[0] = '\0';
+        return 0;
+    }
+
+    size_t n = numero->numeroCifre;
+    uint32_t* copia = malloc(sizeof(uint32_t) * n);
+    uint32_t* blocchi = malloc(sizeof(uint32_t) * (n * 10 / 9 + 2));   // 32 bit < 9.64 cifre decimali
+    if (copia == NULL || blocchi == NULL) {
+        free(copia);
+        free(blocchi);
+        if (dimensione > 0) buffer[0] = '\0';
+        return 0;
+    }
+    memcpy(copia, numero->cifre, sizeof(uint32_t) * n);
+
+    size_t numeroBlocchi = 0;
+    while (n > 0) {
+        uint64_t resto = 0;
+        for (size_t c = n; c-- > 0;) {
+            uint64_t corrente = (resto << 32) | copia[c];
+            copia[c] = (uint32_t)(corrente / 1000000000u);
+            resto = corrente % 1000000000u;
+        }
+        blocchi[numeroBlocchi++] = (uint32_t)resto;
+        while (n > 0 && copia[n - 1] == 0) n--;
+    }
+
+    // Il blocco più significativo senza zeri iniziali, gli altri sempre da nove cifre
+    char testa[16];
+    int lunghezzaTesta = snprintf(testa, sizeof(testa), "%u", (unsigned)blocchi[numeroBlocchi - 1]);
+    size_t totale = (size_t)lunghezzaTesta + 9 * (numeroBlocchi - 1);
+
+    if (dimensione > 0) {
+        size_t scritti = 0;
+        for (int j = 0; j < lunghezzaTesta && scritti + 1 < dimensione; j++) {
+            buffer[scritti++] = testa[j];
+        }
+        for (size_t b = numeroBlocchi - 1; b-- > 0 && scritti + 1 < dimensione;) {
+            char nove[10];
+            snprintf(nove, sizeof(nove), "%09u", (unsigned)blocchi[b]);
+            for (int j = 0; j < 9 && scritti + 1 < dimensione; j++) {
+                buffer[scritti++] = nove[j];
+            }
+        }
+        buffer[scritti] = '\0';
+    }
+
+    free(copia);
+    free(blocchi);
+    return totale;
+}
+
+void liberaNumeroGrande(NumeroGrande* numero) {
+    if (numero == NULL) return;
+    free(numero->cifre);
+    memset(numero, 0, sizeof(*numero));
+}
@@ -0,0 +1,73 @@
+#ifndef PADOVAN_H
+#define PADOVAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Successione di Padovan: P(0) = P(1) = P(2) = 1, P(n) = P(n - 2) + P(n - 3)
+ * (1, 1, 1, 2, 2, 3, 4, 5, 7, 9, 12, 16, 21, ...)
+ * Cresce più lentamente di Fibonacci (rapporto ~1.3247), quindi è adatta a
+ * scalare difficoltà e dimensioni dei dungeon senza salti esagerati.
+ *
+ * Tre modi di calcolarla:
+ *   - padovan(): tabella precalcolata, O(1), per i termini che stanno in 64 bit
+ *   - padovanModulo(): potenza di matrice in O(log n), per n qualsiasi
+ *   - padovanGrande(): valore esatto a precisione arbitraria
+ */
+
+#define PADOVAN_TERMINI_64 159             // P(0) .. P(158) stanno in un uint64_t
+#define PADOVAN_MAX_GRANDE 100000          // Indice massimo accettato da padovanGrande()
+
+// Tabella P(0) .. P(PADOVAN_TERMINI_64 - 1), costante e generata prima della compilazione
+extern const uint64_t TABELLA_PADOVAN[PADOVAN_TERMINI_64];
+
+/**
+ * P(n) con una lettura di tabella
+ * Oltre PADOVAN_TERMINI_64 il valore non sta in 64 bit: ritorna UINT64_MAX
+ */
+static inline uint64_t padovan(uint64_t n) {
+    return n < PADOVAN_TERMINI_64 ? TABELLA_PADOVAN[n] : UINT64_MAX;
+}
+
+/**
+ * P(n) mod 'modulo' con la potenza della matrice 3x3 della ricorrenza, O(log n)
+ * Con modulo 0 il calcolo è modulo 2^64 (aritmetica naturale degli uint64_t)
+ */
+uint64_t padovanModulo(uint64_t n, uint64_t modulo);
+
+/**
+ * Riempie destinazione[i] = P(primo + i) mod 2^64 per i in [0, quanti)
+ * I valori sono esatti finché primo + i < PADOVAN_TERMINI_64
+ * Dopo i primi tre termini la ricorrenza calcola due termini per volta (SSE2 se disponibile)
+ */
+void padovanRiempi(uint64_t* destinazione, uint64_t primo, size_t quanti);
+
+// --- PRECISIONE ARBITRARIA ---
+
+// Intero senza segno a precisione arbitraria (cifre in base 2^32, la meno significativa per prima)
+typedef struct {
+    uint32_t* cifre;               // Cifre (NULL finché non viene usato)
+    size_t numeroCifre;            // Cifre significative (almeno 1)
+    size_t capacita;               // Cifre allocate
+} NumeroGrande;
+
+/**
+ * Calcola il valore esatto di P(n) in 'risultato' (riusa la memoria già allocata)
+ * Ritorna false se n > PADOVAN_MAX_GRANDE o la memoria non basta
+ */
+bool padovanGrande(uint64_t n, NumeroGrande* risultato);
+
+/**
+ * Scrive il numero in base 10 in 'buffer' (terminato da '\0', troncato se non entra)
+ * Ritorna il numero di cifre decimali del valore
+ */
+size_t numeroGrandeDecimale(const NumeroGrande* numero, char* buffer, size_t dimensione);
+
+/**
+ * Libera la memoria di un numero grande
+ */
+void liberaNumeroGrande(NumeroGrande* numero);
+
+#endif // PADOVAN_H
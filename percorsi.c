@@ -0,0 +1,272 @@
+/**
+ * @file percorsi.c
+ * @brief Ricerca di percorsi (A*) e campi di distanza nel dungeon
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * Ogni passo tra due stanze costa 1 e sposta di una cella sulla griglia,
+ * quindi la distanza di Manhattan tra le celle è un'euristica consistente
+ * per A*: ogni stanza viene chiusa al massimo una volta.
+ *
+ * I campi di distanza sfruttano il fatto che il grafo può solo crescere
+ * (una stanza materializzata non sparisce e le sue uscite non cambiano):
+ * aggiungere stanze può solo accorciare le distanze, quindi basta
+ * propagare le diminuzioni a partire dalle stanze nuove.
+ */
+
+#include "percorsi.h"
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Distanza di Manhattan tra le celle di due stanze
+static inline int32_t distanzaGriglia(const Dungeon* d, int a, int b) {
+    int dx = a % d->larghezza - b % d->larghezza;
+    int dy = a / d->larghezza - b / d->larghezza;
+    return (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * HEAP BINARIO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+static void inserisciHeap(RicercaPercorsi* r, int32_t priorita, int slot) {
+    uint64_t chiave = (uint64_t)(uint32_t)priorita << 32 | (uint32_t)slot;
+    int i = r->dimensioneHeap++;
+
+    while (i > 0) {
+        int padre = (i - 1) / 2;
+        if (r->heap[padre] <= chiave) break;
+        r->heap[i] = r->heap[padre];
+        i = padre;
+    }
+    r->heap[i] = chiave;
+}
+
+static int estraiHeap(RicercaPercorsi* r) {
+    int slot = (int)(uint32_t)r->heap[0];
+    uint64_t ultima = r->heap[--r->dimensioneHeap];
+    int n = r->dimensioneHeap;
+    int i = 0;
+
+    for (;;) {
+        int figlio = 2 * i + 1;
+        if (figlio >= n) break;
+        if (figlio + 1 < n && r->heap[figlio + 1] < r->heap[figlio]) figlio++;
+        if (ultima <= r->heap[figlio]) break;
+        r->heap[i] = r->heap[figlio];
+        i = figlio;
+    }
+    if (n > 0) r->heap[i] = ultima;
+    return slot;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * A*
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Adegua gli array della ricerca alla capacità del dungeon
+ *
+ * @details
+ * Ogni stanza entra nell'heap al più una volta per ogni uscita (più la
+ * partenza), quindi 4 * capacità + 1 posti bastano sempre.
+ */
+static bool preparaRicerca(RicercaPercorsi* r, const Dungeon* d) {
+    if (r->capacita >= d->capacita) return true;
+
+    int capacita = d->capacita;
+    size_t dimensione = sizeof(uint64_t) * (4 * (size_t)capacita + 1) +
+                        (sizeof(int32_t) * 2 + sizeof(uint32_t) * 2) * (size_t)capacita;
+    char* p = allocaMemoria(d->arena, dimensione);
+    if (p == NULL) return false;
+
+    rilasciaMemoria(r->arena, r->heap);
+    r->arena = d->arena;
+    r->heap = (uint64_t*)p;          p += sizeof(uint64_t) * (4 * (size_t)capacita + 1);
+    r->costo = (int32_t*)p;          p += sizeof(int32_t) * (size_t)capacita;
+    r->padre = (int32_t*)p;          p += sizeof(int32_t) * (size_t)capacita;
+    r->visitata = (uint32_t*)p;      p += sizeof(uint32_t) * (size_t)capacita;
+    r->chiusa = (uint32_t*)p;
+    r->capacitaHeap = 4 * capacita + 1;
+    r->capacita = capacita;
+    r->ricerca = 0;
+    return true;
+}
+
+void liberaRicercaPercorsi(RicercaPercorsi* r) {
+    if (r == NULL) return;
+    rilasciaMemoria(r->arena, r->heap);
+    memset(r, 0, sizeof(*r));
+}
+
+int cercaPercorso(RicercaPercorsi* r, const Dungeon* d, int partenza, int arrivo,
+                  int* percorso, int massimo) {
+    MISURA_SONDA(SONDA_CERCA_PERCORSO);
+    int sp = slotStanza(d, partenza);
+    int sa = slotStanza(d, arrivo);
+    if (sp < 0 || sa < 0 || !preparaRicerca(r, d)) return -1;
+
+    // Un numero di ricerca nuovo invalida i dati della ricerca precedente senza azzerarli
+    if (++r->ricerca == 0) {
+        memset(r->visitata, 0, sizeof(uint32_t) * (size_t)r->capacita);
+        memset(r->chiusa, 0, sizeof(uint32_t) * (size_t)r->capacita);
+        r->ricerca = 1;
+    }
+    uint32_t ricerca = r->ricerca;
+
+    r->dimensioneHeap = 0;
+    r->costo[sp] = 0;
+    r->padre[sp] = -1;
+    r->visitata[sp] = ricerca;
+    inserisciHeap(r, distanzaGriglia(d, partenza, arrivo), sp);
+
+    while (r->dimensioneHeap > 0) {
+        int u = estraiHeap(r);
+        if (r->chiusa[u] == ricerca) continue;   // Copia superata da un costo migliore
+        r->chiusa[u] = ricerca;
+        if (u == sa) break;
+
+        int id = d->idStanza[u];
+        for (int direzione = USCITA_NORD; direzione <= USCITA_OVEST; direzione <<= 1) {
+            if (!(d->uscite[u] & direzione)) continue;
+
+            int vicina = stanzaVicina(d, id, direzione);
+            int v = slotStanza(d, vicina);
+            if (v < 0 || r->chiusa[v] == ricerca) continue;
+
+            int32_t costo = r->costo[u] + 1;
+            if (r->visitata[v] != ricerca || costo < r->costo[v]) {
+                r->visitata[v] = ricerca;
+                r->costo[v] = costo;
+                r->padre[v] = u;
+                inserisciHeap(r, costo + distanzaGriglia(d, vicina, arrivo), v);
+            }
+        }
+    }
+
+    if (r->chiusa[sa] != ricerca) return -1;
+
+    int lunghezza = r->costo[sa] + 1;
+    if (percorso != NULL && lunghezza <= massimo) {
+        int i = lunghezza;
+        for (int s = sa; s >= 0; s = r->padre[s]) {
+            percorso[--i] = d->idStanza[s];
+        }
+    }
+    return lunghezza;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CAMPI DI DISTANZA
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Adegua gli array del campo alla capacità del dungeon (conservando i valori)
+static bool preparaCampo(CampoDistanze* c, const Dungeon* d) {
+    if (c->capacita >= d->capacita) return true;
+
+    int capacita = d->capacita;
+    int32_t* distanza = ingrandisciMemoria(c->arena, c->distanza, sizeof(int32_t) * (size_t)c->capacita,
+                                           sizeof(int32_t) * (size_t)capacita);
+    if (distanza == NULL) return false;
+    c->distanza = distanza;
+
+    uint8_t* passo = ingrandisciMemoria(c->arena, c->passo, (size_t)c->capacita, (size_t)capacita);
+    if (passo == NULL) return false;
+    c->passo = passo;
+
+    int* coda = ingrandisciMemoria(c->arena, c->coda, sizeof(int) * (size_t)c->capacita,
+                                   sizeof(int) * (size_t)capacita);
+    if (coda == NULL) return false;
+    c->coda = coda;
+
+    c->capacita = capacita;
+    return true;
+}
+
+bool inizializzaCampoDistanze(CampoDistanze* c, const Dungeon* d, int bersaglio) {
+    memset(c, 0, sizeof(*c));
+    c->arena = d->arena;
+    c->bersaglio = bersaglio;
+    return aggiornaCampoDistanze(c, d);
+}
+
+/**
+ * @brief Inserisce nel campo le stanze nuove e propaga le distanze diminuite
+ *
+ * @details
+ * 1. Ogni stanza nuova prende la distanza migliore tra le vicine già nel
+ *    campo (0 se è il bersaglio) ed entra in coda se è raggiungibile.
+ * 2. Dalla coda: ogni stanza prova ad accorciare la distanza delle vicine;
+ *    quelle che migliorano entrano in coda a loro volta.
+ * Una stanza è in coda al massimo una volta per volta (lo segna la distanza
+ * negativa), quindi la coda circolare non supera il numero di stanze.
+ * Le stanze lontane dalle novità non vengono nemmeno guardate.
+ */
+bool aggiornaCampoDistanze(CampoDistanze* c, const Dungeon* d) {
+    MISURA_SONDA(SONDA_CAMPO_DISTANZE);
+    if (!preparaCampo(c, d)) return false;
+
+    int prima = c->stanzeAggiornate;
+    int n = d->stanzeMaterializzate;
+    int testa = 0, lunghezza = 0;
+
+    for (int s = prima; s < n; s++) {
+        c->distanza[s] = d->idStanza[s] == c->bersaglio ? 0 : DISTANZA_INFINITA;
+        c->passo[s] = 0;
+    }
+    c->stanzeAggiornate = n;
+
+    for (int s = prima; s < n; s++) {
+        int id = d->idStanza[s];
+        for (int direzione = USCITA_NORD; direzione <= USCITA_OVEST; direzione <<= 1) {
+            if (!(d->uscite[s] & direzione)) continue;
+            int v = slotStanza(d, stanzaVicina(d, id, direzione));
+            if (v >= 0 && v < prima && c->distanza[v] != DISTANZA_INFINITA &&
+                c->distanza[v] + 1 < c->distanza[s]) {
+                c->distanza[s] = c->distanza[v] + 1;
+                c->passo[s] = (uint8_t)direzione;
+            }
+        }
+        if (c->distanza[s] != DISTANZA_INFINITA) {
+            c->coda[(testa + lunghezza++) % c->capacita] = s;
+            c->distanza[s] = -c->distanza[s] - 1;   // In coda
+        }
+    }
+
+    while (lunghezza > 0) {
+        int u = c->coda[testa];
+        testa = (testa + 1) % c->capacita;
+        lunghezza--;
+        c->distanza[u] = -c->distanza[u] - 1;       // Fuori dalla coda
+
+        int id = d->idStanza[u];
+        for (int direzione = USCITA_NORD; direzione <= USCITA_OVEST; direzione <<= 1) {
+            if (!(d->uscite[u] & direzione)) continue;
+            int v = slotStanza(d, stanzaVicina(d, id, direzione));
+            if (v < 0) continue;
+
+            bool inCoda = c->distanza[v] < 0;
+            int32_t attuale = inCoda ? -c->distanza[v] - 1 : c->distanza[v];
+            if (c->distanza[u] + 1 >= attuale) continue;
+
+            c->passo[v] = (uint8_t)uscitaOpposta(direzione);
+            if (inCoda) {
+                c->distanza[v] = -(c->distanza[u] + 1) - 1;
+            } else {
+                c->distanza[v] = c->distanza[u] + 1;
+                c->coda[(testa + lunghezza++) % c->capacita] = v;
+                c->distanza[v] = -c->distanza[v] - 1;
+            }
+        }
+    }
+    return true;
+}
+
+void liberaCampoDistanze(CampoDistanze* c) {
+    if (c == NULL) return;
+    rilasciaMemoria(c->arena, c->distanza);
+    rilasciaMemoria(c->arena, c->passo);
+    rilasciaMemoria(c->arena, c->coda);
+    memset(c, 0, sizeof(*c));
+}
@@ -0,0 +1,103 @@
+#ifndef PERCORSI_H
+#define PERCORSI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "dungeon.h"
+
+/**
+ * Percorsi nel dungeon
+ * Il grafo è quello delle stanze materializzate: due stanze sono collegate se
+ * c'è un'uscita tra loro ed entrambe sono state materializzate. Tutti gli
+ * array sono indicizzati per slot, come quelli del dungeon, e vengono
+ * allocati una volta sola (crescono solo quando cresce il dungeon).
+ *
+ * Due strumenti:
+ *   - A*: percorso più breve tra due stanze, con heap binario preallocato
+ *   - campi di distanza: distanza e primo passo verso un bersaglio fisso
+ *     (ingresso, oggetto della missione) per ogni stanza. Si aggiornano
+ *     in modo incrementale quando vengono materializzate stanze nuove, e
+ *     rispondono a "dove vado adesso?" con una lettura di array
+ */
+
+#define DISTANZA_INFINITA INT32_MAX
+
+// Stato riutilizzabile per le ricerche A* (nessuna allocazione per ricerca)
+typedef struct {
+    uint64_t* heap;                // (f << 32) | slot: il minimo è la chiave più piccola
+    int dimensioneHeap;
+    int capacitaHeap;
+    int32_t* costo;                // Costo dal punto di partenza (valido se visitata[slot] == ricerca)
+    int32_t* padre;                // Slot precedente sul percorso
+    uint32_t* visitata;            // Numero della ricerca che ha raggiunto lo slot
+    uint32_t* chiusa;              // Numero della ricerca che ha chiuso lo slot
+    uint32_t ricerca;              // Numero della ricerca corrente (evita di azzerare gli array)
+    int capacita;                  // Slot allocati
+    Arena* arena;                  // Arena del dungeon dell'ultima ricerca (NULL = heap)
+} RicercaPercorsi;
+
+// Distanze di ogni stanza materializzata da un bersaglio
+typedef struct {
+    int bersaglio;                 // Id della stanza bersaglio
+    int32_t* distanza;             // Stanze da attraversare per arrivare al bersaglio
+    uint8_t* passo;                // USCITA_* del primo passo verso il bersaglio (0 = già arrivati o irraggiungibile)
+    int* coda;                     // Coda degli slot la cui distanza è diminuita
+    int stanzeAggiornate;          // Slot già inseriti nel campo
+    int capacita;                  // Slot allocati
+    Arena* arena;                  // Arena del dungeon (NULL = heap)
+} CampoDistanze;
+
+// --- A* ---
+
+/**
+ * Libera la memoria di una ricerca (la struttura può partire azzerata: si alloca da sola)
+ */
+void liberaRicercaPercorsi(RicercaPercorsi* r);
+
+/**
+ * Percorso più breve tra due stanze materializzate
+ * Scrive in 'percorso' gli id delle stanze dalla partenza all'arrivo
+ * (entrambe comprese) se ci stanno in 'massimo' elementi
+ * Ritorna il numero di stanze del percorso o -1 se non esiste
+ */
+int cercaPercorso(RicercaPercorsi* r, const Dungeon* d, int partenza, int arrivo,
+                  int* percorso, int massimo);
+
+// --- CAMPI DI DISTANZA ---
+
+/**
+ * Prepara un campo di distanza verso una stanza e lo calcola sulle stanze materializzate
+ * Ritorna false se la memoria non basta
+ */
+bool inizializzaCampoDistanze(CampoDistanze* c, const Dungeon* d, int bersaglio);
+
+/**
+ * Aggiunge al campo le stanze materializzate dopo l'ultimo aggiornamento
+ * Visita solo le stanze nuove e quelle la cui distanza diminuisce
+ * Ritorna false se la memoria non basta
+ */
+bool aggiornaCampoDistanze(CampoDistanze* c, const Dungeon* d);
+
+/**
+ * Libera la memoria di un campo
+ */
+void liberaCampoDistanze(CampoDistanze* c);
+
+/**
+ * Distanza dal bersaglio di una stanza (DISTANZA_INFINITA se non è raggiungibile
+ * con le stanze materializzate finora)
+ */
+static inline int32_t distanzaCampo(const CampoDistanze* c, const Dungeon* d, int id) {
+    int slot = slotStanza(d, id);
+    return slot >= 0 && slot < c->stanzeAggiornate ? c->distanza[slot] : DISTANZA_INFINITA;
+}
+
+/**
+ * Uscita da prendere per avvicinarsi al bersaglio (0 se si è già arrivati o non c'è strada)
+ */
+static inline int prossimoPassoCampo(const CampoDistanze* c, const Dungeon* d, int id) {
+    int slot = slotStanza(d, id);
+    return slot >= 0 && slot < c->stanzeAggiornate ? c->passo[slot] : 0;
+}
+
+#endif // PERCORSI_H
@@ -0,0 +1,346 @@
+/**
+ * @file registrazione.c
+ * @brief Registrazione e riproduzione deterministica delle sessioni di gioco
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * Ogni input consumato dai menu (caratteri di leggiCaratterePulito() e righe di
+ * tastieraLeggiRiga()) viene scritto in un log binario compatto insieme al seme
+ * della sessione e ai salvataggi presenti all'avvio. La riproduzione ricarica
+ * il log come uno script headless, ricrea quei salvataggi in una cartella di
+ * prova, reimposta il seme e riesegue menuPrincipale() senza output: una
+ * sessione lenta o con un bug diventa così riproducibile e misurabile ad ogni
+ * commit, senza toccare i salvataggi veri.
+ */
+
+#include "registrazione.h"
+#include "tastiera.h"
+#include "schermo.h"
+#include "menu.h"
+#include "salvataggi.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Numero massimo di byte di un varint a 64 bit
+#define MAX_BYTE_VARINT 10
+
+/// @brief File su cui si sta registrando (NULL = registrazione spenta)
+static FILE* fileRegistrazione = NULL;
+
+/// @brief true se atexit() è già stato chiamato
+static bool chiusuraRegistrata = false;
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CODIFICA VARINT
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Scrive un intero senza segno in formato varint LEB128
+ *
+ * @details
+ * 7 bit per byte, il bit alto indica che segue un altro byte:
+ * i caratteri ASCII dei menu occupano quindi un solo byte per record.
+ */
+static void scriviVarint(FILE* f, uint64_t valore) {
+    unsigned char buffer[MAX_BYTE_VARINT];
+    int n = 0;
+
+    do {
+        unsigned char byte = valore & 0x7f;
+        valore >>= 7;
+        buffer[n++] = byte | (valore ? 0x80 : 0);
+    } while (valore);
+
+    fwrite(buffer, 1, (size_t)n, f);
+}
+
+/**
+ * @brief Legge un varint da un buffer in memoria
+ *
+ * @param[in,out] p Posizione corrente, avanzata oltre il varint letto
+ * @param fine Fine del buffer
+ * @param[out] valore Valore decodificato
+ * @return false se il buffer finisce prima del varint o il varint è malformato
+ */
+static bool leggiVarint(const unsigned char** p, const unsigned char* fine, uint64_t* valore) {
+    uint64_t risultato = 0;
+
+    for (int i = 0; i < MAX_BYTE_VARINT && *p < fine; i++) {
+        unsigned char byte = *(*p)++;
+        risultato |= (uint64_t)(byte & 0x7f) << (7 * i);
+        if (!(byte & 0x80)) {
+            *valore = risultato;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * REGISTRAZIONE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+bool avviaRegistrazione(const char* percorso, uint64_t seme) {
+    terminaRegistrazione();
+
+    fileRegistrazione = fopen(percorso, "wb");
+    if (!fileRegistrazione) return false;
+
+    fwrite(REGISTRAZIONE_MAGIC, 1, 4, fileRegistrazione);
+    scriviVarint(fileRegistrazione, REGISTRAZIONE_VERSIONE);
+    scriviVarint(fileRegistrazione, seme);
+
+    // Lo stato dei salvataggi da cui parte la sessione
+    int totale = contaSalvataggi();
+    scriviVarint(fileRegistrazione, (uint64_t)totale);
+    for (int i = 1; i <= totale; i++) {
+        Salvataggio s;
+        if (leggiSalvataggioIndice(i, &s)) {
+            scriviVarint(fileRegistrazione, sizeof(s));
+            fwrite(&s, sizeof(s), 1, fileRegistrazione);
+        } else {
+            scriviVarint(fileRegistrazione, 0);
+        }
+    }
+    fflush(fileRegistrazione);
+
+    if (!chiusuraRegistrata) {
+        atexit(terminaRegistrazione);
+        chiusuraRegistrata = true;
+    }
+    return true;
+}
+
+void terminaRegistrazione(void) {
+    if (fileRegistrazione) {
+        fclose(fileRegistrazione);
+        fileRegistrazione = NULL;
+    }
+}
+
+// Ogni record viene scritto subito su disco: se il gioco si blocca il log resta utilizzabile
+
+void registraCarattere(char carattere) {
+    if (!fileRegistrazione) return;
+    scriviVarint(fileRegistrazione, (uint64_t)(unsigned char)carattere << 1);
+    fflush(fileRegistrazione);
+}
+
+void registraRiga(const char* riga, size_t lunghezza) {
+    if (!fileRegistrazione) return;
+    scriviVarint(fileRegistrazione, ((uint64_t)lunghezza << 1) | 1);
+    fwrite(riga, 1, lunghezza, fileRegistrazione);
+    fflush(fileRegistrazione);
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * RIPRODUZIONE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Sessione registrata, decodificata in memoria
+ *
+ * @details
+ * I record vengono trasformati in righe di script: un carattere di menu diventa
+ * una riga di un solo carattere (che punta alla tabella caratteri[]), così la
+ * riproduzione riusa la sorgente script di tastiera.c senza costi di decodifica.
+ */
+typedef struct {
+    unsigned char* dati;           ///< Contenuto del file
+    RigaScript* righe;             ///< Input decodificati
+    int numeroRighe;               ///< Numero di input
+    uint64_t seme;                 ///< Seme della sessione registrata
+    const unsigned char** salvataggi; ///< Salvataggi iniziali dentro dati (NULL = file non leggibile)
+    int numeroSalvataggi;          ///< Salvataggi presenti all'avvio
+} Sessione;
+
+/// @brief Un byte per ogni possibile carattere, puntati dalle righe di un carattere
+static char caratteri[256];
+
+/**
+ * @brief Legge i salvataggi presenti all'avvio della sessione registrata
+ *
+ * @details
+ * Le registrazioni della versione 1 non li hanno: si riproducono partendo
+ * senza salvataggi. I dati restano nel buffer del file, qui si tengono solo
+ * i puntatori.
+ */
+static bool leggiSalvataggiIniziali(const unsigned char** p, const unsigned char* fine,
+                                    uint64_t versione, Sessione* s) {
+    if (versione < 2) return true;
+
+    uint64_t numero, lunghezza;
+    if (!leggiVarint(p, fine, &numero) || numero > (uint64_t)(fine - *p)) return false;
+
+    s->salvataggi = calloc((size_t)numero + 1, sizeof(*s->salvataggi));
+    if (s->salvataggi == NULL) return false;
+
+    for (uint64_t i = 0; i < numero; i++) {
+        if (!leggiVarint(p, fine, &lunghezza)) return false;
+        if (lunghezza == 0) continue;
+        if (lunghezza != sizeof(Salvataggio) || lunghezza > (uint64_t)(fine - *p)) return false;
+        s->salvataggi[i] = *p;
+        *p += lunghezza;
+    }
+    s->numeroSalvataggi = (int)numero;
+    return true;
+}
+
+/**
+ * @brief Ricrea nella cartella di prova i salvataggi presenti all'avvio
+ * @return false se la cartella non si può preparare o un file non si può scrivere
+ */
+static bool ripristinaSalvataggi(const Sessione* s) {
+    if (!preparaCartellaProva()) return false;
+
+    for (int i = 0; i < s->numeroSalvataggi; i++) {
+        Salvataggio salvataggio;
+        const Salvataggio* dati = NULL;
+        if (s->salvataggi[i] != NULL) {
+            memcpy(&salvataggio, s->salvataggi[i], sizeof(salvataggio));   // nel file non è allineato
+            dati = &salvataggio;
+        }
+        if (!scriviSalvataggioIndice(i + 1, dati)) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Carica e decodifica un file di registrazione
+ * @return true se il file è valido
+ */
+static bool caricaSessione(const char* percorso, Sessione* s) {
+    memset(s, 0, sizeof(*s));
+
+    FILE* f = fopen(percorso, "rb");
+    if (!f) return false;
+
+    fseek(f, 0, SEEK_END);
+    long dimensione = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    if (dimensione < 4) {
+        fclose(f);
+        return false;
+    }
+
+    s->dati = malloc((size_t)dimensione);
+    bool letto = s->dati && fread(s->dati, 1, (size_t)dimensione, f) == (size_t)dimensione;
+    fclose(f);
+
+    // Ogni record occupa almeno un byte: il numero di byte limita il numero di righe
+    s->righe = letto ? malloc(sizeof(RigaScript) * (size_t)dimensione) : NULL;
+    if (!s->righe || memcmp(s->dati, REGISTRAZIONE_MAGIC, 4) != 0) {
+        free(s->righe);
+        free(s->dati);
+        return false;
+    }
+
+    for (int i = 0; i < 256; i++) caratteri[i] = (char)i;
+
+    const unsigned char* p = s->dati + 4;
+    const unsigned char* fine = s->dati + dimensione;
+    uint64_t versione, etichetta;
+
+    if (!leggiVarint(&p, fine, &versione) || versione < 1 || versione > REGISTRAZIONE_VERSIONE ||
+        !leggiVarint(&p, fine, &s->seme) || !leggiSalvataggiIniziali(&p, fine, versione, s)) {
+        free(s->salvataggi);
+        free(s->righe);
+        free(s->dati);
+        return false;
+    }
+
+    while (p < fine && leggiVarint(&p, fine, &etichetta)) {
+        RigaScript* r = &s->righe[s->numeroRighe];
+        uint64_t valore = etichetta >> 1;
+
+        if (etichetta & 1) {
+            if (valore > (uint64_t)(fine - p)) break;   // riga troncata: log interrotto
+            r->testo = (const char*)p;
+            r->lunghezza = (size_t)valore;
+            p += valore;
+        } else {
+            // Il '\n' di una riga vuota si ottiene da una riga di lunghezza 0
+            r->testo = &caratteri[valore & 0xff];
+            r->lunghezza = (valore == '\n') ? 0 : 1;
+        }
+        s->numeroRighe++;
+    }
+    return true;
+}
+
+int mainRiproduci(int argc, char* argv[]) {
+    const char* percorso = NULL;
+    long ripetizioni = 1;
+    bool mostra = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            ripetizioni = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--mostra") == 0) {
+            mostra = true;
+        } else if (percorso == NULL) {
+            percorso = argv[i];
+        } else {
+            percorso = NULL;
+            break;
+        }
+    }
+
+    if (percorso == NULL || ripetizioni < 1) {
+        fprintf(stderr, "Uso: %s --riproduci FILE [-n RIPETIZIONI] [--mostra]\n", argv[0]);
+        return 1;
+    }
+
+    Sessione sessione;
+    if (!caricaSessione(percorso, &sessione)) {
+        fprintf(stderr, "Registrazione '%s' non valida o non leggibile\n", percorso);
+        return 1;
+    }
+
+    if (!mostra) schermoImpostaModalita(SCHERMO_SILENZIOSO);
+    tastieraImpostaScript(sessione.righe, sessione.numeroRighe);
+
+    long long minimo = -1, totale = 0;
+    bool salvataggiPronti = true;
+    for (long i = 0; i < ripetizioni && salvataggiPronti; i++) {
+        // Ogni ripetizione riparte dagli stessi salvataggi (fuori dal tempo misurato)
+        salvataggiPronti = ripristinaSalvataggi(&sessione);
+        if (!salvataggiPronti) break;
+
+        impostaSemeSessione(sessione.seme);
+        tastieraRiavvolgiScript();
+
+        long long inizio = adessoNs();
+        menuPrincipale();
+        long long durata = adessoNs() - inizio;
+
+        totale += durata;
+        if (minimo < 0 || durata < minimo) minimo = durata;
+    }
+
+    tastieraRimuoviScript();
+    schermoImpostaModalita(SCHERMO_TERMINALE);
+    rimuoviCartellaSalvataggi();
+
+    if (!salvataggiPronti) {
+        fprintf(stderr, "Impossibile preparare i salvataggi della registrazione in '%s'\n",
+                CARTELLA_SALVATAGGI);
+        free(sessione.salvataggi);
+        free(sessione.righe);
+        free(sessione.dati);
+        return 1;
+    }
+
+    printf("{\"riproduzione\":{\"input\":%d,\"seme\":%llu,\"ripetizioni\":%ld,\"nsMinimo\":%lld,\"nsMedio\":%lld}}\n",
+           sessione.numeroRighe, (unsigned long long)sessione.seme, ripetizioni,
+           minimo, totale / ripetizioni);
+
+    free(sessione.salvataggi);
+    free(sessione.righe);
+    free(sessione.dati);
+    return 0;
+}
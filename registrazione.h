@@ -0,0 +1,57 @@
+#ifndef REGISTRAZIONE_H
+#define REGISTRAZIONE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Formato del file di registrazione (tutti i numeri sono varint LEB128):
+ *   "DGRS"  versione  seme
+ *   numeroSalvataggi  (lunghezza, byte del Salvataggio)...   (dalla versione 2)
+ *   record...
+ * I salvataggi sono quelli presenti all'avvio, in ordine di slot: la
+ * riproduzione li ricrea in una cartella di prova, così il risultato non
+ * dipende da ciò che c'è su disco e i salvataggi veri non vengono toccati.
+ * Lunghezza 0 indica un file che non si poteva leggere.
+ * Ogni record inizia con un'etichetta (valore << 1) | tipo:
+ *   tipo 0 = carattere di menu, valore = codice del carattere
+ *   tipo 1 = riga di testo,     valore = lunghezza, seguita dai byte della riga
+ */
+#define REGISTRAZIONE_MAGIC "DGRS"
+#define REGISTRAZIONE_VERSIONE 2
+
+// --- REGISTRAZIONE ---
+
+/**
+ * Inizia a registrare su file tutti gli input consumati dai menu
+ * Scrive subito l'intestazione con il seme della sessione e i salvataggi presenti
+ * Ritorna false se il file non può essere creato
+ */
+bool avviaRegistrazione(const char* percorso, uint64_t seme);
+
+/**
+ * Chiude il file di registrazione (chiamata anche automaticamente all'uscita)
+ */
+void terminaRegistrazione(void);
+
+/**
+ * Annota un carattere letto da un menu (chiamata da tastiera.c)
+ */
+void registraCarattere(char carattere);
+
+/**
+ * Annota una riga letta da un prompt di testo (chiamata da tastiera.c)
+ */
+void registraRiga(const char* riga, size_t lunghezza);
+
+// --- RIPRODUZIONE ---
+
+/**
+ * Riproduce una sessione registrata alla massima velocità
+ * Uso: --riproduci FILE [-n RIPETIZIONI] [--mostra]
+ * Ritorna 0 se tutto è andato bene, 1 in caso di errore
+ */
+int mainRiproduci(int argc, char* argv[]);
+
+#endif // REGISTRAZIONE_H
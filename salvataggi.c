@@ -14,7 +14,19 @@
  * - Interfaccia utente per la gestione dei salvataggi
  */
 
+#ifndef _WIN32
+#define _DEFAULT_SOURCE   // ctime_r()
+#endif
+
 #include "salvataggi.h"
+#include "sessione.h"
+#include "schermo.h"
+#include "tastiera.h"
+#include "opzioni.h"
+#include "utils.h"
+#include "diario.h"
+#include <pthread.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -24,16 +36,21 @@
 #ifdef _WIN32
 #include <windows.h>
 #include <direct.h>   // per _mkdir su Windows
+#include <process.h>  // per _getpid su Windows
 /// @brief Macro per creare directory su Windows
 #define MKDIR(path) _mkdir(path)
+#define RMDIR(path) _rmdir(path)
+#define PID_PROCESSO() _getpid()
 #else
 #include <unistd.h>
 /// @brief Macro per creare directory su Unix/Linux con permessi 0700
 #define MKDIR(path) mkdir(path, 0700)
+#define RMDIR(path) rmdir(path)
+#define PID_PROCESSO() getpid()
 #endif
 
-/// @brief Nome della cartella dove vengono salvati i file di gioco
-#define CARTELLA_SALVATAGGI "salvataggi"
+/// @brief Serializza chi cambia i file (le connessioni di uno stesso utente condividono la cartella da thread diversi)
+static pthread_mutex_t bloccoSalvataggi = PTHREAD_MUTEX_INITIALIZER;
 
 /*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
  * FUNZIONI UTILITY
@@ -44,7 +61,7 @@
  * 
  * @details
  * Questa funzione genera il nome del file di salvataggio combinando:
- * - Il nome della cartella dei salvataggi (CARTELLA_SALVATAGGI)
+ * - La cartella dei salvataggi della sessione (vedi cartellaSalvataggi())
  * - Il prefisso "save"
  * - L'indice numerico del salvataggio
  * - L'estensione ".dat"
@@ -62,7 +79,7 @@
  *          (almeno MAX_NOME_FILE byte) per evitare buffer overflow.
  */
 static void costruisciNomeFile(int idx, char* buffer) {
-    snprintf(buffer, MAX_NOME_FILE, "%s/save%d.dat", CARTELLA_SALVATAGGI, idx);
+    snprintf(buffer, MAX_NOME_FILE, "%s/save%d.dat", cartellaSalvataggi(), idx);
 }
 
 /**
@@ -71,7 +88,8 @@ static void costruisciNomeFile(int idx, char* buffer) {
  * @details
  * Questa funzione utilizza la syscall stat() per verificare se la cartella
  * dei salvataggi esiste nel filesystem. Se la cartella non esiste, viene
- * creata usando la macro MKDIR che è platform-independent:
+ * creata (insieme alle cartelle che la contengono, per le cartelle di prova
+ * e delle sessioni) usando la macro MKDIR che è platform-independent:
  * - Su Windows: usa _mkdir()
  * - Su Unix/Linux: usa mkdir() con permessi 0700 (rwx------)
  * 
@@ -88,11 +106,75 @@ static void costruisciNomeFile(int idx, char* buffer) {
  */
 static void controllaCreaCartella() {
     struct stat st = {0};
-    if (stat(CARTELLA_SALVATAGGI, &st) == -1) {
-        MKDIR(CARTELLA_SALVATAGGI);
+    const char* cartella = cartellaSalvataggi();
+    if (stat(cartella, &st) == 0) return;
+
+    char parziale[MAX_NOME_FILE];
+    snprintf(parziale, sizeof(parziale), "%s", cartella);
+    for (char* p = parziale + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            MKDIR(parziale);
+            *p = '/';
+        }
+    }
+    MKDIR(parziale);
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CARTELLA DEI SALVATAGGI
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+const char* cartellaSalvataggi(void) {
+    const char* cartella = sessioneCorrente()->cartellaSalvataggi;
+    return cartella[0] != '\0' ? cartella : CARTELLA_SALVATAGGI;
+}
+
+bool impostaCartellaSalvataggi(const char* cartella) {
+    Sessione* sessione = sessioneCorrente();
+    if (cartella == NULL) {
+        sessione->cartellaSalvataggi[0] = '\0';
+        return true;
+    }
+    if (strlen(cartella) >= sizeof(sessione->cartellaSalvataggi)) return false;
+    strcpy(sessione->cartellaSalvataggi, cartella);
+    return true;
+}
+
+/**
+ * @brief Elimina i file saveN.dat della cartella corrente
+ *
+ * @details
+ * I salvataggi sono numerati senza buchi (vedi eliminaSalvataggio()): ci si
+ * ferma al primo che manca.
+ */
+static void svuotaCartella(void) {
+    char nomeFile[MAX_NOME_FILE];
+    for (int i = 1; ; i++) {
+        costruisciNomeFile(i, nomeFile);
+        if (remove(nomeFile) != 0) break;
     }
 }
 
+bool preparaCartellaProva(void) {
+    char cartella[MAX_CARTELLA_SESSIONE];
+    snprintf(cartella, sizeof(cartella), "%s/prova-%d", CARTELLA_SALVATAGGI, (int)PID_PROCESSO());
+    if (!impostaCartellaSalvataggi(cartella)) return false;
+
+    controllaCreaCartella();
+    svuotaCartella();
+
+    struct stat st = {0};
+    return stat(cartella, &st) == 0;
+}
+
+void rimuoviCartellaSalvataggi(void) {
+    if (sessioneCorrente()->cartellaSalvataggi[0] == '\0') return;
+    svuotaCartella();
+    RMDIR(cartellaSalvataggi());
+    impostaCartellaSalvataggi(NULL);
+}
+
 /*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
  * FUNZIONI I/O FILE
  *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
@@ -124,6 +206,32 @@ static bool scriviFile(const char* path, const Salvataggio* s) {
     return true;
 }
 
+/**
+ * @brief Legge un salvataggio da un file della cartella indicata
+ *
+ * @details
+ * La cartella arriva come parametro perché la scansione in parallelo legge
+ * dai thread del pool, che non hanno la sessione di chi ha chiesto i file.
+ */
+static bool leggiSalvataggioDa(const char* cartella, int idx, Salvataggio* s) {
+    MISURA_SONDA(SONDA_LEGGI_SALVATAGGIO);
+    if (idx <= 0) return false;
+
+    char nomeFile[MAX_NOME_FILE];
+    snprintf(nomeFile, sizeof(nomeFile), "%s/save%d.dat", cartella, idx);
+
+    FILE* f = fopen(nomeFile, "rb");
+    if (!f) return false;
+
+    if (fread(s, sizeof(Salvataggio), 1, f) != 1) {
+        fclose(f);
+        return false;
+    }
+    
+    fclose(f);
+    return true;
+}
+
 /**
  * @brief Legge un salvataggio da file
  * 
@@ -137,20 +245,85 @@ static bool scriviFile(const char* path, const Salvataggio* s) {
  * @return false Errore: file non trovato o indice invalido
  */
 bool leggiSalvataggioIndice(int idx, Salvataggio* s) {
-    if (idx <= 0) return false;
+    return leggiSalvataggioDa(cartellaSalvataggi(), idx, s);
+}
 
+/**
+ * @brief Legge solo il nome dell'eroe di un salvataggio
+ *
+ * @details
+ * Per cercare uno slot per nome non serve il resto del file: si legge il
+ * campo nome alla sua posizione nella struttura.
+ *
+ * @param nome Buffer di MAX_NOME_EROE caratteri (sempre terminato)
+ * @return false se il file non esiste o è troppo corto
+ */
+static bool leggiNomeSalvataggio(int idx, char nome[MAX_NOME_EROE]) {
     char nomeFile[MAX_NOME_FILE];
     costruisciNomeFile(idx, nomeFile);
 
     FILE* f = fopen(nomeFile, "rb");
     if (!f) return false;
 
-    if (fread(s, sizeof(Salvataggio), 1, f) != 1) {
-        fclose(f);
+    bool letto = fseek(f, (long)offsetof(Salvataggio, nome), SEEK_SET) == 0 &&
+                 fread(nome, MAX_NOME_EROE, 1, f) == 1;
+    fclose(f);
+    nome[MAX_NOME_EROE - 1] = '\0';
+    return letto;
+}
+
+bool scriviSalvataggioIndice(int idx, const Salvataggio* s) {
+    if (idx <= 0) return false;
+    controllaCreaCartella();
+
+    char nomeFile[MAX_NOME_FILE];
+    costruisciNomeFile(idx, nomeFile);
+    if (s != NULL) return scriviFile(nomeFile, s);
+
+    FILE* f = fopen(nomeFile, "wb");
+    if (!f) return false;
+    fclose(f);
+    return true;
+}
+
+// Scansione in parallelo: un elemento per salvataggio, scritto solo da chi lo legge
+typedef struct {
+    const char* cartella;
+    Salvataggio* salvataggi;
+    bool* letti;
+} ScansioneSalvataggi;
+
+/// @brief Corpo del perOgni() della scansione: legge i salvataggi [da, a) (indici da 0)
+static void leggiPezzoSalvataggi(void* argomento, long da, long a, int lavoratore) {
+    (void)lavoratore;
+    ScansioneSalvataggi* scansione = argomento;
+    for (long i = da; i < a; i++) {
+        scansione->letti[i] = leggiSalvataggioDa(scansione->cartella, (int)i + 1, &scansione->salvataggi[i]);
+    }
+}
+
+/**
+ * @brief Legge i primi 'totale' salvataggi in parallelo sul pool del gioco
+ *
+ * @details
+ * Ogni file finisce nella propria posizione, quindi il risultato è lo stesso
+ * della lettura in ordine. Senza pool (o con pochi file) legge tutto qui.
+ *
+ * @param letti letti[i] dice se il salvataggio i + 1 è stato letto
+ * @return false se la memoria non basta
+ */
+static bool leggiSalvataggi(int totale, Salvataggio** salvataggi, bool** letti) {
+    *salvataggi = calloc((size_t)totale + 1, sizeof(Salvataggio));
+    *letti = calloc((size_t)totale + 1, sizeof(bool));
+    if (*salvataggi == NULL || *letti == NULL) {
+        free(*salvataggi);
+        free(*letti);
         return false;
     }
-    
-    fclose(f);
+
+    ScansioneSalvataggi scansione = { cartellaSalvataggi(), *salvataggi, *letti };
+    PoolLavori* pool = totale > SALVATAGGI_PER_LETTURA ? poolGioco() : NULL;
+    perOgni(pool, 0, totale, SALVATAGGI_PER_LETTURA, leggiPezzoSalvataggi, &scansione);
     return true;
 }
 
@@ -158,38 +331,23 @@ bool leggiSalvataggioIndice(int idx, Salvataggio* s) {
  * FUNZIONI GESTIONE SALVATAGGI
  *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
 
-/**
- * @brief Salva o aggiorna un salvataggio di gioco
- * 
- * @details
- * Questa funzione implementa una logica intelligente di salvataggio che:
- * - Cerca se esiste già un salvataggio con lo stesso nome dell'eroe
- * - Se trovato: AGGIORNA il salvataggio esistente mantenendo lo stesso slot
- * - Se non trovato: CREA un nuovo salvataggio in un nuovo slot
- * 
- * @param s Puntatore costante alla struttura Salvataggio da salvare
- * 
- * @return true Salvataggio creato o aggiornato con successo
- * @return false Errore: puntatore NULL, errore I/O, o altri problemi
- */
-bool salvaGioco(const Salvataggio* s) {
-    if (s == NULL) return false;
-    
+/// @brief Corpo di salvaGioco(), eseguito con bloccoSalvataggi preso
+static bool salvaGiocoBloccato(const Salvataggio* s) {
     controllaCreaCartella();
 
     char nomeFile[MAX_NOME_FILE];
-    Salvataggio temp;
     int count = contaSalvataggi();
     bool trovato = false;
     int indiceTrovato = -1;
+    char nome[MAX_NOME_EROE];
 
-    // Ricerca salvataggio esistente con stesso nome
+    // Ricerca salvataggio esistente con stesso nome: in ordine di slot, ci si ferma al primo
     for (int i = 1; i <= count; i++) {
-        if (!leggiSalvataggioIndice(i, &temp)) {
+        if (!leggiNomeSalvataggio(i, nome)) {
             continue;
         }
         
-        if (strcmp(temp.nome, s->nome) == 0) {
+        if (strcmp(nome, s->nome) == 0) {
             indiceTrovato = i;
             trovato = true;
             break;
@@ -203,11 +361,13 @@ bool salvaGioco(const Salvataggio* s) {
         salvataggioAggiornato.dataSalvataggio = time(NULL);
         
         if (!scriviFile(nomeFile, &salvataggioAggiornato)) {
-            printf("Errore nell'aggiornamento del salvataggio!\n");
+            DIARIO(DIARIO_ERRORE, CATEGORIA_SALVATAGGI,
+                   "Errore nell'aggiornamento del salvataggio '%s' (slot %d)", s->nome, indiceTrovato);
             return false;
         }
         
-        printf("Salvataggio aggiornato per '%s' (slot %d)\n", s->nome, indiceTrovato);
+        DIARIO(DIARIO_INFO, CATEGORIA_SALVATAGGI,
+               "Salvataggio aggiornato per '%s' (slot %d)", s->nome, indiceTrovato);
         return true;
     }
     
@@ -218,15 +378,42 @@ bool salvaGioco(const Salvataggio* s) {
         nuovoSalvataggio.dataSalvataggio = time(NULL);
         
         if (!scriviFile(nomeFile, &nuovoSalvataggio)) {
-            printf("Errore nella creazione del salvataggio!\n");
+            DIARIO(DIARIO_ERRORE, CATEGORIA_SALVATAGGI,
+                   "Errore nella creazione del salvataggio '%s' (slot %d)", s->nome, count + 1);
             return false;
         }
         
-        printf("Nuovo salvataggio creato per '%s' (slot %d)\n", s->nome, count + 1);
+        DIARIO(DIARIO_INFO, CATEGORIA_SALVATAGGI,
+               "Nuovo salvataggio creato per '%s' (slot %d)", s->nome, count + 1);
         return true;
     }
 }
 
+/**
+ * @brief Salva o aggiorna un salvataggio di gioco
+ * 
+ * @details
+ * Questa funzione implementa una logica intelligente di salvataggio che:
+ * - Cerca se esiste già un salvataggio con lo stesso nome dell'eroe
+ * - Se trovato: AGGIORNA il salvataggio esistente mantenendo lo stesso slot
+ * - Se non trovato: CREA un nuovo salvataggio in un nuovo slot
+ * 
+ * @param s Puntatore costante alla struttura Salvataggio da salvare
+ * 
+ * @return true Salvataggio creato o aggiornato con successo
+ * @return false Errore: puntatore NULL, errore I/O, o altri problemi
+ */
+bool salvaGioco(const Salvataggio* s) {
+    MISURA_SONDA(SONDA_SALVA_GIOCO);
+    if (s == NULL) return false;
+
+    // Cerca lo slot e scrive senza che un'altra sessione prenda lo stesso
+    pthread_mutex_lock(&bloccoSalvataggi);
+    bool ok = salvaGiocoBloccato(s);
+    pthread_mutex_unlock(&bloccoSalvataggi);
+    return ok;
+}
+
 /**
  * @brief Conta il numero totale di salvataggi presenti
  * 
@@ -237,6 +424,7 @@ bool salvaGioco(const Salvataggio* s) {
  * @return int Numero di salvataggi presenti (0 se nessuno)
  */
 int contaSalvataggi(void) {
+    MISURA_SONDA(SONDA_CONTA_SALVATAGGI);
     controllaCreaCartella();
 
     int count = 0;
@@ -258,21 +446,8 @@ int contaSalvataggi(void) {
     return count;
 }
 
-/**
- * @brief Elimina un salvataggio e riordina i file rimanenti
- * 
- * @details
- * Questa funzione elimina un file di salvataggio e rinomina tutti i file
- * successivi per mantenere la numerazione consecutiva senza "buchi".
- * 
- * @param idx Indice del salvataggio da eliminare (deve essere > 0)
- * 
- * @return true Eliminazione riuscita
- * @return false Errore: indice invalido o file non eliminabile
- */
-bool eliminaSalvataggio(int idx) {
-    if (idx <= 0) return false;
-
+/// @brief Corpo di eliminaSalvataggio(), eseguito con bloccoSalvataggi preso
+static bool eliminaSalvataggioBloccato(int idx) {
     char nomeFile[MAX_NOME_FILE];
     costruisciNomeFile(idx, nomeFile);
 
@@ -294,6 +469,28 @@ bool eliminaSalvataggio(int idx) {
     return true;
 }
 
+/**
+ * @brief Elimina un salvataggio e riordina i file rimanenti
+ * 
+ * @details
+ * Questa funzione elimina un file di salvataggio e rinomina tutti i file
+ * successivi per mantenere la numerazione consecutiva senza "buchi".
+ * 
+ * @param idx Indice del salvataggio da eliminare (deve essere > 0)
+ * 
+ * @return true Eliminazione riuscita
+ * @return false Errore: indice invalido o file non eliminabile
+ */
+bool eliminaSalvataggio(int idx) {
+    if (idx <= 0) return false;
+
+    // Le rinomine non si devono mescolare con quelle (o i salvataggi) di un'altra sessione
+    pthread_mutex_lock(&bloccoSalvataggi);
+    bool ok = eliminaSalvataggioBloccato(idx);
+    pthread_mutex_unlock(&bloccoSalvataggi);
+    return ok;
+}
+
 /*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
  * FUNZIONI CONVERSIONE
  *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
@@ -351,24 +548,38 @@ Eroe creaEroeDaSalvataggio(const Salvataggio* salvataggio) {
  * in un formato tabellare leggibile.
  */
 void mostraMenuSalvataggi() {
+    MISURA_SONDA(SONDA_MENU_SALVATAGGI);
     int totaleSalvataggi = contaSalvataggi();
     
-    printf("\n----------------------------------------\n");
-    printf("       LISTA SALVATAGGI DISPONIBILI     \n");
-    printf("----------------------------------------\n");
+    stampa("\n----------------------------------------\n");
+    stampa("       LISTA SALVATAGGI DISPONIBILI     \n");
+    stampa("----------------------------------------\n");
     
     if (totaleSalvataggi == 0) {
-        printf("Nessun salvataggio trovato.\n");
+        stampa("Nessun salvataggio trovato.\n");
         return;
     }
     
-    printf("Ci sono %d salvataggio/i disponibile/i:\n\n", totaleSalvataggi);
+    stampa("Ci sono %d salvataggio/i disponibile/i:\n\n", totaleSalvataggi);
     
+    Salvataggio* tutti;
+    bool* letti;
+    if (!leggiSalvataggi(totaleSalvataggi, &tutti, &letti)) {
+        stampa("Memoria insufficiente per leggere i salvataggi.\n");
+        return;
+    }
+
     for (int i = 0; i < totaleSalvataggi; i++) {
-        Salvataggio s;
+        const Salvataggio s = tutti[i];
         
-        if (leggiSalvataggioIndice(i + 1, &s)) {
-            char* dataStr = ctime(&s.dataSalvataggio);
+        if (letti[i]) {
+            // ctime() usa un buffer statico: le sessioni del server stampano da più thread
+            char data[32];
+#ifdef _WIN32
+            char* dataStr = ctime_s(data, sizeof(data), &s.dataSalvataggio) == 0 ? data : NULL;
+#else
+            char* dataStr = ctime_r(&s.dataSalvataggio, data);
+#endif
             
             if (dataStr) {
                 size_t len = strlen(dataStr);
@@ -377,14 +588,17 @@ void mostraMenuSalvataggi() {
                 }
             }
             
-            printf("\033[94m[%d]\033[0m %s", i + 1, s.nome);
-            printf("     %s", dataStr ? dataStr : "Data sconosciuta");
-            printf("      Vita: %d |  Monete: %d |  Oggetti: %d |  Missioni: %d\n\n",
+            stampa("\033[94m[%d]\033[0m %s", i + 1, s.nome);
+            stampa("     %s", dataStr ? dataStr : "Data sconosciuta");
+            stampa("      Vita: %d |  Monete: %d |  Oggetti: %d |  Missioni: %d\n\n",
                 s.vita, s.monete, s.oggettiPosseduti, s.missioniCompletate);
         } else {
-            printf("[%d] File non leggibile.\n\n", i + 1);
+            stampa("[%d] File non leggibile.\n\n", i + 1);
         }
     }
+
+    free(tutti);
+    free(letti);
 }
 
 /**
@@ -397,16 +611,14 @@ int chiediSalvataggioDaCaricare(void) {
     int scelta;
 
     while (1) {
-        printf("\nSeleziona il salvataggio da gestire [1 - %d] (o '%c' per tornare indietro): ", 
+        stampa("\nSeleziona il salvataggio da gestire [1 - %d] (o '%c' per tornare indietro): ", 
                contaSalvataggi(), INPUT_BACK);
 
-        if (!fgets(input, sizeof(input), stdin)) {
-            printf("Errore di input.\n");
-            continue;
+        if (!tastieraLeggiRiga(input, sizeof(input))) {
+            stampa("Errore di input.\n");
+            return -1;
         }
 
-        input[strcspn(input, "\n")] = '\0';
-
         bool valido = true;
         for (int i = 0; input[i] != '\0'; i++) {
             if (input[i] == INPUT_BACK) {
@@ -419,14 +631,14 @@ int chiediSalvataggioDaCaricare(void) {
         }
 
         if (!valido || strlen(input) == 0) {
-            printf("Inserisci solo numeri tra 1 e %d.\n", contaSalvataggi());
+            stampa("Inserisci solo numeri tra 1 e %d.\n", contaSalvataggi());
             continue;
         }
 
         scelta = atoi(input);
         
         if (scelta < 1 || scelta > contaSalvataggi()) {
-            printf("Numero non valido! Scegli tra 1 e %d.\n", contaSalvataggi());
+            stampa("Numero non valido! Scegli tra 1 e %d.\n", contaSalvataggi());
             continue;
         }
 
@@ -441,61 +653,62 @@ int chiediSalvataggioDaCaricare(void) {
  * @return int 1 se un'operazione è stata completata, 0 se annullata
  */
 int gestioneSalvataggioScelto(int sceltaSalvataggio) {
-    printf("Seleziona un'opzione per il salvataggio %d:\n", sceltaSalvataggio);
-    printf("1. Carica Salvataggio\n");
-    printf("2. Elimina Salvataggio\n");
-    printf("3. Annulla e torna al menu principale\n");
+    stampa("Seleziona un'opzione per il salvataggio %d:\n", sceltaSalvataggio);
+    stampa("1. Carica Salvataggio\n");
+    stampa("2. Elimina Salvataggio\n");
+    stampa("3. Annulla e torna al menu principale\n");
     
-    char scelta;
-    int c;
-
     while (1) {
-        printf("Scegli un'opzione [1-3]: ");
-        scelta = getchar();
-        while ((c = getchar()) != '\n' && c != EOF);
+        stampa("Scegli un'opzione [1-3]: ");
+        char scelta = tastieraLeggiCarattere();
+
+        if (scelta == INPUT_FINE) {
+            return 0;
+        }
+
+        int azione = azioneMenu(&MENU_SALVATAGGIO, scelta);
 
-        if (scelta == '1') {
+        if (azione == SALVATAGGIO_CARICA) {
             Salvataggio s;
             
             if (leggiSalvataggioIndice(sceltaSalvataggio, &s)) {
                 Eroe eroeCaricato = creaEroeDaSalvataggio(&s);
                 
-                printf("Salvataggio caricato con successo!\n");
-                printf("Nome: %s\nVita: %d\nMonete: %d\nMissioni completate: %d\nOggetti posseduti: %d\n",
+                stampa("Salvataggio caricato con successo!\n");
+                stampa("Nome: %s\nVita: %d\nMonete: %d\nMissioni completate: %d\nOggetti posseduti: %d\n",
                     eroeCaricato.nome,
                     eroeCaricato.vita,
                     eroeCaricato.monete,
                     eroeCaricato.missioniCompletate,
                     eroeCaricato.oggettiPosseduti);
             } else {
-                printf("Errore nel caricamento.\n");
+                stampa("Errore nel caricamento.\n");
             }
             
             return 1;
         }
-        else if (scelta == '2') {
-            printf("Sei sicuro di voler eliminare questo salvataggio? [S/N]: ");
-            char conferma = getchar();
-            while ((c = getchar()) != '\n' && c != EOF);
+        else if (azione == SALVATAGGIO_ELIMINA) {
+            stampa("Sei sicuro di voler eliminare questo salvataggio? [S/N]: ");
+            char conferma = tastieraLeggiCarattere();
             
-            if (conferma == 'S' || conferma == 's') {
+            if (azioneMenu(&MENU_CONFERMA, conferma) == CONFERMA_SI) {
                 if (eliminaSalvataggio(sceltaSalvataggio)) {
-                    printf("Salvataggio eliminato con successo.\n");
+                    stampa("Salvataggio eliminato con successo.\n");
                 } else {
-                    printf("Errore nell'eliminazione.\n");
+                    stampa("Errore nell'eliminazione.\n");
                 }
             } else {
-                printf("Eliminazione annullata.\n");
+                stampa("Eliminazione annullata.\n");
             }
             
             return 1;
         }
-        else if (scelta == '3') {
-            printf("Operazione annullata.\n");
+        else if (azione == SALVATAGGIO_ANNULLA) {
+            stampa("Operazione annullata.\n");
             return 0;
         }
         else {
-            printf("Opzione non valida. Riprova.\n");
+            stampa("Opzione non valida. Riprova.\n");
         }
     }
 }
\ No newline at end of file
@@ -7,8 +7,10 @@
 #include <time.h>
 #include <stdint.h>
 
+#define CARTELLA_SALVATAGGI "salvataggi"  // Cartella dove vengono salvati i file di gioco
 #define MAX_NOME_FILE 256
 #define INPUT_BACK 'b'
+#define SALVATAGGI_PER_LETTURA 8           // File letti da un lavoro nelle scansioni in parallelo
 
 /**
  * Struttura che rappresenta i dati salvati per una partita
@@ -44,6 +46,37 @@ Salvataggio creaSalvataggioDaEroe(const Eroe* eroe);
  */
 Eroe creaEroeDaSalvataggio(const Salvataggio* salvataggio);
 
+// --- CARTELLA DEI SALVATAGGI ---
+
+/**
+ * Cartella dei salvataggi della sessione corrente
+ * (CARTELLA_SALVATAGGI se la sessione non ne ha scelta un'altra)
+ */
+const char* cartellaSalvataggi(void);
+
+/**
+ * Fa usare alla sessione corrente un'altra cartella (NULL = CARTELLA_SALVATAGGI)
+ * La cartella, e quelle che la contengono, vengono create al primo accesso
+ * Ritorna false se il percorso è troppo lungo
+ */
+bool impostaCartellaSalvataggi(const char* cartella);
+
+/**
+ * Fa usare alla sessione corrente la cartella di prova del processo
+ * (CARTELLA_SALVATAGGI/prova-PID) e la svuota: headless e riproduzione ci
+ * lavorano per non leggere né modificare i salvataggi veri e per partire
+ * ogni volta dallo stesso stato
+ * Ritorna false se la cartella non può essere creata
+ */
+bool preparaCartellaProva(void);
+
+/**
+ * Elimina i salvataggi e la cartella della sessione corrente (di prova o di
+ * una connessione del server) e torna a CARTELLA_SALVATAGGI
+ * Sulla cartella predefinita non fa niente
+ */
+void rimuoviCartellaSalvataggi(void);
+
 // --- FUNZIONI DI GESTIONE FILE ---
 
 /**
@@ -76,6 +109,16 @@ int contaSalvataggi(void);
  */
 bool leggiSalvataggioIndice(int idx, Salvataggio* s);
 
+/**
+ * Scrive il salvataggio idx così com'è, senza cercarlo per nome né cambiarne
+ * la data (usata per ricreare i salvataggi di una registrazione)
+ * Con s == NULL crea un file vuoto, che alla lettura risulta non valido
+ *
+ * @param idx Indice del salvataggio (1-based)
+ * @return true se il file è stato scritto
+ */
+bool scriviSalvataggioIndice(int idx, const Salvataggio* s);
+
 /**
  * Elimina un salvataggio e ricompatta gli altri
  * Esempio: se elimini save2.dat, save3.dat diventa save2.dat
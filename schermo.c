@@ -0,0 +1,78 @@
+/**
+ * @file schermo.c
+ * @brief Punto unico di uscita per il testo del gioco
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * I menu e le missioni stampano tramite stampa() invece di chiamare printf()
+ * direttamente. In questo modo la modalità headless può eseguire la logica
+ * di gioco senza pagare formattazione e scrittura del testo.
+ *
+ * Modalità e destinazione appartengono alla sessione corrente (vedi
+ * sessione.h): ogni giocatore del server scrive nel buffer della propria
+ * connessione.
+ */
+
+#include "schermo.h"
+#include "sessione.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+/// @brief Byte formattati sullo stack prima di ricorrere a malloc (solo con un'uscita impostata)
+#define DIM_TESTO_SCHERMO 1024
+
+void schermoImpostaModalita(ModalitaSchermo modalita) {
+    Sessione* s = sessioneCorrente();
+    if (s->modalitaSchermo == SCHERMO_TERMINALE && s->uscita == NULL) fflush(stdout);
+    s->modalitaSchermo = modalita;
+}
+
+ModalitaSchermo schermoModalita(void) {
+    return sessioneCorrente()->modalitaSchermo;
+}
+
+void schermoImpostaUscita(UscitaSchermo uscita, void* contesto) {
+    Sessione* s = sessioneCorrente();
+    s->uscita = uscita;
+    s->contestoUscita = contesto;
+}
+
+void stampa(const char* formato, ...) {
+    const Sessione* s = sessioneCorrente();
+    if (s->modalitaSchermo == SCHERMO_SILENZIOSO) return;
+
+    va_list argomenti;
+    va_start(argomenti, formato);
+
+    if (s->uscita == NULL) {
+        vprintf(formato, argomenti);
+        va_end(argomenti);
+        return;
+    }
+
+    // Uscita della sessione: si formatta sullo stack e solo i testi lunghi vanno sullo heap
+    char testo[DIM_TESTO_SCHERMO];
+    va_list copia;
+    va_copy(copia, argomenti);
+    int n = vsnprintf(testo, sizeof(testo), formato, argomenti);
+    va_end(argomenti);
+
+    if (n >= 0 && (size_t)n < sizeof(testo)) {
+        s->uscita(s->contestoUscita, testo, (size_t)n);
+    } else if (n > 0) {
+        char* lungo = malloc((size_t)n + 1);
+        if (lungo != NULL) {
+            vsnprintf(lungo, (size_t)n + 1, formato, copia);
+            s->uscita(s->contestoUscita, lungo, (size_t)n);
+            free(lungo);
+        }
+    }
+    va_end(copia);
+}
+
+void schermoSvuota(void) {
+    const Sessione* s = sessioneCorrente();
+    if (s->modalitaSchermo == SCHERMO_TERMINALE && s->uscita == NULL) fflush(stdout);
+}
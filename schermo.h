@@ -0,0 +1,45 @@
+#ifndef SCHERMO_H
+#define SCHERMO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Destinazione dell'output testuale del gioco
+typedef enum {
+    SCHERMO_TERMINALE = 0,         // Output normale su stdout
+    SCHERMO_SILENZIOSO             // Nessun output: il testo non viene nemmeno formattato
+} ModalitaSchermo;
+
+// Destinazione alternativa del testo: riceve il testo già formattato (non terminato da '\0')
+typedef void (*UscitaSchermo)(void* contesto, const char* testo, size_t lunghezza);
+
+/**
+ * Imposta la destinazione dell'output
+ * In modalità silenziosa stampa() ritorna subito, senza formattare nulla
+ */
+void schermoImpostaModalita(ModalitaSchermo modalita);
+
+/**
+ * Ritorna la modalità di output corrente
+ */
+ModalitaSchermo schermoModalita(void);
+
+/**
+ * Manda il testo della sessione corrente a 'uscita' invece che su stdout
+ * (NULL torna a stdout); usata dal server per il buffer di ogni connessione
+ */
+void schermoImpostaUscita(UscitaSchermo uscita, void* contesto);
+
+/**
+ * Stampa testo formattato (stessa sintassi di printf)
+ * Tutto l'output del gioco passa da qui, così può essere disattivato
+ * o reindirizzato senza toccare la logica dei menu
+ */
+void stampa(const char* formato, ...);
+
+/**
+ * Svuota il buffer di output (da chiamare prima di mettersi in attesa di input)
+ */
+void schermoSvuota(void);
+
+#endif // SCHERMO_H
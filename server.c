@@ -0,0 +1,744 @@
+/**
+ * @file server.c
+ * @brief Server di gioco multi-sessione su socket Unix/TCP con cicli epoll
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * Ogni connessione è una piccola macchina a stati:
+ * - SESSIONE_IN_ESECUZIONE: il gioco della connessione sta girando
+ * - SESSIONE_ATTENDE_INPUT: il gioco è sospeso in tastieraLeggi*() in attesa di una riga
+ * - SESSIONE_FINITA: menuPrincipale() è tornato; si chiude appena l'uscita è spedita
+ *
+ * Il gioco non viene riscritto a stati: gira in una coroutine (vedi
+ * coroutine.h) e la sorgente di righe della sessione (vedi tastiera.h),
+ * quando il buffer di ingresso non contiene una riga intera, cede al ciclo
+ * degli eventi. Il ciclo la riprende quando arriva la riga o quando il client
+ * chiude: in quel caso le letture ritornano INPUT_FINE e i menu escono da
+ * soli, liberando tutto come a fine partita.
+ *
+ * Ci sono alcuni thread, ognuno con il proprio ciclo epoll. Tutti ascoltano
+ * sugli stessi socket (EPOLLEXCLUSIVE: una connessione in arrivo sveglia un
+ * solo ciclo) e la connessione resta per sempre al thread che l'ha accettata:
+ * le sue strutture non sono mai toccate da altri thread e la coroutine viene
+ * ripresa sempre dallo stesso.
+ *
+ * Ogni sessione ha la propria cartella dei salvataggi (vedi
+ * scegliCartellaConnessione()), quindi nessun client vede, carica o
+ * cancella i salvataggi di un altro.
+ *
+ * Limite noto: i salvataggi si leggono e scrivono in modo sincrono dentro
+ * la coroutine, cioè sul thread del ciclo. Sono file di poche decine di
+ * byte in una cartella locale con pochi file, ma per la durata di quelle
+ * operazioni (e dell'attesa di bloccoSalvataggi, vedi salvataggi.c) le
+ * altre connessioni dello stesso ciclo aspettano. Con i salvataggi su un
+ * disco lento o di rete andrebbero passati a un thread a parte.
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE   // accept4()
+#endif
+
+#include "server.h"
+#include "menu.h"
+#include "salvataggi.h"
+#include "sessione.h"
+#include "schermo.h"
+#include "tastiera.h"
+#include "utils.h"
+#include "diario.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+
+#include "coroutine.h"
+#include "catalogo.h"
+#include "combattimento.h"
+#include "trucchi.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define EVENTI_PER_ATTESA 256              // Eventi raccolti da una epoll_wait()
+#define ACCETTATE_PER_EVENTO 16            // Connessioni accettate prima di tornare agli altri eventi
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CONNESSIONI
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Stato del gioco di una connessione
+typedef enum {
+    SESSIONE_IN_ESECUZIONE = 0,    ///< Il gioco sta girando
+    SESSIONE_ATTENDE_INPUT,        ///< Sospeso in attesa di una riga
+    SESSIONE_FINITA                ///< menuPrincipale() è tornato
+} StatoSessioneServer;
+
+typedef struct Server Server;
+typedef struct CicloEventi CicloEventi;
+
+/// @brief Una connessione con la sessione che ci gioca
+typedef struct Connessione {
+    int fd;
+    int id;                                  ///< Numero progressivo (per il diario)
+    StatoSessioneServer stato;
+    bool ingressoChiuso;                     ///< Il client ha chiuso: le letture ritornano INPUT_FINE
+    bool erroreUscita;                       ///< Scrittura fallita o client troppo lento: l'uscita si scarta
+    bool attendeScrittura;                   ///< EPOLLOUT attivo
+    bool cartellaPropria;                    ///< La cartella dei salvataggi va eliminata alla chiusura
+
+    char ingresso[DIM_INGRESSO_CONNESSIONE]; ///< Byte ricevuti e non ancora letti dal gioco
+    size_t ingressoUsato;
+
+    char* uscita;                            ///< Testo da spedire: [uscitaInizio, uscitaFine)
+    size_t uscitaInizio;
+    size_t uscitaFine;
+    size_t uscitaCapacita;
+
+    Sessione sessione;                       ///< Stato di gioco del giocatore
+    Coroutine* coroutine;                    ///< Il gioco, sospeso quando aspetta input
+
+    CicloEventi* ciclo;                      ///< Thread a cui appartiene la connessione
+    struct Connessione* precedente;          ///< Lista delle connessioni del ciclo
+    struct Connessione* successiva;
+} Connessione;
+
+/// @brief Un thread con il suo ciclo degli eventi e le sue connessioni
+struct CicloEventi {
+    Server* server;
+    int indice;
+    int epoll;
+    pthread_t thread;
+    Connessione* connessioni;                ///< Testa della lista
+};
+
+/// @brief Stato condiviso dai cicli
+struct Server {
+    int ascoltoUnix;                         ///< -1 se non usato
+    int ascoltoTcp;                          ///< -1 se non usato
+    int fermo;                               ///< eventfd: scritto una volta per fermare tutti i cicli
+    int maxSessioni;
+    _Atomic int sessioniAperte;
+    _Atomic int prossimoId;
+    int numeroCicli;
+    CicloEventi cicli[MAX_THREAD_SERVER];
+};
+
+/// @brief true se nel buffer c'è una riga da dare al gioco (anche incompleta, se il buffer è pieno)
+static bool rigaPronta(const Connessione* c) {
+    return memchr(c->ingresso, '\n', c->ingressoUsato) != NULL ||
+           c->ingressoUsato == sizeof(c->ingresso);
+}
+
+/// @brief Aggiunge testo al buffer di uscita, ingrandendolo fino a MAX_USCITA_CONNESSIONE
+static void scriviUscitaConnessione(void* contesto, const char* testo, size_t lunghezza) {
+    Connessione* c = contesto;
+    if (c->erroreUscita) return;
+
+    if (c->uscitaFine + lunghezza > c->uscitaCapacita) {
+        // Prima si recupera lo spazio già spedito, poi si ingrandisce
+        size_t inAttesa = c->uscitaFine - c->uscitaInizio;
+        memmove(c->uscita, c->uscita + c->uscitaInizio, inAttesa);
+        c->uscitaInizio = 0;
+        c->uscitaFine = inAttesa;
+
+        size_t capacita = c->uscitaCapacita;
+        while (inAttesa + lunghezza > capacita) capacita *= 2;
+        if (capacita > MAX_USCITA_CONNESSIONE) {
+            DIARIO(DIARIO_AVVISO, CATEGORIA_SERVER, "Connessione %d: client troppo lento, chiusa", c->id);
+            c->erroreUscita = true;
+            c->ingressoChiuso = true;
+            return;
+        }
+        if (capacita != c->uscitaCapacita) {
+            char* nuova = realloc(c->uscita, capacita);
+            if (nuova == NULL) {
+                c->erroreUscita = true;
+                c->ingressoChiuso = true;
+                return;
+            }
+            c->uscita = nuova;
+            c->uscitaCapacita = capacita;
+        }
+    }
+
+    memcpy(c->uscita + c->uscitaFine, testo, lunghezza);
+    c->uscitaFine += lunghezza;
+}
+
+/**
+ * @brief Sorgente di righe della sessione: eseguita nella coroutine del gioco
+ *
+ * @details
+ * Se il buffer non contiene una riga intera cede al ciclo degli eventi e
+ * riparte da qui quando il ciclo riprende la coroutine. I '\r' dei client
+ * telnet vengono tolti.
+ */
+static bool leggiRigaConnessione(void* contesto, char* buffer, size_t dimensione) {
+    Connessione* c = contesto;
+
+    for (;;) {
+        if (rigaPronta(c) || (c->ingressoChiuso && c->ingressoUsato > 0)) {
+            char* a = memchr(c->ingresso, '\n', c->ingressoUsato);
+            size_t lunghezza = a != NULL ? (size_t)(a - c->ingresso) : c->ingressoUsato;
+            size_t consumati = a != NULL ? lunghezza + 1 : lunghezza;
+            if (lunghezza > 0 && c->ingresso[lunghezza - 1] == '\r') lunghezza--;
+
+            size_t n = lunghezza < dimensione - 1 ? lunghezza : dimensione - 1;
+            memcpy(buffer, c->ingresso, n);
+            buffer[n] = '\0';
+
+            memmove(c->ingresso, c->ingresso + consumati, c->ingressoUsato - consumati);
+            c->ingressoUsato -= consumati;
+            return true;
+        }
+        if (c->ingressoChiuso) return false;
+
+        c->stato = SESSIONE_ATTENDE_INPUT;
+        cediCoroutine();
+        c->stato = SESSIONE_IN_ESECUZIONE;
+    }
+}
+
+/// @brief Funzione della coroutine: la partita intera di una connessione
+static void avvioSessione(void* argomento) {
+    Connessione* c = argomento;
+
+    uint64_t seme = inizializzaSemeSessione();
+    DIARIO(DIARIO_INFO, CATEGORIA_SERVER, "Connessione %d: sessione avviata (seme %llu)",
+           c->id, (unsigned long long)seme);
+
+    menuPrincipale();
+
+    c->stato = SESSIONE_FINITA;
+}
+
+/// @brief Riprende il gioco della connessione finché non cede o finisce
+static void riprendiSessione(Connessione* c) {
+    Sessione* precedente = impostaSessioneCorrente(&c->sessione);
+    c->stato = SESSIONE_IN_ESECUZIONE;
+    riprendiCoroutine(c->coroutine);
+    impostaSessioneCorrente(precedente);
+}
+
+/// @brief Attiva o disattiva l'attesa di EPOLLOUT
+static void aspettaScrittura(Connessione* c, bool attendi) {
+    if (c->attendeScrittura == attendi) return;
+    struct epoll_event e = { .events = EPOLLIN | (attendi ? EPOLLOUT : 0), .data.ptr = c };
+    epoll_ctl(c->ciclo->epoll, EPOLL_CTL_MOD, c->fd, &e);
+    c->attendeScrittura = attendi;
+}
+
+/// @brief Spedisce quanto possibile del buffer di uscita senza bloccare
+static void spedisciUscita(Connessione* c) {
+    while (!c->erroreUscita && c->uscitaInizio < c->uscitaFine) {
+        ssize_t n = send(c->fd, c->uscita + c->uscitaInizio, c->uscitaFine - c->uscitaInizio,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0) {
+            c->uscitaInizio += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            aspettaScrittura(c, true);
+            return;
+        } else {
+            c->erroreUscita = true;
+            c->ingressoChiuso = true;
+        }
+    }
+    c->uscitaInizio = c->uscitaFine = 0;
+    aspettaScrittura(c, false);
+}
+
+/// @brief Legge i byte disponibili nel buffer di ingresso
+static void riceviIngresso(Connessione* c) {
+    while (!c->ingressoChiuso && c->ingressoUsato < sizeof(c->ingresso)) {
+        ssize_t n = recv(c->fd, c->ingresso + c->ingressoUsato, sizeof(c->ingresso) - c->ingressoUsato, 0);
+        if (n > 0) {
+            c->ingressoUsato += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        } else {
+            c->ingressoChiuso = true;   // Fine dell'input (0) o errore
+        }
+    }
+}
+
+static void chiudiConnessione(Connessione* c) {
+    CicloEventi* ciclo = c->ciclo;
+    DIARIO(DIARIO_INFO, CATEGORIA_SERVER, "Connessione %d chiusa", c->id);
+
+    epoll_ctl(ciclo->epoll, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+
+    if (c->precedente != NULL) c->precedente->successiva = c->successiva;
+    else ciclo->connessioni = c->successiva;
+    if (c->successiva != NULL) c->successiva->precedente = c->precedente;
+    atomic_fetch_sub(&ciclo->server->sessioniAperte, 1);
+
+    if (c->cartellaPropria) {
+        Sessione* precedente = impostaSessioneCorrente(&c->sessione);
+        rimuoviCartellaSalvataggi();
+        impostaSessioneCorrente(precedente);
+    }
+
+    liberaSessione(&c->sessione);
+    liberaCoroutine(c->coroutine);
+    free(c->uscita);
+    free(c);
+}
+
+/**
+ * @brief Fa avanzare la macchina a stati della connessione dopo un evento
+ *
+ * @details
+ * Riprende il gioco se aspettava una riga che ora c'è (o se il client ha
+ * chiuso), spedisce l'uscita e chiude la connessione quando il gioco è
+ * finito e non resta niente da spedire.
+ */
+static void aggiornaConnessione(Connessione* c) {
+    if (c->stato == SESSIONE_ATTENDE_INPUT && (rigaPronta(c) || c->ingressoChiuso)) {
+        riprendiSessione(c);
+    }
+    if (c->stato == SESSIONE_FINITA) {
+        c->ingressoUsato = 0;   // Il gioco non legge più: l'input in arrivo si scarta
+    }
+
+    spedisciUscita(c);
+
+    if (c->stato == SESSIONE_FINITA && (c->erroreUscita || c->uscitaInizio == c->uscitaFine)) {
+        chiudiConnessione(c);
+    }
+}
+
+/**
+ * @brief Sceglie la cartella dei salvataggi della sessione corrente
+ *
+ * @details
+ * Sul socket Unix il kernel dice quale utente si è collegato: i suoi
+ * salvataggi stanno in CARTELLA_SALVATAGGI/utenti/UID e li ritrova a ogni
+ * connessione. Su TCP non si sa chi c'è dall'altra parte: la connessione ha
+ * una cartella sua (con il pid, così non ne eredita una rimasta da un server
+ * precedente) che viene eliminata alla chiusura.
+ */
+static void scegliCartellaConnessione(Connessione* c, bool socketUnix) {
+    char cartella[MAX_CARTELLA_SESSIONE];
+    struct ucred credenziali;
+    socklen_t dimensione = sizeof(credenziali);
+
+    if (socketUnix && getsockopt(c->fd, SOL_SOCKET, SO_PEERCRED, &credenziali, &dimensione) == 0) {
+        snprintf(cartella, sizeof(cartella), "%s/utenti/%u", CARTELLA_SALVATAGGI, (unsigned)credenziali.uid);
+        c->cartellaPropria = false;
+    } else {
+        snprintf(cartella, sizeof(cartella), "%s/sessioni/%d-%d", CARTELLA_SALVATAGGI, (int)getpid(), c->id);
+        c->cartellaPropria = true;
+    }
+    impostaCartellaSalvataggi(cartella);
+}
+
+/// @brief Crea la connessione con la sua coroutine e fa partire il gioco fino alla prima richiesta di input
+static void apriConnessione(CicloEventi* ciclo, int fd, bool socketUnix) {
+    static const char pieno[] = "Server pieno, riprova più tardi.\n";
+    Server* s = ciclo->server;
+
+    if (atomic_fetch_add(&s->sessioniAperte, 1) >= s->maxSessioni) {
+        atomic_fetch_sub(&s->sessioniAperte, 1);
+        send(fd, pieno, sizeof(pieno) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+        close(fd);
+        return;
+    }
+
+    Connessione* c = calloc(1, sizeof(Connessione));
+    char* uscita = malloc(DIM_USCITA_CONNESSIONE);
+    Coroutine* coroutine = c != NULL ? creaCoroutine(avvioSessione, c) : NULL;
+
+    if (c == NULL || uscita == NULL || coroutine == NULL) {
+        DIARIO(DIARIO_ERRORE, CATEGORIA_SERVER, "Memoria insufficiente per una nuova connessione");
+        liberaCoroutine(coroutine);
+        free(uscita);
+        free(c);
+        close(fd);
+        atomic_fetch_sub(&s->sessioniAperte, 1);
+        return;
+    }
+
+    c->fd = fd;
+    c->id = atomic_fetch_add(&s->prossimoId, 1) + 1;
+    c->ciclo = ciclo;
+    c->uscita = uscita;
+    c->uscitaCapacita = DIM_USCITA_CONNESSIONE;
+    c->coroutine = coroutine;
+
+    // La sessione scrive nel buffer della connessione, legge dal suo ingresso e salva nella sua cartella
+    inizializzaSessione(&c->sessione, 0);
+    Sessione* precedente = impostaSessioneCorrente(&c->sessione);
+    schermoImpostaUscita(scriviUscitaConnessione, c);
+    tastieraImpostaSorgente(leggiRigaConnessione, c);
+    scegliCartellaConnessione(c, socketUnix);
+    impostaSessioneCorrente(precedente);
+
+    c->successiva = ciclo->connessioni;
+    if (c->successiva != NULL) c->successiva->precedente = c;
+    ciclo->connessioni = c;
+
+    struct epoll_event e = { .events = EPOLLIN, .data.ptr = c };
+    epoll_ctl(ciclo->epoll, EPOLL_CTL_ADD, fd, &e);
+    DIARIO(DIARIO_INFO, CATEGORIA_SERVER, "Connessione %d aperta sul thread %d", c->id, ciclo->indice);
+
+    riprendiSessione(c);
+    aggiornaConnessione(c);
+}
+
+/// @brief Accetta alcune connessioni in attesa (le altre svegliano un altro ciclo)
+static void accettaConnessioni(CicloEventi* ciclo, int ascolto) {
+    for (int i = 0; i < ACCETTATE_PER_EVENTO; i++) {
+        int fd = accept4(ascolto, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;   // EAGAIN: le ha prese un altro ciclo (o errore temporaneo, come EMFILE)
+        }
+        apriConnessione(ciclo, fd, ascolto == ciclo->server->ascoltoUnix);
+    }
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * SOCKET DI ASCOLTO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+static int ascoltaUnix(const char* percorso) {
+    struct sockaddr_un indirizzo = { .sun_family = AF_UNIX };
+    if (strlen(percorso) >= sizeof(indirizzo.sun_path)) return -1;
+    strcpy(indirizzo.sun_path, percorso);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    unlink(percorso);   // Socket rimasto da un server precedente
+    if (bind(fd, (struct sockaddr*)&indirizzo, sizeof(indirizzo)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int ascoltaTcp(int porta) {
+    struct sockaddr_in indirizzo = {
+        .sin_family = AF_INET,
+        .sin_port = htons((uint16_t)porta),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK)   // Solo connessioni locali
+    };
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    int uno = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &uno, sizeof(uno));
+    if (bind(fd, (struct sockaddr*)&indirizzo, sizeof(indirizzo)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CICLI DEGLI EVENTI
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Crea l'epoll di un ciclo e ci registra i socket di ascolto e l'eventfd di arresto
+static bool preparaCiclo(Server* s, CicloEventi* ciclo, int indice) {
+    ciclo->server = s;
+    ciclo->indice = indice;
+    ciclo->epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (ciclo->epoll < 0) return false;
+
+    // I descrittori condivisi si riconoscono dall'indirizzo del campo che li contiene
+    int* condivisi[] = { &s->ascoltoUnix, &s->ascoltoTcp, &s->fermo };
+    for (int i = 0; i < 3; i++) {
+        if (*condivisi[i] < 0) continue;
+        struct epoll_event e = {
+            .events = EPOLLIN | (condivisi[i] != &s->fermo ? EPOLLEXCLUSIVE : 0),
+            .data.ptr = condivisi[i]
+        };
+        if (epoll_ctl(ciclo->epoll, EPOLL_CTL_ADD, *condivisi[i], &e) != 0) {
+            close(ciclo->epoll);
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Thread di un ciclo: serve le sue connessioni finché l'eventfd di arresto non è scritto
+static void* eseguiCiclo(void* argomento) {
+    CicloEventi* ciclo = argomento;
+    Server* s = ciclo->server;
+    struct epoll_event eventi[EVENTI_PER_ATTESA];
+    bool fermo = false;
+
+    while (!fermo) {
+        int n = epoll_wait(ciclo->epoll, eventi, EVENTI_PER_ATTESA, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (eventi[i].data.ptr == &s->fermo) {
+                fermo = true;   // Non si legge: l'eventfd resta pronto e sveglia tutti i cicli
+            } else if (eventi[i].data.ptr == &s->ascoltoUnix) {
+                accettaConnessioni(ciclo, s->ascoltoUnix);
+            } else if (eventi[i].data.ptr == &s->ascoltoTcp) {
+                accettaConnessioni(ciclo, s->ascoltoTcp);
+            } else {
+                Connessione* c = eventi[i].data.ptr;
+                if (eventi[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) riceviIngresso(c);
+                aggiornaConnessione(c);   // Può chiuderla: 'c' non va più usato
+            }
+        }
+    }
+
+    // Chiusura: ogni gioco ancora aperto riceve la fine dell'input ed esce dai menu
+    while (ciclo->connessioni != NULL) {
+        Connessione* c = ciclo->connessioni;
+        c->ingressoChiuso = true;
+        c->erroreUscita = true;
+        if (c->stato == SESSIONE_ATTENDE_INPUT) riprendiSessione(c);
+        if (c->stato != SESSIONE_FINITA) {
+            // Non dovrebbe succedere: il gioco esce sempre con INPUT_FINE
+            DIARIO(DIARIO_ERRORE, CATEGORIA_SERVER, "Connessione %d: il gioco non termina", c->id);
+            break;
+        }
+        chiudiConnessione(c);
+    }
+    liberaEsitiCombattimento();
+    close(ciclo->epoll);
+    return NULL;
+}
+
+int eseguiServer(const OpzioniServer* opzioni) {
+    static Server s;   // Unico nel processo, e con i cicli è grande per lo stack
+    memset(&s, 0, sizeof(s));
+    s.ascoltoUnix = -1;
+    s.ascoltoTcp = -1;
+    s.maxSessioni = opzioni->maxSessioni > 0 ? opzioni->maxSessioni : MAX_SESSIONI_SERVER;
+    s.numeroCicli = opzioni->thread > 0 ? opzioni->thread : numeroCore();
+    if (s.numeroCicli > MAX_THREAD_SERVER) s.numeroCicli = MAX_THREAD_SERVER;
+
+    if (opzioni->percorsoSocket != NULL && (s.ascoltoUnix = ascoltaUnix(opzioni->percorsoSocket)) < 0) {
+        fprintf(stderr, "Impossibile ascoltare sul socket '%s'\n", opzioni->percorsoSocket);
+        return 1;
+    }
+    if (opzioni->porta > 0 && (s.ascoltoTcp = ascoltaTcp(opzioni->porta)) < 0) {
+        fprintf(stderr, "Impossibile ascoltare sulla porta %d\n", opzioni->porta);
+        if (s.ascoltoUnix >= 0) close(s.ascoltoUnix);
+        return 1;
+    }
+    s.fermo = eventfd(0, EFD_CLOEXEC);
+
+    // Le tabelle condivise si preparano qui, prima che i cicli le leggano insieme
+    catalogoMissioni();
+    compilaTrucchi();
+
+    // I segnali di chiusura arrivano solo a questo thread, in sigwait(); i cicli ereditano la maschera
+    sigset_t chiusura;
+    sigemptyset(&chiusura);
+    sigaddset(&chiusura, SIGINT);
+    sigaddset(&chiusura, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &chiusura, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    int avviati = 0;
+    while (s.fermo >= 0 && avviati < s.numeroCicli) {
+        CicloEventi* ciclo = &s.cicli[avviati];
+        if (!preparaCiclo(&s, ciclo, avviati)) break;
+        if (pthread_create(&ciclo->thread, NULL, eseguiCiclo, ciclo) != 0) {
+            close(ciclo->epoll);
+            break;
+        }
+        avviati++;
+    }
+
+    if (avviati == s.numeroCicli) {
+        DIARIO(DIARIO_INFO, CATEGORIA_SERVER, "Server avviato (socket %s, porta %d, %d thread)",
+               opzioni->percorsoSocket ? opzioni->percorsoSocket : "-", opzioni->porta, avviati);
+        fprintf(stderr, "Server in ascolto%s%s", opzioni->percorsoSocket ? " su " : "",
+                opzioni->percorsoSocket ? opzioni->percorsoSocket : "");
+        if (opzioni->porta > 0) fprintf(stderr, " su 127.0.0.1:%d", opzioni->porta);
+        fprintf(stderr, " (%d thread)\n", avviati);
+
+        int segnale;
+        sigwait(&chiusura, &segnale);
+    } else {
+        fprintf(stderr, "Impossibile avviare i thread del server\n");
+    }
+
+    if (s.fermo >= 0) {
+        uint64_t uno = 1;
+        if (write(s.fermo, &uno, sizeof(uno)) != sizeof(uno)) {
+            DIARIO(DIARIO_ERRORE, CATEGORIA_SERVER, "Impossibile fermare i cicli degli eventi");
+        }
+    }
+    for (int i = 0; i < avviati; i++) {
+        pthread_join(s.cicli[i].thread, NULL);
+    }
+    pthread_sigmask(SIG_UNBLOCK, &chiusura, NULL);
+
+    if (s.ascoltoUnix >= 0) {
+        close(s.ascoltoUnix);
+        unlink(opzioni->percorsoSocket);
+    }
+    if (s.ascoltoTcp >= 0) close(s.ascoltoTcp);
+    if (s.fermo >= 0) close(s.fermo);
+    DIARIO(DIARIO_INFO, CATEGORIA_SERVER, "Server fermato");
+    return avviati == s.numeroCicli ? 0 : 1;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CLIENT DI PROVA
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Si collega al socket Unix o alla porta locale; -1 se non riesce
+static int collegati(const char* percorso, int porta) {
+    int fd;
+    if (porta > 0) {
+        struct sockaddr_in indirizzo = {
+            .sin_family = AF_INET,
+            .sin_port = htons((uint16_t)porta),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+        };
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr*)&indirizzo, sizeof(indirizzo)) == 0) return fd;
+    } else {
+        struct sockaddr_un indirizzo = { .sun_family = AF_UNIX };
+        if (strlen(percorso) >= sizeof(indirizzo.sun_path)) return -1;
+        strcpy(indirizzo.sun_path, percorso);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr*)&indirizzo, sizeof(indirizzo)) == 0) return fd;
+    }
+    if (fd >= 0) close(fd);
+    return -1;
+}
+
+/// @brief Scrive tutto il blocco (il client può bloccare)
+static bool scriviTutto(int fd, const char* dati, size_t n) {
+    while (n > 0) {
+        ssize_t scritti = write(fd, dati, n);
+        if (scritti < 0 && errno == EINTR) continue;
+        if (scritti <= 0) return false;
+        dati += scritti;
+        n -= (size_t)scritti;
+    }
+    return true;
+}
+
+int mainClient(int argc, char* argv[]) {
+    const char* percorso = SOCKET_SERVER_PREDEFINITO;
+    int porta = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            percorso = argv[++i];
+        } else if (strcmp(argv[i], "--porta") == 0 && i + 1 < argc) {
+            porta = (int)strtol(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "Uso: %s --client [--socket PERCORSO | --porta N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int fd = collegati(percorso, porta);
+    if (fd < 0) {
+        fprintf(stderr, "Impossibile collegarsi al server\n");
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    struct pollfd attese[2] = {
+        { .fd = fd, .events = POLLIN },
+        { .fd = STDIN_FILENO, .events = POLLIN }
+    };
+    int numeroAttese = 2;
+    char buffer[4096];
+
+    for (;;) {
+        if (poll(attese, (nfds_t)numeroAttese, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (attese[0].revents) {
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n <= 0) break;   // Il server ha chiuso
+            scriviTutto(STDOUT_FILENO, buffer, (size_t)n);
+        }
+        if (numeroAttese > 1 && attese[1].revents) {
+            ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (n <= 0) {
+                shutdown(fd, SHUT_WR);   // Fine dell'input: il server chiude la sessione
+                numeroAttese = 1;
+            } else if (!scriviTutto(fd, buffer, (size_t)n)) {
+                break;
+            }
+        }
+    }
+
+    close(fd);
+    return 0;
+}
+
+#else // !__linux__
+
+int eseguiServer(const OpzioniServer* opzioni) {
+    (void)opzioni;
+    fprintf(stderr, "Il server è disponibile solo su Linux\n");
+    return 1;
+}
+
+int mainClient(int argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+    fprintf(stderr, "Il client è disponibile solo su Linux\n");
+    return 1;
+}
+
+#endif // __linux__
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * RIGA DI COMANDO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+int mainServer(int argc, char* argv[]) {
+    OpzioniServer opzioni = { NULL, 0, MAX_SESSIONI_SERVER, 0 };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            opzioni.percorsoSocket = argv[++i];
+        } else if (strcmp(argv[i], "--porta") == 0 && i + 1 < argc) {
+            opzioni.porta = (int)strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-sessioni") == 0 && i + 1 < argc) {
+            opzioni.maxSessioni = (int)strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--thread") == 0 && i + 1 < argc) {
+            opzioni.thread = (int)strtol(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "Uso: %s --server [--socket PERCORSO] [--porta N] [--max-sessioni N] [--thread N]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (opzioni.percorsoSocket == NULL && opzioni.porta <= 0) {
+        opzioni.percorsoSocket = SOCKET_SERVER_PREDEFINITO;
+    }
+
+    return eseguiServer(&opzioni);
+}
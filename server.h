@@ -0,0 +1,60 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdbool.h>
+
+/**
+ * Server di gioco: un solo processo accetta connessioni su un socket Unix e/o
+ * su una porta TCP di 127.0.0.1 e fa giocare ogni connessione in una propria
+ * sessione (vedi sessione.h). Le sessioni si dividono tra pochi thread, ognuno
+ * con il proprio ciclo epoll; una sessione resta sempre sul suo thread.
+ *
+ * Il gioco di una connessione è lo stesso del terminale (menuPrincipale() e
+ * tutto ciò che chiama) e gira in una coroutine (vedi coroutine.h): quando
+ * chiede una riga che non è ancora arrivata si sospende, e il ciclo lo
+ * riprende appena la riga è nel buffer della connessione. Il testo stampato
+ * finisce nel buffer di uscita e viene spedito senza bloccare.
+ *
+ * I salvataggi sono separati: sul socket Unix ogni utente del sistema ha i
+ * suoi, su TCP ogni connessione ha una cartella temporanea. Le operazioni
+ * sui file dei salvataggi restano sincrone sul thread del ciclo (vedi
+ * server.c).
+ *
+ * Disponibile solo su Linux.
+ */
+
+#define SOCKET_SERVER_PREDEFINITO "gioco.sock"  // Socket Unix se non si indica né socket né porta
+#define MAX_SESSIONI_SERVER 4096                 // Connessioni contemporanee predefinite
+#define DIM_INGRESSO_CONNESSIONE 512             // Byte ricevuti e non ancora letti dal gioco
+#define DIM_USCITA_CONNESSIONE 4096              // Capacità iniziale del buffer di uscita
+#define MAX_USCITA_CONNESSIONE (1024 * 1024)     // Oltre questo il client è troppo lento e viene chiuso
+#define MAX_THREAD_SERVER 64                     // Thread con un ciclo degli eventi
+
+// Opzioni del server
+typedef struct {
+    const char* percorsoSocket;    // Socket Unix (NULL = nessuno)
+    int porta;                     // Porta TCP su 127.0.0.1 (0 = nessuna)
+    int maxSessioni;               // Connessioni contemporanee oltre le quali si rifiuta
+    int thread;                    // Thread dei cicli degli eventi (0 = uno per core)
+} OpzioniServer;
+
+/**
+ * Esegue il server finché non riceve SIGINT o SIGTERM
+ * Ritorna 0 alla chiusura normale, 1 se i socket non possono essere aperti
+ */
+int eseguiServer(const OpzioniServer* opzioni);
+
+/**
+ * Interpreta gli argomenti di --server ed esegue
+ * Uso: --server [--socket PERCORSO] [--porta N] [--max-sessioni N] [--thread N]
+ */
+int mainServer(int argc, char* argv[]);
+
+/**
+ * Client di prova in stile telnet: manda le righe di stdin al server e
+ * stampa quello che risponde, finché il server non chiude
+ * Uso: --client [--socket PERCORSO | --porta N]
+ */
+int mainClient(int argc, char* argv[]);
+
+#endif // SERVER_H
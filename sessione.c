@@ -0,0 +1,44 @@
+/**
+ * @file sessione.c
+ * @brief Stato di un giocatore e sessione corrente di ogni thread
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * La sessione corrente è un puntatore per thread: chi esegue il gioco per
+ * un giocatore (il ciclo del server) la imposta prima di riprenderlo, e
+ * tutti i moduli trovano lì il proprio stato senza riceverlo come parametro.
+ */
+
+#include "sessione.h"
+#include <string.h>
+
+/// @brief Sessione del gioco da terminale, headless e riproduzione
+static Sessione sessioneLocale = {
+    .arena = { .dimensionePezzo = DIM_PEZZO_ARENA },
+    .modalitaSchermo = SCHERMO_TERMINALE
+};
+
+/// @brief Sessione corrente del thread (NULL = locale)
+static _Thread_local Sessione* corrente = NULL;
+
+void inizializzaSessione(Sessione* s, uint64_t seme) {
+    memset(s, 0, sizeof(*s));
+    s->seme = seme;
+    s->modalitaSchermo = SCHERMO_TERMINALE;
+    inizializzaArena(&s->arena, 0);
+}
+
+void liberaSessione(Sessione* s) {
+    liberaArena(&s->arena);
+}
+
+Sessione* sessioneCorrente(void) {
+    return corrente != NULL ? corrente : &sessioneLocale;
+}
+
+Sessione* impostaSessioneCorrente(Sessione* s) {
+    Sessione* precedente = sessioneCorrente();
+    corrente = s;
+    return precedente;
+}
@@ -0,0 +1,62 @@
+#ifndef SESSIONE_H
+#define SESSIONE_H
+
+#include "utils.h"
+#include "eventi.h"
+#include "schermo.h"
+#include "tastiera.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MAX_CARTELLA_SESSIONE 128          // Lunghezza massima della cartella dei salvataggi di una sessione
+
+/**
+ * Sessione di gioco: lo stato che appartiene a un giocatore e non al
+ * programma (seme, arena della partita, bus degli eventi, trucchi, dove va
+ * il testo, da dove arriva l'input e dove stanno i salvataggi). I moduli lo leggono dalla sessione
+ * corrente invece che da variabili globali, così un solo processo può far
+ * giocare più persone alternandole (vedi server.c).
+ *
+ * Senza server c'è una sola sessione, quella locale, sempre corrente.
+ * Le tabelle condivise (catalogo, automa dei trucchi) restano globali: si
+ * preparano una volta e poi si leggono. La cache delle tabelle dei
+ * combattimenti è di ogni thread.
+ */
+typedef struct {
+    uint64_t seme;                 // Seme casuale (vedi semeSessione())
+    Arena arena;                   // Stato della partita (vedi arenaSessione())
+    BusEventi eventi;              // Bus degli eventi (vedi eventi.h)
+    ListaLibera dungeonLiberi;     // Dungeon delle missioni da riusare (vedi missioni.c)
+    bool trucchiAttivi;            // Menu dei trucchi sbloccato (vedi menu.c)
+    uint16_t statoTrucchi;         // Stato dell'automa dei codici (vedi trucchi.c)
+    ModalitaSchermo modalitaSchermo; // Testo attivo o silenzioso (vedi schermo.h)
+    UscitaSchermo uscita;          // Destinazione del testo (NULL = stdout)
+    void* contestoUscita;
+    SorgenteRighe sorgente;        // Provenienza dell'input (NULL = stdin o script)
+    void* contestoSorgente;
+    char cartellaSalvataggi[MAX_CARTELLA_SESSIONE]; // "" = CARTELLA_SALVATAGGI (vedi salvataggi.h)
+} Sessione;
+
+/**
+ * Prepara una sessione vuota con il seme indicato (niente viene allocato
+ * finché la partita non inizia)
+ */
+void inizializzaSessione(Sessione* s, uint64_t seme);
+
+/**
+ * Libera la memoria della partita di una sessione che non è più corrente
+ */
+void liberaSessione(Sessione* s);
+
+/**
+ * Sessione su cui lavora il thread chiamante (la sessione locale se non ne è stata impostata una)
+ */
+Sessione* sessioneCorrente(void);
+
+/**
+ * Rende 's' la sessione corrente del thread (NULL = sessione locale)
+ * Ritorna la sessione corrente precedente
+ */
+Sessione* impostaSessioneCorrente(Sessione* s);
+
+#endif // SESSIONE_H
@@ -0,0 +1,422 @@
+/**
+ * @file simulatore.c
+ * @brief Simulatore Monte Carlo parallelo per il bilanciamento delle missioni
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * Ogni partita è un giocatore che ripete eseguiMissione() finché la missione
+ * non è completata. Ogni ingresso genera il dungeon con generaDungeon() e
+ * latoDungeonMissione(), come il gioco; "Esplora" visita la prossima stanza
+ * con esploraProssimaStanza() e ne gestisce il contenuto: nemici e generali
+ * (con la scorta) si combattono con il motore del gioco, con il seme del
+ * dungeon e l'id della stanza come incontro, i tesori danno monete e
+ * l'oggetto speciale conta per la missione.
+ *
+ * Le regole di fine ingresso sono quelle di eseguiMissione(): se l'eroe muore
+ * torna al villaggio senza monete e l'ingresso finisce; quando è ferito e ha
+ * COSTO_RITORNO_VILLAGGIO monete paga e torna; appena obiettivi e oggetto sono
+ * raggiunti torna gratis. Il progresso della missione resta tra un ingresso e
+ * l'altro (come nel GestoreMissioni) e al villaggio l'eroe si riposa sempre
+ * prima di ripartire. Un dungeon esplorato tutto senza raggiungere gli
+ * obiettivi (un generale fuggito) si lascia come gli altri, pagando.
+ *
+ * Le partite sono raggruppate in lotti da PARTITE_PER_LOTTO. Ogni lotto ha il
+ * proprio generatore, con seme derivato da (seme, missione, lotto), da cui
+ * vengono i semi dei dungeon; ogni thread accumula su statistiche proprie
+ * fatte solo di interi: la riduzione finale, fatta in ordine di thread, dà lo
+ * stesso risultato bit per bit con qualsiasi numero di thread e qualsiasi
+ * distribuzione dei lotti.
+ *
+ * I lotti sono distribuiti dal pool di lavoro (vedi utils.h) con un perOgni():
+ * un thread rimasto senza lotti ruba la metà più grande di quelli non ancora
+ * iniziati da un altro.
+ */
+
+#include "simulatore.h"
+#include "catalogo.h"
+#include "combattimento.h"
+#include "dungeon.h"
+#include "eroe.h"
+#include "missioni.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * MODELLO DI UNA PARTITA
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+ModelloSimulazione modelloSimulazionePredefinito(void) {
+    return (ModelloSimulazione){
+        .vitaEroe = VITA_MASSIMA_EROE,
+        .dannoEroe = DANNO_EROE,
+        .colpoEroe = PRECISIONE_EROE,
+        .vitaNemico = VITA_NEMICO,
+        .vitaGenerale = VITA_GENERALE,
+        .dannoNemico = DANNO_NEMICO,
+        .colpoNemico = PRECISIONE_NEMICO,
+        .sogliaRitiro = 6
+    };
+}
+
+/// @brief Stato di un lavoratore del pool durante una simulazione
+typedef struct {
+    StatisticheMissione* statistiche;
+    PoolNemici nemici;             ///< Nemici dei combattimenti, riusati da una partita all'altra
+    Arena arena;                   ///< Memoria dei dungeon, svuotata dopo ogni ingresso
+} Lavoratore;
+
+/**
+ * @brief Combatte il nemico di una stanza con il motore del gioco fino alla fine
+ *
+ * Come in eseguiMissione() il livello è il valore della stanza e il
+ * combattimento si riproduce da (seme del dungeon, id della stanza).
+ *
+ * @return Esito del combattimento (la vita dell'eroe viene aggiornata)
+ */
+static EsitoCombattimento combattiStanza(const ModelloSimulazione* m, const Dungeon* dungeon,
+                                         int stanza, int slot, int* vitaEroe, PoolNemici* nemici) {
+    bool generale = dungeon->contenuto[slot] == STANZA_GENERALE;
+    Combattente eroe = { *vitaEroe, m->dannoEroe, m->colpoEroe, 0 };
+    Combattente nemico = combattenteNemico(generale ? m->vitaGenerale : m->vitaNemico,
+                                           m->dannoNemico, m->colpoNemico, dungeon->valore[slot], generale);
+    EsitoCombattimento esito;
+
+    if (!generale) {
+        Combattimento c;
+        iniziaCombattimento(&c, &eroe, &nemico, dungeon->seme, (uint64_t)stanza);
+        esito = risolviCombattimento(&c);
+        *vitaEroe = c.eroe.vita;
+    } else {
+        // Il generale combatte con la sua scorta di livello 1, come nel dungeon
+        Combattente scorta = combattenteNemico(m->vitaNemico, m->dannoNemico, m->colpoNemico, 1, false);
+        CombattimentoGruppo c;
+        svuotaPoolNemici(nemici);
+        aggiungiNemico(nemici, &nemico, true);
+        for (int i = 0; i < SCORTA_GENERALE; i++) {
+            aggiungiNemico(nemici, &scorta, false);
+        }
+        iniziaCombattimentoGruppo(&c, &eroe, nemici, dungeon->seme, (uint64_t)stanza);
+        while ((esito = risolviRoundGruppo(&c, NULL)) == COMBATTIMENTO_IN_CORSO) {}
+        *vitaEroe = c.eroe.vita;
+    }
+    return esito;
+}
+
+/**
+ * @brief Gioca una partita della missione e ne scrive le misure in 'valori'
+ *
+ * Ogni ingresso nella missione usa un dungeon nuovo con seme preso da 'stato'.
+ *
+ * @return true se la missione è stata completata entro MAX_TURNI_SIMULAZIONE
+ */
+static bool giocaPartita(const ModelloSimulazione* m, const DefinizioneMissione* d, int lato,
+                         uint64_t* stato, Lavoratore* l, uint32_t valori[NUMERO_MISURE]) {
+    bool conOggetto = (d->flag & MISSIONE_FLAG_OGGETTO) != 0;
+    int monete = 0;
+    int obiettivi = 0;
+    bool oggetto = !conOggetto;
+    uint32_t spese = 0, morti = 0, turni = 0;
+    bool completata = false;
+    bool abbandonata = false;
+
+    while (!completata && !abbandonata && turni < MAX_TURNI_SIMULAZIONE) {
+        // Un ingresso nella missione, dopo il riposo al villaggio
+        SegnoArena segno = segnaArena(&l->arena);
+        Dungeon dungeon;
+        if (!generaDungeon(&dungeon, lato, lato, splitMix64(stato), d->obiettiviTotali, conOggetto,
+                           &l->arena)) {
+            break;
+        }
+        int vita = m->vitaEroe;
+        bool inCorso = true;
+
+        while (inCorso && turni < MAX_TURNI_SIMULAZIONE) {
+            turni++;
+
+            // Obiettivi raggiunti: il ritorno al villaggio è gratuito
+            if (obiettivi >= d->obiettiviTotali && oggetto) {
+                completata = true;
+                break;
+            }
+
+            // Ferito: si torna pagando, se si può (altrimenti si continua)
+            if (vita <= m->sogliaRitiro && monete >= COSTO_RITORNO_VILLAGGIO) {
+                monete -= COSTO_RITORNO_VILLAGGIO;
+                spese += COSTO_RITORNO_VILLAGGIO;
+                break;
+            }
+
+            int stanza = esploraProssimaStanza(&dungeon);
+            if (stanza < 0) {
+                // Dungeon finito senza obiettivi (un generale è fuggito): si esce pagando
+                if (monete < COSTO_RITORNO_VILLAGGIO) {
+                    abbandonata = true;    // Bloccato nel dungeon: la partita finisce qui
+                    break;
+                }
+                turni++;
+                monete -= COSTO_RITORNO_VILLAGGIO;
+                spese += COSTO_RITORNO_VILLAGGIO;
+                break;
+            }
+
+            int slot = slotStanza(&dungeon, stanza);
+            switch (dungeon.contenuto[slot]) {
+                case STANZA_NEMICO:
+                case STANZA_GENERALE: {
+                    bool generale = dungeon.contenuto[slot] == STANZA_GENERALE;
+                    EsitoCombattimento esito = combattiStanza(m, &dungeon, stanza, slot, &vita, &l->nemici);
+                    if (esito == COMBATTIMENTO_SCONFITTA) {
+                        // Morte: si torna al villaggio senza monete, il progresso resta
+                        morti++;
+                        monete = 0;
+                        inCorso = false;
+                    } else if (esito == COMBATTIMENTO_VITTORIA && generale &&
+                               obiettivi < d->obiettiviTotali) {
+                        obiettivi++;
+                    }
+                    break;
+                }
+                case STANZA_OGGETTO:
+                    oggetto = true;
+                    break;
+                case STANZA_TESORO:
+                    monete += dungeon.valore[slot];
+                    break;
+                default:
+                    break;
+            }
+            if (inCorso) svuotaStanza(&dungeon, stanza);
+        }
+
+        liberaDungeon(&dungeon);
+        ripristinaArena(&l->arena, segno);
+    }
+
+    valori[MISURA_MONETE_SPESE] = spese;
+    valori[MISURA_MORTI] = morti;
+    valori[MISURA_TURNI] = turni;
+    return completata;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * LOTTI
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Dati condivisi da tutti i thread di una simulazione
+typedef struct {
+    const ModelloSimulazione* modello;
+    const DefinizioneMissione* definizione;
+    uint64_t semeMissione;         ///< Seme comune, già mescolato con l'id della missione
+    int lato;                      ///< Stanze per lato dei dungeon della missione
+    long partite;                  ///< Partite totali della missione
+    Lavoratore* lavoratori;        ///< Uno per lavoratore del pool
+} Simulazione;
+
+/// @brief Gioca le partite di un lotto accumulandole nelle statistiche del thread
+static void eseguiLotto(const Simulazione* s, long lotto, Lavoratore* l) {
+    StatisticheMissione* stat = l->statistiche;
+    uint64_t stato = s->semeMissione ^ ((uint64_t)lotto * 0xD1B54A32D192ED03ULL);
+    stato = splitMix64(&stato);
+
+    long prima = lotto * PARTITE_PER_LOTTO;
+    long numero = s->partite - prima < PARTITE_PER_LOTTO ? s->partite - prima : PARTITE_PER_LOTTO;
+
+    for (long p = 0; p < numero; p++) {
+        uint32_t valori[NUMERO_MISURE];
+        if (giocaPartita(s->modello, s->definizione, s->lato, &stato, l, valori)) {
+            stat->completate++;
+        }
+        stat->partite++;
+
+        for (int k = 0; k < NUMERO_MISURE; k++) {
+            uint32_t v = valori[k];
+            stat->somma[k] += v;
+            if (v > stat->massimo[k]) stat->massimo[k] = v;
+            stat->istogramma[k][v < DIM_ISTOGRAMMA_SIMULAZIONE ? v : DIM_ISTOGRAMMA_SIMULAZIONE - 1]++;
+        }
+    }
+}
+
+/// @brief Corpo del perOgni() sui lotti: ogni lavoratore accumula nelle proprie statistiche
+static void giocaLotti(void* argomento, long da, long a, int lavoratore) {
+    const Simulazione* s = argomento;
+    for (long lotto = da; lotto < a; lotto++) {
+        eseguiLotto(s, lotto, &s->lavoratori[lavoratore]);
+    }
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * SIMULAZIONE DI UNA MISSIONE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+bool simulaMissione(const OpzioniSimulazione* opzioni, int missione, StatisticheMissione* statistiche) {
+    const DefinizioneMissione* d = definizioneMissione(missione);
+    if (d == NULL || opzioni->partite < 1 || opzioni->thread < 1 ||
+        opzioni->thread > MAX_THREAD_SIMULAZIONE) {
+        return false;
+    }
+
+    long lotti = (opzioni->partite + PARTITE_PER_LOTTO - 1) / PARTITE_PER_LOTTO;
+
+    uint64_t semeMissione = opzioni->seme ^ ((uint64_t)(missione + 1) * 0x9E3779B97F4A7C15ULL);
+
+    PoolLavori* pool = creaPoolLavori(opzioni->thread, false);
+    if (pool == NULL) return false;
+    int numeroThread = numeroLavoratori(pool);
+
+    // Un unico blocco: lavoratori e statistiche parziali di ogni thread
+    size_t dimensione = sizeof(Lavoratore) * (size_t)numeroThread +
+                        sizeof(StatisticheMissione) * (size_t)numeroThread;
+    char* blocco = calloc(1, dimensione);
+    if (blocco == NULL) {
+        liberaPoolLavori(pool);
+        return false;
+    }
+
+    Lavoratore* lavoratori = (Lavoratore*)blocco;
+    StatisticheMissione* parziali = (StatisticheMissione*)(lavoratori + numeroThread);
+
+    for (int t = 0; t < numeroThread; t++) {
+        lavoratori[t].statistiche = &parziali[t];
+        inizializzaArena(&lavoratori[t].arena, 0);
+        if (!inizializzaPoolNemici(&lavoratori[t].nemici, 1 + SCORTA_GENERALE, NULL)) {
+            for (int u = 0; u < t; u++) {
+                liberaPoolNemici(&lavoratori[u].nemici);
+            }
+            free(blocco);
+            liberaPoolLavori(pool);
+            return false;
+        }
+    }
+
+    Simulazione s = { &opzioni->modello, d, semeMissione, latoDungeonMissione(d), opzioni->partite,
+                      lavoratori };
+    perOgni(pool, 0, lotti, 1, giocaLotti, &s);
+    liberaPoolLavori(pool);
+
+    // Riduzione in ordine di thread (tutti interi: il risultato non dipende dall'ordine)
+    memset(statistiche, 0, sizeof(*statistiche));
+    for (int t = 0; t < numeroThread; t++) {
+        const StatisticheMissione* p = &parziali[t];
+        statistiche->partite += p->partite;
+        statistiche->completate += p->completate;
+        for (int k = 0; k < NUMERO_MISURE; k++) {
+            statistiche->somma[k] += p->somma[k];
+            if (p->massimo[k] > statistiche->massimo[k]) statistiche->massimo[k] = p->massimo[k];
+            for (int v = 0; v < DIM_ISTOGRAMMA_SIMULAZIONE; v++) {
+                statistiche->istogramma[k][v] += p->istogramma[k][v];
+            }
+        }
+        liberaPoolNemici(&lavoratori[t].nemici);
+        liberaArena(&lavoratori[t].arena);
+    }
+
+    free(blocco);
+    return statistiche->partite == (uint64_t)opzioni->partite;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * RISULTATI
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Più piccolo valore v con almeno 'percentuale'% delle partite <= v
+static int percentile(const uint64_t* istogramma, uint64_t partite, int percentuale) {
+    uint64_t soglia = (partite * (uint64_t)percentuale + 99) / 100;
+    uint64_t cumulate = 0;
+    for (int v = 0; v < DIM_ISTOGRAMMA_SIMULAZIONE; v++) {
+        cumulate += istogramma[v];
+        if (cumulate >= soglia) return v;
+    }
+    return DIM_ISTOGRAMMA_SIMULAZIONE - 1;
+}
+
+static void scriviDistribuzione(FILE* out, const char* nome, const StatisticheMissione* st,
+                                MisuraSimulazione k) {
+    fprintf(out, "\"%s\":{\"media\":%.3f,\"p50\":%d,\"p90\":%d,\"p99\":%d,\"max\":%u}",
+            nome, st->partite ? (double)st->somma[k] / (double)st->partite : 0.0,
+            percentile(st->istogramma[k], st->partite, 50),
+            percentile(st->istogramma[k], st->partite, 90),
+            percentile(st->istogramma[k], st->partite, 99),
+            st->massimo[k]);
+}
+
+int eseguiSimulazione(const OpzioniSimulazione* opzioni, FILE* risultati) {
+    int numeroMissioni = numeroMissioniCatalogo();
+    int prima = opzioni->missione < 0 ? 0 : opzioni->missione;
+    int ultima = opzioni->missione < 0 ? numeroMissioni - 1 : opzioni->missione;
+
+    // Le statistiche (istogrammi compresi) sono troppo grandi per lo stack
+    StatisticheMissione* st = malloc(sizeof(StatisticheMissione));
+    if (st == NULL) return 1;
+
+    long long inizio = adessoNs();
+    for (int id = prima; id <= ultima; id++) {
+        if (!simulaMissione(opzioni, id, st)) {
+            fprintf(stderr, "Simulazione della missione %d non riuscita\n", id);
+            free(st);
+            return 1;
+        }
+
+        fprintf(risultati, "{\"missione\":%d,\"partite\":%llu,\"completate\":%llu,",
+                id, (unsigned long long)st->partite, (unsigned long long)st->completate);
+        scriviDistribuzione(risultati, "moneteSpese", st, MISURA_MONETE_SPESE);
+        fputc(',', risultati);
+        scriviDistribuzione(risultati, "morti", st, MISURA_MORTI);
+        fputc(',', risultati);
+        scriviDistribuzione(risultati, "turni", st, MISURA_TURNI);
+        fprintf(risultati, "}\n");
+    }
+    long long totaleNs = adessoNs() - inizio;
+
+    long partiteTotali = opzioni->partite * (ultima - prima + 1);
+    double secondi = totaleNs / 1e9;
+    fprintf(risultati, "{\"riepilogo\":{\"seme\":%llu,\"thread\":%d,\"partite\":%ld,\"ns\":%lld,"
+                       "\"partiteAlSecondo\":%.1f}}\n",
+            (unsigned long long)opzioni->seme, opzioni->thread, partiteTotali, totaleNs,
+            secondi > 0 ? partiteTotali / secondi : 0.0);
+
+    free(st);
+    return 0;
+}
+
+int mainSimula(int argc, char* argv[]) {
+    OpzioniSimulazione opzioni = {
+        .partite = 1000000,
+        .seme = 0,
+        .thread = numeroCore(),
+        .missione = -1,
+        .modello = modelloSimulazionePredefinito()
+    };
+    bool semeScelto = false;
+    bool valide = true;
+
+    for (int i = 1; i < argc && valide; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            opzioni.partite = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--seme") == 0 && i + 1 < argc) {
+            opzioni.seme = strtoull(argv[++i], NULL, 10);
+            semeScelto = true;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            opzioni.thread = (int)strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--missione") == 0 && i + 1 < argc) {
+            opzioni.missione = (int)strtol(argv[++i], NULL, 10);
+        } else {
+            valide = false;
+        }
+    }
+
+    if (!valide || opzioni.partite < 1 || opzioni.thread < 1 ||
+        opzioni.thread > MAX_THREAD_SIMULAZIONE ||
+        opzioni.missione < -1 || opzioni.missione >= numeroMissioniCatalogo()) {
+        fprintf(stderr, "Uso: %s --simula [-n PARTITE] [--seme SEME] [-t THREAD] [--missione ID]\n",
+                argv[0]);
+        return 1;
+    }
+
+    // Senza --seme se ne genera uno; viene scritto nel riepilogo per poter ripetere la simulazione
+    if (!semeScelto) opzioni.seme = inizializzaSemeSessione();
+
+    return eseguiSimulazione(&opzioni, stdout);
+}
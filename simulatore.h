@@ -0,0 +1,85 @@
+#ifndef SIMULATORE_H
+#define SIMULATORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Simulatore Monte Carlo per il bilanciamento delle missioni
+ * Gioca una missione come eseguiMissione() (dungeon del gioco, combattimenti,
+ * ritorno al villaggio a pagamento) milioni di volte, senza I/O.
+ * Le partite sono divise in lotti con un seme derivato da (seme, missione, lotto):
+ * il risultato non dipende da quale thread esegue un lotto né da quanti thread ci sono.
+ */
+
+#define PARTITE_PER_LOTTO 4096             // Partite giocate da un lotto (unità di lavoro dei thread)
+#define MAX_TURNI_SIMULAZIONE 1000         // Oltre questo numero di azioni la partita è abbandonata
+#define DIM_ISTOGRAMMA_SIMULAZIONE 1024    // I valori più grandi finiscono nell'ultima casella
+#define MAX_THREAD_SIMULAZIONE 64
+
+// Grandezze misurate per ogni partita
+typedef enum {
+    MISURA_MONETE_SPESE = 0,       // Monete spese per tornare al villaggio
+    MISURA_MORTI,                  // Volte in cui l'eroe è morto prima di finire la missione
+    MISURA_TURNI,                  // Azioni del menu di missione, su tutti gli ingressi
+    NUMERO_MISURE
+} MisuraSimulazione;
+
+/**
+ * Parametri dei combattimenti e della strategia del giocatore simulato
+ * Dungeon, livelli dei nemici e tesori sono quelli del gioco
+ */
+typedef struct {
+    int vitaEroe;                  // Vita all'inizio di ogni ingresso (dopo il riposo al villaggio)
+    int dannoEroe;                 // Danno massimo di un colpo dell'eroe (minimo 1)
+    int colpoEroe;                 // Probabilità (percentuale) che l'eroe colpisca
+    int vitaNemico;                // Vita di un nemico comune al livello 1
+    int vitaGenerale;              // Vita di un generale al livello 1
+    int dannoNemico;               // Danno massimo di un colpo nemico al livello 1
+    int colpoNemico;               // Probabilità (percentuale) che il nemico colpisca
+    int sogliaRitiro;              // Con vita <= soglia l'eroe torna al villaggio, se ha le monete
+} ModelloSimulazione;
+
+// Statistiche di una missione; solo interi, quindi la somma dei parziali è esatta
+typedef struct {
+    uint64_t partite;                                              // Partite giocate
+    uint64_t completate;                                           // Missioni completate entro MAX_TURNI_SIMULAZIONE
+    uint64_t somma[NUMERO_MISURE];                                 // Somma dei valori (per la media)
+    uint32_t massimo[NUMERO_MISURE];                               // Valore massimo osservato
+    uint64_t istogramma[NUMERO_MISURE][DIM_ISTOGRAMMA_SIMULAZIONE];// Partite per valore
+} StatisticheMissione;
+
+// Opzioni della simulazione
+typedef struct {
+    long partite;                  // Partite per missione
+    uint64_t seme;                 // Seme comune a tutti i lotti
+    int thread;                    // Thread di lavoro
+    int missione;                  // Id della missione da simulare (-1 = tutte)
+    ModelloSimulazione modello;    // Parametri del modello
+} OpzioniSimulazione;
+
+/**
+ * Parametri predefiniti del modello
+ */
+ModelloSimulazione modelloSimulazionePredefinito(void);
+
+/**
+ * Simula le partite di una missione del catalogo e riempie 'statistiche'
+ * Ritorna false se la missione non esiste o i thread non possono essere avviati
+ */
+bool simulaMissione(const OpzioniSimulazione* opzioni, int missione, StatisticheMissione* statistiche);
+
+/**
+ * Simula le missioni richieste e scrive i risultati (JSON, uno per riga) su 'risultati'
+ * Ritorna 0 se tutto è andato bene, 1 in caso di errore
+ */
+int eseguiSimulazione(const OpzioniSimulazione* opzioni, FILE* risultati);
+
+/**
+ * Interpreta gli argomenti da riga di comando di --simula ed esegue
+ * Uso: --simula [-n PARTITE] [--seme SEME] [-t THREAD] [--missione ID]
+ */
+int mainSimula(int argc, char* argv[]);
+
+#endif // SIMULATORE_H
@@ -0,0 +1,600 @@
+/**
+ * @file tastiera.c
+ * @brief Livello di input non bloccante con modalità raw e coda di eventi
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ *
+ * @details
+ * Questo modulo sostituisce la lettura bloccante con getchar() per i menu:
+ * - Porta il terminale in modalità raw (un tasto alla volta, senza Invio)
+ * - Legge i byte disponibili senza bloccare tramite poll()
+ * - Decodifica le sequenze di escape (frecce) in eventi
+ * - Accoda gli eventi in una coda circolare a dimensione fissa
+ *
+ * I cicli di gioco possono quindi chiedere "il prossimo evento" senza fermarsi,
+ * oppure inserire tastieraDescrittore() nel proprio poll insieme ad altre sorgenti.
+ *
+ * La modalità raw, una volta attivata, resta tale per tutta la partita: si
+ * torna alla modalità normale solo per il tempo di una lettura di riga.
+ * I cambi usano TCSANOW, quindi i tasti battuti in anticipo non vanno persi.
+ */
+
+#ifndef _WIN32
+#define _DEFAULT_SOURCE   // sigaction()
+#endif
+
+#include "tastiera.h"
+#include "schermo.h"
+#include "registrazione.h"
+#include "sessione.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <conio.h>
+#include <windows.h>
+#else
+#include <termios.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#endif
+
+/// @brief Attesa massima (ms) per i byte che completano una sequenza di escape
+#define ATTESA_SEQUENZA_MS 25
+
+/// @brief Numero massimo di byte in attesa di essere decodificati
+#define MAX_BYTE_PENDENTI 16
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * STATO DEL MODULO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Stato interno della tastiera
+ *
+ * @details
+ * La coda è un ring buffer: testa indica il prossimo evento da leggere,
+ * coda il prossimo slot libero. Gli indici crescono sempre e vengono
+ * ridotti con la maschera DIM_CODA_TASTIERA - 1.
+ */
+static struct {
+    bool rawAttiva;                               ///< true se il terminale è in modalità raw
+    bool ripristinoRegistrato;                    ///< true se atexit() è già stato chiamato
+    bool invioDaIgnorare;                         ///< L'ultimo input era un tasto di menu (vedi leggiTastoRaw)
+#ifndef _WIN32
+    struct termios originale;                     ///< Impostazioni del terminale da ripristinare
+#endif
+    EventoTastiera eventi[DIM_CODA_TASTIERA];     ///< Coda circolare degli eventi decodificati
+    unsigned int testa;                           ///< Indice del prossimo evento da consumare
+    unsigned int coda;                            ///< Indice del prossimo slot libero
+    unsigned char pendenti[MAX_BYTE_PENDENTI];    ///< Byte letti ma non ancora decodificati
+    int numPendenti;                              ///< Numero di byte in pendenti[]
+    const RigaScript* script;                     ///< Righe dello script (NULL = leggi da stdin)
+    int righeScript;                              ///< Numero di righe dello script
+    int rigaCorrente;                             ///< Prossima riga dello script da consumare
+    bool terminato;                               ///< true se l'input è finito
+    long consumati;                               ///< Input consumati dall'ultimo riavvolgimento
+} stato = {0};
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * CODA DEGLI EVENTI
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Inserisce un evento in coda
+ *
+ * @note Se la coda è piena l'evento più vecchio viene scartato:
+ *       un giocatore che tiene premuto un tasto non deve bloccare il gioco.
+ */
+static void accoda(TipoTasto tipo, char carattere) {
+    if (stato.coda - stato.testa == DIM_CODA_TASTIERA) {
+        stato.testa++;
+    }
+    EventoTastiera* e = &stato.eventi[stato.coda & (DIM_CODA_TASTIERA - 1)];
+    e->tipo = tipo;
+    e->carattere = carattere;
+    stato.coda++;
+}
+
+/**
+ * @brief Estrae il prossimo evento dalla coda
+ * @return true se è stato estratto un evento, false se la coda è vuota
+ */
+static bool estrai(EventoTastiera* evento) {
+    if (stato.testa == stato.coda) return false;
+    *evento = stato.eventi[stato.testa & (DIM_CODA_TASTIERA - 1)];
+    stato.testa++;
+    return true;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * DECODIFICA
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Traduce il byte finale di una sequenza di escape in un tasto freccia
+ * @return Il tasto corrispondente, o TASTO_ESC se il byte non è riconosciuto
+ */
+static TipoTasto tastoFreccia(unsigned char lettera) {
+    switch (lettera) {
+        case 'A': return TASTO_SU;
+        case 'B': return TASTO_GIU;
+        case 'C': return TASTO_DESTRA;
+        case 'D': return TASTO_SINISTRA;
+        default:  return TASTO_ESC;
+    }
+}
+
+/**
+ * @brief Lunghezza della sequenza di escape che inizia con l'ESC in s[0]
+ *
+ * @details
+ * ESC O x è lunga sempre 3 byte. Una CSI (ESC [) può avere parametri e
+ * intermedi prima del byte finale, come ESC [ 1 ; 5 A (Ctrl+freccia) o
+ * ESC [ 3 ~ (Canc): va consumata tutta, altrimenti i parametri
+ * arriverebbero al menu come tasti.
+ *
+ * @return Byte della sequenza, 0 se l'ESC non apre una sequenza, -1 se mancano byte
+ */
+static int lunghezzaSequenza(const unsigned char* s, int n) {
+    if (n < 2) return -1;
+    if (s[1] == 'O') return n >= 3 ? 3 : -1;
+    if (s[1] != '[') return 0;
+
+    // Parametri 0x30-0x3F, intermedi 0x20-0x2F, byte finale 0x40-0x7E
+    for (int k = 2; k < n; k++) {
+        if (s[k] >= 0x40 && s[k] <= 0x7E) return k + 1;
+        if (s[k] < 0x20 || s[k] > 0x3F) return 0;
+    }
+    return -1;
+}
+
+/**
+ * @brief Decodifica i byte pendenti e li trasforma in eventi
+ *
+ * @details
+ * Riconosce le sequenze ESC [ ... A-D e ESC O A-D (frecce in modalità normale
+ * e applicazione, anche con modificatori); le altre sequenze vengono
+ * consumate e diventano TASTO_ESC. Una sequenza incompleta resta in
+ * pendenti[] finché non arrivano gli altri byte, a meno che completa sia
+ * true (timeout scaduto): in quel caso l'ESC viene emesso da solo e i byte
+ * della sequenza troncata vengono scartati.
+ *
+ * @param completa true se non arriveranno altri byte a breve
+ */
+static void decodifica(bool completa) {
+    int i = 0;
+
+    while (i < stato.numPendenti) {
+        unsigned char b = stato.pendenti[i];
+
+        if (b == 0x1b) {
+            int rimasti = stato.numPendenti - i;
+            int lunghezza = lunghezzaSequenza(&stato.pendenti[i], rimasti);
+            if (lunghezza > 0) {
+                accoda(tastoFreccia(stato.pendenti[i + lunghezza - 1]), 0);
+                i += lunghezza;
+                continue;
+            }
+            if (lunghezza < 0 && !completa) break;   // aspetta il resto della sequenza
+            accoda(TASTO_ESC, 0);
+            i += lunghezza < 0 ? rimasti : 1;
+            continue;
+        }
+
+        if (b == '\r' || b == '\n') {
+            accoda(TASTO_INVIO, '\n');
+        } else if (b == 0x7f || b == 0x08) {
+            accoda(TASTO_BACKSPACE, 0);
+        } else if (b == 0x04) {
+            accoda(TASTO_FINE_INPUT, 0);
+        } else {
+            accoda(TASTO_CARATTERE, (char)b);
+        }
+        i++;
+    }
+
+    // Sposta in testa i byte non ancora consumati
+    memmove(stato.pendenti, stato.pendenti + i, (size_t)(stato.numPendenti - i));
+    stato.numPendenti -= i;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * LETTURA DAL TERMINALE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+#ifdef _WIN32
+
+/**
+ * @brief Legge i tasti disponibili dalla console di Windows
+ *
+ * @details
+ * Su Windows la console consegna già i tasti singolarmente: le frecce arrivano
+ * come coppia (0 o 0xE0, codice) e vengono tradotte direttamente in eventi.
+ */
+static bool pompa(int timeoutMs) {
+    DWORD inizio = GetTickCount();
+
+    while (!_kbhit()) {
+        if (timeoutMs >= 0 && (int)(GetTickCount() - inizio) >= timeoutMs) return false;
+        Sleep(1);
+    }
+
+    while (_kbhit()) {
+        int c = _getch();
+        if (c == 0 || c == 0xE0) {
+            switch (_getch()) {
+                case 72: accoda(TASTO_SU, 0); break;
+                case 80: accoda(TASTO_GIU, 0); break;
+                case 77: accoda(TASTO_DESTRA, 0); break;
+                case 75: accoda(TASTO_SINISTRA, 0); break;
+                default: break;
+            }
+        } else {
+            stato.pendenti[0] = (unsigned char)c;
+            stato.numPendenti = 1;
+            decodifica(true);
+        }
+    }
+    return true;
+}
+
+bool tastieraAttivaRaw(void) {
+    if (!_isatty(_fileno(stdin))) return false;
+    stato.rawAttiva = true;
+    return true;
+}
+
+void tastieraRipristina(void) {
+    stato.rawAttiva = false;
+}
+
+int tastieraDescrittore(void) {
+    return -1;
+}
+
+#else
+
+/**
+ * @brief Legge senza bloccare i byte disponibili su stdin e li decodifica
+ *
+ * @param timeoutMs Attesa massima in millisecondi (0 = nessuna attesa, < 0 = infinita)
+ * @return true se è stato letto almeno un byte (o la fine dell'input)
+ */
+static bool pompa(int timeoutMs) {
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+
+    if (poll(&pfd, 1, timeoutMs) <= 0) return false;
+
+    unsigned char buffer[64];
+    ssize_t letti = read(STDIN_FILENO, buffer, sizeof(buffer));
+
+    if (letti <= 0) {
+        accoda(TASTO_FINE_INPUT, 0);
+        return true;
+    }
+
+    for (ssize_t i = 0; i < letti; i++) {
+        if (stato.numPendenti == MAX_BYTE_PENDENTI) decodifica(false);
+        if (stato.numPendenti == MAX_BYTE_PENDENTI) decodifica(true);   // sequenza troppo lunga
+        stato.pendenti[stato.numPendenti++] = buffer[i];
+    }
+    decodifica(false);
+
+    // Un ESC rimasto da solo: attende brevemente il resto della sequenza
+    if (stato.numPendenti > 0) {
+        pfd.revents = 0;
+        if (poll(&pfd, 1, ATTESA_SEQUENZA_MS) > 0) {
+            return pompa(0);
+        }
+        decodifica(true);
+    }
+    return true;
+}
+
+/**
+ * @brief Ripristina il terminale e lascia che il segnale termini il processo
+ *
+ * @details
+ * Con la modalità raw attiva per tutta la partita, un Ctrl-C lascerebbe il
+ * terminale senza eco (atexit non viene chiamata da un segnale).
+ * tcsetattr è sicura dentro un gestore di segnale.
+ */
+static void ripristinaPerSegnale(int segnale) {
+    tcsetattr(STDIN_FILENO, TCSANOW, &stato.originale);
+    signal(segnale, SIG_DFL);
+    raise(segnale);
+}
+
+/// @brief Installa ripristinaPerSegnale dove il segnale ha ancora l'azione predefinita
+static void registraRipristinoSegnali(void) {
+    static const int segnali[] = { SIGINT, SIGTERM, SIGHUP, SIGQUIT };
+
+    for (size_t i = 0; i < sizeof(segnali) / sizeof(segnali[0]); i++) {
+        struct sigaction attuale;
+        if (sigaction(segnali[i], NULL, &attuale) == 0 && attuale.sa_handler == SIG_DFL) {
+            struct sigaction azione = {0};
+            azione.sa_handler = ripristinaPerSegnale;
+            sigemptyset(&azione.sa_mask);
+            sigaction(segnali[i], &azione, NULL);
+        }
+    }
+}
+
+bool tastieraAttivaRaw(void) {
+    if (stato.rawAttiva) return true;
+    if (!isatty(STDIN_FILENO)) return false;
+
+    if (tcgetattr(STDIN_FILENO, &stato.originale) == -1) return false;
+
+    struct termios raw = stato.originale;
+    raw.c_lflag &= ~(ICANON | ECHO);    // niente buffer di riga e niente eco (ISIG resta: Ctrl-C funziona)
+    raw.c_iflag &= ~(IXON | ICRNL);     // niente Ctrl-S/Ctrl-Q, Invio arriva come '\r'
+    raw.c_cc[VMIN] = 0;                 // read() non blocca mai: l'attesa la gestisce poll()
+    raw.c_cc[VTIME] = 0;
+
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) == -1) return false;
+
+    if (!stato.ripristinoRegistrato) {
+        atexit(tastieraRipristina);
+        registraRipristinoSegnali();
+        stato.ripristinoRegistrato = true;
+    }
+    stato.rawAttiva = true;
+    return true;
+}
+
+void tastieraRipristina(void) {
+    if (!stato.rawAttiva) return;
+    tcsetattr(STDIN_FILENO, TCSANOW, &stato.originale);
+    stato.rawAttiva = false;
+}
+
+int tastieraDescrittore(void) {
+    return STDIN_FILENO;
+}
+
+#endif
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * API PUBBLICA
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+bool tastieraRawAttiva(void) {
+    return stato.rawAttiva;
+}
+
+bool tastieraProssimoEvento(EventoTastiera* evento) {
+    if (evento == NULL) return false;
+    if (estrai(evento)) return true;
+    pompa(0);
+    return estrai(evento);
+}
+
+bool tastieraAttendiEvento(EventoTastiera* evento, int timeoutMs) {
+    if (evento == NULL) return false;
+    if (estrai(evento)) return true;
+    schermoSvuota();    // il prompt deve essere visibile prima di mettersi in attesa
+    pompa(timeoutMs);
+    return estrai(evento);
+}
+
+/**
+ * @brief Attende un tasto in modalità raw e lo converte nel carattere atteso dai menu
+ *
+ * @details
+ * Le frecce diventano w/s/a/d: la sequenza Konami (su su giù giù sinistra destra
+ * sinistra destra b a) corrisponde quindi alla stringa dei trucchi.
+ * Backspace ed Esc vengono ignorati, e così un Invio che segue subito un
+ * tasto di menu: chi è abituato a confermare la scelta lo batte comunque.
+ */
+static char leggiTastoRaw(void) {
+    EventoTastiera e;
+
+    while (1) {
+        if (!tastieraAttendiEvento(&e, -1)) continue;
+
+        bool dopoTasto = stato.invioDaIgnorare;
+        stato.invioDaIgnorare = false;
+
+        char ch;
+        switch (e.tipo) {
+            case TASTO_CARATTERE:   ch = e.carattere; break;
+            case TASTO_INVIO:
+                if (dopoTasto) continue;
+                ch = '\n';
+                break;
+            case TASTO_SU:          ch = 'w'; break;
+            case TASTO_GIU:         ch = 's'; break;
+            case TASTO_SINISTRA:    ch = 'a'; break;
+            case TASTO_DESTRA:      ch = 'd'; break;
+            case TASTO_FINE_INPUT:  return INPUT_FINE;
+            default:                continue;
+        }
+
+        // La modalità raw non fa eco: ripete il tasto come farebbe il terminale
+        if (ch != '\n') {
+            stampa("%c", ch);
+            stato.invioDaIgnorare = true;
+        }
+        stampa("\n");
+        return ch;
+    }
+}
+
+/**
+ * @brief Legge una riga da stdin senza il '\n' finale
+ * La parte di riga che non entra nel buffer viene scartata
+ */
+static bool leggiRigaStdin(char* buffer, size_t dimensione) {
+    if (fgets(buffer, (int)dimensione, stdin) == NULL) return false;
+
+    size_t len = strlen(buffer);
+    if (len > 0 && buffer[len - 1] == '\n') {
+        buffer[len - 1] = '\0';
+    } else {
+        int c;
+        while ((c = getchar()) != '\n' && c != EOF);   // riga troppo lunga: scarta il resto
+    }
+    return true;
+}
+
+/**
+ * @brief Legge una riga dal terminale mentre la modalità raw è attiva
+ *
+ * @details
+ * I tasti già decodificati in coda (battuti in anticipo) sono l'inizio della
+ * riga: se comprendono l'Invio la riga è pronta senza toccare il terminale.
+ * Altrimenti vengono ripetuti a schermo, si torna in modalità normale solo
+ * per la fgets (TCSANOW non scarta ciò che è ancora nel terminale) e poi si
+ * rientra in raw. Come nei menu, un Invio che segue subito un tasto di menu
+ * non produce una riga vuota.
+ */
+static bool leggiRigaTerminale(char* buffer, size_t dimensione) {
+    bool dopoTasto = stato.invioDaIgnorare;
+    stato.invioDaIgnorare = false;
+
+    size_t n = 0;
+    EventoTastiera e;
+    pompa(0);
+    while (estrai(&e)) {
+        switch (e.tipo) {
+            case TASTO_INVIO:
+                if (dopoTasto && n == 0) break;
+                buffer[n] = '\0';
+                stampa("%s\n", buffer);
+                return true;
+            case TASTO_CARATTERE:
+                if (n + 1 < dimensione) buffer[n++] = e.carattere;
+                break;
+            case TASTO_BACKSPACE:
+                if (n > 0) n--;
+                break;
+            case TASTO_FINE_INPUT:
+                if (n == 0) return false;
+                break;
+            default:
+                break;
+        }
+        dopoTasto = false;
+    }
+
+    buffer[n] = '\0';
+    stampa("%s", buffer);
+    schermoSvuota();
+
+    tastieraRipristina();
+    bool letta = leggiRigaStdin(buffer + n, dimensione - n);
+    if (letta && dopoTasto && buffer[0] == '\0') letta = leggiRigaStdin(buffer, dimensione);
+    tastieraAttivaRaw();
+    return letta;
+}
+
+/**
+ * @brief Prende la prossima riga dello script
+ * @return Puntatore alla riga, o NULL se lo script è esaurito
+ */
+static const RigaScript* prossimaRigaScript(void) {
+    if (stato.rigaCorrente >= stato.righeScript) return NULL;
+    return &stato.script[stato.rigaCorrente++];
+}
+
+char tastieraLeggiCarattere(void) {
+    char ch;
+    const Sessione* sessione = sessioneCorrente();
+
+    if (sessione->sorgente != NULL) {
+        // Lo stato globale (fine e contatore dello script) non si tocca: le sessioni girano su più thread
+        char riga[2];
+        if (!sessione->sorgente(sessione->contestoSorgente, riga, sizeof(riga))) return INPUT_FINE;
+        return riga[0] != '\0' ? riga[0] : '\n';
+    }
+
+    if (stato.script != NULL) {
+        const RigaScript* riga = prossimaRigaScript();
+        ch = (riga == NULL) ? INPUT_FINE : (riga->lunghezza > 0 ? riga->testo[0] : '\n');
+    } else if (tastieraAttivaRaw()) {
+        ch = leggiTastoRaw();   // la modalità raw resta attiva: vedi leggiRigaTerminale
+    } else {
+        schermoSvuota();
+        int c = getchar();
+        int resto = c;
+        while (resto != '\n' && resto != EOF) resto = getchar();   // scarta il resto della riga
+        ch = (c == EOF) ? INPUT_FINE : (char)c;
+    }
+
+    if (ch == INPUT_FINE) {
+        stato.terminato = true;
+    } else {
+        stato.consumati++;
+        registraCarattere(ch);
+    }
+    return ch;
+}
+
+bool tastieraLeggiRiga(char* buffer, size_t dimensione) {
+    if (buffer == NULL || dimensione == 0) return false;
+    buffer[0] = '\0';
+
+    const Sessione* sessione = sessioneCorrente();
+    if (sessione->sorgente != NULL) {
+        return sessione->sorgente(sessione->contestoSorgente, buffer, dimensione);
+    }
+
+    if (stato.script != NULL) {
+        const RigaScript* riga = prossimaRigaScript();
+        if (riga == NULL) {
+            stato.terminato = true;
+            return false;
+        }
+        size_t n = riga->lunghezza < dimensione - 1 ? riga->lunghezza : dimensione - 1;
+        memcpy(buffer, riga->testo, n);
+        buffer[n] = '\0';
+        stato.consumati++;
+        registraRiga(buffer, n);
+        return true;
+    }
+
+    schermoSvuota();
+    bool letta = stato.rawAttiva ? leggiRigaTerminale(buffer, dimensione)
+                                 : leggiRigaStdin(buffer, dimensione);
+    if (!letta) {
+        stato.terminato = true;
+        return false;
+    }
+    stato.consumati++;
+    registraRiga(buffer, strlen(buffer));
+    return true;
+}
+
+void tastieraImpostaSorgente(SorgenteRighe sorgente, void* contesto) {
+    Sessione* sessione = sessioneCorrente();
+    sessione->sorgente = sorgente;
+    sessione->contestoSorgente = contesto;
+}
+
+void tastieraImpostaScript(const RigaScript* righe, int numeroRighe) {
+    stato.script = righe;
+    stato.righeScript = (righe != NULL) ? numeroRighe : 0;
+    tastieraRiavvolgiScript();
+}
+
+void tastieraRimuoviScript(void) {
+    tastieraImpostaScript(NULL, 0);
+}
+
+void tastieraRiavvolgiScript(void) {
+    stato.rigaCorrente = 0;
+    stato.terminato = false;
+    stato.consumati = 0;
+}
+
+bool tastieraInputTerminato(void) {
+    return stato.terminato;
+}
+
+long tastieraInputConsumati(void) {
+    return stato.consumati;
+}
@@ -0,0 +1,150 @@
+#ifndef TASTIERA_H
+#define TASTIERA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * Dimensione della coda circolare degli eventi di tastiera.
+ * Deve essere una potenza di 2 (l'indice viene calcolato con una maschera).
+ */
+#define DIM_CODA_TASTIERA 64
+
+/**
+ * Valore ritornato da tastieraLeggiCarattere() quando l'input è finito
+ * (EOF su stdin oppure script esaurito)
+ */
+#define INPUT_FINE ((char)EOF)
+
+// Tipi di tasto riconosciuti dal decodificatore
+typedef enum {
+    TASTO_CARATTERE = 0,           // Carattere stampabile (vedi campo carattere)
+    TASTO_INVIO,                   // Invio / a capo
+    TASTO_ESC,                     // Tasto Esc isolato
+    TASTO_BACKSPACE,               // Cancella
+    TASTO_SU,                      // Freccia su
+    TASTO_GIU,                     // Freccia giù
+    TASTO_DESTRA,                  // Freccia destra
+    TASTO_SINISTRA,                // Freccia sinistra
+    TASTO_FINE_INPUT               // Fine dell'input (EOF, Ctrl-D, terminale chiuso)
+} TipoTasto;
+
+// Singolo evento prodotto dal decodificatore
+typedef struct {
+    TipoTasto tipo;                // Tipo di tasto premuto
+    char carattere;                // Carattere associato (solo per TASTO_CARATTERE)
+} EventoTastiera;
+
+// Una riga di input già pronta (usata dagli script della modalità headless)
+typedef struct {
+    const char* testo;             // Testo della riga (non terminato da '\0')
+    size_t lunghezza;              // Numero di caratteri della riga
+} RigaScript;
+
+/**
+ * Sorgente di righe alternativa (usata dal server): scrive la prossima riga
+ * in 'buffer' senza il '\n' finale, troncandola a 'dimensione' - 1 caratteri,
+ * e ritorna false quando l'input è finito. Può sospendere la sessione
+ * finché la riga non arriva.
+ */
+typedef bool (*SorgenteRighe)(void* contesto, char* buffer, size_t dimensione);
+
+// --- MODALITÀ RAW ---
+
+/**
+ * Porta il terminale in modalità raw (niente eco, niente attesa dell'Invio)
+ * Ritorna false se lo standard input non è un terminale: in quel caso
+ * l'input va letto con le normali funzioni di stdio
+ */
+bool tastieraAttivaRaw(void);
+
+/**
+ * Ripristina le impostazioni originali del terminale
+ * Viene registrata anche con atexit() alla prima attivazione
+ */
+void tastieraRipristina(void);
+
+/**
+ * Ritorna true se il terminale è attualmente in modalità raw
+ */
+bool tastieraRawAttiva(void);
+
+// --- CODA DEGLI EVENTI ---
+
+/**
+ * Legge senza bloccare i byte disponibili, li decodifica e ritorna
+ * il prossimo evento in coda
+ * Ritorna false se non ci sono eventi pronti
+ */
+bool tastieraProssimoEvento(EventoTastiera* evento);
+
+/**
+ * Come tastieraProssimoEvento() ma attende al massimo timeoutMs millisecondi
+ * (timeoutMs < 0 attende indefinitamente)
+ */
+bool tastieraAttendiEvento(EventoTastiera* evento, int timeoutMs);
+
+/**
+ * Descrittore da usare per multiplexare la tastiera con altre sorgenti
+ * (poll/epoll); -1 se non disponibile sulla piattaforma
+ */
+int tastieraDescrittore(void);
+
+// --- LETTURA PER I MENU ---
+
+/**
+ * Legge la scelta di un menu (un solo carattere) dalla sorgente corrente
+ * - Script: primo carattere della prossima riga
+ * - Terminale: un tasto in modalità raw; le frecce diventano w/s/a/d
+ *   (così il codice Konami si digita con le frecce) e il tasto viene ripetuto a schermo
+ * - Pipe/file: primo carattere della riga, il resto della riga viene scartato
+ * Ritorna '\n' per una riga vuota e INPUT_FINE quando l'input è finito
+ */
+char tastieraLeggiCarattere(void);
+
+/**
+ * Legge una riga intera dalla sorgente corrente, senza il '\n' finale
+ * La parte di riga che non entra nel buffer viene scartata
+ * Ritorna false se l'input è finito
+ */
+bool tastieraLeggiRiga(char* buffer, size_t dimensione);
+
+// --- SORGENTE DELLA SESSIONE ---
+
+/**
+ * Fa leggere alla sessione corrente le righe di 'sorgente' invece di stdin o
+ * dello script (NULL per tornare indietro); l'input non viene registrato
+ */
+void tastieraImpostaSorgente(SorgenteRighe sorgente, void* contesto);
+
+// --- SORGENTE SCRIPT ---
+
+/**
+ * Fa leggere l'input dalle righe indicate invece che da stdin
+ * Le righe non vengono copiate: devono restare valide finché lo script è attivo
+ */
+void tastieraImpostaScript(const RigaScript* righe, int numeroRighe);
+
+/**
+ * Torna a leggere da stdin
+ */
+void tastieraRimuoviScript(void);
+
+/**
+ * Riporta lo script alla prima riga e azzera il contatore degli input
+ */
+void tastieraRiavvolgiScript(void);
+
+/**
+ * Ritorna true se l'ultima lettura ha trovato l'input finito
+ * (questo e il contatore seguente valgono per stdin e lo script, non per le sorgenti di sessione)
+ */
+bool tastieraInputTerminato(void);
+
+/**
+ * Numero di input (caratteri di menu o righe) consumati dall'ultimo riavvolgimento
+ */
+long tastieraInputConsumati(void);
+
+#endif // TASTIERA_H
@@ -1,34 +1,179 @@
+/**
+ * @file trucchi.c
+ * @brief Riconoscimento dei codici trucco con un automa Aho-Corasick
+ *
+ * @details
+ * I codici registrati vengono compilati in un automa a stati finiti deterministico:
+ * ogni tasto fa avanzare lo stato con un solo accesso a tabella, senza buffer
+ * e senza terminatore. Il costo per tasto non dipende da quanti codici ci sono.
+ *
+ * Per tenere piccola la tabella le colonne non sono i 256 byte possibili ma solo
+ * le "classi" di caratteri che compaiono nei codici (la classe 0 raccoglie tutti
+ * gli altri caratteri e riporta sempre allo stato iniziale).
+ */
+
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include "trucchi.h"
+#include "opzioni.h"
+#include "sessione.h"
+
+// Numero massimo di stati: nel caso peggiore uno per ogni carattere di ogni codice, più la radice
+#define MAX_STATI_TRUCCHI (MAX_TRUCCHI_REGISTRATI * MAX_LUNGHEZZA_TRUCCO + 1)
+
+// Codici registrati di default
+static const struct {
+    const char* codice;
+    int id;
+} TRUCCHI_PREDEFINITI[] = {
+    { "wwssadadba", TRUCCO_MENU },      // su su giù giù sinistra destra sinistra destra b a
+};
+
+// Registro dei codici (prima della compilazione)
+static char codici[MAX_TRUCCHI_REGISTRATI][MAX_LUNGHEZZA_TRUCCO + 1];
+static int idCodici[MAX_TRUCCHI_REGISTRATI];
+static int numeroCodici = 0;
+static bool predefinitiRegistrati = false;
 
-static const char TRUCCHI[] = "wwssadadba";
+// Automa compilato
+static uint8_t classe[256];             // Carattere -> colonna della tabella (0 = carattere estraneo)
+static int numeroClassi = 1;            // Colonne usate (classe 0 compresa)
+static uint16_t* transizioni = NULL;    // [stato * numeroClassi + classe] -> stato successivo
+static int16_t* uscita = NULL;          // Id del codice più lungo che termina in questo stato
+static int numeroStati = 0;
+static bool compilato = false;
 
-static bool carattereTruccoValido(char c) {
-    size_t len = strlen(TRUCCHI);
-    for (size_t i = 0; i < len; i++) {
-        if (TRUCCHI[i] == c)
-            return true;
+static void registraPredefiniti(void) {
+    if (predefinitiRegistrati) return;
+    predefinitiRegistrati = true;
+    for (size_t i = 0; i < sizeof(TRUCCHI_PREDEFINITI) / sizeof(TRUCCHI_PREDEFINITI[0]); i++) {
+        registraTrucco(TRUCCHI_PREDEFINITI[i].codice, TRUCCHI_PREDEFINITI[i].id);
     }
-    return false;
 }
 
-bool confrontoString(const char *input) {
-    return strcmp(input, TRUCCHI) == 0;
+bool registraTrucco(const char* codice, int id) {
+    if (codice == NULL || id < 0 || id > INT16_MAX) return false;
+
+    size_t len = strlen(codice);
+    if (len == 0 || len > MAX_LUNGHEZZA_TRUCCO || numeroCodici >= MAX_TRUCCHI_REGISTRATI) return false;
+
+    registraPredefiniti();
+    memcpy(codici[numeroCodici], codice, len + 1);
+    idCodici[numeroCodici] = id;
+    numeroCodici++;
+    compilato = false;      // la prossima pressione ricompila l'automa
+    return true;
 }
 
-bool carattereValido(char c, bool trucchiAttivi) {
-    if (trucchiAttivi) {
-        if (c == '1' || c == '2' || c == '3')
-            return true;
-        return false;
-    } else {
-        if (c == '1' || c == '2' || c == ' ' || c == '0')
-            return true;
+/**
+ * @brief Costruisce la tabella delle transizioni
+ *
+ * @details
+ * 1. Assegna una classe ad ogni carattere usato nei codici
+ * 2. Inserisce i codici in un trie (le transizioni mancanti valgono 0)
+ * 3. Visita il trie in ampiezza calcolando i collegamenti di fallimento e
+ *    completando le transizioni mancanti: trans[s][c] = trans[fail(s)][c].
+ *    L'uscita di uno stato è il suo codice o, se non ne ha, quella del suo fallimento.
+ */
+bool compilaTrucchi(void) {
+    registraPredefiniti();
 
-        if (carattereTruccoValido(c))
-            return true;
+    // 1. Classi dei caratteri
+    memset(classe, 0, sizeof(classe));
+    numeroClassi = 1;
+    int statiMassimi = 1;
+    for (int i = 0; i < numeroCodici; i++) {
+        for (const unsigned char* p = (const unsigned char*)codici[i]; *p; p++) {
+            if (classe[*p] == 0) classe[*p] = (uint8_t)numeroClassi++;
+            statiMassimi++;
+        }
+    }
+    if (statiMassimi > MAX_STATI_TRUCCHI || statiMassimi > UINT16_MAX) return false;
 
+    free(transizioni);
+    free(uscita);
+    transizioni = calloc((size_t)statiMassimi * (size_t)numeroClassi, sizeof(uint16_t));
+    uscita = malloc((size_t)statiMassimi * sizeof(int16_t));
+    int* fallimento = malloc((size_t)statiMassimi * sizeof(int));
+    int* codaBfs = malloc((size_t)statiMassimi * sizeof(int));
+    if (!transizioni || !uscita || !fallimento || !codaBfs) {
+        free(fallimento);
+        free(codaBfs);
+        compilato = false;
         return false;
     }
+
+    // 2. Trie
+    numeroStati = 1;
+    uscita[0] = TRUCCO_NESSUNO;
+    for (int i = 0; i < numeroCodici; i++) {
+        int s = 0;
+        for (const unsigned char* p = (const unsigned char*)codici[i]; *p; p++) {
+            uint16_t* t = &transizioni[s * numeroClassi + classe[*p]];
+            if (*t == 0) {
+                uscita[numeroStati] = TRUCCO_NESSUNO;
+                *t = (uint16_t)numeroStati++;
+            }
+            s = *t;
+        }
+        if (uscita[s] == TRUCCO_NESSUNO) uscita[s] = (int16_t)idCodici[i];
+    }
+
+    // 3. Visita in ampiezza: fallimenti e transizioni complete
+    int testa = 0, fondo = 0;
+    for (int c = 1; c < numeroClassi; c++) {
+        int figlio = transizioni[c];
+        if (figlio) {
+            fallimento[figlio] = 0;
+            codaBfs[fondo++] = figlio;
+        }
+    }
+    while (testa < fondo) {
+        int s = codaBfs[testa++];
+        if (uscita[s] == TRUCCO_NESSUNO) uscita[s] = uscita[fallimento[s]];
+
+        for (int c = 1; c < numeroClassi; c++) {
+            uint16_t* t = &transizioni[s * numeroClassi + c];
+            int viaFallimento = transizioni[fallimento[s] * numeroClassi + c];
+            if (*t) {
+                fallimento[*t] = viaFallimento;
+                codaBfs[fondo++] = *t;
+            } else {
+                *t = (uint16_t)viaFallimento;
+            }
+        }
+    }
+
+    free(fallimento);
+    free(codaBfs);
+    compilato = true;
+    sessioneCorrente()->statoTrucchi = 0;
+    return true;
+}
+
+int avanzaTrucchi(char c) {
+    if (!compilato && !compilaTrucchi()) return TRUCCO_NESSUNO;
+
+    // Lo stato dell'automa è della sessione: la tabella è condivisa
+    Sessione* s = sessioneCorrente();
+    s->statoTrucchi = transizioni[s->statoTrucchi * numeroClassi + classe[(unsigned char)c]];
+    return uscita[s->statoTrucchi];
+}
+
+void reimpostaTrucchi(void) {
+    sessioneCorrente()->statoTrucchi = 0;
+}
+
+/**
+ * Un tasto è valido se il menu principale ha un'azione per lui (tabella di opzioni.h)
+ * oppure, finché i trucchi non sono attivi, se appartiene a un codice trucco:
+ * due accessi a tabella, nessun confronto carattere per carattere
+ */
+bool carattereValido(char c, bool trucchiAttivi) {
+    if (!compilato && !compilaTrucchi()) return false;
+
+    const DefinizioneMenu* menu = trucchiAttivi ? &MENU_PRINCIPALE_TRUCCHI : &MENU_PRINCIPALE;
+    return (azioneMenu(menu, c) != AZIONE_NESSUNA) | (!trucchiAttivi & (classe[(unsigned char)c] != 0));
 }
@@ -3,8 +3,29 @@
 
 #include <stdbool.h>
 
-// Controlla se la stringa input corrisponde al codice trucchi
-bool confrontoString(const char *input);
+#define MAX_TRUCCHI_REGISTRATI 512      // Numero massimo di codici registrabili
+#define MAX_LUNGHEZZA_TRUCCO 64         // Lunghezza massima di un singolo codice
+
+// Identificativi dei trucchi predefiniti
+typedef enum {
+    TRUCCO_NESSUNO = -1,                // Nessun codice completato
+    TRUCCO_MENU = 0                     // Sequenza Konami: attiva il menu trucchi
+} IdTrucco;
+
+// Registra un nuovo codice con il suo identificativo (da fare prima del primo tasto)
+// Ritorna false se il codice non è valido o il registro è pieno
+bool registraTrucco(const char* codice, int id);
+
+// Costruisce l'automa (Aho-Corasick) con tutti i codici registrati
+// Viene chiamata automaticamente al primo tasto se non è già stata chiamata
+bool compilaTrucchi(void);
+
+// Avanza l'automa di un tasto: costo costante, indipendente dal numero di codici
+// Ritorna l'id del codice appena completato, o TRUCCO_NESSUNO
+int avanzaTrucchi(char c);
+
+// Riporta l'automa allo stato iniziale (nessun tasto digitato)
+void reimpostaTrucchi(void);
 
 // Controlla se il carattere c è valido come input nel menu o nella sequenza trucchi
 // trucchiAttivi = true significa che il menu ha anche opzione 3 (trucchi)
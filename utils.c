@@ -0,0 +1,735 @@
+/**
+ * @file utils.c
+ * @brief Funzioni di utilità condivise dai moduli del gioco
+ * @author [RICCARDO/LORENZO/BOLA/YUNUX]
+ * @date 2025
+ */
+
+#ifndef _WIN32
+#define _DEFAULT_SOURCE   // clock_gettime()
+#endif
+
+#include "utils.h"
+#include "sessione.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(STRUMENTAZIONE) && !defined(_WIN32)
+#include <signal.h>
+#endif
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * SEME DELLA SESSIONE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+// Il seme sta nella sessione corrente (0 finché non viene inizializzato, vedi sessione.h)
+
+uint64_t semeSessione(void) {
+    return sessioneCorrente()->seme;
+}
+
+void impostaSemeSessione(uint64_t nuovoSeme) {
+    sessioneCorrente()->seme = nuovoSeme;
+}
+
+/**
+ * @brief Genera un seme diverso ad ogni avvio
+ *
+ * @details
+ * Combina l'orologio in nanosecondi con l'indirizzo di una variabile locale
+ * (diverso ad ogni esecuzione grazie all'ASLR) e li mescola con SplitMix64.
+ */
+uint64_t inizializzaSemeSessione(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+
+    uint64_t stato = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    stato ^= (uint64_t)(uintptr_t)&stato;
+
+    uint64_t seme = splitMix64(&stato);
+    impostaSemeSessione(seme);
+    return seme;
+}
+
+uint64_t splitMix64(uint64_t* stato) {
+    uint64_t z = (*stato += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * TEMPO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/**
+ * @brief Orologio monotono in nanosecondi
+ *
+ * @details
+ * Su POSIX usa CLOCK_MONOTONIC, su Windows il contatore ad alta risoluzione.
+ * L'ora del calendario (TIME_UTC) non va bene per le durate: un aggiustamento
+ * NTP durante una misura la falserebbe o la renderebbe negativa.
+ */
+int64_t adessoNs(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequenza;
+    LARGE_INTEGER contatore;
+    if (frequenza.QuadPart == 0) QueryPerformanceFrequency(&frequenza);
+    QueryPerformanceCounter(&contatore);
+    return (int64_t)(contatore.QuadPart / frequenza.QuadPart) * 1000000000LL
+         + (int64_t)(contatore.QuadPart % frequenza.QuadPart) * 1000000000LL / frequenza.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * ARENA
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+/// @brief Pezzo della catena: intestazione seguita dai dati
+struct PezzoArena {
+    PezzoArena* prossimo;
+    size_t dimensione;             // Byte di dati dopo l'intestazione
+};
+
+/// @brief Arrotonda al multiplo di ALLINEAMENTO_ARENA
+static inline size_t allineaArena(size_t n) {
+    return (n + ALLINEAMENTO_ARENA - 1) & ~(size_t)(ALLINEAMENTO_ARENA - 1);
+}
+
+/// @brief Primo byte di dati di un pezzo
+static inline char* datiPezzo(PezzoArena* p) {
+    return (char*)p + allineaArena(sizeof(PezzoArena));
+}
+
+/// @brief Byte liberi nel pezzo corrente (0 se non c'è)
+static inline size_t liberiArena(const Arena* a) {
+    return (size_t)((uintptr_t)a->fine - (uintptr_t)a->cima);
+}
+
+static void usaPezzo(Arena* a, PezzoArena* p) {
+    a->corrente = p;
+    a->cima = p ? datiPezzo(p) : NULL;
+    a->fine = p ? a->cima + p->dimensione : NULL;
+}
+
+/**
+ * @brief Passa a un pezzo con almeno 'dimensione' byte liberi
+ *
+ * @details
+ * Se il pezzo successivo (rimasto da uno svuotamento) è abbastanza grande si
+ * riusa, altrimenti se ne alloca uno nuovo e lo si inserisce subito dopo il
+ * corrente: i pezzi già in catena restano disponibili per dopo.
+ */
+static bool nuovoPezzo(Arena* a, size_t dimensione) {
+    PezzoArena* prossimo = a->corrente ? a->corrente->prossimo : a->primo;
+    if (prossimo != NULL && prossimo->dimensione >= dimensione) {
+        usaPezzo(a, prossimo);
+        return true;
+    }
+
+    size_t dati = dimensione > a->dimensionePezzo ? dimensione : a->dimensionePezzo;
+    PezzoArena* p = malloc(allineaArena(sizeof(PezzoArena)) + dati);
+    if (p == NULL) return false;
+
+    p->dimensione = dati;
+    p->prossimo = prossimo;
+    if (a->corrente) a->corrente->prossimo = p;
+    else a->primo = p;
+    usaPezzo(a, p);
+    return true;
+}
+
+void inizializzaArena(Arena* a, size_t dimensionePezzo) {
+    memset(a, 0, sizeof(*a));
+    a->dimensionePezzo = dimensionePezzo ? allineaArena(dimensionePezzo) : DIM_PEZZO_ARENA;
+}
+
+void* allocaArena(Arena* a, size_t dimensione) {
+    size_t n = allineaArena(dimensione ? dimensione : 1);
+    if (liberiArena(a) < n && !nuovoPezzo(a, n)) return NULL;
+
+    a->ultima = a->cima;
+    a->cima += n;
+    return a->ultima;
+}
+
+void* allocaArenaAzzerata(Arena* a, size_t dimensione) {
+    void* p = allocaArena(a, dimensione);
+    if (p != NULL) memset(p, 0, dimensione);
+    return p;
+}
+
+void* ingrandisciArena(Arena* a, void* blocco, size_t vecchia, size_t nuova) {
+    if (blocco != NULL && blocco == a->ultima &&
+        (size_t)(a->fine - a->ultima) >= allineaArena(nuova)) {
+        a->cima = a->ultima + allineaArena(nuova);
+        return blocco;
+    }
+
+    void* nuovo = allocaArena(a, nuova);
+    if (nuovo != NULL && blocco != NULL) memcpy(nuovo, blocco, vecchia < nuova ? vecchia : nuova);
+    return nuovo;
+}
+
+SegnoArena segnaArena(const Arena* a) {
+    SegnoArena segno = { a->corrente, a->cima };
+    return segno;
+}
+
+void ripristinaArena(Arena* a, SegnoArena segno) {
+    usaPezzo(a, segno.pezzo);
+    if (segno.pezzo != NULL) a->cima = segno.cima;
+    a->ultima = NULL;
+    a->epoca++;
+}
+
+void svuotaArena(Arena* a) {
+    usaPezzo(a, NULL);
+    a->ultima = NULL;
+    a->epoca++;
+}
+
+void liberaArena(Arena* a) {
+    if (a == NULL) return;
+    PezzoArena* p = a->primo;
+    while (p != NULL) {
+        PezzoArena* prossimo = p->prossimo;
+        free(p);
+        p = prossimo;
+    }
+    inizializzaArena(a, a->dimensionePezzo);
+}
+
+Arena* arenaSessione(void) {
+    return &sessioneCorrente()->arena;
+}
+
+void* allocaMemoria(Arena* arena, size_t dimensione) {
+    if (arena == NULL) return calloc(1, dimensione ? dimensione : 1);
+    return allocaArenaAzzerata(arena, dimensione);
+}
+
+void* ingrandisciMemoria(Arena* arena, void* blocco, size_t vecchia, size_t nuova) {
+    if (arena == NULL) return realloc(blocco, nuova ? nuova : 1);
+    return ingrandisciArena(arena, blocco, vecchia, nuova);
+}
+
+void rilasciaMemoria(Arena* arena, void* blocco) {
+    if (arena == NULL) free(blocco);
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * LISTE LIBERE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+void inizializzaListaLibera(ListaLibera* l, Arena* arena, size_t dimensione) {
+    l->arena = arena;
+    l->testa = NULL;
+    l->dimensione = dimensione > sizeof(void*) ? dimensione : sizeof(void*);
+    l->epoca = arena->epoca;
+}
+
+/// @brief Dimentica gli oggetti liberi se l'arena è stata svuotata o ripristinata
+static inline void controllaEpoca(ListaLibera* l) {
+    if (l->epoca != l->arena->epoca) {
+        l->testa = NULL;
+        l->epoca = l->arena->epoca;
+    }
+}
+
+void* prendiDaLista(ListaLibera* l) {
+    controllaEpoca(l);
+    void* oggetto = l->testa;
+    if (oggetto == NULL) return allocaArenaAzzerata(l->arena, l->dimensione);
+
+    memcpy(&l->testa, oggetto, sizeof(void*));
+    memset(oggetto, 0, l->dimensione);
+    return oggetto;
+}
+
+void restituisciALista(ListaLibera* l, void* oggetto) {
+    if (oggetto == NULL) return;
+    controllaEpoca(l);
+    memcpy(oggetto, &l->testa, sizeof(void*));
+    l->testa = oggetto;
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * LAVORI IN PARALLELO
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+#define GIRI_PRIMA_DI_DORMIRE 64           // Tentativi di furto a vuoto prima di addormentarsi
+
+/**
+ * @brief Coda di un lavoratore (Chase-Lev a capacità fissa)
+ *
+ * @details
+ * Il proprietario mette e toglie in basso; i ladri tolgono in alto con un
+ * compare-and-swap. Un posto viene riscritto solo dopo che 'alto' lo ha
+ * superato, quindi chi legge un posto e vince il CAS ha letto un lavoro intero.
+ */
+typedef struct {
+    _Atomic long alto;             // Prossimo lavoro da rubare
+    char separazioneAlto[64 - sizeof(long)];
+    _Atomic long basso;            // Prossimo posto libero del proprietario
+    char separazioneBasso[64 - sizeof(long)];
+    Lavoro* _Atomic lavori[DIM_CODA_LAVORI];
+} CodaLavori;
+
+// Argomento di un thread del pool
+typedef struct {
+    PoolLavori* pool;
+    int indice;
+} AvvioLavoratore;
+
+struct PoolLavori {
+    int numero;                    // Lavoratori, compreso il thread esterno
+    int avviati;                   // Thread creati (lavoratori 1 .. avviati)
+    _Atomic bool fermo;            // Chiesto l'arresto dei thread
+    _Atomic unsigned segnale;      // Cambia ad ogni lavoro messo in coda
+    _Atomic int dormienti;         // Thread addormentati sulla condizione
+    pthread_mutex_t blocco;
+    pthread_cond_t sveglia;
+    pthread_mutex_t esterno;       // Preso dal thread esterno che usa la coda 0
+    pthread_t thread[MAX_LAVORATORI];
+    AvvioLavoratore avvio[MAX_LAVORATORI];
+    CodaLavori code[];             // Una per lavoratore
+};
+
+// Pool e indice del lavoratore che gira su questo thread (il thread esterno non ne ha)
+static _Thread_local PoolLavori* poolCorrente;
+static _Thread_local int indiceCorrente;
+
+/// @brief Indice del lavoratore del thread chiamante in 'pool' (0 per il thread esterno)
+static inline int lavoratoreCorrente(const PoolLavori* pool) {
+    return poolCorrente == pool ? indiceCorrente : 0;
+}
+
+/// @brief Mette un lavoro in basso nella propria coda (false se è piena)
+static bool mettiInCoda(CodaLavori* c, Lavoro* l) {
+    long b = atomic_load_explicit(&c->basso, memory_order_relaxed);
+    long a = atomic_load_explicit(&c->alto, memory_order_acquire);
+    if (b - a >= DIM_CODA_LAVORI) return false;
+
+    atomic_store_explicit(&c->lavori[b & (DIM_CODA_LAVORI - 1)], l, memory_order_relaxed);
+    atomic_store_explicit(&c->basso, b + 1, memory_order_release);
+    return true;
+}
+
+/// @brief Toglie l'ultimo lavoro messo nella propria coda (NULL se è vuota)
+static Lavoro* togliDaCoda(CodaLavori* c) {
+    long b = atomic_load_explicit(&c->basso, memory_order_relaxed) - 1;
+    // seq_cst: i ladri devono vedere il nuovo basso prima che si legga alto
+    atomic_store_explicit(&c->basso, b, memory_order_seq_cst);
+    long a = atomic_load_explicit(&c->alto, memory_order_seq_cst);
+
+    if (a > b) {
+        atomic_store_explicit(&c->basso, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    Lavoro* l = atomic_load_explicit(&c->lavori[b & (DIM_CODA_LAVORI - 1)], memory_order_relaxed);
+    if (a == b) {
+        // Ultimo lavoro: si contende con i ladri
+        if (!atomic_compare_exchange_strong_explicit(&c->alto, &a, a + 1,
+                                                     memory_order_seq_cst, memory_order_relaxed)) {
+            l = NULL;
+        }
+        atomic_store_explicit(&c->basso, b + 1, memory_order_relaxed);
+    }
+    return l;
+}
+
+/// @brief Ruba il lavoro più vecchio di una coda altrui (NULL se è vuota o un altro ladro ha vinto)
+static Lavoro* rubaDaCoda(CodaLavori* c) {
+    long a = atomic_load_explicit(&c->alto, memory_order_seq_cst);
+    long b = atomic_load_explicit(&c->basso, memory_order_seq_cst);
+    if (a >= b) return NULL;
+
+    Lavoro* l = atomic_load_explicit(&c->lavori[a & (DIM_CODA_LAVORI - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&c->alto, &a, a + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return NULL;
+    }
+    return l;
+}
+
+/// @brief Esegue un lavoro e lo segna come finito nel suo gruppo
+static void eseguiLavoro(Lavoro* l, int lavoratore) {
+    GruppoLavori* gruppo = l->gruppo;
+    l->funzione(l->argomento, lavoratore);
+    // Dopo questa riga 'l' può non esistere più
+    atomic_fetch_sub_explicit(&gruppo->rimasti, 1, memory_order_release);
+}
+
+/// @brief Un lavoro dalla propria coda o, se è vuota, rubato agli altri partendo dal vicino
+static Lavoro* cercaLavoro(PoolLavori* pool, int lavoratore) {
+    Lavoro* l = togliDaCoda(&pool->code[lavoratore]);
+    for (int i = 1; l == NULL && i < pool->numero; i++) {
+        l = rubaDaCoda(&pool->code[(lavoratore + i) % pool->numero]);
+    }
+    return l;
+}
+
+/// @brief Ciclo dei thread del pool: lavora finché c'è lavoro, poi dorme fino al prossimo
+static void* cicloLavoratore(void* argomento) {
+    const AvvioLavoratore* avvio = argomento;
+    PoolLavori* pool = avvio->pool;
+    int indice = avvio->indice;
+    poolCorrente = pool;
+    indiceCorrente = indice;
+
+    while (!atomic_load_explicit(&pool->fermo, memory_order_acquire)) {
+        // Il segnale va letto prima dell'ultimo giro: un lavoro messo dopo lo cambia
+        unsigned segnale = atomic_load(&pool->segnale);
+
+        Lavoro* l = NULL;
+        for (int giro = 0; l == NULL && giro < GIRI_PRIMA_DI_DORMIRE; giro++) {
+            l = cercaLavoro(pool, indice);
+        }
+        if (l != NULL) {
+            eseguiLavoro(l, indice);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->blocco);
+        atomic_fetch_add(&pool->dormienti, 1);
+        while (atomic_load(&pool->segnale) == segnale && !atomic_load(&pool->fermo)) {
+            pthread_cond_wait(&pool->sveglia, &pool->blocco);
+        }
+        atomic_fetch_sub(&pool->dormienti, 1);
+        pthread_mutex_unlock(&pool->blocco);
+    }
+    return NULL;
+}
+
+/// @brief Sveglia un thread addormentato (se ce n'è uno) dopo aver messo un lavoro in coda
+static void svegliaLavoratore(PoolLavori* pool) {
+    atomic_fetch_add(&pool->segnale, 1);
+    if (atomic_load(&pool->dormienti) > 0) {
+        pthread_mutex_lock(&pool->blocco);
+        pthread_cond_signal(&pool->sveglia);
+        pthread_mutex_unlock(&pool->blocco);
+    }
+}
+
+int numeroCore(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int n = (int)info.dwNumberOfProcessors;
+#else
+    int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (n < 1) n = 1;
+    return n > MAX_LAVORATORI ? MAX_LAVORATORI : n;
+}
+
+PoolLavori* creaPoolLavori(int lavoratori, bool deterministico) {
+    if (lavoratori <= 0) lavoratori = numeroCore();
+    if (lavoratori > MAX_LAVORATORI) lavoratori = MAX_LAVORATORI;
+    if (deterministico) lavoratori = 1;
+
+    PoolLavori* pool = calloc(1, sizeof(PoolLavori) + sizeof(CodaLavori) * (size_t)lavoratori);
+    if (pool == NULL) return NULL;
+
+    pool->numero = lavoratori;
+    pthread_mutex_init(&pool->blocco, NULL);
+    pthread_cond_init(&pool->sveglia, NULL);
+    pthread_mutex_init(&pool->esterno, NULL);
+
+    // Il lavoratore 0 è il thread esterno
+    for (int i = 1; i < lavoratori; i++) {
+        pool->avvio[i] = (AvvioLavoratore){ pool, i };
+        if (pthread_create(&pool->thread[i], NULL, cicloLavoratore, &pool->avvio[i]) != 0) {
+            liberaPoolLavori(pool);
+            return NULL;
+        }
+        pool->avviati = i;
+    }
+    return pool;
+}
+
+void liberaPoolLavori(PoolLavori* pool) {
+    if (pool == NULL) return;
+
+    pthread_mutex_lock(&pool->blocco);
+    atomic_store(&pool->fermo, true);
+    pthread_cond_broadcast(&pool->sveglia);
+    pthread_mutex_unlock(&pool->blocco);
+
+    for (int i = 1; i <= pool->avviati; i++) {
+        pthread_join(pool->thread[i], NULL);
+    }
+    pthread_cond_destroy(&pool->sveglia);
+    pthread_mutex_destroy(&pool->blocco);
+    pthread_mutex_destroy(&pool->esterno);
+    free(pool);
+}
+
+int numeroLavoratori(const PoolLavori* pool) {
+    return pool != NULL ? pool->numero : 1;
+}
+
+static PoolLavori* poolCondiviso;
+static pthread_once_t poolCondivisoCreato = PTHREAD_ONCE_INIT;
+
+static void liberaPoolGioco(void) {
+    liberaPoolLavori(poolCondiviso);
+    poolCondiviso = NULL;
+}
+
+static void creaPoolGioco(void) {
+    poolCondiviso = creaPoolLavori(0, false);
+    if (poolCondiviso != NULL) atexit(liberaPoolGioco);
+}
+
+PoolLavori* poolGioco(void) {
+    pthread_once(&poolCondivisoCreato, creaPoolGioco);
+    return poolCondiviso;
+}
+
+void inizializzaGruppoLavori(GruppoLavori* gruppo) {
+    atomic_init(&gruppo->rimasti, 0);
+}
+
+void avviaLavoro(PoolLavori* pool, GruppoLavori* gruppo, Lavoro* lavoro,
+                 FunzioneLavoro funzione, void* argomento) {
+    int lavoratore = lavoratoreCorrente(pool);
+    *lavoro = (Lavoro){ funzione, argomento, gruppo };
+
+    if (pool == NULL || pool->numero == 1) {
+        funzione(argomento, lavoratore);
+        return;
+    }
+
+    atomic_fetch_add_explicit(&gruppo->rimasti, 1, memory_order_relaxed);
+    if (mettiInCoda(&pool->code[lavoratore], lavoro)) {
+        svegliaLavoratore(pool);
+    } else {
+        eseguiLavoro(lavoro, lavoratore);
+    }
+}
+
+void attendiGruppo(PoolLavori* pool, GruppoLavori* gruppo) {
+    if (pool == NULL) return;
+    int lavoratore = lavoratoreCorrente(pool);
+
+    while (atomic_load_explicit(&gruppo->rimasti, memory_order_acquire) > 0) {
+        Lavoro* l = cercaLavoro(pool, lavoratore);
+        if (l != NULL) {
+            eseguiLavoro(l, lavoratore);
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+// Parte di un perOgni(): gli indici [da, a), già allineati ai pezzi
+typedef struct {
+    PoolLavori* pool;
+    long da;
+    long a;
+    long granularita;
+    CorpoPerOgni corpo;
+    void* argomento;
+} IntervalloPerOgni;
+
+/**
+ * @brief Divide un intervallo a metà (sul confine di un pezzo) finché non resta un pezzo solo
+ *
+ * @details
+ * Ogni metà destra diventa un lavoro che un altro thread può rubare; la metà
+ * sinistra prosegue qui. Così chi ruba prende sempre la parte più grande
+ * rimasta e i lavori in coda sono pochi (logaritmici nei pezzi).
+ */
+static void eseguiIntervallo(void* argomento, int lavoratore) {
+    const IntervalloPerOgni* intervallo = argomento;
+    long g = intervallo->granularita;
+    long da = intervallo->da;
+    long a = intervallo->a;
+
+    IntervalloPerOgni destre[64];
+    Lavoro lavori[64];
+    GruppoLavori gruppo;
+    inizializzaGruppoLavori(&gruppo);
+
+    for (int n = 0; n < 64 && a - da > g; n++) {
+        long pezzi = (a - da + g - 1) / g;
+        long meta = da + (pezzi / 2) * g;
+        destre[n] = *intervallo;
+        destre[n].da = meta;
+        destre[n].a = a;
+        avviaLavoro(intervallo->pool, &gruppo, &lavori[n], eseguiIntervallo, &destre[n]);
+        a = meta;
+    }
+
+    for (long x = da; x < a; x += g) {
+        intervallo->corpo(intervallo->argomento, x, a - x > g ? x + g : a, lavoratore);
+    }
+    attendiGruppo(intervallo->pool, &gruppo);
+}
+
+/// @brief perOgni() sequenziale: stessi pezzi, in ordine, sul chiamante
+static void eseguiInOrdine(long inizio, long fine, long granularita, CorpoPerOgni corpo,
+                           void* argomento, int lavoratore) {
+    for (long x = inizio; x < fine; x += granularita) {
+        corpo(argomento, x, fine - x > granularita ? x + granularita : fine, lavoratore);
+    }
+}
+
+void perOgni(PoolLavori* pool, long inizio, long fine, long granularita,
+             CorpoPerOgni corpo, void* argomento) {
+    if (granularita < 1) granularita = 1;
+    if (fine <= inizio) return;
+
+    if (pool == NULL || pool->numero == 1 || fine - inizio <= granularita) {
+        eseguiInOrdine(inizio, fine, granularita, corpo, argomento, lavoratoreCorrente(pool));
+        return;
+    }
+
+    // La coda 0 è di un solo thread esterno alla volta: gli altri fanno tutto da soli
+    bool esterno = poolCorrente != pool;
+    if (esterno && pthread_mutex_trylock(&pool->esterno) != 0) {
+        eseguiInOrdine(inizio, fine, granularita, corpo, argomento, 0);
+        return;
+    }
+
+    IntervalloPerOgni intervallo = { pool, inizio, fine, granularita, corpo, argomento };
+    eseguiIntervallo(&intervallo, lavoratoreCorrente(pool));
+
+    if (esterno) pthread_mutex_unlock(&pool->esterno);
+}
+
+/*━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━
+ * STRUMENTAZIONE
+ *━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━*/
+
+#ifdef STRUMENTAZIONE
+
+#define NOME_SONDA(id, nome) nome,
+static const char* const nomiSonde[NUMERO_SONDE] = { SONDE(NOME_SONDA) };
+#undef NOME_SONDA
+
+/// @brief Contatori di un thread, in una lista che non perde mai elementi
+typedef struct ThreadSonde {
+    ContatoreSonda contatori[NUMERO_SONDE];
+    struct ThreadSonde* prossimo;
+} ThreadSonde;
+
+_Thread_local ContatoreSonda* contatoriThread = NULL;
+
+/// @brief Thread registrati (inserimento in testa senza blocchi)
+static ThreadSonde* threadSonde = NULL;
+
+/// @brief Orologio delle sonde e nanosecondi all'avvio (per convertire i tick in tempo)
+static uint64_t tickAvvio = 0;
+static uint64_t nsAvvio = 0;
+
+/**
+ * @brief Alloca i contatori del thread e li aggiunge alla lista
+ *
+ * @details
+ * I contatori di un thread finito restano nella lista (non vengono mai
+ * liberati), così il riepilogo all'uscita comprende anche il suo lavoro.
+ */
+ContatoreSonda* registraThreadSonde(void) {
+    ThreadSonde* t = calloc(1, sizeof(ThreadSonde));
+    if (t == NULL) return NULL;
+
+    t->prossimo = __atomic_load_n(&threadSonde, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&threadSonde, &t->prossimo, t, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    contatoriThread = t->contatori;
+    return contatoriThread;
+}
+
+void stampaSonde(void) {
+    ContatoreSonda somma[NUMERO_SONDE] = {0};
+    for (ThreadSonde* t = __atomic_load_n(&threadSonde, __ATOMIC_ACQUIRE); t; t = t->prossimo) {
+        for (int i = 0; i < NUMERO_SONDE; i++) {
+            uint64_t massimo = __atomic_load_n(&t->contatori[i].massimo, __ATOMIC_RELAXED);
+            somma[i].chiamate += __atomic_load_n(&t->contatori[i].chiamate, __ATOMIC_RELAXED);
+            somma[i].totale += __atomic_load_n(&t->contatori[i].totale, __ATOMIC_RELAXED);
+            if (massimo > somma[i].massimo) somma[i].massimo = massimo;
+        }
+    }
+
+    // Nanosecondi per tick, misurati sul tempo trascorso dall'avvio
+    uint64_t tick = orologioSonde() - tickAvvio;
+    uint64_t ns = (uint64_t)adessoNs() - nsAvvio;
+    double nsPerTick = tick > 0 ? (double)ns / (double)tick : 1.0;
+
+    fprintf(stderr, "%-28s %12s %12s %12s %12s\n", "sonda", "chiamate", "totale ms", "media us", "max us");
+    for (int i = 0; i < NUMERO_SONDE; i++) {
+        if (somma[i].chiamate == 0) continue;
+        if (somma[i].totale == 0) {   // Solo conteggio
+            fprintf(stderr, "%-28s %12llu\n", nomiSonde[i], (unsigned long long)somma[i].chiamate);
+            continue;
+        }
+        double totale = (double)somma[i].totale * nsPerTick;
+        fprintf(stderr, "%-28s %12llu %12.3f %12.3f %12.3f\n", nomiSonde[i],
+                (unsigned long long)somma[i].chiamate, totale / 1e6,
+                totale / (double)somma[i].chiamate / 1e3,
+                (double)somma[i].massimo * nsPerTick / 1e3);
+    }
+}
+
+#ifndef _WIN32
+/**
+ * @brief Thread che aspetta SIGUSR1 e stampa il riepilogo
+ *
+ * @details
+ * Il segnale è bloccato in tutti i thread (la maschera viene ereditata) e
+ * arriva solo qui con sigwait(): la stampa avviene fuori da un gestore di
+ * segnale, quindi può usare fprintf.
+ */
+static void* attendiSegnaleSonde(void* argomento) {
+    const sigset_t* segnali = argomento;
+    for (;;) {
+        int segnale;
+        if (sigwait(segnali, &segnale) == 0) stampaSonde();
+    }
+    return NULL;
+}
+#endif
+
+void inizializzaStrumentazione(void) {
+    tickAvvio = orologioSonde();
+    nsAvvio = (uint64_t)adessoNs();
+    atexit(stampaSonde);
+
+#ifndef _WIN32
+    static sigset_t segnali;
+    sigemptyset(&segnali);
+    sigaddset(&segnali, SIGUSR1);
+    pthread_t thread;
+    if (pthread_sigmask(SIG_BLOCK, &segnali, NULL) == 0 &&
+        pthread_create(&thread, NULL, attendiSegnaleSonde, &segnali) == 0) {
+        pthread_detach(thread);
+    }
+#endif
+}
+
+#else
+
+void inizializzaStrumentazione(void) {}
+
+void stampaSonde(void) {}
+
+#endif // STRUMENTAZIONE
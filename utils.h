@@ -0,0 +1,400 @@
+#ifndef UTILS_H
+#define UTILS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// --- SEME DELLA SESSIONE ---
+
+/**
+ * Ritorna il seme casuale della sessione corrente
+ * Tutta la casualità del gioco deve derivare da questo seme, così una
+ * sessione registrata può essere riprodotta identica
+ */
+uint64_t semeSessione(void);
+
+/**
+ * Imposta il seme della sessione (usato dalla riproduzione di una registrazione)
+ */
+void impostaSemeSessione(uint64_t seme);
+
+/**
+ * Genera un nuovo seme non deterministico (orologio e indirizzi) e lo imposta
+ */
+uint64_t inizializzaSemeSessione(void);
+
+/**
+ * Passo del generatore SplitMix64: avanza *stato e ritorna 64 bit pseudo-casuali
+ * Utile anche per derivare semi indipendenti a partire da un seme comune
+ */
+uint64_t splitMix64(uint64_t* stato);
+
+// --- TEMPO ---
+
+/**
+ * Orologio monotono in nanosecondi (non salta se l'ora di sistema cambia)
+ * Serve solo a misurare intervalli: il valore assoluto non ha significato
+ */
+int64_t adessoNs(void);
+
+// --- ARENA ---
+
+/**
+ * Arena (regione) di memoria: una catena di pezzi da cui si alloca spostando
+ * in avanti un puntatore. Non si libera un oggetto alla volta: si torna a un
+ * segno preso in precedenza o si svuota tutto, in tempo costante. I pezzi non
+ * vengono restituiti al sistema finché l'arena non viene liberata, quindi una
+ * volta raggiunto il massimo di memoria usata non ci sono più malloc.
+ */
+
+#define DIM_PEZZO_ARENA (64 * 1024)        // Dimensione minima di un pezzo della catena
+#define ALLINEAMENTO_ARENA 16              // Allineamento di ogni allocazione
+
+typedef struct PezzoArena PezzoArena;
+
+typedef struct {
+    PezzoArena* primo;             // Primo pezzo della catena
+    PezzoArena* corrente;          // Pezzo da cui si alloca (NULL = nessuno, si riparte da primo)
+    char* cima;                    // Primo byte libero del pezzo corrente
+    char* fine;                    // Fine del pezzo corrente
+    char* ultima;                  // Inizio dell'ultima allocazione (può crescere sul posto)
+    size_t dimensionePezzo;        // Dimensione minima dei pezzi nuovi
+    uint32_t epoca;                // Cambia ad ogni svuotamento o ripristino
+} Arena;
+
+// Punto dell'arena a cui tornare con ripristinaArena()
+typedef struct {
+    PezzoArena* pezzo;
+    char* cima;
+} SegnoArena;
+
+/**
+ * Prepara un'arena vuota (nessuna allocazione finché non serve)
+ * 'dimensionePezzo' = 0 usa DIM_PEZZO_ARENA
+ */
+void inizializzaArena(Arena* a, size_t dimensionePezzo);
+
+/**
+ * Alloca 'dimensione' byte allineati ad ALLINEAMENTO_ARENA, non azzerati
+ * Ritorna NULL se la memoria non basta
+ */
+void* allocaArena(Arena* a, size_t dimensione);
+
+/**
+ * Come allocaArena() ma con la memoria azzerata
+ */
+void* allocaArenaAzzerata(Arena* a, size_t dimensione);
+
+/**
+ * Ingrandisce un blocco dell'arena conservandone i primi 'vecchia' byte
+ * Se è l'ultima allocazione e c'è spazio cresce sul posto, altrimenti viene
+ * copiato (il vecchio spazio torna libero solo con un ripristino o uno svuotamento)
+ */
+void* ingrandisciArena(Arena* a, void* blocco, size_t vecchia, size_t nuova);
+
+/**
+ * Segno della posizione corrente dell'arena
+ */
+SegnoArena segnaArena(const Arena* a);
+
+/**
+ * Libera tutto ciò che è stato allocato dopo il segno (i pezzi restano per le allocazioni successive)
+ */
+void ripristinaArena(Arena* a, SegnoArena segno);
+
+/**
+ * Libera tutto ciò che è stato allocato nell'arena (i pezzi restano per le allocazioni successive)
+ */
+void svuotaArena(Arena* a);
+
+/**
+ * Restituisce al sistema tutti i pezzi dell'arena
+ */
+void liberaArena(Arena* a);
+
+/**
+ * Arena della sessione corrente: contiene tutto lo stato di una partita
+ * (eroe, missioni, dungeon) e viene svuotata quando si torna al menu principale
+ */
+Arena* arenaSessione(void);
+
+/**
+ * Memoria azzerata da un'arena o, se 'arena' è NULL, dallo heap
+ * Permette ai moduli usati anche fuori da una sessione (simulatore) di
+ * scegliere l'allocatore senza cambiare codice
+ */
+void* allocaMemoria(Arena* arena, size_t dimensione);
+
+/**
+ * Come realloc() ma per la memoria di allocaMemoria() (la parte nuova non è azzerata)
+ */
+void* ingrandisciMemoria(Arena* arena, void* blocco, size_t vecchia, size_t nuova);
+
+/**
+ * Rilascia la memoria di allocaMemoria(): free() se viene dallo heap, niente
+ * se viene da un'arena (torna libera con ripristinaArena() o svuotaArena())
+ */
+void rilasciaMemoria(Arena* arena, void* blocco);
+
+// --- LISTE LIBERE ---
+
+/**
+ * Lista degli oggetti liberi di un tipo, allocati da un'arena
+ * Per gli oggetti che nascono e muoiono più volte nella stessa sessione: un
+ * oggetto restituito viene riusato dalla prossima richiesta invece di
+ * consumare altra arena. La lista si svuota da sola quando l'arena viene
+ * svuotata o ripristinata; un oggetto preso prima di un segno si può
+ * restituire anche dopo il ripristino.
+ */
+typedef struct {
+    Arena* arena;                  // Arena da cui vengono gli oggetti nuovi
+    void* testa;                   // Primo oggetto libero (il puntatore al prossimo sta nell'oggetto)
+    size_t dimensione;             // Byte di un oggetto (almeno un puntatore)
+    uint32_t epoca;                // Epoca dell'arena in cui la lista è valida
+} ListaLibera;
+
+/**
+ * Prepara una lista per oggetti di 'dimensione' byte allocati da 'arena'
+ */
+void inizializzaListaLibera(ListaLibera* l, Arena* arena, size_t dimensione);
+
+/**
+ * Un oggetto azzerato: dalla lista se ce n'è uno libero, altrimenti dall'arena
+ * Ritorna NULL se la memoria non basta
+ */
+void* prendiDaLista(ListaLibera* l);
+
+/**
+ * Rimette un oggetto nella lista per riusarlo
+ */
+void restituisciALista(ListaLibera* l, void* oggetto);
+
+// --- LAVORI IN PARALLELO ---
+
+/**
+ * Pool di thread con furto di lavoro: ogni lavoratore ha una coda a due
+ * estremità (Chase-Lev) dove mette i lavori che crea e da cui li riprende in
+ * ordine inverso; quando la sua coda è vuota ruba il lavoro più vecchio da
+ * quella di un altro. Chi usa il pool da fuori (il thread del gioco) fa da
+ * lavoratore 0 e lavora anche lui mentre aspetta.
+ *
+ * avviaLavoro() e attendiGruppo() vanno usati da un solo thread esterno alla
+ * volta; perOgni() si può chiamare da più thread insieme (chi trova il pool
+ * occupato da un altro thread esterno esegue i pezzi da solo, in ordine).
+ *
+ * Determinismo: perOgni() divide sempre [inizio, fine) negli stessi pezzi, qualunque
+ * sia il numero di thread, e passa ad ogni pezzo i propri estremi; chi scrive
+ * i risultati per pezzo (non per thread) li ottiene identici in ogni caso. Il
+ * modo deterministico va oltre: ogni lavoro viene eseguito subito dal thread
+ * che lo crea, nell'ordine del programma, come con un solo thread.
+ */
+
+#define MAX_LAVORATORI 64                  // Lavoratori massimi di un pool (compreso il thread esterno)
+#define DIM_CODA_LAVORI 1024               // Lavori in coda per lavoratore (potenza di 2)
+
+typedef struct PoolLavori PoolLavori;
+
+/// Funzione di un lavoro: 'lavoratore' è l'indice del thread che lo esegue (0 .. numeroLavoratori - 1)
+typedef void (*FunzioneLavoro)(void* argomento, int lavoratore);
+
+/// Corpo di perOgni(): elabora gli indici [da, a)
+typedef void (*CorpoPerOgni)(void* argomento, long da, long a, int lavoratore);
+
+// Gruppo di lavori da aspettare insieme
+typedef struct {
+    _Atomic long rimasti;          // Lavori avviati e non ancora finiti
+} GruppoLavori;
+
+// Un lavoro: la memoria è di chi lo avvia e deve restare valida finché il gruppo non è finito
+typedef struct {
+    FunzioneLavoro funzione;
+    void* argomento;
+    GruppoLavori* gruppo;
+} Lavoro;
+
+/**
+ * Crea un pool con 'lavoratori' thread compreso il chiamante (0 = uno per core)
+ * Con 'deterministico' non parte nessun thread e ogni lavoro è eseguito subito
+ * Ritorna NULL se la memoria o i thread non bastano
+ */
+PoolLavori* creaPoolLavori(int lavoratori, bool deterministico);
+
+/**
+ * Ferma i thread del pool e lo libera (non devono esserci lavori in corso)
+ */
+void liberaPoolLavori(PoolLavori* pool);
+
+/**
+ * Numero di lavoratori del pool, compreso il thread esterno
+ */
+int numeroLavoratori(const PoolLavori* pool);
+
+/**
+ * Pool condiviso dal gioco, creato al primo uso con un lavoratore per core
+ * Ritorna NULL se non può essere creato (chi lo usa ripiega sul codice sequenziale)
+ */
+PoolLavori* poolGioco(void);
+
+/**
+ * Numero di core disponibili (almeno 1, al più MAX_LAVORATORI)
+ */
+int numeroCore(void);
+
+/**
+ * Prepara un gruppo vuoto
+ */
+void inizializzaGruppoLavori(GruppoLavori* gruppo);
+
+/**
+ * Mette 'lavoro' nella coda del lavoratore corrente come parte di 'gruppo'
+ * Se la coda è piena (o il pool è deterministico) lo esegue subito
+ */
+void avviaLavoro(PoolLavori* pool, GruppoLavori* gruppo, Lavoro* lavoro,
+                 FunzioneLavoro funzione, void* argomento);
+
+/**
+ * Aspetta che tutti i lavori del gruppo siano finiti, eseguendo lavori
+ * (propri o rubati) nel frattempo
+ */
+void attendiGruppo(PoolLavori* pool, GruppoLavori* gruppo);
+
+/**
+ * Esegue 'corpo' su [inizio, fine) diviso in pezzi di 'granularita' indici
+ * (l'ultimo può essere più corto), distribuiti tra i lavoratori; ritorna
+ * quando tutti i pezzi sono finiti. I pezzi iniziano sempre a
+ * inizio + k * granularita, qualunque sia il pool. Con 'pool' NULL esegue
+ * tutto sul chiamante come lavoratore 0.
+ */
+void perOgni(PoolLavori* pool, long inizio, long fine, long granularita,
+             CorpoPerOgni corpo, void* argomento);
+
+// --- STRUMENTAZIONE ---
+
+/**
+ * Sonde di misura sui punti caldi del gioco
+ * Sono attive solo compilando con -DSTRUMENTAZIONE: altrimenti MISURA_SONDA e
+ * CONTA_SONDA non generano codice. Ogni thread aggiorna i propri contatori
+ * (chiamate, tempo totale e massimo per sonda) senza sincronizzazione; il
+ * riepilogo somma tutti i thread e viene stampato su stderr all'uscita e
+ * quando il processo riceve SIGUSR1.
+ *
+ * Le sonde sono definite una sola volta con SONDA(id, nome), come le voci dei menu.
+ */
+#define SONDE(SONDA) \
+    SONDA(SONDA_SALVA_GIOCO,           "salvaGioco") \
+    SONDA(SONDA_CONTA_SALVATAGGI,      "contaSalvataggi") \
+    SONDA(SONDA_LEGGI_SALVATAGGIO,     "leggiSalvataggioIndice") \
+    SONDA(SONDA_ESEGUI_MISSIONE,       "eseguiMissione") \
+    SONDA(SONDA_STAMPA_MENU,           "stampaVociMenu") \
+    SONDA(SONDA_MENU_MISSIONI,         "mostraMenuMissioni") \
+    SONDA(SONDA_MENU_MISSIONE,         "mostraMenuDuranteMissione") \
+    SONDA(SONDA_MENU_SALVATAGGI,       "mostraMenuSalvataggi") \
+    SONDA(SONDA_GENERA_DUNGEON,        "generaDungeon") \
+    SONDA(SONDA_ESPLORA_STANZA,        "esploraProssimaStanza") \
+    SONDA(SONDA_MATERIALIZZA_STANZA,   "stanze materializzate") \
+    SONDA(SONDA_CAMPO_VISIVO,          "calcolaCampoVisivo") \
+    SONDA(SONDA_DISEGNA_MAPPA,         "disegnaMappaDungeon") \
+    SONDA(SONDA_CERCA_PERCORSO,        "cercaPercorso") \
+    SONDA(SONDA_CAMPO_DISTANZE,        "aggiornaCampoDistanze") \
+    SONDA(SONDA_COMBATTIMENTO,         "risolviCombattimento") \
+    SONDA(SONDA_ROUND,                 "round risolti") \
+    SONDA(SONDA_ROUND_GRUPPO,          "risolviRoundGruppo") \
+    SONDA(SONDA_TABELLA_ESITI,         "calcolaTabellaEsiti")
+
+#define ENUM_SONDA(id, nome) id,
+typedef enum {
+    SONDE(ENUM_SONDA)
+    NUMERO_SONDE                   // Numero di sonde (non è una sonda)
+} IdSonda;
+#undef ENUM_SONDA
+
+/**
+ * Prepara la strumentazione: riepilogo all'uscita e su SIGUSR1
+ * Va chiamata all'avvio, prima di creare altri thread; senza STRUMENTAZIONE non fa nulla
+ */
+void inizializzaStrumentazione(void);
+
+/**
+ * Stampa su stderr chiamate, tempo totale, medio e massimo di ogni sonda usata
+ */
+void stampaSonde(void);
+
+#ifdef STRUMENTAZIONE
+
+#if !defined(__GNUC__)
+#error "La strumentazione richiede GCC o Clang (attributo cleanup)"
+#endif
+
+#include <time.h>
+
+// Contatori di una sonda in un thread (scritti solo dal thread proprietario)
+typedef struct {
+    uint64_t chiamate;
+    uint64_t totale;               // Tick dell'orologio delle sonde
+    uint64_t massimo;
+} ContatoreSonda;
+
+extern _Thread_local ContatoreSonda* contatoriThread;
+
+/**
+ * Registra i contatori del thread chiamante (alla sua prima misura)
+ */
+ContatoreSonda* registraThreadSonde(void);
+
+/**
+ * Orologio delle sonde: contatore dei cicli (rdtsc) su x86, nanosecondi altrove
+ */
+static inline uint64_t orologioSonde(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * Aggiunge chiamate e tempo ai contatori del thread
+ * Le scritture sono atomiche rilassate (costano come quelle normali) perché il
+ * riepilogo può leggerle da un altro thread
+ */
+static inline void aggiornaSonda(IdSonda id, uint64_t chiamate, uint64_t durata) {
+    ContatoreSonda* c = contatoriThread;
+    if (c == NULL && (c = registraThreadSonde()) == NULL) return;
+    c += id;
+    __atomic_store_n(&c->chiamate, c->chiamate + chiamate, __ATOMIC_RELAXED);
+    __atomic_store_n(&c->totale, c->totale + durata, __ATOMIC_RELAXED);
+    if (durata > c->massimo) __atomic_store_n(&c->massimo, durata, __ATOMIC_RELAXED);
+}
+
+// Misura in corso, chiusa automaticamente all'uscita dal blocco
+typedef struct {
+    IdSonda id;
+    uint64_t inizio;
+} MisuraSonda;
+
+static inline void chiudiMisuraSonda(MisuraSonda* m) {
+    aggiornaSonda(m->id, 1, orologioSonde() - m->inizio);
+}
+
+#define UNISCI_SONDA_(a, b) a##b
+#define UNISCI_SONDA(a, b) UNISCI_SONDA_(a, b)
+
+/// Misura il tempo da qui alla fine del blocco (qualunque sia l'uscita)
+#define MISURA_SONDA(id) \
+    MisuraSonda UNISCI_SONDA(misuraSonda_, __LINE__) __attribute__((cleanup(chiudiMisuraSonda))) = \
+        { (id), orologioSonde() }
+
+/// Conta n eventi senza misurare il tempo
+#define CONTA_SONDA(id, n) aggiornaSonda((id), (uint64_t)(n), 0)
+
+#else
+
+#define MISURA_SONDA(id) ((void)0)
+#define CONTA_SONDA(id, n) ((void)0)
+
+#endif // STRUMENTAZIONE
+
+#endif // UTILS_H